@@ -213,6 +213,18 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			  "'euclid' or 'manhattan'");
 		return -1;
 	}
+	if (opts->layout == hash_index_layout_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 BOX_INDEX_FIELD_OPTS, "layout must be either "\
+			  "'light' or 'swiss'");
+		return -1;
+	}
+	if (opts->bloom_type == bloom_type_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 BOX_INDEX_FIELD_OPTS, "bloom_type must be either "\
+			  "'classic' or 'split_block'");
+		return -1;
+	}
 	if (opts->page_size <= 0 || (opts->range_size > 0 &&
 				     opts->page_size > opts->range_size)) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
@@ -240,6 +252,18 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			 "less than or equal to 1");
 		return -1;
 	}
+	/*
+	 * Reverse iteration restores a statement from the closest
+	 * restart point, so keep the interval small.
+	 */
+	if (opts->page_restart_interval < 0 ||
+	    opts->page_restart_interval > 128) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 BOX_INDEX_FIELD_OPTS,
+			 "page_restart_interval must be greater than or "
+			 "equal to 0 and less than or equal to 128");
+		return -1;
+	}
 	return 0;
 }
 
@@ -482,6 +506,12 @@ field_def_decode(struct field_def *field, const char **data,
 				    fieldno + TUPLE_INDEX_BASE));
 		return -1;
 	}
+	if (field->compression == compression_type_MAX) {
+		diag_set(ClientError, errcode, tt_cstr(space_name, name_len),
+			 tt_sprintf("field %d has unknown compression type",
+				    fieldno + TUPLE_INDEX_BASE));
+		return -1;
+	}
 	if (!((field->is_nullable && field->nullable_action ==
 				     ON_CONFLICT_ACTION_NONE)
 	      || (!field->is_nullable
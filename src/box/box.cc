@@ -47,6 +47,7 @@
 #include "main.h"
 #include "tuple.h"
 #include "tuple_format.h"
+#include "tuple_compression.h"
 #include "session.h"
 #include "schema.h"
 #include "engine.h"
@@ -79,6 +80,7 @@
 #include "sql_stmt_cache.h"
 #include "msgpack.h"
 #include "raft.h"
+#include "snap_reader.h"
 #include "trivia/util.h"
 
 static char status[64] = "unknown";
@@ -262,8 +264,12 @@ box_process_rw(struct request *request, struct space *space,
 	        fiber_gc();
 	}
 	if (return_tuple) {
-		tuple_bless(tuple);
+		*result = tuple_decompress(tuple);
+		if (*result != NULL)
+			tuple_bless(*result);
 		tuple_unref(tuple);
+		if (*result == NULL)
+			return -1;
 	}
 	return 0;
 
@@ -672,6 +678,71 @@ box_check_readahead(int readahead)
 	}
 }
 
+static int
+box_check_iproto_threads(void)
+{
+	int threads = cfg_geti("iproto_threads");
+	if (threads <= 0 || threads > IPROTO_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "iproto_threads",
+			 tt_sprintf("must be greater than 0 and less than or "
+				    "equal to %d", IPROTO_THREADS_MAX));
+		return -1;
+	}
+	return threads;
+}
+
+static int64_t
+box_check_wal_ring_size(int64_t size)
+{
+	if (size < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_ring_size",
+			  "the value must be greater than or equal to 0");
+	}
+	return size;
+}
+
+static int
+box_check_wal_compress_threads(void)
+{
+	int threads = cfg_geti("wal_compress_threads");
+	if (threads < 0 || threads > WAL_COMPRESS_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "wal_compress_threads",
+			 tt_sprintf("must be greater than or equal to 0 and "
+				    "less than or equal to %d",
+				    WAL_COMPRESS_THREADS_MAX));
+		return -1;
+	}
+	return threads;
+}
+
+static int
+box_check_memtx_recovery_threads(void)
+{
+	int threads = cfg_geti("memtx_recovery_threads");
+	if (threads < 0 || threads > SNAP_READER_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "memtx_recovery_threads",
+			 tt_sprintf("must be greater than or equal to 0 and "
+				    "less than or equal to %d",
+				    SNAP_READER_THREADS_MAX));
+		return -1;
+	}
+	return threads;
+}
+
+static int
+box_check_memtx_checkpoint_threads(void)
+{
+	int threads = cfg_geti("memtx_checkpoint_threads");
+	if (threads < 1 || threads > MEMTX_CHECKPOINT_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "memtx_checkpoint_threads",
+			 tt_sprintf("must be greater than or equal to 1 and "
+				    "less than or equal to %d",
+				    MEMTX_CHECKPOINT_THREADS_MAX));
+		return -1;
+	}
+	return threads;
+}
+
 static void
 box_check_checkpoint_count(int checkpoint_count)
 {
@@ -692,6 +763,38 @@ box_check_wal_max_size(int64_t wal_max_size)
 	return wal_max_size;
 }
 
+static double
+box_check_wal_commit_delay(double delay)
+{
+	if (delay < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_commit_delay",
+			  "the value must not be less than zero");
+	}
+	return delay;
+}
+
+static int64_t
+box_check_compression_dict_size(int64_t size)
+{
+	if (size != 0 &&
+	    (size < XLOG_ZDICT_SIZE_MIN || size > XLOG_ZDICT_SIZE_MAX)) {
+		tnt_raise(ClientError, ER_CFG, "compression_dict_size",
+			  tt_sprintf("the value must be 0 or between %d and %d",
+				     XLOG_ZDICT_SIZE_MIN, XLOG_ZDICT_SIZE_MAX));
+	}
+	return size;
+}
+
+static int64_t
+box_check_wal_max_batch_size(int64_t size)
+{
+	if (size <= 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_max_batch_size",
+			  "the value must be greater than zero");
+	}
+	return size;
+}
+
 static ssize_t
 box_check_memory_quota(const char *quota_name)
 {
@@ -704,6 +807,17 @@ box_check_memory_quota(const char *quota_name)
 	return -1;
 }
 
+static int
+box_check_vinyl_readahead(void)
+{
+	int readahead = cfg_geti("vinyl_readahead");
+	if (readahead < 0) {
+		tnt_raise(ClientError, ER_CFG, "vinyl_readahead",
+			  "must be greater than or equal to 0");
+	}
+	return readahead;
+}
+
 static void
 box_check_vinyl_options(void)
 {
@@ -743,6 +857,7 @@ box_check_vinyl_options(void)
 		tnt_raise(ClientError, ER_CFG, "vinyl_bloom_fpr",
 			  "must be greater than 0 and less than or equal to 1");
 	}
+	box_check_vinyl_readahead();
 }
 
 static int
@@ -779,12 +894,24 @@ box_check_config(void)
 		diag_raise();
 	box_check_replication_sync_timeout();
 	box_check_readahead(cfg_geti("readahead"));
+	if (box_check_iproto_threads() < 0)
+		diag_raise();
 	box_check_checkpoint_count(cfg_geti("checkpoint_count"));
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
+	if (box_check_wal_compress_threads() < 0)
+		diag_raise();
+	box_check_wal_ring_size(cfg_geti64("wal_ring_size"));
+	box_check_wal_commit_delay(cfg_getd("wal_commit_delay"));
+	box_check_wal_max_batch_size(cfg_geti64("wal_max_batch_size"));
+	box_check_compression_dict_size(cfg_geti64("compression_dict_size"));
 	if (box_check_memory_quota("memtx_memory") < 0)
 		diag_raise();
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
+	if (box_check_memtx_recovery_threads() < 0)
+		diag_raise();
+	if (box_check_memtx_checkpoint_threads() < 0)
+		diag_raise();
 	box_check_vinyl_options();
 	if (box_check_sql_cache_size(cfg_geti("sql_cache_size")) != 0)
 		diag_raise();
@@ -1119,6 +1246,32 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+void
+box_set_compression_dict_size(void)
+{
+	int64_t size = box_check_compression_dict_size(
+			cfg_geti64("compression_dict_size"));
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_zdict_size(memtx, size);
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_zdict_size(vinyl, size);
+}
+
+void
+box_set_memtx_checkpoint_threads(void)
+{
+	int threads = box_check_memtx_checkpoint_threads();
+	if (threads < 0)
+		diag_raise();
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_checkpoint_threads(memtx, threads);
+}
+
 void
 box_set_memtx_memory(void)
 {
@@ -1181,6 +1334,20 @@ box_set_checkpoint_wal_threshold(void)
 	wal_set_checkpoint_threshold(threshold);
 }
 
+void
+box_set_wal_commit_delay(void)
+{
+	double delay = box_check_wal_commit_delay(cfg_getd("wal_commit_delay"));
+	wal_set_commit_delay(delay);
+}
+
+void
+box_set_wal_max_batch_size(void)
+{
+	int64_t size = cfg_geti64("wal_max_batch_size");
+	wal_set_max_batch_size(box_check_wal_max_batch_size(size));
+}
+
 void
 box_set_vinyl_memory(void)
 {
@@ -1209,6 +1376,22 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_page_cache(vinyl, cfg_geti64("vinyl_page_cache"));
+}
+
+void
+box_set_vinyl_readahead(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_readahead(vinyl, box_check_vinyl_readahead());
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -1222,8 +1405,9 @@ box_set_net_msg_max(void)
 {
 	int new_iproto_msg_max = cfg_geti("net_msg_max");
 	iproto_set_msg_max(new_iproto_msg_max);
+	/* The limit is per iproto thread. */
 	fiber_pool_set_max_size(&tx_fiber_pool,
-				new_iproto_msg_max *
+				new_iproto_msg_max * iproto_threads_count *
 				IPROTO_FIBER_POOL_SIZE_FACTOR);
 }
 
@@ -1387,6 +1571,49 @@ box_select(uint32_t space_id, uint32_t index_id,
 	   int iterator, uint32_t offset, uint32_t limit,
 	   const char *key, const char *key_end,
 	   struct port *port)
+{
+	return box_select_after(space_id, index_id, iterator, offset, limit,
+				key, key_end, NULL, NULL, port);
+}
+
+/**
+ * Check that pagination is supported by @a index and return the
+ * key definition positions are encoded with.
+ */
+static struct key_def *
+box_select_position_def(struct index *index)
+{
+	struct key_def *cmp_def = index->def->cmp_def;
+	if (index->def->type != TREE || cmp_def->is_multikey ||
+	    cmp_def->for_func_index) {
+		diag_set(UnsupportedIndexFeature, index->def, "pagination");
+		return NULL;
+	}
+	return cmp_def;
+}
+
+const char *
+box_select_position(uint32_t space_id, uint32_t index_id,
+		    struct tuple *tuple, uint32_t *size)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return NULL;
+	struct index *index = index_find(space, index_id);
+	if (index == NULL)
+		return NULL;
+	struct key_def *cmp_def = box_select_position_def(index);
+	if (cmp_def == NULL)
+		return NULL;
+	return tuple_extract_key(tuple, cmp_def, MULTIKEY_NONE, size);
+}
+
+int
+box_select_after(uint32_t space_id, uint32_t index_id,
+		 int iterator, uint32_t offset, uint32_t limit,
+		 const char *key, const char *key_end,
+		 const char *after, const char *after_end,
+		 struct port *port)
 {
 	(void)key_end;
 
@@ -1413,6 +1640,56 @@ box_select(uint32_t space_id, uint32_t index_id,
 	if (key_validate(index->def, type, key, part_count))
 		return -1;
 
+	/*
+	 * Resume from the position with a strict iterator and
+	 * check the original equality condition by hand, the
+	 * range bounds are satisfied by the position itself.
+	 */
+	enum iterator_type it_type = type;
+	const char *it_key = key;
+	uint32_t it_part_count = part_count;
+	bool check_eq = false;
+	if (after != NULL) {
+		struct key_def *cmp_def = box_select_position_def(index);
+		if (cmp_def == NULL)
+			return -1;
+		switch (type) {
+		case ITER_EQ:
+		case ITER_GE:
+		case ITER_GT:
+		case ITER_ALL:
+			it_type = ITER_GT;
+			break;
+		case ITER_REQ:
+		case ITER_LE:
+		case ITER_LT:
+			it_type = ITER_LT;
+			break;
+		default:
+			diag_set(ClientError, ER_ILLEGAL_PARAMS, "position "
+				 "is not supported for the iterator type");
+			return -1;
+		}
+		check_eq = (type == ITER_EQ || type == ITER_REQ) &&
+			   part_count > 0;
+		it_key = after;
+		if (mp_typeof(*it_key) != MP_ARRAY ||
+		    mp_check(&after, after_end) != 0 || after != after_end) {
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "invalid position");
+			return -1;
+		}
+		it_part_count = mp_decode_array(&it_key);
+		const char *it_key_end;
+		if (it_part_count != cmp_def->part_count ||
+		    key_validate_parts(cmp_def, it_key, it_part_count, true,
+				       &it_key_end) != 0) {
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "invalid position");
+			return -1;
+		}
+	}
+
 	ERROR_INJECT(ERRINJ_TESTING, {
 		diag_set(ClientError, ER_INJECTION, "ERRINJ_TESTING");
 		return -1;
@@ -1422,8 +1699,10 @@ box_select(uint32_t space_id, uint32_t index_id,
 	if (txn_begin_ro_stmt(space, &txn) != 0)
 		return -1;
 
-	struct iterator *it = index_create_iterator(index, type,
-						    key, part_count);
+	struct iterator *it = index_create_iterator_with_offset(index, it_type,
+								it_key,
+								it_part_count,
+								offset);
 	if (it == NULL) {
 		txn_rollback_stmt(txn);
 		return -1;
@@ -1437,9 +1716,14 @@ box_select(uint32_t space_id, uint32_t index_id,
 		rc = iterator_next(it, &tuple);
 		if (rc != 0 || tuple == NULL)
 			break;
-		if (offset > 0) {
-			offset--;
-			continue;
+		if (check_eq && tuple_compare_with_key(tuple, HINT_NONE, key,
+						       part_count, HINT_NONE,
+						       index->def->key_def) != 0)
+			break;
+		tuple = tuple_decompress(tuple);
+		if (tuple == NULL) {
+			rc = -1;
+			break;
 		}
 		rc = port_c_add_tuple(port, tuple);
 		if (rc != 0)
@@ -1457,6 +1741,93 @@ box_select(uint32_t space_id, uint32_t index_id,
 	return 0;
 }
 
+int
+box_get_many(uint32_t space_id, uint32_t index_id,
+	     const char *keys, const char *keys_end,
+	     struct port *port)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	struct index *index = index_find(space, index_id);
+	if (index == NULL)
+		return -1;
+	if (!index->def->opts.is_unique) {
+		diag_set(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		return -1;
+	}
+	const char *p = keys;
+	if (mp_typeof(*p) != MP_ARRAY || mp_check(&p, keys_end) != 0 ||
+	    p != keys_end) {
+		diag_set(ClientError, ER_ILLEGAL_PARAMS,
+			 "keys must be an array");
+		return -1;
+	}
+	uint32_t key_count = mp_decode_array(&keys);
+	p = keys;
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (mp_typeof(*p) != MP_ARRAY) {
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "key must be an array");
+			return -1;
+		}
+		uint32_t part_count = mp_decode_array(&p);
+		if (exact_key_validate(index->def->key_def, p, part_count))
+			return -1;
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&p);
+	}
+
+	rmean_collect(rmean_box, IPROTO_SELECT, 1);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	struct tuple **result = region_alloc_array(region, typeof(result[0]),
+						   key_count, &size);
+	if (result == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "result");
+		return -1;
+	}
+
+	struct txn *txn;
+	if (txn_begin_ro_stmt(space, &txn) != 0) {
+		region_truncate(region, region_svp);
+		return -1;
+	}
+	if (index_get_many(index, keys, key_count, result) != 0) {
+		txn_rollback_stmt(txn);
+		region_truncate(region, region_svp);
+		return -1;
+	}
+
+	int rc = 0;
+	port_c_create(port);
+	for (uint32_t i = 0; i < key_count; i++) {
+		struct tuple *tuple = result[i];
+		if (tuple == NULL)
+			continue;
+		if (rc == 0) {
+			struct tuple *decompressed = tuple_decompress(tuple);
+			if (decompressed == NULL ||
+			    port_c_add_tuple(port, decompressed) != 0)
+				rc = -1;
+		}
+		tuple_unref(tuple);
+	}
+	region_truncate(region, region_svp);
+
+	if (rc != 0) {
+		port_destroy(port);
+		txn_rollback_stmt(txn);
+		return -1;
+	}
+	txn_commit_ro_stmt(txn);
+	return 0;
+}
+
 API_EXPORT int
 box_insert(uint32_t space_id, const char *tuple, const char *tuple_end,
 	   box_tuple_t **result)
@@ -2278,6 +2649,10 @@ engine_init()
 				    cfg_getd("slab_alloc_factor"));
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
+	int recovery_threads = box_check_memtx_recovery_threads();
+	if (recovery_threads < 0)
+		diag_raise();
+	memtx_engine_set_recovery_threads(memtx, recovery_threads);
 
 	struct sysview_engine *sysview = sysview_engine_new_xc();
 	engine_register((struct engine *)sysview);
@@ -2297,6 +2672,8 @@ engine_init()
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_page_cache();
+	box_set_vinyl_readahead();
 	box_set_vinyl_timeout();
 }
 
@@ -2687,16 +3064,28 @@ box_cfg_xc(void)
 	schema_init();
 	replication_init();
 	port_init();
-	iproto_init();
+	int iproto_threads = box_check_iproto_threads();
+	if (iproto_threads < 0)
+		diag_raise();
+	iproto_init(iproto_threads, cfg_getb("iproto_io_uring"));
 	sql_init();
 
 	int64_t wal_max_size = box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
+	int wal_compress_threads = box_check_wal_compress_threads();
+	if (wal_compress_threads < 0)
+		diag_raise();
+	int64_t wal_ring_size =
+		box_check_wal_ring_size(cfg_geti64("wal_ring_size"));
 	if (wal_init(wal_mode, cfg_gets("wal_dir"), wal_max_size,
-		     &INSTANCE_UUID, on_wal_garbage_collection,
+		     wal_compress_threads, cfg_geti("wal_direct_io") != 0,
+		     wal_ring_size, &INSTANCE_UUID,
+		     on_wal_garbage_collection,
 		     on_wal_checkpoint_threshold) != 0) {
 		diag_raise();
 	}
+	box_set_wal_commit_delay();
+	box_set_wal_max_batch_size();
 
 	title("loading");
 
@@ -2924,5 +3313,6 @@ box_reset_stat(void)
 	rmean_cleanup(rmean_box);
 	rmean_cleanup(rmean_error);
 	engine_reset_stat();
+	wal_reset_stat();
 	space_foreach(box_reset_space_stat, NULL);
 }
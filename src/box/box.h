@@ -234,16 +234,22 @@ void box_set_log_level(void);
 void box_set_log_format(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+void box_set_compression_dict_size(void);
+void box_set_memtx_checkpoint_threads(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
 void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
+void box_set_wal_commit_delay(void);
+void box_set_wal_max_batch_size(void);
 void box_set_memtx_memory(void);
 void box_set_memtx_max_tuple_size(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_page_cache(void);
+void box_set_vinyl_readahead(void);
 void box_set_vinyl_timeout(void);
 int box_set_election_mode(void);
 int box_set_election_timeout(void);
@@ -276,6 +282,46 @@ box_select(uint32_t space_id, uint32_t index_id,
 	   const char *key, const char *key_end,
 	   struct port *port);
 
+/**
+ * Same as box_select(), but if @a after is not NULL, resume
+ * the iteration right after the position returned by
+ * box_select_position() for a previous page of the same select.
+ * Unlike @a offset, skipping the previous pages costs nothing.
+ * Supported for TREE indexes and iterators EQ, REQ, GE, GT, LE,
+ * LT and ALL only.
+ */
+int
+box_select_after(uint32_t space_id, uint32_t index_id,
+		 int iterator, uint32_t offset, uint32_t limit,
+		 const char *key, const char *key_end,
+		 const char *after, const char *after_end,
+		 struct port *port);
+
+/**
+ * Encode the position of @a tuple in an index to pass it to
+ * box_select_after(). The position is the tuple key including
+ * the primary key parts, so it's unique. It is allocated on
+ * the fiber region.
+ * @retval NULL on error, diag is set.
+ */
+const char *
+box_select_position(uint32_t space_id, uint32_t index_id,
+		    struct tuple *tuple, uint32_t *size);
+
+/**
+ * Look up tuples by many full keys of a unique index at once.
+ * @a keys is a MsgPack array of keys. Found tuples are put into
+ * @a port in the order of the keys, keys that match nothing are
+ * skipped. Unlike calling box_index_get() for each key, lets the
+ * engine share and parallelize the work needed to find the keys.
+ *
+ * box_get_many is private and used only by FFI.
+ */
+API_EXPORT int
+box_get_many(uint32_t space_id, uint32_t index_id,
+	     const char *keys, const char *keys_end,
+	     struct port *port);
+
 /** \cond public */
 
 /*
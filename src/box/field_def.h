@@ -79,6 +79,13 @@ enum on_conflict_action {
 
 /** \endcond public */
 
+/** Way a field value is compressed in a stored tuple. */
+enum compression_type {
+	COMPRESSION_TYPE_NONE = 0,
+	COMPRESSION_TYPE_ZSTD,
+	compression_type_MAX
+};
+
 enum {
 	/**
 	 * This mask allows to store in VdbeOp.p5 operand of
@@ -99,6 +106,8 @@ extern const char *field_type_strs[];
 
 extern const char *on_conflict_action_strs[];
 
+extern const char *compression_type_strs[];
+
 /** Check if @a type1 can store values of @a type2. */
 bool
 field_type1_contains_type2(enum field_type type1, enum field_type type2);
@@ -144,6 +153,8 @@ struct field_def {
 	char *default_value;
 	/** AST for parsed default value. */
 	struct Expr *default_value_expr;
+	/** Compression of the field value in stored tuples. */
+	enum compression_type compression;
 };
 
 /**
@@ -30,6 +30,7 @@
  */
 #include "index.h"
 #include "tuple.h"
+#include "tuple_compression.h"
 #include "say.h"
 #include "schema.h"
 #include "user_def.h"
@@ -215,8 +216,12 @@ box_index_random(uint32_t space_id, uint32_t index_id, uint32_t rnd,
 	/* No tx management, random() is for approximation anyway. */
 	if (index_random(index, rnd, result) != 0)
 		return -1;
-	if (*result != NULL)
+	if (*result != NULL) {
+		*result = tuple_decompress(*result);
+		if (*result == NULL)
+			return -1;
 		tuple_bless(*result);
+	}
 	return 0;
 }
 
@@ -248,8 +253,12 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	txn_commit_ro_stmt(txn);
 	/* Count statistics. */
 	rmean_collect(rmean_box, IPROTO_SELECT, 1);
-	if (*result != NULL)
+	if (*result != NULL) {
+		*result = tuple_decompress(*result);
+		if (*result == NULL)
+			return -1;
 		tuple_bless(*result);
+	}
 	return 0;
 }
 
@@ -280,8 +289,12 @@ box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 		return -1;
 	}
 	txn_commit_ro_stmt(txn);
-	if (*result != NULL)
+	if (*result != NULL) {
+		*result = tuple_decompress(*result);
+		if (*result == NULL)
+			return -1;
 		tuple_bless(*result);
+	}
 	return 0;
 }
 
@@ -312,8 +325,12 @@ box_index_max(uint32_t space_id, uint32_t index_id, const char *key,
 		return -1;
 	}
 	txn_commit_ro_stmt(txn);
-	if (*result != NULL)
+	if (*result != NULL) {
+		*result = tuple_decompress(*result);
+		if (*result == NULL)
+			return -1;
 		tuple_bless(*result);
+	}
 	return 0;
 }
 
@@ -393,8 +410,12 @@ box_iterator_next(box_iterator_t *itr, box_tuple_t **result)
 	assert(result != NULL);
 	if (iterator_next(itr, result) != 0)
 		return -1;
-	if (*result != NULL)
+	if (*result != NULL) {
+		*result = tuple_decompress(*result);
+		if (*result == NULL)
+			return -1;
 		tuple_bless(*result);
+	}
 	return 0;
 }
 
@@ -508,7 +529,7 @@ index_delete(struct index *index)
 }
 
 int
-index_build(struct index *index, struct index *pk)
+index_build_keys(struct index *index, struct index *pk)
 {
 	ssize_t n_tuples = index_size(pk);
 	if (n_tuples < 0)
@@ -542,9 +563,14 @@ index_build(struct index *index, struct index *pk)
 			break;
 	}
 	iterator_delete(it);
-	if (rc != 0)
-		return -1;
+	return rc;
+}
 
+int
+index_build(struct index *index, struct index *pk)
+{
+	if (index_build_keys(index, pk) != 0)
+		return -1;
 	index_end_build(index);
 	return 0;
 }
@@ -668,6 +694,27 @@ generic_index_get(struct index *index, const char *key,
 	return -1;
 }
 
+int
+generic_index_get_many(struct index *index, const char *keys,
+		       uint32_t key_count, struct tuple **result)
+{
+	for (uint32_t i = 0; i < key_count; i++) {
+		uint32_t part_count = mp_decode_array(&keys);
+		if (index_get(index, keys, part_count, &result[i]) != 0) {
+			for (uint32_t j = 0; j < i; j++) {
+				if (result[j] != NULL)
+					tuple_unref(result[j]);
+			}
+			return -1;
+		}
+		if (result[i] != NULL)
+			tuple_ref(result[i]);
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&keys);
+	}
+	return 0;
+}
+
 int
 generic_index_replace(struct index *index, struct tuple *old_tuple,
 		      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -690,6 +737,28 @@ generic_index_create_iterator(struct index *base, enum iterator_type type,
 	return NULL;
 }
 
+struct iterator *
+generic_index_create_iterator_with_offset(struct index *base,
+					  enum iterator_type type,
+					  const char *key, uint32_t part_count,
+					  uint32_t offset)
+{
+	struct iterator *it = index_create_iterator(base, type,
+						    key, part_count);
+	if (it == NULL)
+		return NULL;
+	struct tuple *tuple;
+	for (; offset > 0; offset--) {
+		if (iterator_next(it, &tuple) != 0) {
+			iterator_delete(it);
+			return NULL;
+		}
+		if (tuple == NULL)
+			break;
+	}
+	return it;
+}
+
 
 struct snapshot_iterator *
 generic_index_create_snapshot_iterator(struct index *index)
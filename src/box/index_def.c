@@ -39,6 +39,8 @@ const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *hash_index_layout_strs[] = { "light", "swiss" };
+
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
 	/* .dimension           = */ 2,
@@ -48,10 +50,14 @@ const struct index_opts index_opts_default = {
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
 	/* .bloom_fpr           = */ 0.05,
+	/* .bloom_type          = */ BLOOM_TYPE_CLASSIC,
+	/* .page_restart_interval = */ 0,
 	/* .lsn                 = */ 0,
 	/* .stat                = */ NULL,
 	/* .func                = */ 0,
 	/* .hint                = */ true,
+	/* .layout              = */ HASH_INDEX_LAYOUT_LIGHT,
+	/* .normalized_keys     = */ false,
 };
 
 const struct opt_def index_opts_reg[] = {
@@ -64,10 +70,18 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
+	OPT_DEF_ENUM("bloom_type", bloom_type, struct index_opts, bloom_type,
+		     NULL),
+	OPT_DEF("page_restart_interval", OPT_INT64, struct index_opts,
+		page_restart_interval),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
 	OPT_DEF("hint", OPT_BOOL, struct index_opts, hint),
+	OPT_DEF_ENUM("layout", hash_index_layout, struct index_opts, layout,
+		     NULL),
+	OPT_DEF("normalized_keys", OPT_BOOL, struct index_opts,
+		normalized_keys),
 	OPT_END,
 };
 
@@ -34,6 +34,7 @@
 #include "key_def.h"
 #include "opt_def.h"
 #include "small/rlist.h"
+#include "salad/bloom.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -58,6 +59,15 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+enum hash_index_layout {
+	/* Chained hash table, see salad/light.h */
+	HASH_INDEX_LAYOUT_LIGHT,
+	/* Open addressing hash table, see salad/swiss.h */
+	HASH_INDEX_LAYOUT_SWISS,
+	hash_index_layout_MAX
+};
+extern const char *hash_index_layout_strs[];
+
 /** Simple alias to represent logarithm metrics. */
 typedef int16_t log_est_t;
 
@@ -153,6 +163,14 @@ struct index_opts {
 	double run_size_ratio;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/** Layout of bloom filters of vinyl runs. */
+	enum bloom_type bloom_type;
+	/**
+	 * Number of statements between restart points of run
+	 * pages stored with key prefix compression. 0 disables
+	 * prefix compression.
+	 */
+	int64_t page_restart_interval;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -169,6 +187,15 @@ struct index_opts {
 	 * Use hint optimization for tree index.
 	 */
 	bool hint;
+	/**
+	 * Hash table layout of memtx hash index.
+	 */
+	enum hash_index_layout layout;
+	/**
+	 * Store normalized keys of tuples in memtx tree index,
+	 * see tuple_normalized_key().
+	 */
+	bool normalized_keys;
 };
 
 extern const struct index_opts index_opts_default;
@@ -213,10 +240,19 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->bloom_type != o2->bloom_type)
+		return o1->bloom_type < o2->bloom_type ? -1 : 1;
+	if (o1->page_restart_interval != o2->page_restart_interval)
+		return o1->page_restart_interval < o2->page_restart_interval ?
+		       -1 : 1;
 	if (o1->func_id != o2->func_id)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
 		return o1->hint - o2->hint;
+	if (o1->layout != o2->layout)
+		return o1->layout < o2->layout ? -1 : 1;
+	if (o1->normalized_keys != o2->normalized_keys)
+		return o1->normalized_keys - o2->normalized_keys;
 	return 0;
 }
 
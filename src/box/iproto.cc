@@ -57,6 +57,9 @@
 #include "session.h"
 #include "xrow.h"
 #include "schema.h" /* schema_version */
+#include "space.h"
+#include "index.h"
+#include "tuple.h"
 #include "replication.h" /* instance_uuid */
 #include "iproto_constants.h"
 #include "rmean.h"
@@ -64,8 +67,19 @@
 #include "errinj.h"
 #include "tt_static.h"
 
+#if defined(HAVE_LIBURING)
+#include <sys/eventfd.h>
+#include <liburing.h>
+#endif /* defined(HAVE_LIBURING) */
+
 enum {
 	IPROTO_SALT_SIZE = 32,
+	/**
+	 * Minimal size of SELECT result tuples data which is
+	 * sent without copying it to the output buffer. Smaller
+	 * result sets are cheaper to copy than to track.
+	 */
+	IPROTO_ZC_REPLY_SIZE_MIN = 16384,
 	IPROTO_PACKET_SIZE_MAX = 2UL * 1024 * 1024 * 1024,
 };
 
@@ -126,9 +140,18 @@ struct iproto_kharon {
  */
 unsigned iproto_readahead = 16320;
 
-/* The maximal number of iproto messages in fly. */
+/**
+ * The maximal number of iproto messages in fly per thread.
+ * Used only in tx, network threads have their own copies.
+ */
 static int iproto_msg_max = IPROTO_MSG_MAX_MIN;
 
+/**
+ * True if network threads should try to use io_uring for
+ * socket reads and writes. Set once in iproto_init().
+ */
+static bool iproto_use_io_uring = false;
+
 /**
  * Address the iproto listens for, stored in TX
  * thread. Is kept in TX to be shown in box.info.
@@ -232,10 +255,13 @@ struct iproto_msg
 	 * and the connection must be closed.
 	 */
 	bool close_connection;
+	/**
+	 * SELECT result set which is written to the socket
+	 * right from the tuple memory, see iproto_zc_reply.
+	 */
+	struct iproto_zc_reply *zc_reply;
 };
 
-static struct mempool iproto_msg_pool;
-
 static struct iproto_msg *
 iproto_msg_new(struct iproto_connection *con);
 
@@ -243,45 +269,14 @@ iproto_msg_new(struct iproto_connection *con);
  * Resume stopped connections, if any.
  */
 static void
-iproto_resume(void);
+iproto_resume(struct iproto_thread *iproto_thread);
 
 static void
 iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input);
 
 static inline void
-iproto_msg_delete(struct iproto_msg *msg)
-{
-	mempool_free(&iproto_msg_pool, msg);
-	iproto_resume();
-}
-
-/**
- * A single global queue for all requests in all connections. All
- * requests from all connections are processed concurrently.
- * Is also used as a queue for just established connections and to
- * execute disconnect triggers. A few notes about these triggers:
- * - they need to be run in a fiber
- * - unlike an ordinary request failure, on_connect trigger
- *   failure must lead to connection close.
- * - on_connect trigger must be processed before any other
- *   request on this connection.
- */
-static struct cpipe tx_pipe;
-static struct cpipe net_pipe;
-
-/**
- * Network thread.
- */
-static struct cord net_cord;
-
-/**
- * Slab cache used for allocating memory for output network buffers
- * in the tx thread.
- */
-static struct slab_cache net_slabc;
-
-struct rmean *rmean_net;
+iproto_msg_delete(struct iproto_msg *msg);
 
 enum rmean_net_name {
 	IPROTO_SENT,
@@ -298,16 +293,137 @@ const char *rmean_net_strings[IPROTO_LAST] = {
 	"REQUESTS",
 };
 
+/**
+ * State of a single network thread. Client connections are
+ * spread among several such threads: all of them listen on the
+ * same socket and the kernel hands every accepted connection to
+ * one of them. A connection is served by the thread which has
+ * accepted it until it is closed.
+ */
+struct iproto_thread {
+	/** Thread number, from 0 to iproto_threads_count - 1. */
+	int id;
+	/**
+	 * A single queue for all requests in all connections
+	 * of this thread. All requests from all connections are
+	 * processed concurrently.
+	 * Is also used as a queue for just established connections and to
+	 * execute disconnect triggers. A few notes about these triggers:
+	 * - they need to be run in a fiber
+	 * - unlike an ordinary request failure, on_connect trigger
+	 *   failure must lead to connection close.
+	 * - on_connect trigger must be processed before any other
+	 *   request on this connection.
+	 */
+	struct cpipe tx_pipe;
+	struct cpipe net_pipe;
+	/** Network thread. */
+	struct cord net_cord;
+	/**
+	 * Slab cache used for allocating memory for output network
+	 * buffers in the tx thread.
+	 */
+	struct slab_cache net_slabc;
+	/** Messages of connections served by this thread. */
+	struct mempool iproto_msg_pool;
+	/** Connections served by this thread. */
+	struct mempool iproto_connection_pool;
+	/**
+	 * Connections whose input was stopped because the thread
+	 * has reached net_msg_max limit.
+	 */
+	struct rlist stopped_connections;
+	/**
+	 * The maximal number of messages in fly in this thread,
+	 * a copy of iproto_msg_max owned by the network thread.
+	 */
+	int msg_max;
+	/** Network statistics of this thread. */
+	struct rmean *rmean;
+	/** Iproto binary listener of this thread. */
+	struct evio_service binary;
+	/**
+	 * Routes of cbus messages. Each thread has its own set,
+	 * since a route embeds a pointer to the thread net_pipe.
+	 */
+	struct cmsg_hop destroy_route[2];
+	struct cmsg_hop disconnect_route[2];
+	struct cmsg_hop push_route[2];
+	struct cmsg_hop misc_route[2];
+	struct cmsg_hop call_route[2];
+	struct cmsg_hop select_route[2];
+	struct cmsg_hop process1_route[2];
+	struct cmsg_hop sql_route[2];
+	struct cmsg_hop join_route[2];
+	struct cmsg_hop subscribe_route[2];
+	struct cmsg_hop error_route[2];
+	struct cmsg_hop connect_route[2];
+	/** Net -> tx route to release a written zero-copy reply. */
+	struct cmsg_hop zc_release_route[1];
+	const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX];
+#if defined(HAVE_LIBURING)
+	/**
+	 * Asynchronous socket I/O. Reads and writes of all
+	 * connections issued during an event loop iteration are
+	 * submitted to the kernel with a single syscall right
+	 * before the loop blocks, completions are reaped when
+	 * the ring eventfd becomes readable.
+	 */
+	struct {
+		/** False if io_uring is disabled or unsupported. */
+		bool is_enabled;
+		struct io_uring ring;
+		/** Number of queued, but not submitted requests. */
+		int pending;
+		/** Watcher of the eventfd signalled on completions. */
+		struct ev_io complete_ev;
+		/** Submits pending requests before the loop blocks. */
+		struct ev_prepare submit_ev;
+	} uring;
+#endif /* defined(HAVE_LIBURING) */
+};
+
+/**
+ * SELECT result set sent to the client without copying it to
+ * the output buffer. The tx thread references the result tuples
+ * and builds an iovec per tuple pointing to the tuple data. Only
+ * the reply header is written to the output buffer, the network
+ * thread splices the tuple data into the output stream right
+ * after it and sends the reply back to tx to unreference the
+ * tuples once the data is written.
+ */
+struct iproto_zc_reply {
+	/** Release message, net -> tx. */
+	struct cmsg base;
+	/** Link in iproto_connection::zc_replies. */
+	struct rlist in_connection;
+	/** Output buffer position the data is spliced at. */
+	struct obuf *obuf;
+	struct obuf_svp svp;
+	/** Referenced tuples. */
+	struct tuple **tuples;
+	/** Data of the tuples, one iovec per tuple. */
+	struct iovec *iov;
+	/** Number of tuples. */
+	int count;
+	/** Number of fully written iovecs. */
+	int iov_pos;
+	/** Number of written bytes of iov[iov_pos]. */
+	size_t iov_offset;
+};
+
+/** Network threads, allocated in iproto_init(). */
+static struct iproto_thread *iproto_threads;
+int iproto_threads_count;
+
 static void
 tx_process_destroy(struct cmsg *m);
 
 static void
-net_finish_destroy(struct cmsg *m);
+tx_zc_reply_delete(struct iproto_zc_reply *zc);
 
-static const struct cmsg_hop destroy_route[] = {
-	{ tx_process_destroy, &net_pipe },
-	{ net_finish_destroy, NULL },
-};
+static void
+net_finish_destroy(struct cmsg *m);
 
 /** Fire on_disconnect triggers in the tx thread. */
 static void
@@ -317,11 +433,6 @@ tx_process_disconnect(struct cmsg *m);
 static void
 net_finish_disconnect(struct cmsg *m);
 
-static const struct cmsg_hop disconnect_route[] = {
-	{ tx_process_disconnect, &net_pipe },
-	{ net_finish_disconnect, NULL }
-};
-
 /**
  * Kharon is in the dead world (iproto). Schedule an event to
  * flush new obuf as reflected in the fresh wpos.
@@ -339,12 +450,6 @@ iproto_process_push(struct cmsg *m);
 static void
 tx_end_push(struct cmsg *m);
 
-static const struct cmsg_hop push_route[] = {
-	{ iproto_process_push, &tx_pipe },
-	{ tx_end_push, NULL }
-};
-
-
 /* }}} */
 
 /* {{{ iproto_connection - declaration and definition */
@@ -534,29 +639,56 @@ struct iproto_connection
 	} tx;
 	/** Authentication salt. */
 	char salt[IPROTO_SALT_SIZE];
+	/** Network thread serving the connection. */
+	struct iproto_thread *iproto_thread;
+	/**
+	 * Zero-copy replies, which data hasn't been written
+	 * yet, in the output order. Used by the iproto thread
+	 * and released by tx_process_destroy().
+	 */
+	struct rlist zc_replies;
+#if defined(HAVE_LIBURING)
+	/** State of socket I/O submitted to io_uring. */
+	struct {
+		/** True if recv() into p_ibuf is in progress. */
+		bool is_read_in_flight;
+		/** True if writev() of the output is in progress. */
+		bool is_write_in_flight;
+		/** Position in the output the in-flight write ends at. */
+		struct obuf_svp write_end;
+		/** The in-flight write, must live until completion. */
+		struct iovec iov[SMALL_OBUF_IOV_MAX + 1];
+	} uring;
+#endif /* defined(HAVE_LIBURING) */
 };
 
-static struct mempool iproto_connection_pool;
-static RLIST_HEAD(stopped_connections);
-
 /**
  * Return true if we have not enough spare messages
- * in the message pool.
+ * in the message pool of the thread.
  */
 static inline bool
-iproto_check_msg_max(void)
+iproto_check_msg_max(struct iproto_thread *iproto_thread)
 {
-	size_t request_count = mempool_count(&iproto_msg_pool);
-	return request_count > (size_t) iproto_msg_max;
+	size_t request_count = mempool_count(&iproto_thread->iproto_msg_pool);
+	return request_count > (size_t) iproto_thread->msg_max;
+}
+
+static inline void
+iproto_msg_delete(struct iproto_msg *msg)
+{
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
+	mempool_free(&iproto_thread->iproto_msg_pool, msg);
+	iproto_resume(iproto_thread);
 }
 
 static struct iproto_msg *
 iproto_msg_new(struct iproto_connection *con)
 {
-	struct iproto_msg *msg =
-		(struct iproto_msg *) mempool_alloc(&iproto_msg_pool);
+	struct iproto_thread *iproto_thread = con->iproto_thread;
+	struct iproto_msg *msg = (struct iproto_msg *)
+		mempool_alloc(&iproto_thread->iproto_msg_pool);
 	ERROR_INJECT(ERRINJ_TESTING, {
-		mempool_free(&iproto_msg_pool, msg);
+		mempool_free(&iproto_thread->iproto_msg_pool, msg);
 		msg = NULL;
 	});
 	if (msg == NULL) {
@@ -566,7 +698,8 @@ iproto_msg_new(struct iproto_connection *con)
 		return NULL;
 	}
 	msg->connection = con;
-	rmean_collect(rmean_net, IPROTO_REQUESTS, 1);
+	msg->zc_reply = NULL;
+	rmean_collect(iproto_thread->rmean, IPROTO_REQUESTS, 1);
 	return msg;
 }
 
@@ -588,6 +721,11 @@ iproto_msg_new(struct iproto_connection *con)
 static inline bool
 iproto_connection_is_idle(struct iproto_connection *con)
 {
+#if defined(HAVE_LIBURING)
+	/* The kernel may still be using the connection buffers. */
+	if (con->uring.is_read_in_flight || con->uring.is_write_in_flight)
+		return false;
+#endif
 	return con->long_poll_count == 0 &&
 	       ibuf_used(&con->ibuf[0]) == 0 &&
 	       ibuf_used(&con->ibuf[1]) == 0;
@@ -621,7 +759,8 @@ iproto_connection_stop_msg_max_limit(struct iproto_connection *con)
 	 * Important to add to tail and fetch from head to ensure
 	 * strict lifo order (fairness) for stopped connections.
 	 */
-	rlist_add_tail(&stopped_connections, &con->in_stop_list);
+	rlist_add_tail(&con->iproto_thread->stopped_connections,
+		       &con->in_stop_list);
 }
 
 /**
@@ -650,7 +789,7 @@ iproto_connection_try_to_start_destroy(struct iproto_connection *con)
 	 * other parts of the connection.
 	 */
 	con->state = IPROTO_CONNECTION_DESTROYED;
-	cpipe_push(&tx_pipe, &con->destroy_msg);
+	cpipe_push(&con->iproto_thread->tx_pipe, &con->destroy_msg);
 }
 
 /**
@@ -669,6 +808,19 @@ iproto_connection_close(struct iproto_connection *con)
 		int fd = con->input.fd;
 		/* Make evio_has_fd() happy */
 		con->input.fd = con->output.fd = -1;
+#if defined(HAVE_LIBURING)
+		/*
+		 * io_uring holds its own reference to the socket, so
+		 * closing the fd neither closes the socket nor
+		 * completes the requests in flight. Shut the socket
+		 * down to make them complete: the completion finishes
+		 * closing the connection, see
+		 * iproto_connection_uring_check_closed().
+		 */
+		if (con->uring.is_read_in_flight ||
+		    con->uring.is_write_in_flight)
+			shutdown(fd, SHUT_RDWR);
+#endif
 		close(fd);
 		/*
 		 * Discard unparsed data, to recycle the
@@ -677,7 +829,7 @@ iproto_connection_close(struct iproto_connection *con)
 		 * is done only once.
 		 */
 		con->p_ibuf->wpos -= con->parse_size;
-		cpipe_push(&tx_pipe, &con->disconnect_msg);
+		cpipe_push(&con->iproto_thread->tx_pipe, &con->disconnect_msg);
 		assert(con->state == IPROTO_CONNECTION_ALIVE);
 		con->state = IPROTO_CONNECTION_CLOSED;
 	} else if (con->state == IPROTO_CONNECTION_PENDING_DESTROY) {
@@ -807,13 +959,14 @@ static inline int
 iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 {
 	assert(rlist_empty(&con->in_stop_list));
+	struct cpipe *tx_pipe = &con->iproto_thread->tx_pipe;
 	int n_requests = 0;
 	bool stop_input = false;
 	const char *errmsg;
 	while (con->parse_size != 0 && !stop_input) {
-		if (iproto_check_msg_max()) {
+		if (iproto_check_msg_max(con->iproto_thread)) {
 			iproto_connection_stop_msg_max_limit(con);
-			cpipe_flush_input(&tx_pipe);
+			cpipe_flush_input(tx_pipe);
 			return 0;
 		}
 		const char *reqstart = in->wpos - con->parse_size;
@@ -822,7 +975,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		if (mp_typeof(*pos) != MP_UINT) {
 			errmsg = "packet length";
 err_msgpack:
-			cpipe_flush_input(&tx_pipe);
+			cpipe_flush_input(tx_pipe);
 			diag_set(ClientError, ER_INVALID_MSGPACK,
 				 errmsg);
 			return -1;
@@ -858,7 +1011,7 @@ err_msgpack:
 		 * This can't throw, but should not be
 		 * done in case of exception.
 		 */
-		cpipe_push_input(&tx_pipe, &msg->base);
+		cpipe_push_input(tx_pipe, &msg->base);
 		n_requests++;
 		/* Request is parsed */
 		assert(reqend > reqstart);
@@ -896,7 +1049,7 @@ err_msgpack:
 		 */
 		ev_feed_event(con->loop, &con->input, EV_READ);
 	}
-	cpipe_flush_input(&tx_pipe);
+	cpipe_flush_input(tx_pipe);
 	return 0;
 }
 
@@ -908,7 +1061,7 @@ err_msgpack:
 static void
 iproto_connection_resume(struct iproto_connection *con)
 {
-	assert(! iproto_check_msg_max());
+	assert(! iproto_check_msg_max(con->iproto_thread));
 	rlist_del(&con->in_stop_list);
 	/*
 	 * Enqueue_batch() stops the connection again, if the
@@ -932,21 +1085,49 @@ iproto_connection_resume(struct iproto_connection *con)
  * necessary to use up the limit.
  */
 static void
-iproto_resume(void)
+iproto_resume(struct iproto_thread *iproto_thread)
 {
-	while (!iproto_check_msg_max() && !rlist_empty(&stopped_connections)) {
+	while (!iproto_check_msg_max(iproto_thread) &&
+	       !rlist_empty(&iproto_thread->stopped_connections)) {
 		/*
 		 * Shift from list head to ensure strict FIFO
 		 * (fairness) for resumed connections.
 		 */
 		struct iproto_connection *con =
-			rlist_first_entry(&stopped_connections,
+			rlist_first_entry(&iproto_thread->stopped_connections,
 					  struct iproto_connection,
 					  in_stop_list);
 		iproto_connection_resume(con);
 	}
 }
 
+/**
+ * Account @a nrd bytes read into @a in and enqueue all requests
+ * which are fully read up. Throws on error.
+ */
+static void
+iproto_connection_on_read(struct iproto_connection *con, struct ibuf *in,
+			  size_t nrd)
+{
+	/* Count statistics */
+	rmean_collect(con->iproto_thread->rmean, IPROTO_RECEIVED, nrd);
+
+	/* Update the read position and connection state. */
+	in->wpos += nrd;
+	con->parse_size += nrd;
+	/* Enqueue all requests which are fully read up. */
+	if (iproto_enqueue_batch(con, in) != 0)
+		diag_raise();
+}
+
+#if defined(HAVE_LIBURING)
+static int
+iproto_connection_uring_read(struct iproto_connection *con, struct ibuf *in);
+
+static void
+iproto_connection_uring_write(struct iproto_connection *con);
+#endif /* defined(HAVE_LIBURING) */
+
 static void
 iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			   int /* revents */)
@@ -957,12 +1138,17 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	assert(fd >= 0);
 	assert(rlist_empty(&con->in_stop_list));
 	assert(loop == con->loop);
+#if defined(HAVE_LIBURING)
+	/* The input is handled on the read completion. */
+	if (con->uring.is_read_in_flight)
+		return;
+#endif
 	/*
 	 * Throttle if there are too many pending requests,
 	 * otherwise we might deplete the fiber pool in tx
 	 * thread and deadlock.
 	 */
-	if (iproto_check_msg_max()) {
+	if (iproto_check_msg_max(con->iproto_thread)) {
 		iproto_connection_stop_msg_max_limit(con);
 		return;
 	}
@@ -974,6 +1160,11 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			iproto_connection_stop_readahead_limit(con);
 			return;
 		}
+#if defined(HAVE_LIBURING)
+		if (con->iproto_thread->uring.is_enabled &&
+		    iproto_connection_uring_read(con, in) == 0)
+			return;
+#endif
 		/* Read input. */
 		int nrd = sio_read(fd, in->wpos, ibuf_unused(in));
 		if (nrd < 0) {                  /* Socket is not ready. */
@@ -986,15 +1177,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			iproto_connection_close(con);
 			return;
 		}
-		/* Count statistics */
-		rmean_collect(rmean_net, IPROTO_RECEIVED, nrd);
-
-		/* Update the read position and connection state. */
-		in->wpos += nrd;
-		con->parse_size += nrd;
-		/* Enqueue all requests which are fully read up. */
-		if (iproto_enqueue_batch(con, in) != 0)
-			diag_raise();
+		iproto_connection_on_read(con, in, nrd);
 	} catch (Exception *e) {
 		/* Best effort at sending the error message to the client. */
 		iproto_write_error(fd, e, ::schema_version, 0);
@@ -1003,16 +1186,90 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	}
 }
 
-/** writev() to the socket and handle the result. */
+/** {{{ Zero-copy replies in the iproto thread. */
 
+/** The first zero-copy reply awaiting to be written, if any. */
+static inline struct iproto_zc_reply *
+iproto_connection_zc_reply(struct iproto_connection *con)
+{
+	if (rlist_empty(&con->zc_replies))
+		return NULL;
+	return rlist_first_entry(&con->zc_replies, struct iproto_zc_reply,
+				 in_connection);
+}
+
+/**
+ * True if the output up to the zero-copy reply has been flushed
+ * and its data goes next.
+ */
+static inline bool
+iproto_zc_reply_is_next(struct iproto_connection *con,
+			struct iproto_zc_reply *zc)
+{
+	return zc->obuf == con->wpos.obuf &&
+	       zc->svp.used == con->wpos.svp.used;
+}
+
+/** Fill @a iov with the not written data of @a zc. */
 static int
-iproto_flush(struct iproto_connection *con)
+iproto_zc_reply_prepare(struct iproto_zc_reply *zc, struct iovec *iov)
+{
+	assert(zc->iov_pos < zc->count);
+	int iovcnt = MIN(zc->count - zc->iov_pos, SMALL_OBUF_IOV_MAX + 1);
+	memcpy(iov, zc->iov + zc->iov_pos, iovcnt * sizeof(struct iovec));
+	iov[0].iov_base = (char *) iov[0].iov_base + zc->iov_offset;
+	iov[0].iov_len -= zc->iov_offset;
+	return iovcnt;
+}
+
+/**
+ * Advance the written position of @a zc by @a nwr bytes. When
+ * all the data is written, send the reply to tx to release it.
+ * @retval 0 Written up to an iovec boundary, can flush more.
+ * @retval -1 Partial write.
+ */
+static int
+iproto_zc_reply_advance(struct iproto_connection *con,
+			struct iproto_zc_reply *zc, size_t nwr)
+{
+	while (nwr > 0) {
+		assert(zc->iov_pos < zc->count);
+		size_t left = zc->iov[zc->iov_pos].iov_len - zc->iov_offset;
+		if (nwr < left) {
+			zc->iov_offset += nwr;
+			return -1;
+		}
+		nwr -= left;
+		zc->iov_pos++;
+		zc->iov_offset = 0;
+	}
+	if (zc->iov_pos == zc->count) {
+		rlist_del_entry(zc, in_connection);
+		cpipe_push(&con->iproto_thread->tx_pipe, &zc->base);
+	}
+	return 0;
+}
+
+/** }}} */
+
+/**
+ * Fill @a iov with the output awaiting to be flushed and set
+ * @a end to the position the output ends at.
+ * @retval Number of filled iovecs, 0 if there is nothing to flush.
+ */
+static int
+iproto_flush_prepare(struct iproto_connection *con, struct iovec *iov,
+		     struct obuf_svp *end)
 {
-	int fd = con->output.fd;
 	struct obuf *obuf = con->wpos.obuf;
 	struct obuf_svp obuf_end = obuf_create_svp(obuf);
 	struct obuf_svp *begin = &con->wpos.svp;
-	struct obuf_svp *end = &con->wend.svp;
+	struct iproto_zc_reply *zc = iproto_connection_zc_reply(con);
+	if (zc != NULL && iproto_zc_reply_is_next(con, zc)) {
+		*end = *begin;
+		return iproto_zc_reply_prepare(zc, iov);
+	}
+	*end = con->wend.svp;
 	if (con->wend.obuf != obuf) {
 		/*
 		 * Flush the current buffer before
@@ -1022,15 +1279,19 @@ iproto_flush(struct iproto_connection *con)
 			obuf = con->wpos.obuf = con->wend.obuf;
 			obuf_svp_reset(begin);
 		} else {
-			end = &obuf_end;
+			*end = obuf_end;
 		}
 	}
+	if (zc != NULL && zc->obuf == obuf && zc->svp.used < end->used) {
+		/* Stop at the zero-copy data, it goes next. */
+		assert(zc->svp.used > begin->used);
+		*end = zc->svp;
+	}
 	if (begin->used == end->used) {
 		/* Nothing to do. */
-		return 1;
+		return 0;
 	}
 	assert(begin->used < end->used);
-	struct iovec iov[SMALL_OBUF_IOV_MAX+1];
 	struct iovec *src = obuf->iov;
 	int iovcnt = end->pos - begin->pos + 1;
 	/*
@@ -1041,26 +1302,56 @@ iproto_flush(struct iproto_connection *con)
 	sio_add_to_iov(iov, -begin->iov_len);
 	/* *Overwrite* iov_len of the last pos as it may be garbage. */
 	iov[iovcnt-1].iov_len = end->iov_len - begin->iov_len * (iovcnt == 1);
+	return iovcnt;
+}
+
+/**
+ * Advance the flushed position after @a nwr bytes of @a iov
+ * prepared by iproto_flush_prepare() have been written.
+ * @retval 0 All the output up to @a end is flushed.
+ * @retval -1 Partial write.
+ */
+static int
+iproto_flush_advance(struct iproto_connection *con, struct iovec *iov,
+		     size_t nwr, const struct obuf_svp *end)
+{
+	struct obuf_svp *begin = &con->wpos.svp;
+	/* Count statistics */
+	rmean_collect(con->iproto_thread->rmean, IPROTO_SENT, nwr);
+	struct iproto_zc_reply *zc = iproto_connection_zc_reply(con);
+	if (zc != NULL && iproto_zc_reply_is_next(con, zc))
+		return iproto_zc_reply_advance(con, zc, nwr);
+	if (begin->used + nwr == end->used) {
+		*begin = *end;
+		return 0;
+	}
+	size_t offset = 0;
+	int advance = 0;
+	advance = sio_move_iov(iov, nwr, &offset);
+	begin->used += nwr;             /* advance write position */
+	begin->iov_len = advance == 0 ? begin->iov_len + offset: offset;
+	begin->pos += advance;
+	assert(begin->pos <= end->pos);
+	return -1;
+}
 
-	ssize_t nwr = sio_writev(fd, iov, iovcnt);
+/** writev() to the socket and handle the result. */
 
-	if (nwr > 0) {
-		/* Count statistics */
-		rmean_collect(rmean_net, IPROTO_SENT, nwr);
-		if (begin->used + nwr == end->used) {
-			*begin = *end;
-			return 0;
-		}
-		size_t offset = 0;
-		int advance = 0;
-		advance = sio_move_iov(iov, nwr, &offset);
-		begin->used += nwr;             /* advance write position */
-		begin->iov_len = advance == 0 ? begin->iov_len + offset: offset;
-		begin->pos += advance;
-		assert(begin->pos <= end->pos);
-	} else if (nwr < 0 && ! sio_wouldblock(errno)) {
+static int
+iproto_flush(struct iproto_connection *con)
+{
+	struct iovec iov[SMALL_OBUF_IOV_MAX+1];
+	struct obuf_svp end;
+	int iovcnt = iproto_flush_prepare(con, iov, &end);
+	if (iovcnt == 0)
+		return 1;
+
+	ssize_t nwr = sio_writev(con->output.fd, iov, iovcnt);
+
+	if (nwr > 0)
+		return iproto_flush_advance(con, iov, nwr, &end);
+	if (nwr < 0 && ! sio_wouldblock(errno))
 		diag_raise();
-	}
 	return -1;
 }
 
@@ -1070,6 +1361,12 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 {
 	struct iproto_connection *con = (struct iproto_connection *) watcher->data;
 
+#if defined(HAVE_LIBURING)
+	if (con->iproto_thread->uring.is_enabled) {
+		iproto_connection_uring_write(con);
+		return;
+	}
+#endif
 	try {
 		int rc;
 		while ((rc = iproto_flush(con)) <= 0) {
@@ -1090,11 +1387,288 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 	}
 }
 
+#if defined(HAVE_LIBURING)
+
+/** {{{ Socket I/O with io_uring. */
+
+enum {
+	/** Size of the submission queue of a network thread. */
+	IPROTO_URING_ENTRIES = 1024,
+	/**
+	 * Request user data is a connection pointer tagged
+	 * with the request type in the lowest bit.
+	 */
+	IPROTO_URING_WRITE = 1,
+};
+
+/** Get a free submission queue entry, flush the queue if full. */
+static struct io_uring_sqe *
+iproto_uring_get_sqe(struct iproto_thread *iproto_thread)
+{
+	struct io_uring *ring = &iproto_thread->uring.ring;
+	struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+	if (sqe == NULL) {
+		if (io_uring_submit(ring) < 0)
+			return NULL;
+		iproto_thread->uring.pending = 0;
+		sqe = io_uring_get_sqe(ring);
+	}
+	if (sqe != NULL)
+		iproto_thread->uring.pending++;
+	return sqe;
+}
+
+/**
+ * Submit a recv() of the next portion of input into @a in.
+ * @retval 0 The request is queued.
+ * @retval -1 The queue is full, the caller should read
+ *            synchronously.
+ */
+static int
+iproto_connection_uring_read(struct iproto_connection *con, struct ibuf *in)
+{
+	assert(in == con->p_ibuf);
+	assert(!con->uring.is_read_in_flight);
+	struct io_uring_sqe *sqe = iproto_uring_get_sqe(con->iproto_thread);
+	if (sqe == NULL)
+		return -1;
+	io_uring_prep_recv(sqe, con->input.fd, in->wpos, ibuf_unused(in), 0);
+	io_uring_sqe_set_data(sqe, con);
+	con->uring.is_read_in_flight = true;
+	/* The watcher is restarted on completion. */
+	ev_io_stop(con->loop, &con->input);
+	return 0;
+}
+
+/**
+ * Submit a writev() of the output awaiting to be flushed.
+ * Does nothing if a write is already in flight: the output
+ * is rechecked upon its completion.
+ */
+static void
+iproto_connection_uring_write(struct iproto_connection *con)
+{
+	if (con->uring.is_write_in_flight || !evio_has_fd(&con->output))
+		return;
+	if (ev_is_active(&con->output))
+		ev_io_stop(con->loop, &con->output);
+	int iovcnt = iproto_flush_prepare(con, con->uring.iov,
+					  &con->uring.write_end);
+	if (iovcnt == 0)
+		return;
+	struct io_uring_sqe *sqe = iproto_uring_get_sqe(con->iproto_thread);
+	if (sqe == NULL) {
+		/* Retry when the socket is writable. */
+		ev_io_start(con->loop, &con->output);
+		return;
+	}
+	io_uring_prep_writev(sqe, con->output.fd, con->uring.iov, iovcnt, 0);
+	io_uring_sqe_set_data(sqe, (void *)((uintptr_t)con |
+					    IPROTO_URING_WRITE));
+	con->uring.is_write_in_flight = true;
+}
+
+/**
+ * If the connection was closed while a request was in flight,
+ * it's the request completion that finishes the close.
+ * @retval true if the connection is closed.
+ */
+static bool
+iproto_connection_uring_check_closed(struct iproto_connection *con)
+{
+	if (evio_has_fd(&con->input))
+		return false;
+	if (iproto_connection_is_idle(con))
+		iproto_connection_close(con);
+	return true;
+}
+
+static void
+iproto_connection_uring_on_read(struct iproto_connection *con, int res)
+{
+	assert(con->uring.is_read_in_flight);
+	con->uring.is_read_in_flight = false;
+	if (iproto_connection_uring_check_closed(con))
+		return;
+	int fd = con->input.fd;
+	try {
+		if (res == -EAGAIN || res == -EINTR) {
+			/* Spurious wakeup, wait for more input. */
+			ev_io_start(con->loop, &con->input);
+			return;
+		}
+		if (res < 0) {
+			errno = -res;
+			diag_set(SocketError, sio_socketname(fd), "recv");
+			diag_raise();
+		}
+		if (res == 0) {                 /* EOF */
+			iproto_connection_close(con);
+			return;
+		}
+		/*
+		 * Keep watching the socket as the synchronous
+		 * path does. Enqueueing may stop it again.
+		 */
+		ev_io_start(con->loop, &con->input);
+		iproto_connection_on_read(con, con->p_ibuf, res);
+	} catch (Exception *e) {
+		/* Best effort at sending the error message to the client. */
+		iproto_write_error(fd, e, ::schema_version, 0);
+		e->log();
+		iproto_connection_close(con);
+	}
+}
+
+static void
+iproto_connection_uring_on_write(struct iproto_connection *con, int res)
+{
+	assert(con->uring.is_write_in_flight);
+	con->uring.is_write_in_flight = false;
+	if (iproto_connection_uring_check_closed(con))
+		return;
+	if (res == -EAGAIN || res == -EINTR) {
+		/* Socket buffer is full. */
+		ev_io_start(con->loop, &con->output);
+		return;
+	}
+	if (res < 0) {
+		errno = -res;
+		diag_set(SocketError, sio_socketname(con->output.fd),
+			 "writev");
+		diag_log();
+		iproto_connection_close(con);
+		return;
+	}
+	if (iproto_flush_advance(con, con->uring.iov, res,
+				 &con->uring.write_end) != 0) {
+		/* Partial write, wait until the socket is writable. */
+		ev_io_start(con->loop, &con->output);
+		return;
+	}
+	if (!ev_is_active(&con->input) && rlist_empty(&con->in_stop_list))
+		ev_feed_event(con->loop, &con->input, EV_READ);
+	/* Proceed with the output appended meanwhile, if any. */
+	iproto_connection_uring_write(con);
+}
+
+/** Reap completions of the network thread requests. */
+static void
+iproto_uring_on_complete(ev_loop * /* loop */, struct ev_io *watcher,
+			 int /* revents */)
+{
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) watcher->data;
+	struct io_uring *ring = &iproto_thread->uring.ring;
+	uint64_t count;
+	/* Reset the eventfd counter. */
+	if (read(watcher->fd, &count, sizeof(count)) < 0 &&
+	    !sio_wouldblock(errno))
+		say_syserror("io_uring eventfd read");
+	struct io_uring_cqe *cqe;
+	while (io_uring_peek_cqe(ring, &cqe) == 0) {
+		uintptr_t data = (uintptr_t) io_uring_cqe_get_data(cqe);
+		int res = cqe->res;
+		io_uring_cqe_seen(ring, cqe);
+		struct iproto_connection *con = (struct iproto_connection *)
+			(data & ~(uintptr_t) IPROTO_URING_WRITE);
+		if ((data & IPROTO_URING_WRITE) != 0)
+			iproto_connection_uring_on_write(con, res);
+		else
+			iproto_connection_uring_on_read(con, res);
+	}
+}
+
+/**
+ * Submit all requests queued during the event loop iteration
+ * with a single syscall.
+ */
+static void
+iproto_uring_on_prepare(ev_loop * /* loop */, struct ev_prepare *watcher,
+			int /* revents */)
+{
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) watcher->data;
+	if (iproto_thread->uring.pending == 0)
+		return;
+	int rc = io_uring_submit(&iproto_thread->uring.ring);
+	if (rc < 0) {
+		errno = -rc;
+		say_syserror("io_uring_submit");
+		return;
+	}
+	iproto_thread->uring.pending = 0;
+}
+
+/**
+ * Set up io_uring in the network thread. If the kernel doesn't
+ * support io_uring or any of the used operations, the thread
+ * silently keeps using the ev_io based path.
+ */
+static void
+iproto_thread_uring_create(struct iproto_thread *iproto_thread)
+{
+	struct io_uring *ring = &iproto_thread->uring.ring;
+	iproto_thread->uring.is_enabled = false;
+	iproto_thread->uring.pending = 0;
+	int rc = io_uring_queue_init(IPROTO_URING_ENTRIES, ring, 0);
+	if (rc < 0) {
+		say_warn("io_uring is not available: %s, "
+			 "falling back to epoll", strerror(-rc));
+		return;
+	}
+	struct io_uring_probe *probe = io_uring_get_probe_ring(ring);
+	bool is_supported = probe != NULL &&
+		io_uring_opcode_supported(probe, IORING_OP_RECV) &&
+		io_uring_opcode_supported(probe, IORING_OP_WRITEV);
+	free(probe);
+	if (!is_supported) {
+		say_warn("io_uring doesn't support socket operations, "
+			 "falling back to epoll");
+		io_uring_queue_exit(ring);
+		return;
+	}
+	int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (efd < 0 || io_uring_register_eventfd(ring, efd) != 0) {
+		say_syserror("io_uring eventfd, falling back to epoll");
+		if (efd >= 0)
+			close(efd);
+		io_uring_queue_exit(ring);
+		return;
+	}
+	ev_io_init(&iproto_thread->uring.complete_ev, iproto_uring_on_complete,
+		   efd, EV_READ);
+	iproto_thread->uring.complete_ev.data = iproto_thread;
+	ev_io_start(loop(), &iproto_thread->uring.complete_ev);
+	ev_prepare_init(&iproto_thread->uring.submit_ev,
+			iproto_uring_on_prepare);
+	iproto_thread->uring.submit_ev.data = iproto_thread;
+	ev_prepare_start(loop(), &iproto_thread->uring.submit_ev);
+	iproto_thread->uring.is_enabled = true;
+	say_info("%s: using io_uring for socket I/O", cord_name(cord()));
+}
+
+static void
+iproto_thread_uring_destroy(struct iproto_thread *iproto_thread)
+{
+	if (!iproto_thread->uring.is_enabled)
+		return;
+	ev_prepare_stop(loop(), &iproto_thread->uring.submit_ev);
+	ev_io_stop(loop(), &iproto_thread->uring.complete_ev);
+	close(iproto_thread->uring.complete_ev.fd);
+	io_uring_queue_exit(&iproto_thread->uring.ring);
+	iproto_thread->uring.is_enabled = false;
+}
+
+/** }}} */
+
+#endif /* defined(HAVE_LIBURING) */
+
 static struct iproto_connection *
-iproto_connection_new(int fd)
+iproto_connection_new(struct iproto_thread *iproto_thread, int fd)
 {
 	struct iproto_connection *con = (struct iproto_connection *)
-		mempool_alloc(&iproto_connection_pool);
+		mempool_alloc(&iproto_thread->iproto_connection_pool);
 	if (con == NULL) {
 		diag_set(OutOfMemory, sizeof(*con), "mempool_alloc", "con");
 		return NULL;
@@ -1105,8 +1679,8 @@ iproto_connection_new(int fd)
 	ev_io_init(&con->output, iproto_connection_on_output, fd, EV_WRITE);
 	ibuf_create(&con->ibuf[0], cord_slab_cache(), iproto_readahead);
 	ibuf_create(&con->ibuf[1], cord_slab_cache(), iproto_readahead);
-	obuf_create(&con->obuf[0], &net_slabc, iproto_readahead);
-	obuf_create(&con->obuf[1], &net_slabc, iproto_readahead);
+	obuf_create(&con->obuf[0], &iproto_thread->net_slabc, iproto_readahead);
+	obuf_create(&con->obuf[1], &iproto_thread->net_slabc, iproto_readahead);
 	con->p_ibuf = &con->ibuf[0];
 	con->tx.p_obuf = &con->obuf[0];
 	iproto_wpos_create(&con->wpos, con->tx.p_obuf);
@@ -1115,13 +1689,19 @@ iproto_connection_new(int fd)
 	con->long_poll_count = 0;
 	con->session = NULL;
 	rlist_create(&con->in_stop_list);
+	rlist_create(&con->zc_replies);
 	/* It may be very awkward to allocate at close. */
-	cmsg_init(&con->destroy_msg, destroy_route);
-	cmsg_init(&con->disconnect_msg, disconnect_route);
+	cmsg_init(&con->destroy_msg, iproto_thread->destroy_route);
+	cmsg_init(&con->disconnect_msg, iproto_thread->disconnect_route);
 	con->state = IPROTO_CONNECTION_ALIVE;
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = false;
-	rmean_collect(rmean_net, IPROTO_CONNECTIONS, 1);
+	con->iproto_thread = iproto_thread;
+#if defined(HAVE_LIBURING)
+	con->uring.is_read_in_flight = false;
+	con->uring.is_write_in_flight = false;
+#endif
+	rmean_collect(iproto_thread->rmean, IPROTO_CONNECTIONS, 1);
 	return con;
 }
 
@@ -1144,7 +1724,7 @@ iproto_connection_delete(struct iproto_connection *con)
 	       con->obuf[0].iov[0].iov_base == NULL);
 	assert(con->obuf[1].pos == 0 &&
 	       con->obuf[1].iov[0].iov_base == NULL);
-	mempool_free(&iproto_connection_pool, con);
+	mempool_free(&con->iproto_thread->iproto_connection_pool, con);
 }
 
 /* }}} iproto_connection */
@@ -1163,6 +1743,9 @@ tx_process1(struct cmsg *msg);
 static void
 tx_process_select(struct cmsg *msg);
 
+static void
+tx_zc_release(struct cmsg *msg);
+
 static void
 tx_process_sql(struct cmsg *msg);
 
@@ -1187,68 +1770,67 @@ net_end_join(struct cmsg *msg);
 static void
 net_end_subscribe(struct cmsg *msg);
 
-static const struct cmsg_hop misc_route[] = {
-	{ tx_process_misc, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop call_route[] = {
-	{ tx_process_call, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop select_route[] = {
-	{ tx_process_select, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop process1_route[] = {
-	{ tx_process1, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop sql_route[] = {
-	{ tx_process_sql, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
-	NULL,                                   /* IPROTO_OK */
-	select_route,                           /* IPROTO_SELECT */
-	process1_route,                         /* IPROTO_INSERT */
-	process1_route,                         /* IPROTO_REPLACE */
-	process1_route,                         /* IPROTO_UPDATE */
-	process1_route,                         /* IPROTO_DELETE */
-	call_route,                             /* IPROTO_CALL_16 */
-	misc_route,                             /* IPROTO_AUTH */
-	call_route,                             /* IPROTO_EVAL */
-	process1_route,                         /* IPROTO_UPSERT */
-	call_route,                             /* IPROTO_CALL */
-	sql_route,                              /* IPROTO_EXECUTE */
-	NULL,                                   /* IPROTO_NOP */
-	sql_route,                              /* IPROTO_PREPARE */
-};
-
-static const struct cmsg_hop join_route[] = {
-	{ tx_process_replication, &net_pipe },
-	{ net_end_join, NULL },
-};
+static void
+tx_process_connect(struct cmsg *msg);
 
-static const struct cmsg_hop subscribe_route[] = {
-	{ tx_process_replication, &net_pipe },
-	{ net_end_subscribe, NULL },
-};
+static void
+net_send_greeting(struct cmsg *msg);
 
-static const struct cmsg_hop error_route[] = {
-	{ tx_reply_iproto_error, &net_pipe },
-	{ net_send_error, NULL },
-};
+/** Initialize message routes of a network thread. */
+static void
+iproto_thread_init_routes(struct iproto_thread *iproto_thread)
+{
+	struct cpipe *net_pipe = &iproto_thread->net_pipe;
+#define IPROTO_ROUTE(route, tx_f, net_f) do {				\
+	iproto_thread->route[0].f = tx_f;				\
+	iproto_thread->route[0].pipe = net_pipe;			\
+	iproto_thread->route[1].f = net_f;				\
+	iproto_thread->route[1].pipe = NULL;				\
+} while (0)
+	IPROTO_ROUTE(destroy_route, tx_process_destroy, net_finish_destroy);
+	IPROTO_ROUTE(disconnect_route, tx_process_disconnect,
+		     net_finish_disconnect);
+	IPROTO_ROUTE(misc_route, tx_process_misc, net_send_msg);
+	IPROTO_ROUTE(call_route, tx_process_call, net_send_msg);
+	IPROTO_ROUTE(select_route, tx_process_select, net_send_msg);
+	IPROTO_ROUTE(process1_route, tx_process1, net_send_msg);
+	IPROTO_ROUTE(sql_route, tx_process_sql, net_send_msg);
+	IPROTO_ROUTE(join_route, tx_process_replication, net_end_join);
+	IPROTO_ROUTE(subscribe_route, tx_process_replication,
+		     net_end_subscribe);
+	IPROTO_ROUTE(error_route, tx_reply_iproto_error, net_send_error);
+	IPROTO_ROUTE(connect_route, tx_process_connect, net_send_greeting);
+#undef IPROTO_ROUTE
+	/* Push route goes in the opposite direction: net -> tx. */
+	iproto_thread->push_route[0].f = iproto_process_push;
+	iproto_thread->push_route[0].pipe = &iproto_thread->tx_pipe;
+	iproto_thread->push_route[1].f = tx_end_push;
+	iproto_thread->push_route[1].pipe = NULL;
+	iproto_thread->zc_release_route[0].f = tx_zc_release;
+	iproto_thread->zc_release_route[0].pipe = NULL;
+
+	const struct cmsg_hop **dml_route = iproto_thread->dml_route;
+	memset(dml_route, 0, sizeof(iproto_thread->dml_route));
+	dml_route[IPROTO_SELECT] = iproto_thread->select_route;
+	dml_route[IPROTO_INSERT] = iproto_thread->process1_route;
+	dml_route[IPROTO_REPLACE] = iproto_thread->process1_route;
+	dml_route[IPROTO_UPDATE] = iproto_thread->process1_route;
+	dml_route[IPROTO_DELETE] = iproto_thread->process1_route;
+	dml_route[IPROTO_CALL_16] = iproto_thread->call_route;
+	dml_route[IPROTO_AUTH] = iproto_thread->misc_route;
+	dml_route[IPROTO_EVAL] = iproto_thread->call_route;
+	dml_route[IPROTO_UPSERT] = iproto_thread->process1_route;
+	dml_route[IPROTO_CALL] = iproto_thread->call_route;
+	dml_route[IPROTO_EXECUTE] = iproto_thread->sql_route;
+	dml_route[IPROTO_PREPARE] = iproto_thread->sql_route;
+}
 
 static void
 iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input)
 {
 	uint8_t type;
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
 
 	if (xrow_header_decode(&msg->header, pos, reqend, true))
 		goto error;
@@ -1271,43 +1853,44 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		if (xrow_decode_dml(&msg->header, &msg->dml,
 				    dml_request_key_map(type)))
 			goto error;
-		assert(type < sizeof(dml_route)/sizeof(*dml_route));
-		cmsg_init(&msg->base, dml_route[type]);
+		assert(type < sizeof(iproto_thread->dml_route) /
+			      sizeof(*iproto_thread->dml_route));
+		cmsg_init(&msg->base, iproto_thread->dml_route[type]);
 		break;
 	case IPROTO_CALL_16:
 	case IPROTO_CALL:
 	case IPROTO_EVAL:
 		if (xrow_decode_call(&msg->header, &msg->call))
 			goto error;
-		cmsg_init(&msg->base, call_route);
+		cmsg_init(&msg->base, iproto_thread->call_route);
 		break;
 	case IPROTO_EXECUTE:
 	case IPROTO_PREPARE:
 		if (xrow_decode_sql(&msg->header, &msg->sql) != 0)
 			goto error;
-		cmsg_init(&msg->base, sql_route);
+		cmsg_init(&msg->base, iproto_thread->sql_route);
 		break;
 	case IPROTO_PING:
-		cmsg_init(&msg->base, misc_route);
+		cmsg_init(&msg->base, iproto_thread->misc_route);
 		break;
 	case IPROTO_JOIN:
 	case IPROTO_FETCH_SNAPSHOT:
 	case IPROTO_REGISTER:
-		cmsg_init(&msg->base, join_route);
+		cmsg_init(&msg->base, iproto_thread->join_route);
 		*stop_input = true;
 		break;
 	case IPROTO_SUBSCRIBE:
-		cmsg_init(&msg->base, subscribe_route);
+		cmsg_init(&msg->base, iproto_thread->subscribe_route);
 		*stop_input = true;
 		break;
 	case IPROTO_VOTE_DEPRECATED:
 	case IPROTO_VOTE:
-		cmsg_init(&msg->base, misc_route);
+		cmsg_init(&msg->base, iproto_thread->misc_route);
 		break;
 	case IPROTO_AUTH:
 		if (xrow_decode_auth(&msg->header, &msg->auth))
 			goto error;
-		cmsg_init(&msg->base, misc_route);
+		cmsg_init(&msg->base, iproto_thread->misc_route);
 		break;
 	default:
 		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
@@ -1320,7 +1903,7 @@ error:
 	diag_log();
 	diag_create(&msg->diag);
 	diag_move(&fiber()->diag, &msg->diag);
-	cmsg_init(&msg->base, error_route);
+	cmsg_init(&msg->base, iproto_thread->error_route);
 }
 
 static void
@@ -1388,6 +1971,11 @@ tx_process_destroy(struct cmsg *m)
 	 */
 	obuf_destroy(&con->obuf[0]);
 	obuf_destroy(&con->obuf[1]);
+	/* Replies which have never been written. */
+	struct iproto_zc_reply *zc, *tmp;
+	rlist_foreach_entry_safe(zc, &con->zc_replies, in_connection, tmp)
+		tx_zc_reply_delete(zc);
+	rlist_create(&con->zc_replies);
 }
 
 /**
@@ -1436,7 +2024,8 @@ tx_discard_input(struct iproto_msg *msg)
 		{ net_discard_input, NULL },
 	};
 	cmsg_init(&msg->discard_input, discard_input_route);
-	cpipe_push(&net_pipe, &msg->discard_input);
+	cpipe_push(&msg->connection->iproto_thread->net_pipe,
+		   &msg->discard_input);
 }
 
 /**
@@ -1550,13 +2139,265 @@ error:
 	tx_reply_error(msg);
 }
 
+/** {{{ Zero-copy replies in the tx thread. */
+
+static void
+tx_zc_reply_delete(struct iproto_zc_reply *zc)
+{
+	for (int i = 0; i < zc->count; i++)
+		tuple_unref(zc->tuples[i]);
+	free(zc);
+}
+
+/** Release a written zero-copy reply. */
+static void
+tx_zc_release(struct cmsg *m)
+{
+	tx_zc_reply_delete((struct iproto_zc_reply *) m);
+}
+
+/**
+ * Reference the tuples of a SELECT result set to send them
+ * without copying to the output buffer.
+ * @retval NULL if the result set is too small to be worth it
+ *         or memory allocation failed. The caller falls back
+ *         to copying then.
+ */
+static struct iproto_zc_reply *
+tx_zc_reply_new(struct iproto_connection *con, struct port *base,
+		size_t *data_size)
+{
+	assert(base->vtab == &port_c_vtab);
+	struct port_c *port = (struct port_c *) base;
+	struct port_c_entry *pe;
+	*data_size = 0;
+	for (pe = port->first; pe != NULL; pe = pe->next) {
+		/* box_select() returns tuples only. */
+		if (pe->mp_size != 0)
+			return NULL;
+		*data_size += pe->tuple->bsize;
+	}
+	if (*data_size < IPROTO_ZC_REPLY_SIZE_MIN)
+		return NULL;
+	int count = port->size;
+	size_t size = sizeof(struct iproto_zc_reply) +
+		      count * (sizeof(struct iovec) + sizeof(struct tuple *));
+	struct iproto_zc_reply *zc = (struct iproto_zc_reply *) malloc(size);
+	if (zc == NULL)
+		return NULL;
+	cmsg_init(&zc->base, con->iproto_thread->zc_release_route);
+	zc->iov = (struct iovec *) (zc + 1);
+	zc->tuples = (struct tuple **) (zc->iov + count);
+	zc->count = count;
+	zc->iov_pos = 0;
+	zc->iov_offset = 0;
+	int i = 0;
+	for (pe = port->first; pe != NULL; pe = pe->next, i++) {
+		uint32_t bsize;
+		const char *data = tuple_data_range(pe->tuple, &bsize);
+		tuple_ref(pe->tuple);
+		zc->tuples[i] = pe->tuple;
+		zc->iov[i].iov_base = (void *) data;
+		zc->iov[i].iov_len = bsize;
+	}
+	assert(i == count);
+	return zc;
+}
+
+/** }}} */
+
+/** {{{ SELECT result projection. */
+
+/** A field of IPROTO_FIELDS, resolved once per request. */
+struct tx_select_field {
+	/** Field number if @a path is NULL. */
+	uint32_t fieldno;
+	/** Field name or JSON path. */
+	const char *path;
+	uint32_t path_len;
+	uint32_t path_hash;
+};
+
+/**
+ * Decode IPROTO_FIELDS of a SELECT request to an array of
+ * fields allocated on the fiber region.
+ * @retval NULL on error, diag is set.
+ */
+static struct tx_select_field *
+tx_select_fields_decode(struct request *req, uint32_t *count)
+{
+	const char *data = req->fields;
+	*count = mp_decode_array(&data);
+	size_t size;
+	struct tx_select_field *fields =
+		region_alloc_array(&fiber()->gc, typeof(fields[0]), *count,
+				   &size);
+	if (fields == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "fields");
+		return NULL;
+	}
+	for (uint32_t i = 0; i < *count; i++) {
+		struct tx_select_field *field = &fields[i];
+		switch (mp_typeof(*data)) {
+		case MP_UINT: {
+			uint64_t fieldno = mp_decode_uint(&data);
+			if (fieldno < (uint64_t) req->index_base ||
+			    fieldno - req->index_base > UINT32_MAX) {
+				diag_set(ClientError, ER_ILLEGAL_PARAMS,
+					 "invalid field number in fields");
+				return NULL;
+			}
+			field->fieldno = fieldno - req->index_base;
+			field->path = NULL;
+			break;
+		}
+		case MP_STR:
+			field->path = mp_decode_str(&data, &field->path_len);
+			if (field->path_len == 0) {
+				diag_set(ClientError, ER_ILLEGAL_PARAMS,
+					 "empty field path in fields");
+				return NULL;
+			}
+			field->path_hash = field_name_hash(field->path,
+							   field->path_len);
+			break;
+		default:
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "fields must be field numbers or paths");
+			return NULL;
+		}
+	}
+	assert(data == req->fields_end);
+	return fields;
+}
+
+/**
+ * Encode the tuples of a SELECT result set to @a out leaving
+ * only the requested fields (IPROTO_FIELDS) or the index key
+ * parts (IPROTO_KEY_ONLY) in each of them. A requested field
+ * the tuple doesn't have is encoded as nil.
+ * @retval Number of encoded tuples or -1 on error.
+ */
+static int
+tx_dump_select_projection(struct request *req, struct port *base,
+			  struct obuf *out)
+{
+	assert(base->vtab == &port_c_vtab);
+	struct port_c *port = (struct port_c *) base;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct key_def *key_def = NULL;
+	struct tx_select_field *fields = NULL;
+	uint32_t field_count = 0;
+	if (req->key_only) {
+		/* The request has been checked by box_select(). */
+		struct space *space = space_cache_find(req->space_id);
+		struct index *index = space != NULL ?
+				      index_find(space, req->index_id) : NULL;
+		if (index == NULL)
+			return -1;
+		key_def = index->def->key_def;
+		if (key_def->is_multikey) {
+			diag_set(UnsupportedIndexFeature, index->def,
+				 "key-only select");
+			return -1;
+		}
+	} else {
+		fields = tx_select_fields_decode(req, &field_count);
+		if (fields == NULL)
+			goto error;
+	}
+	for (struct port_c_entry *pe = port->first; pe != NULL;
+	     pe = pe->next) {
+		struct tuple *tuple = pe->tuple;
+		if (key_def != NULL) {
+			uint32_t key_size;
+			const char *key = tuple_extract_key(tuple, key_def,
+							    MULTIKEY_NONE,
+							    &key_size);
+			if (key == NULL)
+				goto error;
+			if (obuf_dup(out, key, key_size) != key_size)
+				goto error_oom;
+			continue;
+		}
+		char header[5];
+		size_t header_size = mp_encode_array(header, field_count) -
+				     header;
+		if (obuf_dup(out, header, header_size) != header_size)
+			goto error_oom;
+		struct tuple_format *format = tuple_format(tuple);
+		const char *data = tuple_data(tuple);
+		const uint32_t *field_map = tuple_field_map(tuple);
+		for (uint32_t i = 0; i < field_count; i++) {
+			const char *field;
+			if (fields[i].path == NULL) {
+				field = tuple_field_raw(format, data, field_map,
+							fields[i].fieldno);
+			} else {
+				field = tuple_field_raw_by_full_path(
+					format, data, field_map,
+					fields[i].path, fields[i].path_len,
+					fields[i].path_hash);
+			}
+			size_t field_size;
+			if (field != NULL) {
+				const char *field_end = field;
+				mp_next(&field_end);
+				field_size = field_end - field;
+			} else {
+				/* A nil is a one byte msgpack. */
+				field = header;
+				mp_encode_nil(header);
+				field_size = 1;
+			}
+			if (obuf_dup(out, field, field_size) != field_size)
+				goto error_oom;
+		}
+	}
+	region_truncate(region, region_svp);
+	return port->size;
+error_oom:
+	diag_set(OutOfMemory, 0, "obuf_dup", "select projection");
+error:
+	region_truncate(region, region_svp);
+	return -1;
+}
+
+/** }}} */
+
+/**
+ * Append IPROTO_POSITION to the body of a SELECT response.
+ * @retval 0 Success.
+ * @retval -1 Memory error.
+ */
+static int
+tx_encode_position(struct obuf *out, const char *position, uint32_t size)
+{
+	size_t len = mp_sizeof_uint(IPROTO_POSITION) + mp_sizeof_str(size);
+	char *pos = (char *) obuf_alloc(out, len);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, len, "obuf_alloc", "position");
+		return -1;
+	}
+	pos = mp_encode_uint(pos, IPROTO_POSITION);
+	mp_encode_str(pos, position, size);
+	return 0;
+}
+
 static void
 tx_process_select(struct cmsg *m)
 {
 	struct iproto_msg *msg = tx_accept_msg(m);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
 	struct obuf *out;
 	struct obuf_svp svp;
 	struct port port;
+	struct iproto_zc_reply *zc = NULL;
+	size_t zc_size = 0;
+	const char *position = NULL;
+	uint32_t position_size = 0;
 	int count;
 	int rc;
 	struct request *req = &msg->dml;
@@ -1564,32 +2405,63 @@ tx_process_select(struct cmsg *m)
 		goto error;
 
 	tx_inject_delay();
-	rc = box_select(req->space_id, req->index_id,
-			req->iterator, req->offset, req->limit,
-			req->key, req->key_end, &port);
+	rc = box_select_after(req->space_id, req->index_id,
+			      req->iterator, req->offset, req->limit,
+			      req->key, req->key_end, req->after_position,
+			      req->after_position_end, &port);
 	if (rc < 0)
 		goto error;
 
+	if (req->fetch_position && ((struct port_c *) &port)->last != NULL) {
+		struct tuple *last = ((struct port_c *) &port)->last->tuple;
+		position = box_select_position(req->space_id, req->index_id,
+					       last, &position_size);
+		if (position == NULL) {
+			port_destroy(&port);
+			goto error;
+		}
+	}
+
 	out = msg->connection->tx.p_obuf;
 	if (iproto_prepare_select(out, &svp) != 0) {
 		port_destroy(&port);
 		goto error;
 	}
-	/*
-	 * SELECT output format has not changed since Tarantool 1.6
-	 */
-	count = port_dump_msgpack_16(&port, out);
-	port_destroy(&port);
-	if (count < 0) {
-		/* Discard the prepared select. */
-		obuf_rollback_to_svp(out, &svp);
-		goto error;
+	if (req->fields != NULL || req->key_only) {
+		count = tx_dump_select_projection(req, &port, out);
+	} else if ((zc = tx_zc_reply_new(msg->connection, &port,
+					 &zc_size)) != NULL) {
+		count = zc->count;
+		zc->obuf = out;
+		zc->svp = obuf_create_svp(out);
+	} else {
+		zc_size = 0;
+		/*
+		 * SELECT output format has not changed since
+		 * Tarantool 1.6
+		 */
+		count = port_dump_msgpack_16(&port, out);
 	}
-	iproto_reply_select(out, &svp, msg->header.sync,
-			    ::schema_version, count);
+	port_destroy(&port);
+	if (count < 0)
+		goto discard;
+	if (position != NULL &&
+	    tx_encode_position(out, position, position_size) != 0)
+		goto discard;
+	iproto_reply_select_with_data(out, &svp, msg->header.sync,
+				      ::schema_version, count, zc_size,
+				      position != NULL ? 1 : 0);
+	msg->zc_reply = zc;
 	iproto_wpos_create(&msg->wpos, out);
+	region_truncate(region, region_svp);
 	return;
+discard:
+	/* Discard the prepared select. */
+	if (zc != NULL)
+		tx_zc_reply_delete(zc);
+	obuf_rollback_to_svp(out, &svp);
 error:
+	region_truncate(region, region_svp);
 	tx_reply_error(msg);
 }
 
@@ -1879,6 +2751,12 @@ net_send_msg(struct cmsg *m)
 		assert(con->long_poll_count > 0);
 		con->long_poll_count--;
 	}
+	if (msg->zc_reply != NULL) {
+		/* Spliced at msg->wpos, which is the output end. */
+		rlist_add_tail_entry(&con->zc_replies, msg->zc_reply,
+				     in_connection);
+		msg->zc_reply = NULL;
+	}
 	con->wend = msg->wpos;
 
 	if (evio_has_fd(&con->output)) {
@@ -1986,7 +2864,8 @@ net_send_greeting(struct cmsg *m)
 
 		if (nwr > 0) {
 			/* Count statistics. */
-			rmean_collect(rmean_net, IPROTO_SENT, nwr);
+			rmean_collect(con->iproto_thread->rmean,
+				      IPROTO_SENT, nwr);
 		} else if (nwr < 0 && ! sio_wouldblock(errno)) {
 			diag_log();
 		}
@@ -2007,24 +2886,22 @@ net_send_greeting(struct cmsg *m)
 	iproto_msg_delete(msg);
 }
 
-static const struct cmsg_hop connect_route[] = {
-	{ tx_process_connect, &net_pipe },
-	{ net_send_greeting, NULL },
-};
-
 /** }}} */
 
 /**
  * Create a connection and start input.
  */
 static int
-iproto_on_accept(struct evio_service * /* service */, int fd,
+iproto_on_accept(struct evio_service *service, int fd,
 		 struct sockaddr *addr, socklen_t addrlen)
 {
 	(void) addr;
 	(void) addrlen;
 	struct iproto_msg *msg;
-	struct iproto_connection *con = iproto_connection_new(fd);
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) service->on_accept_param;
+	struct iproto_connection *con =
+		iproto_connection_new(iproto_thread, fd);
 	if (con == NULL)
 		return -1;
 	/*
@@ -2034,62 +2911,85 @@ iproto_on_accept(struct evio_service * /* service */, int fd,
 	 */
 	msg = iproto_msg_new(con);
 	if (msg == NULL) {
-		mempool_free(&iproto_connection_pool, con);
+		mempool_free(&iproto_thread->iproto_connection_pool, con);
 		return -1;
 	}
-	cmsg_init(&msg->base, connect_route);
+	cmsg_init(&msg->base, iproto_thread->connect_route);
 	msg->p_ibuf = con->p_ibuf;
 	msg->wpos = con->wpos;
 	msg->close_connection = false;
-	cpipe_push(&tx_pipe, &msg->base);
+	cpipe_push(&iproto_thread->tx_pipe, &msg->base);
 	return 0;
 }
 
-static struct evio_service binary; /* iproto binary listener */
+/** Name of a network thread entity, numbered unless it's the first. */
+static const char *
+iproto_thread_name(struct iproto_thread *iproto_thread, const char *prefix)
+{
+	if (iproto_thread->id == 0)
+		return prefix;
+	return tt_sprintf("%s%d", prefix, iproto_thread->id);
+}
 
 /**
  * The network io thread main function:
  * begin serving the message bus.
  */
 static int
-net_cord_f(va_list /* ap */)
+net_cord_f(va_list ap)
 {
-	mempool_create(&iproto_msg_pool, &cord()->slabc,
+	struct iproto_thread *iproto_thread =
+		va_arg(ap, struct iproto_thread *);
+
+	mempool_create(&iproto_thread->iproto_msg_pool, &cord()->slabc,
 		       sizeof(struct iproto_msg));
-	mempool_create(&iproto_connection_pool, &cord()->slabc,
+	mempool_create(&iproto_thread->iproto_connection_pool, &cord()->slabc,
 		       sizeof(struct iproto_connection));
 
-	evio_service_init(loop(), &binary, "binary",
-			  iproto_on_accept, NULL);
-
+	evio_service_init(loop(), &iproto_thread->binary, "binary",
+			  iproto_on_accept, iproto_thread);
+#if defined(HAVE_LIBURING)
+	if (iproto_use_io_uring)
+		iproto_thread_uring_create(iproto_thread);
+#endif
 
 	/* Init statistics counter */
-	rmean_net = rmean_new(rmean_net_strings, IPROTO_LAST);
+	iproto_thread->rmean = rmean_new(rmean_net_strings, IPROTO_LAST);
 
-	if (rmean_net == NULL) {
+	if (iproto_thread->rmean == NULL) {
 		tnt_raise(OutOfMemory, sizeof(struct rmean),
 			  "rmean", "struct rmean");
 	}
 
 	struct cbus_endpoint endpoint;
 	/* Create "net" endpoint. */
-	cbus_endpoint_create(&endpoint, "net", fiber_schedule_cb, fiber());
+	cbus_endpoint_create(&endpoint, iproto_thread_name(iproto_thread, "net"),
+			     fiber_schedule_cb, fiber());
 	/* Create a pipe to "tx" thread. */
-	cpipe_create(&tx_pipe, "tx");
-	cpipe_set_max_input(&tx_pipe, iproto_msg_max / 2);
+	cpipe_create(&iproto_thread->tx_pipe, "tx");
+	cpipe_set_max_input(&iproto_thread->tx_pipe,
+			    iproto_thread->msg_max / 2);
 	/* Process incomming messages. */
 	cbus_loop(&endpoint);
 
-	cpipe_destroy(&tx_pipe);
+	cpipe_destroy(&iproto_thread->tx_pipe);
 	/*
 	 * Nothing to do in the fiber so far, the service
 	 * will take care of creating events for incoming
-	 * connections.
+	 * connections. Only the first thread owns the
+	 * listening socket, the others just watch it.
 	 */
-	if (evio_service_is_active(&binary))
-		evio_service_stop(&binary);
+	if (iproto_thread->id == 0) {
+		if (evio_service_is_active(&iproto_thread->binary))
+			evio_service_stop(&iproto_thread->binary);
+	} else {
+		evio_service_detach(&iproto_thread->binary);
+	}
 
-	rmean_delete(rmean_net);
+#if defined(HAVE_LIBURING)
+	iproto_thread_uring_destroy(iproto_thread);
+#endif
+	rmean_delete(iproto_thread->rmean);
 	return 0;
 }
 
@@ -2131,11 +3031,12 @@ static void
 tx_begin_push(struct iproto_connection *con)
 {
 	assert(! con->tx.is_push_sent);
-	cmsg_init(&con->kharon.base, push_route);
+	cmsg_init(&con->kharon.base, con->iproto_thread->push_route);
 	iproto_wpos_create(&con->kharon.wpos, con->tx.p_obuf);
 	con->tx.is_push_pending = false;
 	con->tx.is_push_sent = true;
-	cpipe_push(&net_pipe, (struct cmsg *) &con->kharon);
+	cpipe_push(&con->iproto_thread->net_pipe,
+		   (struct cmsg *) &con->kharon);
 }
 
 static void
@@ -2183,18 +3084,52 @@ iproto_session_push(struct session *session, struct port *port)
 
 /** }}} */
 
-/** Initialize the iproto subsystem and start network io thread */
-void
-iproto_init(void)
+/** Start a network thread and connect it to the tx thread. */
+static void
+iproto_thread_start(struct iproto_thread *iproto_thread)
 {
-	slab_cache_create(&net_slabc, &runtime);
+	slab_cache_create(&iproto_thread->net_slabc, &runtime);
+	rlist_create(&iproto_thread->stopped_connections);
+	iproto_thread->msg_max = iproto_msg_max;
+	iproto_thread_init_routes(iproto_thread);
 
-	if (cord_costart(&net_cord, "iproto", net_cord_f, NULL))
+	if (cord_costart(&iproto_thread->net_cord,
+			 iproto_thread_name(iproto_thread, "iproto"),
+			 net_cord_f, iproto_thread))
 		panic("failed to initialize iproto thread");
 
 	/* Create a pipe to "net" thread. */
-	cpipe_create(&net_pipe, "net");
-	cpipe_set_max_input(&net_pipe, iproto_msg_max / 2);
+	cpipe_create(&iproto_thread->net_pipe,
+		     iproto_thread_name(iproto_thread, "net"));
+	cpipe_set_max_input(&iproto_thread->net_pipe, iproto_msg_max / 2);
+}
+
+/** Initialize the iproto subsystem and start network io threads */
+void
+iproto_init(int threads_count, bool use_io_uring)
+{
+	assert(threads_count > 0);
+#if !defined(HAVE_LIBURING)
+	if (use_io_uring) {
+		say_warn("tarantool is built without io_uring support, "
+			 "iproto_io_uring is ignored");
+		use_io_uring = false;
+	}
+#endif
+	iproto_use_io_uring = use_io_uring;
+	iproto_threads = (struct iproto_thread *)
+		calloc(threads_count, sizeof(struct iproto_thread));
+	if (iproto_threads == NULL) {
+		tnt_raise(OutOfMemory, threads_count *
+			  sizeof(struct iproto_thread), "calloc",
+			  "struct iproto_thread");
+	}
+	iproto_threads_count = threads_count;
+	for (int i = 0; i < iproto_threads_count; i++) {
+		iproto_threads[i].id = i;
+		iproto_thread_start(&iproto_threads[i]);
+	}
+
 	struct session_vtab iproto_session_vtab = {
 		/* .push = */ iproto_session_push,
 		/* .fd = */ iproto_session_fd,
@@ -2205,8 +3140,14 @@ iproto_init(void)
 
 /** Available iproto configuration changes. */
 enum iproto_cfg_op {
+	/** Set net_msg_max. */
 	IPROTO_CFG_MSG_MAX,
-	IPROTO_CFG_LISTEN
+	/** Bind and listen the socket, done by the first thread. */
+	IPROTO_CFG_LISTEN,
+	/** Start watching a socket listened by another thread. */
+	IPROTO_CFG_ATTACH,
+	/** Stop watching a socket listened by another thread. */
+	IPROTO_CFG_DETACH,
 };
 
 /**
@@ -2231,7 +3172,12 @@ struct iproto_cfg_msg: public cbus_call_msg
 
 		/** New iproto max message count. */
 		int iproto_msg_max;
+
+		/** Listener of the first thread to attach to. */
+		const struct evio_service *binary;
 	};
+	/** Thread which the message is sent to. */
+	struct iproto_thread *iproto_thread;
 };
 
 static inline void
@@ -2245,26 +3191,37 @@ static int
 iproto_do_cfg_f(struct cbus_call_msg *m)
 {
 	struct iproto_cfg_msg *cfg_msg = (struct iproto_cfg_msg *) m;
+	struct iproto_thread *iproto_thread = cfg_msg->iproto_thread;
+	struct evio_service *binary = &iproto_thread->binary;
 	int old;
 	try {
 		switch (cfg_msg->op) {
 		case IPROTO_CFG_MSG_MAX:
-			cpipe_set_max_input(&tx_pipe,
+			cpipe_set_max_input(&iproto_thread->tx_pipe,
 					    cfg_msg->iproto_msg_max / 2);
-			old = iproto_msg_max;
-			iproto_msg_max = cfg_msg->iproto_msg_max;
-			if (old < iproto_msg_max)
-				iproto_resume();
+			old = iproto_thread->msg_max;
+			iproto_thread->msg_max = cfg_msg->iproto_msg_max;
+			if (old < iproto_thread->msg_max)
+				iproto_resume(iproto_thread);
 			break;
 		case IPROTO_CFG_LISTEN:
-			if (evio_service_is_active(&binary))
-				evio_service_stop(&binary);
+			assert(iproto_thread->id == 0);
+			if (evio_service_is_active(binary))
+				evio_service_stop(binary);
 			if (cfg_msg->uri != NULL &&
-			    (evio_service_bind(&binary, cfg_msg->uri) != 0 ||
-			     evio_service_listen(&binary) != 0))
+			    (evio_service_bind(binary, cfg_msg->uri) != 0 ||
+			     evio_service_listen(binary) != 0))
 				diag_raise();
-			cfg_msg->addrlen = binary.addr_len;
-			cfg_msg->addr = binary.addrstorage;
+			cfg_msg->addrlen = binary->addr_len;
+			cfg_msg->addr = binary->addrstorage;
+			break;
+		case IPROTO_CFG_ATTACH:
+			assert(iproto_thread->id != 0);
+			evio_service_attach(binary, cfg_msg->binary);
+			break;
+		case IPROTO_CFG_DETACH:
+			assert(iproto_thread->id != 0);
+			evio_service_detach(binary);
 			break;
 		default:
 			unreachable();
@@ -2276,10 +3233,11 @@ iproto_do_cfg_f(struct cbus_call_msg *m)
 }
 
 static inline void
-iproto_do_cfg(struct iproto_cfg_msg *msg)
+iproto_do_cfg(struct iproto_thread *iproto_thread, struct iproto_cfg_msg *msg)
 {
-	if (cbus_call(&net_pipe, &tx_pipe, msg, iproto_do_cfg_f,
-		      NULL, TIMEOUT_INFINITY) != 0)
+	msg->iproto_thread = iproto_thread;
+	if (cbus_call(&iproto_thread->net_pipe, &iproto_thread->tx_pipe, msg,
+		      iproto_do_cfg_f, NULL, TIMEOUT_INFINITY) != 0)
 		diag_raise();
 }
 
@@ -2287,35 +3245,107 @@ void
 iproto_listen(const char *uri)
 {
 	struct iproto_cfg_msg cfg_msg;
+	/*
+	 * The listening socket is owned by the first thread.
+	 * The other threads must stop watching it before it is
+	 * closed and rebound.
+	 */
+	for (int i = 1; i < iproto_threads_count; i++) {
+		iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_DETACH);
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+	}
 	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_LISTEN);
 	cfg_msg.uri = uri;
-	iproto_do_cfg(&cfg_msg);
+	iproto_do_cfg(&iproto_threads[0], &cfg_msg);
 	iproto_bound_address_storage = cfg_msg.addr;
 	iproto_bound_address_len = cfg_msg.addrlen;
+	if (uri == NULL)
+		return;
+	/*
+	 * All threads accept connections on the same socket,
+	 * the kernel wakes up one of them for each connection.
+	 */
+	for (int i = 1; i < iproto_threads_count; i++) {
+		iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_ATTACH);
+		cfg_msg.binary = &iproto_threads[0].binary;
+		iproto_do_cfg(&iproto_threads[i], &cfg_msg);
+	}
 }
 
 size_t
 iproto_mem_used(void)
 {
-	return slab_cache_used(&net_cord.slabc) + slab_cache_used(&net_slabc);
+	size_t mem = 0;
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		mem += slab_cache_used(&iproto_thread->net_cord.slabc) +
+		       slab_cache_used(&iproto_thread->net_slabc);
+	}
+	return mem;
+}
+
+size_t
+iproto_thread_connection_count(int thread_id)
+{
+	assert(thread_id >= 0 && thread_id < iproto_threads_count);
+	return mempool_count(&iproto_threads[thread_id].iproto_connection_pool);
+}
+
+size_t
+iproto_thread_request_count(int thread_id)
+{
+	assert(thread_id >= 0 && thread_id < iproto_threads_count);
+	return mempool_count(&iproto_threads[thread_id].iproto_msg_pool);
 }
 
 size_t
 iproto_connection_count(void)
 {
-	return mempool_count(&iproto_connection_pool);
+	size_t count = 0;
+	for (int i = 0; i < iproto_threads_count; i++)
+		count += iproto_thread_connection_count(i);
+	return count;
 }
 
 size_t
 iproto_request_count(void)
 {
-	return mempool_count(&iproto_msg_pool);
+	size_t count = 0;
+	for (int i = 0; i < iproto_threads_count; i++)
+		count += iproto_thread_request_count(i);
+	return count;
+}
+
+int
+iproto_thread_rmean_foreach(int thread_id, rmean_cb cb, void *cb_ctx)
+{
+	assert(thread_id >= 0 && thread_id < iproto_threads_count);
+	return rmean_foreach(iproto_threads[thread_id].rmean, cb, cb_ctx);
+}
+
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx)
+{
+	for (size_t name = 0; name < IPROTO_LAST; name++) {
+		int64_t rps = 0;
+		int64_t total = 0;
+		for (int i = 0; i < iproto_threads_count; i++) {
+			struct rmean *rmean = iproto_threads[i].rmean;
+			rps += rmean_mean(rmean, name);
+			total += rmean_total(rmean, name);
+		}
+		int rc = cb(rmean_net_strings[name], rps, total, cb_ctx);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
 }
 
 void
 iproto_reset_stat(void)
 {
-	rmean_cleanup(rmean_net);
+	for (int i = 0; i < iproto_threads_count; i++)
+		rmean_cleanup(iproto_threads[i].rmean);
 }
 
 void
@@ -2327,22 +3357,31 @@ iproto_set_msg_max(int new_iproto_msg_max)
 				     IPROTO_MSG_MAX_MIN));
 	}
 	struct iproto_cfg_msg cfg_msg;
-	iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_MSG_MAX);
-	cfg_msg.iproto_msg_max = new_iproto_msg_max;
-	iproto_do_cfg(&cfg_msg);
-	cpipe_set_max_input(&net_pipe, new_iproto_msg_max / 2);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		iproto_cfg_msg_create(&cfg_msg, IPROTO_CFG_MSG_MAX);
+		cfg_msg.iproto_msg_max = new_iproto_msg_max;
+		iproto_do_cfg(iproto_thread, &cfg_msg);
+		cpipe_set_max_input(&iproto_thread->net_pipe,
+				    new_iproto_msg_max / 2);
+	}
+	iproto_msg_max = new_iproto_msg_max;
 }
 
 void
 iproto_free(void)
 {
-	tt_pthread_cancel(net_cord.id);
-	tt_pthread_join(net_cord.id, NULL);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		tt_pthread_cancel(iproto_thread->net_cord.id);
+		tt_pthread_join(iproto_thread->net_cord.id, NULL);
+	}
 	/*
 	* Close socket descriptor to prevent hot standby instance
 	* failing to bind in case it tries to bind before socket
 	* is closed by OS.
 	*/
-	if (evio_service_is_active(&binary))
-		close(binary.ev.fd);
+	struct evio_service *binary = &iproto_threads[0].binary;
+	if (evio_service_is_active(binary))
+		close(binary->ev.fd);
 }
@@ -33,6 +33,8 @@
 
 #include <stddef.h>
 
+#include "rmean.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -52,10 +54,15 @@ enum {
 	 * processing stops until some new fibers are freed up.
 	 */
 	IPROTO_FIBER_POOL_SIZE_FACTOR = 5,
+	/** Maximum count of iproto threads. */
+	IPROTO_THREADS_MAX = 1000,
 };
 
 extern unsigned iproto_readahead;
 
+/** The number of running iproto threads. */
+extern int iproto_threads_count;
+
 /**
  * Return size of memory used for storing network buffers.
  */
@@ -74,6 +81,34 @@ iproto_connection_count(void);
 size_t
 iproto_request_count(void);
 
+/**
+ * Return the number of active connections served by
+ * the iproto thread @a thread_id.
+ */
+size_t
+iproto_thread_connection_count(int thread_id);
+
+/**
+ * Return the number of requests in flight in the iproto
+ * thread @a thread_id.
+ */
+size_t
+iproto_thread_request_count(int thread_id);
+
+/**
+ * Invoke @a cb for every network metric summed up over
+ * all iproto threads.
+ */
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx);
+
+/**
+ * Invoke @a cb for every network metric of the iproto
+ * thread @a thread_id.
+ */
+int
+iproto_thread_rmean_foreach(int thread_id, rmean_cb cb, void *cb_ctx);
+
 /**
  * Reset network statistics.
  */
@@ -90,8 +125,14 @@ iproto_bound_address(void);
 #if defined(__cplusplus)
 } /* extern "C" */
 
+/**
+ * Initialize the iproto subsystem and start @a threads_count
+ * network threads. If @a use_io_uring is set, the threads do
+ * socket I/O with io_uring when it's supported by the build and
+ * the kernel.
+ */
 void
-iproto_init(void);
+iproto_init(int threads_count, bool use_io_uring);
 
 void
 iproto_listen(const char *uri);
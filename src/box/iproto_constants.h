@@ -98,6 +98,21 @@ enum iproto_key {
 	IPROTO_BALLOT = 0x29,
 	IPROTO_TUPLE_META = 0x2a,
 	IPROTO_OPTIONS = 0x2b,
+	/**
+	 * SELECT result projection: [field, ...], where a field
+	 * is a number counted from IPROTO_INDEX_BASE or a name
+	 * or a JSON path.
+	 */
+	IPROTO_FIELDS = 0x2c,
+	/**
+	 * SELECT returns the index key parts of the tuples.
+	 * Can't be used along with IPROTO_FIELDS.
+	 */
+	IPROTO_KEY_ONLY = 0x2d,
+	/** SELECT starts after this IPROTO_POSITION. */
+	IPROTO_AFTER_POSITION = 0x2e,
+	/** SELECT returns the position of the last tuple. */
+	IPROTO_FETCH_POSITION = 0x2f,
 
 	/* Leave a gap between request keys and response keys */
 	IPROTO_DATA = 0x30,
@@ -112,6 +127,11 @@ enum iproto_key {
 	IPROTO_METADATA = 0x32,
 	IPROTO_BIND_METADATA = 0x33,
 	IPROTO_BIND_COUNT = 0x34,
+	/**
+	 * Opaque position of the last tuple of a SELECT
+	 * response, requested with IPROTO_FETCH_POSITION.
+	 */
+	IPROTO_POSITION = 0x35,
 
 	/* Leave a gap between response keys and SQL keys. */
 	IPROTO_SQL_TEXT = 0x40,
@@ -159,6 +179,10 @@ enum iproto_ballot_key {
 #define IPROTO_DML_BODY_BMAP (bit(SPACE_ID) | bit(INDEX_ID) | bit(LIMIT) |\
 			      bit(OFFSET) | bit(ITERATOR) | bit(INDEX_BASE) |\
 			      bit(KEY) | bit(TUPLE) | bit(OPS) | bit(TUPLE_META))
+/** Keys that are only meaningful in the body of a SELECT request. */
+#define IPROTO_SELECT_BODY_BMAP (IPROTO_DML_BODY_BMAP | bit(FIELDS) |\
+				 bit(KEY_ONLY) | bit(FETCH_POSITION) |\
+				 bit(AFTER_POSITION))
 
 static inline bool
 xrow_header_has_key(const char *pos, const char *end)
@@ -174,6 +198,13 @@ iproto_dml_body_has_key(const char *pos, const char *end)
 	return key < IPROTO_KEY_MAX && IPROTO_DML_BODY_BMAP & (1ULL<<key);
 }
 
+static inline bool
+iproto_select_body_has_key(const char *pos, const char *end)
+{
+	unsigned char key = pos < end ? *pos : (unsigned char) IPROTO_KEY_MAX;
+	return key < IPROTO_KEY_MAX && IPROTO_SELECT_BODY_BMAP & (1ULL<<key);
+}
+
 #undef bit
 
 static inline uint64_t
@@ -396,6 +427,8 @@ enum vy_run_info_key {
 	VY_RUN_INFO_BLOOM = 7,
 	/** Number of statements of each type (map). */
 	VY_RUN_INFO_STMT_STAT = 8,
+	/** Split block bloom filter for keys. */
+	VY_RUN_INFO_BLOOM_SPLIT_BLOCK = 9,
 	/** The last key in this enum + 1 */
 	VY_RUN_INFO_KEY_MAX
 };
@@ -454,6 +487,12 @@ vy_page_info_key_name(enum vy_page_info_key key)
 enum vy_row_index_key {
 	/** Array of row offsets. */
 	VY_ROW_INDEX_DATA = 1,
+	/**
+	 * Number of rows between restart points of a page stored
+	 * with key prefix compression. Absent if the page rows are
+	 * stored as is.
+	 */
+	VY_ROW_INDEX_RESTART_INTERVAL = 2,
 	/** The last key in this enum + 1 */
 	VY_ROW_INDEX_KEY_MAX
 };
@@ -471,6 +510,18 @@ vy_row_index_key_name(enum vy_row_index_key key)
 	return vy_row_index_key_strs[key];
 }
 
+/**
+ * Xrow body keys of a Vinyl statement stored with key prefix
+ * compression. The values are greater than any iproto key so
+ * that such a body can't be mistaken for a plain DML body.
+ */
+enum vy_row_prefix_key {
+	/** Size of the body prefix shared with the previous row. */
+	VY_ROW_PREFIX_SIZE = 0x70,
+	/** The rest of the row body. */
+	VY_ROW_PREFIX_SUFFIX = 0x71,
+};
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif
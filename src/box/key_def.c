@@ -718,6 +718,15 @@ key_def_update_optionality(struct key_def *def, uint32_t min_field_count)
 	key_def_set_func(def);
 }
 
+void
+key_def_set_normalized(struct key_def *def)
+{
+	assert(!def->is_multikey && !def->for_func_index);
+	assert(key_def_unnormalizable_type(def) == field_type_MAX);
+	def->is_normalized = true;
+	key_def_set_compare_func(def);
+}
+
 int
 key_def_snprint_parts(char *buf, int size, const struct key_part_def *parts,
 		      uint32_t part_count)
@@ -203,6 +203,11 @@ struct key_def {
 	bool is_multikey;
 	/** True if it is a functional index key definition. */
 	bool for_func_index;
+	/**
+	 * True if tuple hints are pointers to normalized keys,
+	 * see key_def_set_normalized().
+	 */
+	bool is_normalized;
 	/**
 	 * True, if some key parts can be absent in a tuple. These
 	 * fields assumed to be MP_NIL.
@@ -667,6 +672,15 @@ key_def_dump_parts(const struct key_def *def, struct key_part_def *parts,
 void
 key_def_update_optionality(struct key_def *def, uint32_t min_field_count);
 
+/**
+ * Make @a key_def expect pointers to normalized keys built by
+ * tuple_normalized_key() as tuple comparison hints. Tuples with
+ * HINT_NONE are still compared field by field. The key parts
+ * must be normalizable, see key_def_unnormalizable_type().
+ */
+void
+key_def_set_normalized(struct key_def *def);
+
 /**
  * An snprint-style function to print a key definition.
  */
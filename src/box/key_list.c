@@ -40,6 +40,7 @@
 #include "port.h"
 #include "schema.h"
 #include "tt_static.h"
+#include "tuple_compression.h"
 
 int
 key_list_iterator_create(struct key_list_iterator *it, struct tuple *tuple,
@@ -55,9 +56,13 @@ key_list_iterator_create(struct key_list_iterator *it, struct tuple *tuple,
 	size_t region_svp = region_used(region);
 	struct func *func = index_def->key_def->func_index_func;
 
+	/* The function must see the original field values. */
+	struct tuple *arg = tuple_decompress(tuple);
+	if (arg == NULL)
+		return -1;
 	struct port out_port, in_port;
 	port_c_create(&in_port);
-	port_c_add_tuple(&in_port, tuple);
+	port_c_add_tuple(&in_port, arg);
 	int rc = func_call(func, &in_port, &out_port);
 	port_destroy(&in_port);
 	if (rc != 0) {
@@ -42,6 +42,8 @@ local default_cfg = {
     strip_core          = true,
     memtx_min_tuple_size = 16,
     memtx_max_tuple_size = 1024 * 1024,
+    memtx_recovery_threads = 0,
+    memtx_checkpoint_threads = 1,
     slab_alloc_factor   = 1.05,
     work_dir            = nil,
     memtx_dir           = ".",
@@ -50,6 +52,8 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 64 * 1024 * 1024,
+    vinyl_readahead     = 4,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
@@ -67,10 +71,16 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    compression_dict_size = 0,
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     wal_max_size        = 256 * 1024 * 1024,
     wal_dir_rescan_delay= 2,
+    wal_commit_delay    = 0,
+    wal_compress_threads = 0,
+    wal_direct_io       = false,
+    wal_max_batch_size  = 1024 * 1024,
+    wal_ring_size       = 0,
     force_recovery      = false,
     replication         = nil,
     instance_uuid       = nil,
@@ -102,6 +112,8 @@ local default_cfg = {
     feedback_host         = "https://feedback.tarantool.io",
     feedback_interval     = 3600,
     net_msg_max           = 768,
+    iproto_threads        = 1,
+    iproto_io_uring       = false,
     sql_cache_size        = 5 * 1024 * 1024,
 }
 
@@ -122,6 +134,8 @@ local template_cfg = {
     strip_core          = 'boolean',
     memtx_min_tuple_size  = 'number',
     memtx_max_tuple_size  = 'number',
+    memtx_recovery_threads = 'number',
+    memtx_checkpoint_threads = 'number',
     slab_alloc_factor   = 'number',
     work_dir            = 'string',
     memtx_dir            = 'string',
@@ -129,6 +143,8 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
+    vinyl_readahead           = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
@@ -147,10 +163,16 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    compression_dict_size = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     wal_max_size        = 'number',
     wal_dir_rescan_delay= 'number',
+    wal_commit_delay    = 'number',
+    wal_compress_threads = 'number',
+    wal_direct_io       = 'boolean',
+    wal_max_batch_size  = 'number',
+    wal_ring_size       = 'number',
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
     instance_uuid       = 'string',
@@ -182,6 +204,8 @@ local template_cfg = {
     feedback_host         = ifdef_feedback('string'),
     feedback_interval     = ifdef_feedback('number'),
     net_msg_max           = 'number',
+    iproto_threads        = 'number',
+    iproto_io_uring       = 'boolean',
     sql_cache_size        = 'number',
 }
 
@@ -265,16 +289,22 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    compression_dict_size   = private.cfg_set_compression_dict_size,
+    memtx_checkpoint_threads = private.cfg_set_memtx_checkpoint_threads,
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
+    vinyl_readahead         = private.cfg_set_vinyl_readahead,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
     checkpoint_wal_threshold = private.cfg_set_checkpoint_wal_threshold,
+    wal_commit_delay        = private.cfg_set_wal_commit_delay,
+    wal_max_batch_size      = private.cfg_set_wal_max_batch_size,
     worker_pool_threads     = private.cfg_set_worker_pool_threads,
     feedback_enabled        = ifdef_feedback_set_params,
     feedback_host           = ifdef_feedback_set_params,
@@ -358,6 +388,8 @@ local dynamic_cfg_skip_at_load = {
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_page_cache        = true,
+    vinyl_readahead         = true,
     vinyl_timeout           = true,
     too_long_threshold      = true,
     election_mode           = true,
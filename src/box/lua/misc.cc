@@ -136,6 +136,31 @@ lbox_select(lua_State *L)
 	return 1; /* lua table with tuples */
 }
 
+/** Lua/C implementation of index:get_many(): used only by Vinyl. */
+static int
+lbox_get_many(lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    !lua_istable(L, 3))
+		return luaL_error(L, "Usage index:get_many(keys)");
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+
+	size_t keys_len;
+	const char *keys = lbox_encode_tuple_on_gc(L, 3, &keys_len);
+
+	struct port port;
+	if (box_get_many(space_id, index_id, keys, keys + keys_len,
+			 &port) != 0)
+		return luaT_error(L);
+
+	/* See the comment in lbox_select(). */
+	port_dump_lua(&port, L, false);
+	port_destroy(&port);
+	return 1; /* lua table with tuples */
+}
+
 /* }}} */
 
 /** {{{ Utils to work with tuple_format. **/
@@ -252,6 +277,7 @@ box_lua_misc_init(struct lua_State *L)
 {
 	static const struct luaL_Reg boxlib_internal[] = {
 		{"select", lbox_select},
+		{"get_many", lbox_get_many},
 		{"new_tuple_format", lbox_tuple_format_new},
 		{NULL, NULL}
 	};
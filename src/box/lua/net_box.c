@@ -229,13 +229,22 @@ netbox_encode_select(lua_State *L)
 	if (lua_gettop(L) < 8) {
 		return luaL_error(L, "Usage netbox.encode_select(ibuf, sync, "
 				     "space_id, index_id, iterator, offset, "
-				     "limit, key)");
+				     "limit, key[, fields[, key_only[, after"
+				     "[, fetch_pos]]]])");
 	}
 
 	struct mpstream stream;
 	size_t svp = netbox_prepare_request(L, &stream, IPROTO_SELECT);
 
-	mpstream_encode_map(&stream, 6);
+	bool has_fields = !lua_isnoneornil(L, 9);
+	bool key_only = lua_toboolean(L, 10);
+	size_t after_len = 0;
+	const char *after = lua_isnoneornil(L, 11) ? NULL :
+			    lua_tolstring(L, 11, &after_len);
+	bool fetch_pos = lua_toboolean(L, 12);
+	mpstream_encode_map(&stream, 6 + (has_fields ? 2 : 0) +
+			    (key_only ? 1 : 0) + (after != NULL ? 1 : 0) +
+			    (fetch_pos ? 1 : 0));
 
 	uint32_t space_id = lua_tonumber(L, 3);
 	uint32_t index_id = lua_tonumber(L, 4);
@@ -267,6 +276,29 @@ netbox_encode_select(lua_State *L)
 	mpstream_encode_uint(&stream, IPROTO_KEY);
 	luamp_convert_key(L, cfg, &stream, 8);
 
+	/* encode projection */
+	if (has_fields) {
+		/* Lua field numbers are 1-based. */
+		mpstream_encode_uint(&stream, IPROTO_INDEX_BASE);
+		mpstream_encode_uint(&stream, 1);
+		mpstream_encode_uint(&stream, IPROTO_FIELDS);
+		luamp_encode_tuple(L, cfg, &stream, 9);
+	}
+	if (key_only) {
+		mpstream_encode_uint(&stream, IPROTO_KEY_ONLY);
+		mpstream_encode_bool(&stream, true);
+	}
+
+	/* encode pagination */
+	if (after != NULL) {
+		mpstream_encode_uint(&stream, IPROTO_AFTER_POSITION);
+		mpstream_encode_strn(&stream, after, after_len);
+	}
+	if (fetch_pos) {
+		mpstream_encode_uint(&stream, IPROTO_FETCH_POSITION);
+		mpstream_encode_bool(&stream, true);
+	}
+
 	netbox_encode_request(&stream, svp);
 	return 0;
 }
@@ -641,10 +673,11 @@ netbox_decode_data(struct lua_State *L, const char **data,
 }
 
 /**
- * Decode Tarantool response body consisting of single
- * IPROTO_DATA key into array of tuples.
+ * Decode Tarantool response body consisting of IPROTO_DATA key
+ * and optional IPROTO_POSITION into array of tuples.
  * @param Lua stack[1] Raw MessagePack pointer.
- * @retval Tuples array and position of the body end.
+ * @retval Tuples array, position of the body end and
+ *         IPROTO_POSITION if present.
  */
 static int
 netbox_decode_select(struct lua_State *L)
@@ -659,15 +692,24 @@ netbox_decode_select(struct lua_State *L)
 	const char *data = *(const char **)luaL_checkcdata(L, 1, &ctypeid);
 	assert(mp_typeof(*data) == MP_MAP);
 	uint32_t map_size = mp_decode_map(&data);
-	/* Until 2.0 body has no keys except DATA. */
-	assert(map_size == 1);
-	(void) map_size;
+	/* DATA goes first, POSITION is optional. */
+	assert(map_size == 1 || map_size == 2);
 	uint32_t key = mp_decode_uint(&data);
 	assert(key == IPROTO_DATA);
 	(void) key;
 	netbox_decode_data(L, &data, format);
+	const char *position = NULL;
+	uint32_t position_len = 0;
+	if (map_size == 2) {
+		key = mp_decode_uint(&data);
+		assert(key == IPROTO_POSITION);
+		position = mp_decode_str(&data, &position_len);
+	}
 	*(const char **)luaL_pushcdata(L, ctypeid) = data;
-	return 2;
+	if (position == NULL)
+		return 2;
+	lua_pushlstring(L, position, position_len);
+	return 3;
 }
 
 /** Decode optional (i.e. may be present in response) metadata fields. */
@@ -81,6 +81,10 @@ local function decode_get(raw_data, raw_data_end, format) -- luacheck: no unused
     end
     return body[1], raw_end
 end
+local function decode_select_pos(raw_data, raw_data_end, format) -- luacheck: no unused args
+    local tuples, raw_end, pos = internal.decode_select(raw_data, nil, format)
+    return {tuples, pos}, raw_end
+end
 local function decode_count(raw_data)
     local response, raw_end = decode(raw_data)
     return response[IPROTO_DATA_KEY][1], raw_end
@@ -109,6 +113,7 @@ local method_encoder = {
     update  = internal.encode_update,
     upsert  = internal.encode_upsert,
     select  = internal.encode_select,
+    select_pos = internal.encode_select,
     execute = internal.encode_execute,
     prepare = internal.encode_prepare,
     unprepare = internal.encode_prepare,
@@ -135,6 +140,7 @@ local method_decoder = {
     update  = decode_tuple,
     upsert  = decode_nil,
     select  = internal.decode_select,
+    select_pos = decode_select_pos,
     execute = internal.decode_execute,
     prepare = internal.decode_prepare,
     unprepare = decode_nil,
@@ -1518,9 +1524,38 @@ index_metatable = function(remote)
         local iterator = check_iterator_type(opts, key_is_nil)
         local offset = tonumber(opts and opts.offset) or 0
         local limit = tonumber(opts and opts.limit) or 0xFFFFFFFF
-        return (remote:_request('select', opts, self.space._format_cdata,
-                                self.space.id, self.id, iterator, offset,
-                                limit, key))
+        local fields = opts and opts.fields
+        local key_only = opts and opts.key_only
+        if fields ~= nil and type(fields) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "options parameter 'fields' should be a table")
+        end
+        -- Projected tuples don't match the space format.
+        local format = self.space._format_cdata
+        if fields ~= nil or key_only then
+            format = nil
+        end
+        local after = opts and opts.after
+        if after ~= nil and type(after) ~= 'string' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "options parameter 'after' should be a string")
+        end
+        if not (opts and opts.fetch_pos) then
+            return (remote:_request('select', opts, format,
+                                    self.space.id, self.id, iterator,
+                                    offset, limit, key, fields, key_only,
+                                    after))
+        end
+        -- Returns the tuples and the position of the last one
+        -- to pass it as `after` to get the next page.
+        local res = remote:_request('select_pos', opts, format,
+                                    self.space.id, self.id, iterator,
+                                    offset, limit, key, fields, key_only,
+                                    after, true)
+        if opts.buffer or opts.is_async then
+            return res
+        end
+        return res[1], res[2]
     end
 
     function methods:get(key, opts)
@@ -104,6 +104,11 @@ ffi.cdef[[
                const char *key, const char *key_end,
                struct port *port);
 
+    int
+    box_get_many(uint32_t space_id, uint32_t index_id,
+                 const char *keys, const char *keys_end,
+                 struct port *port);
+
     void password_prepare(const char *password, int len,
                           char *out, int out_len);
 
@@ -1026,8 +1031,12 @@ local index_options = {
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    bloom_type = 'string',
+    page_restart_interval = 'number',
     func = 'number, string',
     hint = 'boolean',
+    layout = 'string',
+    normalized_keys = 'boolean',
 }
 
 local function jsonpaths_from_idx_parts(parts)
@@ -1135,6 +1144,25 @@ box.schema.index.create = function(space_id, name, options)
         box.error(box.error.MODIFY_INDEX, name, space.name,
                 "functional index can't use hints")
     end
+    if options.layout and
+            (options.type ~= 'hash' or box.space[space_id].engine ~= 'memtx') then
+        box.error(box.error.MODIFY_INDEX, name, space.name,
+                "layout is only reasonable with memtx hash index")
+    end
+    if options.normalized_keys and
+            (options.type ~= 'tree' or box.space[space_id].engine ~= 'memtx') then
+        box.error(box.error.MODIFY_INDEX, name, space.name,
+                "normalized_keys is only reasonable with memtx tree index")
+    end
+    if options.page_restart_interval and
+            box.space[space_id].engine ~= 'vinyl' then
+        box.error(box.error.MODIFY_INDEX, name, space.name,
+                "page_restart_interval is only reasonable with vinyl index")
+    end
+    if options.bloom_type and box.space[space_id].engine ~= 'vinyl' then
+        box.error(box.error.MODIFY_INDEX, name, space.name,
+                "bloom_type is only reasonable with vinyl index")
+    end
 
     local _index = box.space[box.schema.INDEX_ID]
     local _vindex = box.space[box.schema.VINDEX_ID]
@@ -1173,8 +1201,12 @@ box.schema.index.create = function(space_id, name, options)
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
             bloom_fpr = options.bloom_fpr,
+            bloom_type = options.bloom_type,
+            page_restart_interval = options.page_restart_interval,
             func = options.func,
             hint = options.hint,
+            layout = options.layout,
+            normalized_keys = options.normalized_keys,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -1328,6 +1360,29 @@ box.schema.index.alter = function(space_id, index_id, options)
                                           space.name,
                 "functional index can't use hints")
     end
+    if options.layout and
+       (options.type ~= 'hash' or box.space[space_id].engine ~= 'memtx') then
+        box.error(box.error.MODIFY_INDEX, space.index[index_id].name,
+                                          space.name,
+            "layout is only reasonable with memtx hash index")
+    end
+    if options.normalized_keys and
+       (options.type ~= 'tree' or box.space[space_id].engine ~= 'memtx') then
+        box.error(box.error.MODIFY_INDEX, space.index[index_id].name,
+                                          space.name,
+            "normalized_keys is only reasonable with memtx tree index")
+    end
+    if options.page_restart_interval and
+       box.space[space_id].engine ~= 'vinyl' then
+        box.error(box.error.MODIFY_INDEX, space.index[index_id].name,
+                                          space.name,
+            "page_restart_interval is only reasonable with vinyl index")
+    end
+    if options.bloom_type and box.space[space_id].engine ~= 'vinyl' then
+        box.error(box.error.MODIFY_INDEX, space.index[index_id].name,
+                                          space.name,
+            "bloom_type is only reasonable with vinyl index")
+    end
     if options.parts then
         local parts_can_be_simplified
         parts, parts_can_be_simplified =
@@ -1874,6 +1929,43 @@ base_index_mt.get_luac = function(index, key)
     return internal.get(index.space_id, index.id, key)
 end
 
+local function keify_many(keys)
+    if type(keys) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage index:get_many({key1, key2, ...})")
+    end
+    local ret = {}
+    for i, key in ipairs(keys) do
+        ret[i] = keify(key)
+    end
+    return ret
+end
+
+base_index_mt.get_many_ffi = function(index, keys)
+    check_index_arg(index, 'get_many')
+    local keys, keys_end = tuple_encode(keify_many(keys))
+
+    local port = ffi.cast('struct port *', port_c)
+
+    if builtin.box_get_many(index.space_id, index.id,
+                            keys, keys_end, port) ~= 0 then
+        return box.error()
+    end
+
+    local ret = {}
+    local entry = port_c.first
+    for i=1,tonumber(port_c.size),1 do
+        ret[i] = tuple_bless(entry.tuple)
+        entry = entry.next
+    end
+    builtin.port_destroy(port);
+    return ret
+end
+base_index_mt.get_many_luac = function(index, keys)
+    check_index_arg(index, 'get_many')
+    return internal.get_many(index.space_id, index.id, keify_many(keys))
+end
+
 local function check_select_opts(opts, key_is_nil)
     local offset = 0
     local limit = 4294967295
@@ -1952,7 +2044,8 @@ base_index_mt.alter = function(index, options)
     return box.schema.index.alter(index.space_id, index.id, options)
 end
 
-local read_ops = {'select', 'get', 'min', 'max', 'count', 'random', 'pairs'}
+local read_ops = {'select', 'get', 'get_many', 'min', 'max', 'count', 'random',
+                  'pairs'}
 for _, op in ipairs(read_ops) do
     vinyl_index_mt[op] = base_index_mt[op..'_luac']
     memtx_index_mt[op] = base_index_mt[op..'_ffi']
@@ -1993,6 +2086,10 @@ space_mt.get = function(space, key)
     check_space_arg(space, 'get')
     return check_primary_index(space):get(key)
 end
+space_mt.get_many = function(space, keys)
+    check_space_arg(space, 'get_many')
+    return check_primary_index(space):get_many(keys)
+end
 space_mt.select = function(space, key, opts)
     check_space_arg(space, 'select')
     return check_primary_index(space):select(key, opts)
@@ -48,6 +48,7 @@ extern "C" {
 #include "box/schema.h"
 #include "box/user_def.h"
 #include "box/tuple.h"
+#include "box/tuple_compression.h"
 #include "box/txn.h"
 #include "box/sequence.h"
 #include "box/coll_id_cache.h"
@@ -58,18 +59,34 @@ extern "C" {
 /**
  * Trigger function for all spaces
  */
+/**
+ * Push a statement tuple with compressed fields decompressed.
+ * Pushing a trigger argument can't fail, so the stored tuple
+ * is pushed as is if decompression fails.
+ */
+static void
+lbox_push_stmt_tuple(struct lua_State *L, struct tuple *tuple)
+{
+	struct tuple *ret = tuple_decompress(tuple);
+	if (ret == NULL) {
+		diag_log();
+		ret = tuple;
+	}
+	luaT_pushtuple(L, ret);
+}
+
 static int
 lbox_push_txn_stmt(struct lua_State *L, void *event)
 {
 	struct txn_stmt *stmt = txn_current_stmt((struct txn *) event);
 
 	if (stmt->old_tuple) {
-		luaT_pushtuple(L, stmt->old_tuple);
+		lbox_push_stmt_tuple(L, stmt->old_tuple);
 	} else {
 		lua_pushnil(L);
 	}
 	if (stmt->new_tuple) {
-		luaT_pushtuple(L, stmt->new_tuple);
+		lbox_push_stmt_tuple(L, stmt->new_tuple);
 	} else {
 		lua_pushnil(L);
 	}
@@ -351,6 +368,25 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnil(L);
 			lua_setfield(L, -2, "hint");
 		}
+		/*
+		 * Only show the option if it's set so as not to
+		 * clutter the output for regular indexes.
+		 */
+		if (index_opts->normalized_keys) {
+			lua_pushboolean(L, true);
+			lua_setfield(L, -2, "normalized_keys");
+		} else {
+			lua_pushnil(L);
+			lua_setfield(L, -2, "normalized_keys");
+		}
+		if (space_is_memtx(space) && index_def->type == HASH) {
+			lua_pushstring(L,
+				hash_index_layout_strs[index_opts->layout]);
+			lua_setfield(L, -2, "layout");
+		} else {
+			lua_pushnil(L);
+			lua_setfield(L, -2, "layout");
+		}
 
 		if (index_opts->func_id > 0) {
 			lua_pushstring(L, "func");
@@ -439,6 +475,18 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnumber(L, index_opts->bloom_fpr);
 			lua_setfield(L, -2, "bloom_fpr");
 
+			if (index_opts->bloom_type != BLOOM_TYPE_CLASSIC) {
+				lua_pushstring(L,
+					bloom_type_strs[index_opts->bloom_type]);
+				lua_setfield(L, -2, "bloom_type");
+			}
+
+			if (index_opts->page_restart_interval > 0) {
+				lua_pushnumber(L,
+					index_opts->page_restart_interval);
+				lua_setfield(L, -2, "page_restart_interval");
+			}
+
 			lua_settable(L, -3);
 		}
 		lua_setfield(L, -2, index_def->name);
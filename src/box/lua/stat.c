@@ -43,14 +43,13 @@
 #include "box/engine.h"
 #include "box/vinyl.h"
 #include "box/sql.h"
+#include "box/wal.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
 
 extern struct rmean *rmean_box;
 extern struct rmean *rmean_error;
-/** network statistics (iproto & cbus) */
-extern struct rmean *rmean_net;
 extern struct rmean *rmean_tx_wal_bus;
 
 static void
@@ -148,7 +147,7 @@ static int
 lbox_stat_net_index(struct lua_State *L)
 {
 	const char *key = luaL_checkstring(L, -1);
-	if (rmean_foreach(rmean_net, seek_stat_item, L) == 0)
+	if (iproto_rmean_foreach(seek_stat_item, L) == 0)
 		return 0;
 
 	if (strcmp(key, "CONNECTIONS") == 0) {
@@ -183,7 +182,7 @@ static int
 lbox_stat_net_call(struct lua_State *L)
 {
 	lua_newtable(L);
-	rmean_foreach(rmean_net, set_stat_item, L);
+	iproto_rmean_foreach(set_stat_item, L);
 
 	lua_pushstring(L, "CONNECTIONS");
 	lua_rawget(L, -2);
@@ -202,6 +201,40 @@ lbox_stat_net_call(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Push an array of network metrics of every iproto thread
+ * to a Lua stack. Each item has the same layout as the
+ * table returned by lbox_stat_net_call(), but is limited
+ * to the connections served by the corresponding thread.
+ * Used to detect imbalance between the threads.
+ */
+static int
+lbox_stat_net_thread(struct lua_State *L)
+{
+	lua_createtable(L, iproto_threads_count, 0);
+	for (int i = 0; i < iproto_threads_count; i++) {
+		lua_newtable(L);
+		iproto_thread_rmean_foreach(i, set_stat_item, L);
+
+		lua_pushstring(L, "CONNECTIONS");
+		lua_rawget(L, -2);
+		lua_pushstring(L, "current");
+		lua_pushnumber(L, iproto_thread_connection_count(i));
+		lua_rawset(L, -3);
+		lua_pop(L, 1);
+
+		lua_pushstring(L, "REQUESTS");
+		lua_rawget(L, -2);
+		lua_pushstring(L, "current");
+		lua_pushnumber(L, iproto_thread_request_count(i));
+		lua_rawset(L, -3);
+		lua_pop(L, 1);
+
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
 static int
 lbox_stat_sql(struct lua_State *L)
 {
@@ -211,6 +244,15 @@ lbox_stat_sql(struct lua_State *L)
 	return 1;
 }
 
+static int
+lbox_stat_wal(struct lua_State *L)
+{
+	struct info_handler info;
+	luaT_info_handler_create(&info, L);
+	wal_stat(&info);
+	return 1;
+}
+
 static const struct luaL_Reg lbox_stat_meta [] = {
 	{"__index", lbox_stat_index},
 	{"__call",  lbox_stat_call},
@@ -231,6 +273,7 @@ box_lua_stat_init(struct lua_State *L)
 		{"vinyl", lbox_stat_vinyl},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
+		{"wal", lbox_stat_wal},
 		{NULL, NULL}
 	};
 
@@ -242,6 +285,7 @@ box_lua_stat_init(struct lua_State *L)
 	lua_pop(L, 1); /* stat module */
 
 	static const struct luaL_Reg netstatlib [] = {
+		{"thread", lbox_stat_net_thread},
 		{NULL, NULL}
 	};
 
@@ -39,6 +39,7 @@
 #include "errinj.h"
 #include "coio_file.h"
 #include "tuple.h"
+#include "tuple_compression.h"
 #include "txn.h"
 #include "memtx_tx.h"
 #include "memtx_tree.h"
@@ -50,6 +51,7 @@
 #include "schema.h"
 #include "gc.h"
 #include "raft.h"
+#include "snap_reader.h"
 
 /* sync snapshot every 16MB */
 #define SNAP_SYNC_INTERVAL	(1 << 24)
@@ -76,6 +78,11 @@ enum {
 	OBJSIZE_MIN = 16,
 	SLAB_SIZE = 16 * 1024 * 1024,
 	MAX_TUPLE_SIZE = 1 * 1024 * 1024,
+	/**
+	 * Min number of tuples in a space for its secondary
+	 * keys to be sorted in threads, see memtx_sort_keys().
+	 */
+	SORT_THREAD_MIN_TUPLES = 10000,
 };
 
 static int
@@ -91,6 +98,81 @@ memtx_end_build_primary_key(struct space *space, void *param)
 	return 0;
 }
 
+/** A thread sorting keys of secondary tree indexes. */
+struct memtx_sort_thread {
+	struct cord cord;
+	/** Indexes to sort keys of. */
+	struct index **indexes;
+	/** Number of indexes in the array. */
+	int index_count;
+	/** The thread sorts indexes first, first + step, ... */
+	int first;
+	int step;
+};
+
+static int
+memtx_sort_thread_f(va_list ap)
+{
+	struct memtx_sort_thread *thread =
+		va_arg(ap, struct memtx_sort_thread *);
+	for (int i = thread->first; i < thread->index_count; i += thread->step)
+		memtx_tree_index_sort_build_array(thread->indexes[i]);
+	return 0;
+}
+
+/**
+ * Sort keys of secondary tree indexes of a space in parallel
+ * threads. Sorting is the most expensive part of building a tree
+ * index and indexes are independent of each other at this point,
+ * while the rest of the build allocates memory from the engine
+ * and so has to be done in the tx thread. Each thread sorts one
+ * index at a time without spawning more threads of its own, so
+ * there are at most box.cfg.memtx_recovery_threads of them. Keys
+ * that haven't been sorted here, e.g. because a thread failed to
+ * start, are sorted by index_end_build().
+ */
+static void
+memtx_sort_keys(struct memtx_engine *memtx, struct space *space)
+{
+	struct index *indexes[BOX_INDEX_MAX];
+	int index_count = 0;
+	for (uint32_t j = 1; j < space->index_count; j++) {
+		struct index *index = space->index[j];
+		if (index->def->type == TREE)
+			indexes[index_count++] = index;
+	}
+	int thread_count = MIN(index_count, memtx->recovery_threads);
+	if (thread_count < 2)
+		return;
+
+	struct memtx_sort_thread *threads = calloc(thread_count,
+						   sizeof(*threads));
+	if (threads == NULL) {
+		say_warn("failed to allocate secondary key sort threads");
+		return;
+	}
+	int started = 0;
+	for (; started < thread_count; started++) {
+		struct memtx_sort_thread *thread = &threads[started];
+		thread->indexes = indexes;
+		thread->index_count = index_count;
+		thread->first = started;
+		thread->step = thread_count;
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "memtx.sort.%d", started);
+		if (cord_costart(&thread->cord, name, memtx_sort_thread_f,
+				 thread) != 0) {
+			diag_log();
+			break;
+		}
+	}
+	for (int i = 0; i < started; i++) {
+		if (cord_cojoin(&threads[i].cord) != 0)
+			panic("failed to join secondary key sort thread");
+	}
+	free(threads);
+}
+
 /**
  * Secondary indexes are built in bulk after all data is
  * recovered. This function enables secondary keys on a space.
@@ -100,6 +182,7 @@ memtx_end_build_primary_key(struct space *space, void *param)
 static int
 memtx_build_secondary_keys(struct space *space, void *param)
 {
+	struct memtx_engine *memtx = (struct memtx_engine *)param;
 	struct memtx_space *memtx_space = (struct memtx_space *)space;
 	if (space->engine != param || space_index(space, 0) == NULL ||
 	    memtx_space->replace == memtx_space_replace_all_keys)
@@ -115,9 +198,23 @@ memtx_build_secondary_keys(struct space *space, void *param)
 				 space_name(space));
 		}
 
-		for (uint32_t j = 1; j < space->index_count; j++) {
-			if (index_build(space->index[j], pk) < 0)
-				return -1;
+		if (n_tuples < SORT_THREAD_MIN_TUPLES) {
+			for (uint32_t j = 1; j < space->index_count; j++) {
+				if (index_build(space->index[j], pk) < 0)
+					return -1;
+			}
+		} else {
+			/*
+			 * Collect keys of all indexes first, then sort
+			 * them in threads, then build the indexes.
+			 */
+			for (uint32_t j = 1; j < space->index_count; j++) {
+				if (index_build_keys(space->index[j], pk) < 0)
+					return -1;
+			}
+			memtx_sort_keys(memtx, space);
+			for (uint32_t j = 1; j < space->index_count; j++)
+				index_end_build(space->index[j]);
 		}
 
 		if (n_tuples > 0) {
@@ -145,6 +242,8 @@ memtx_engine_shutdown(struct engine *engine)
 	slab_cache_destroy(&memtx->slab_cache);
 	tuple_arena_destroy(&memtx->arena);
 	xdir_destroy(&memtx->snap_dir);
+	if (memtx->zdict != NULL)
+		xlog_zdict_unref(memtx->zdict);
 	free(memtx);
 }
 
@@ -152,17 +251,79 @@ static int
 memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 				  struct xrow_header *row);
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
+/**
+ * Recover from a snapshot file read and decoded by a pipeline
+ * of threads, see snap_reader. Rows are still applied by the tx
+ * thread in the file order, because tuples and indexes can't
+ * be modified concurrently.
+ */
+static int
+memtx_engine_recover_snapshot_file_parallel(struct memtx_engine *memtx,
+					    const char *filename,
+					    int64_t signature,
+					    uint32_t *part_count)
 {
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature, NONE);
+	struct snap_reader *reader = snap_reader_new(filename,
+						     memtx->recovery_threads);
+	if (reader == NULL)
+		return -1;
 
+	int rc;
+	struct xrow_header row;
+	uint64_t row_count = 0;
+	while ((rc = snap_reader_next(reader, &row)) == 0) {
+		row.lsn = signature;
+		rc = memtx_engine_recover_snapshot_row(memtx, &row);
+		if (rc < 0)
+			break;
+		++row_count;
+		if (row_count % 100000 == 0) {
+			say_info("%.1fM rows processed",
+				 row_count / 1000000.);
+			fiber_yield_timeout(0);
+		}
+	}
+	bool is_eof = false;
+	if (rc > 0) {
+		is_eof = snap_reader_is_eof(reader);
+		*part_count = snap_reader_part_count(reader);
+		/* Reuse the snapshot dictionary for the next snapshot. */
+		struct xlog_zdict *zdict = snap_reader_steal_zdict(reader);
+		if (zdict != NULL) {
+			if (memtx->zdict != NULL)
+				xlog_zdict_unref(memtx->zdict);
+			memtx->zdict = zdict;
+		}
+	}
+	snap_reader_delete(reader);
+	if (rc < 0)
+		return -1;
+
+	/* See memtx_engine_recover_snapshot_file(). */
+	if (!is_eof)
+		panic("snapshot `%s' has no EOF marker", filename);
+
+	return 0;
+}
+
+/**
+ * Recover from a snapshot file. Return the number of part files
+ * listed in its header in @a part_count.
+ */
+static int
+memtx_engine_recover_snapshot_file(struct memtx_engine *memtx,
+				   const char *filename, int64_t signature,
+				   uint32_t *part_count)
+{
 	say_info("recovering from `%s'", filename);
+	/*
+	 * Invalid rows can't be skipped by the parallel reader,
+	 * because it reads the file in whole tx blocks.
+	 */
+	if (memtx->recovery_threads > 0 && !memtx->force_recovery)
+		return memtx_engine_recover_snapshot_file_parallel(memtx,
+					filename, signature, part_count);
+
 	struct xlog_cursor cursor;
 	if (xlog_cursor_open(&cursor, filename) < 0)
 		return -1;
@@ -187,6 +348,14 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 			fiber_yield_timeout(0);
 		}
 	}
+	*part_count = cursor.meta.part_count;
+	/* Reuse the snapshot dictionary for the next snapshot. */
+	if (cursor.zdict != NULL) {
+		if (memtx->zdict != NULL)
+			xlog_zdict_unref(memtx->zdict);
+		memtx->zdict = cursor.zdict;
+		cursor.zdict = NULL;
+	}
 	xlog_cursor_close(&cursor, false);
 	if (rc < 0)
 		return -1;
@@ -202,6 +371,40 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	return 0;
 }
 
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
+{
+	/* Process existing snapshot */
+	say_info("recovery start");
+	int64_t signature = vclock_sum(vclock);
+	char filename[PATH_MAX];
+	snprintf(filename, sizeof(filename), "%s",
+		 xdir_format_filename(&memtx->snap_dir, signature, NONE));
+	uint32_t part_count;
+	if (memtx_engine_recover_snapshot_file(memtx, filename, signature,
+					       &part_count) != 0)
+		return -1;
+	/*
+	 * User spaces may be stored in part files written in
+	 * parallel, see checkpoint_part. System spaces are always
+	 * stored in the main file, so they have been recovered.
+	 * The part files are recovered one after another, because
+	 * rows are applied by the tx thread anyway.
+	 */
+	for (uint32_t part = 1; part <= part_count; part++) {
+		snprintf(filename, sizeof(filename), "%s",
+			 xdir_format_part_filename(&memtx->snap_dir,
+						   signature, part, NONE));
+		uint32_t unused;
+		if (memtx_engine_recover_snapshot_file(memtx, filename,
+						       signature,
+						       &unused) != 0)
+			return -1;
+	}
+	return 0;
+}
+
 static int
 memtx_engine_recover_raft(const struct xrow_header *row)
 {
@@ -462,7 +665,8 @@ memtx_engine_bootstrap(struct engine *engine)
 static int
 checkpoint_write_row(struct xlog *l, struct xrow_header *row)
 {
-	static ev_tstamp last = 0;
+	/* Snapshot files may be written by several threads. */
+	static __thread ev_tstamp last = 0;
 	if (last == 0) {
 		ev_now_update(loop());
 		last = ev_now(loop());
@@ -514,21 +718,61 @@ checkpoint_write_tuple(struct xlog *l, uint32_t space_id, uint32_t group_id,
 struct checkpoint_entry {
 	uint32_t space_id;
 	uint32_t group_id;
+	/** Size of the space data, used to balance parts. */
+	size_t size;
 	struct snapshot_iterator *iterator;
 	struct rlist link;
 };
 
+/**
+ * A file of a snapshot and the thread writing it. A snapshot
+ * may be split into several files written in parallel, see
+ * xdir_create_xlog_part(). The main file, part 0, stores system
+ * spaces, which must be recovered before anything else, and the
+ * Raft state. User spaces are distributed among all parts.
+ */
+struct checkpoint_part {
+	struct checkpoint *ckpt;
+	/** Number of the part, 0 for the main file. */
+	uint32_t id;
+	/** Spaces to write, linked by checkpoint_entry::link. */
+	struct rlist entries;
+	/** Total size of the spaces. */
+	size_t size;
+	struct cord cord;
+	/** Set if the thread has been started and not joined. */
+	bool is_running;
+};
+
 struct checkpoint {
 	/**
 	 * List of MemTX spaces to snapshot, with consistent
-	 * read view iterators.
+	 * read view iterators. Moved to parts by
+	 * checkpoint_distribute().
 	 */
 	struct rlist entries;
-	struct cord cord;
+	/** Snapshot files, part_count + 1 elements. */
+	struct checkpoint_part *parts;
+	/** Number of part files in addition to the main file. */
+	uint32_t part_count;
 	bool waiting_for_snap_thread;
 	/** The vclock of the snapshot file. */
 	struct vclock vclock;
 	struct xdir dir;
+	/** Dictionary the snapshot is compressed with or NULL. */
+	struct xlog_zdict *zdict;
+	/**
+	 * Size of a dictionary to train on the snapshot data,
+	 * 0 if it shouldn't be trained.
+	 */
+	size_t zdict_size;
+	/**
+	 * Part the dictionary is trained on, the biggest one,
+	 * so that only one thread has to sample data.
+	 */
+	uint32_t zdict_part;
+	/** Dictionary trained on the snapshot data or NULL. */
+	struct xlog_zdict *new_zdict;
 	struct raft_request raft;
 	/**
 	 * Do nothing, just touch the snapshot file - the
@@ -538,7 +782,8 @@ struct checkpoint {
 };
 
 static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit,
+	       struct xlog_zdict *zdict, size_t zdict_size)
 {
 	struct checkpoint *ckpt = malloc(sizeof(*ckpt));
 	if (ckpt == NULL) {
@@ -547,12 +792,21 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 		return NULL;
 	}
 	rlist_create(&ckpt->entries);
+	ckpt->parts = NULL;
+	ckpt->part_count = 0;
 	ckpt->waiting_for_snap_thread = false;
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = snap_io_rate_limit;
 	opts.sync_interval = SNAP_SYNC_INTERVAL;
 	opts.free_cache = true;
+	opts.zdict = zdict;
 	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID, &opts);
+	ckpt->zdict = zdict;
+	if (zdict != NULL)
+		xlog_zdict_ref(zdict);
+	ckpt->zdict_size = zdict_size;
+	ckpt->zdict_part = 0;
+	ckpt->new_zdict = NULL;
 	vclock_create(&ckpt->vclock);
 	raft_serialize_for_disk(box_raft(), &ckpt->raft);
 	ckpt->touch = false;
@@ -560,14 +814,29 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 }
 
 static void
-checkpoint_delete(struct checkpoint *ckpt)
+checkpoint_delete_entries(struct rlist *entries)
 {
 	struct checkpoint_entry *entry, *tmp;
-	rlist_foreach_entry_safe(entry, &ckpt->entries, link, tmp) {
+	rlist_foreach_entry_safe(entry, entries, link, tmp) {
 		entry->iterator->free(entry->iterator);
 		free(entry);
 	}
+}
+
+static void
+checkpoint_delete(struct checkpoint *ckpt)
+{
+	checkpoint_delete_entries(&ckpt->entries);
+	if (ckpt->parts != NULL) {
+		for (uint32_t i = 0; i <= ckpt->part_count; i++)
+			checkpoint_delete_entries(&ckpt->parts[i].entries);
+		free(ckpt->parts);
+	}
 	xdir_destroy(&ckpt->dir);
+	if (ckpt->zdict != NULL)
+		xlog_zdict_unref(ckpt->zdict);
+	if (ckpt->new_zdict != NULL)
+		xlog_zdict_unref(ckpt->new_zdict);
 	free(ckpt);
 }
 
@@ -575,13 +844,18 @@ static void
 checkpoint_cancel(struct checkpoint *ckpt)
 {
 	/*
-	 * Cancel the checkpoint thread if it's running and wait
-	 * for it to terminate so as to eliminate the possibility
-	 * of use-after-free.
+	 * Cancel the checkpoint threads if they're running and
+	 * wait for them to terminate so as to eliminate the
+	 * possibility of use-after-free.
 	 */
 	if (ckpt->waiting_for_snap_thread) {
-		tt_pthread_cancel(ckpt->cord.id);
-		tt_pthread_join(ckpt->cord.id, NULL);
+		for (uint32_t i = 0; i <= ckpt->part_count; i++) {
+			struct checkpoint_part *part = &ckpt->parts[i];
+			if (!part->is_running)
+				continue;
+			tt_pthread_cancel(part->cord.id);
+			tt_pthread_join(part->cord.id, NULL);
+		}
 	}
 	checkpoint_delete(ckpt);
 }
@@ -619,6 +893,7 @@ checkpoint_add_space(struct space *sp, void *data)
 
 	entry->space_id = space_id(sp);
 	entry->group_id = space_group_id(sp);
+	entry->size = space_bsize(sp);
 	entry->iterator = index_create_snapshot_iterator(pk);
 	if (entry->iterator == NULL)
 		return -1;
@@ -626,6 +901,91 @@ checkpoint_add_space(struct space *sp, void *data)
 	return 0;
 };
 
+static int
+checkpoint_entry_cmp_size(const void *a, const void *b)
+{
+	const struct checkpoint_entry *entry_a =
+		*(const struct checkpoint_entry **)a;
+	const struct checkpoint_entry *entry_b =
+		*(const struct checkpoint_entry **)b;
+	if (entry_a->size != entry_b->size)
+		return entry_a->size > entry_b->size ? -1 : 1;
+	return entry_a->space_id < entry_b->space_id ? -1 : 1;
+}
+
+/**
+ * Split the snapshot into at most @a thread_count files. System
+ * spaces go to the main file. User spaces are assigned to files
+ * one by one, from the biggest to the smallest, each to the file
+ * with the least data so far.
+ */
+static int
+checkpoint_distribute(struct checkpoint *ckpt, int thread_count)
+{
+	assert(thread_count > 0);
+	uint32_t user_count = 0;
+	struct checkpoint_entry *entry, *tmp;
+	rlist_foreach_entry(entry, &ckpt->entries, link) {
+		if (entry->space_id > BOX_SYSTEM_ID_MAX)
+			user_count++;
+	}
+	uint32_t part_count = MIN((uint32_t)thread_count - 1, user_count);
+	struct checkpoint_entry **user = NULL;
+	if (part_count > 0) {
+		user = malloc(user_count * sizeof(*user));
+		if (user == NULL) {
+			diag_set(OutOfMemory, user_count * sizeof(*user),
+				 "malloc", "checkpoint entries");
+			return -1;
+		}
+	}
+	ckpt->parts = calloc(part_count + 1, sizeof(*ckpt->parts));
+	if (ckpt->parts == NULL) {
+		diag_set(OutOfMemory, (part_count + 1) * sizeof(*ckpt->parts),
+			 "calloc", "struct checkpoint_part");
+		free(user);
+		return -1;
+	}
+	ckpt->part_count = part_count;
+	for (uint32_t i = 0; i <= part_count; i++) {
+		struct checkpoint_part *part = &ckpt->parts[i];
+		part->ckpt = ckpt;
+		part->id = i;
+		rlist_create(&part->entries);
+	}
+	if (part_count == 0) {
+		rlist_splice_tail(&ckpt->parts[0].entries, &ckpt->entries);
+		return 0;
+	}
+	uint32_t i = 0;
+	rlist_foreach_entry_safe(entry, &ckpt->entries, link, tmp) {
+		rlist_del_entry(entry, link);
+		if (entry->space_id > BOX_SYSTEM_ID_MAX) {
+			user[i++] = entry;
+			continue;
+		}
+		rlist_add_tail_entry(&ckpt->parts[0].entries, entry, link);
+		ckpt->parts[0].size += entry->size;
+	}
+	assert(i == user_count);
+	qsort(user, user_count, sizeof(*user), checkpoint_entry_cmp_size);
+	for (i = 0; i < user_count; i++) {
+		struct checkpoint_part *min = &ckpt->parts[0];
+		for (uint32_t j = 1; j <= part_count; j++) {
+			if (ckpt->parts[j].size < min->size)
+				min = &ckpt->parts[j];
+		}
+		rlist_add_tail_entry(&min->entries, user[i], link);
+		min->size += user[i]->size;
+	}
+	free(user);
+	for (i = 1; i <= part_count; i++) {
+		if (ckpt->parts[i].size > ckpt->parts[ckpt->zdict_part].size)
+			ckpt->zdict_part = i;
+	}
+	return 0;
+}
+
 static int
 checkpoint_write_raft(struct xlog *l, const struct raft_request *req)
 {
@@ -646,26 +1006,46 @@ finish:
 static int
 checkpoint_f(va_list ap)
 {
-	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
+	struct checkpoint_part *part = va_arg(ap, struct checkpoint_part *);
+	struct checkpoint *ckpt = part->ckpt;
 
 	if (ckpt->touch) {
+		assert(part->id == 0);
 		if (xdir_touch_xlog(&ckpt->dir, &ckpt->vclock) == 0)
 			return 0;
 		/*
 		 * Failed to touch an existing snapshot, create
-		 * a new one.
+		 * a new one. Threads writing part files haven't
+		 * been started, so write all spaces to the main
+		 * file.
 		 */
 		ckpt->touch = false;
+		for (uint32_t i = 1; i <= ckpt->part_count; i++) {
+			rlist_splice_tail(&part->entries,
+					  &ckpt->parts[i].entries);
+		}
+		ckpt->part_count = 0;
+		ckpt->zdict_part = 0;
 	}
 
+	/* Files share the rate limit. */
+	struct xlog_opts opts = ckpt->dir.opts;
+	if (opts.rate_limit > 0)
+		opts.rate_limit = MAX(opts.rate_limit /
+				      (ckpt->part_count + 1), 1);
 	struct xlog snap;
-	if (xdir_create_xlog(&ckpt->dir, &snap, &ckpt->vclock) != 0)
+	if (xdir_create_xlog_part(&ckpt->dir, &snap, &ckpt->vclock,
+				  part->id, ckpt->part_count, &opts) != 0)
 		return -1;
 
 	say_info("saving snapshot `%s'", snap.filename);
 	ERROR_INJECT_SLEEP(ERRINJ_SNAP_WRITE_DELAY);
+	size_t zdict_size = part->id == ckpt->zdict_part ?
+			    ckpt->zdict_size : 0;
+	struct xlog_zdict_sampler sampler;
+	xlog_zdict_sampler_create(&sampler, zdict_size);
 	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
+	rlist_foreach_entry(entry, &part->entries, link) {
 		int rc;
 		uint32_t size;
 		const char *data;
@@ -674,20 +1054,32 @@ checkpoint_f(va_list ap)
 			if (checkpoint_write_tuple(&snap, entry->space_id,
 					entry->group_id, data, size) != 0)
 				goto fail;
+			if (zdict_size > 0)
+				xlog_zdict_sampler_add(&sampler, data, size);
 		}
 		if (rc != 0)
 			goto fail;
 	}
-	if (checkpoint_write_raft(&snap, &ckpt->raft) != 0)
+	if (part->id == 0 && checkpoint_write_raft(&snap, &ckpt->raft) != 0)
 		goto fail;
 	if (xlog_flush(&snap) < 0)
 		goto fail;
 
 	xlog_close(&snap, false);
 	say_info("done");
+
+	/* Train a dictionary for the next snapshot. */
+	if (zdict_size > 0 &&
+	    xlog_zdict_sampler_train(&sampler, zdict_size,
+				     &ckpt->new_zdict) != 0) {
+		diag_log();
+		say_warn("failed to train snapshot compression dictionary");
+	}
+	xlog_zdict_sampler_destroy(&sampler);
 	return 0;
 fail:
 	xlog_close(&snap, false);
+	xlog_zdict_sampler_destroy(&sampler);
 	return -1;
 }
 
@@ -699,11 +1091,16 @@ memtx_engine_begin_checkpoint(struct engine *engine, bool is_scheduled)
 
 	assert(memtx->checkpoint == NULL);
 	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
+					   memtx->snap_io_rate_limit,
+					   memtx->zdict_size > 0 ?
+					   memtx->zdict : NULL,
+					   memtx->zdict_size);
 	if (memtx->checkpoint == NULL)
 		return -1;
 
-	if (space_foreach(checkpoint_add_space, memtx->checkpoint) != 0) {
+	if (space_foreach(checkpoint_add_space, memtx->checkpoint) != 0 ||
+	    checkpoint_distribute(memtx->checkpoint,
+				  memtx->checkpoint_threads) != 0) {
 		checkpoint_delete(memtx->checkpoint);
 		memtx->checkpoint = NULL;
 		return -1;
@@ -716,30 +1113,49 @@ memtx_engine_wait_checkpoint(struct engine *engine,
 			     const struct vclock *vclock)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	struct checkpoint *ckpt = memtx->checkpoint;
 
-	assert(memtx->checkpoint != NULL);
+	assert(ckpt != NULL);
 	/*
 	 * If a snapshot already exists, do not create a new one.
 	 */
 	struct vclock last;
 	if (xdir_last_vclock(&memtx->snap_dir, &last) >= 0 &&
 	    vclock_compare(&last, vclock) == 0) {
-		memtx->checkpoint->touch = true;
+		ckpt->touch = true;
 	}
-	vclock_copy(&memtx->checkpoint->vclock, vclock);
-
-	if (cord_costart(&memtx->checkpoint->cord, "snapshot",
-			 checkpoint_f, memtx->checkpoint)) {
-		return -1;
+	vclock_copy(&ckpt->vclock, vclock);
+
+	int result = 0;
+	uint32_t thread_count = ckpt->touch ? 1 : ckpt->part_count + 1;
+	for (uint32_t i = 0; i < thread_count; i++) {
+		struct checkpoint_part *part = &ckpt->parts[i];
+		char name[FIBER_NAME_MAX];
+		if (i == 0)
+			snprintf(name, sizeof(name), "snapshot");
+		else
+			snprintf(name, sizeof(name), "snapshot.%u", i);
+		if (cord_costart(&part->cord, name, checkpoint_f, part)) {
+			result = -1;
+			break;
+		}
+		part->is_running = true;
 	}
-	memtx->checkpoint->waiting_for_snap_thread = true;
+	ckpt->waiting_for_snap_thread = true;
 
 	/* wait for memtx-part snapshot completion */
-	int result = cord_cojoin(&memtx->checkpoint->cord);
-	if (result != 0)
-		diag_log();
+	for (uint32_t i = 0; i < thread_count; i++) {
+		struct checkpoint_part *part = &ckpt->parts[i];
+		if (!part->is_running)
+			continue;
+		if (cord_cojoin(&part->cord) != 0) {
+			diag_log();
+			result = -1;
+		}
+		part->is_running = false;
+	}
 
-	memtx->checkpoint->waiting_for_snap_thread = false;
+	ckpt->waiting_for_snap_thread = false;
 	return result;
 }
 
@@ -758,11 +1174,26 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 	if (!memtx->checkpoint->touch) {
 		int64_t lsn = vclock_sum(&memtx->checkpoint->vclock);
 		struct xdir *dir = &memtx->checkpoint->dir;
-		/* rename snapshot on completion */
 		char to[PATH_MAX];
+		char from[PATH_MAX];
+		/*
+		 * Rename part files first so that the snapshot
+		 * appears as a whole along with the main file.
+		 */
+		for (uint32_t i = 1; i <= memtx->checkpoint->part_count; i++) {
+			snprintf(to, sizeof(to), "%s",
+				 xdir_format_part_filename(dir, lsn, i, NONE));
+			snprintf(from, sizeof(from), "%s",
+				 xdir_format_part_filename(dir, lsn, i,
+							   INPROGRESS));
+			if (coio_rename(from, to) != 0)
+				panic("can't rename .snap.inprogress");
+		}
+		/* rename snapshot on completion */
 		snprintf(to, sizeof(to), "%s",
 			 xdir_format_filename(dir, lsn, NONE));
-		const char *from = xdir_format_filename(dir, lsn, INPROGRESS);
+		snprintf(from, sizeof(from), "%s",
+			 xdir_format_filename(dir, lsn, INPROGRESS));
 		ERROR_INJECT_YIELD(ERRINJ_SNAP_COMMIT_DELAY);
 		int rc = coio_rename(from, to);
 		if (rc != 0)
@@ -776,6 +1207,14 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 		xdir_add_vclock(&memtx->snap_dir, &memtx->checkpoint->vclock);
 	}
 
+	/* Compress the next snapshot with the new dictionary. */
+	if (memtx->checkpoint->new_zdict != NULL) {
+		if (memtx->zdict != NULL)
+			xlog_zdict_unref(memtx->zdict);
+		memtx->zdict = memtx->checkpoint->new_zdict;
+		memtx->checkpoint->new_zdict = NULL;
+	}
+
 	checkpoint_delete(memtx->checkpoint);
 	memtx->checkpoint = NULL;
 }
@@ -784,25 +1223,35 @@ static void
 memtx_engine_abort_checkpoint(struct engine *engine)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	struct checkpoint *ckpt = memtx->checkpoint;
 
 	/**
 	 * An error in the other engine's first phase.
 	 */
-	if (memtx->checkpoint->waiting_for_snap_thread) {
+	if (ckpt->waiting_for_snap_thread) {
 		/* wait for memtx-part snapshot completion */
-		if (cord_cojoin(&memtx->checkpoint->cord) != 0)
-			diag_log();
-		memtx->checkpoint->waiting_for_snap_thread = false;
+		for (uint32_t i = 0; i <= ckpt->part_count; i++) {
+			struct checkpoint_part *part = &ckpt->parts[i];
+			if (!part->is_running)
+				continue;
+			if (cord_cojoin(&part->cord) != 0)
+				diag_log();
+			part->is_running = false;
+		}
+		ckpt->waiting_for_snap_thread = false;
 	}
 
-	/** Remove garbage .inprogress file. */
+	/** Remove garbage .inprogress files. */
+	int64_t lsn = vclock_sum(&ckpt->vclock);
+	for (uint32_t i = 1; i <= ckpt->part_count; i++) {
+		(void) coio_unlink(xdir_format_part_filename(&ckpt->dir, lsn,
+							     i, INPROGRESS));
+	}
 	const char *filename =
-		xdir_format_filename(&memtx->checkpoint->dir,
-				     vclock_sum(&memtx->checkpoint->vclock),
-				     INPROGRESS);
+		xdir_format_filename(&ckpt->dir, lsn, INPROGRESS);
 	(void) coio_unlink(filename);
 
-	checkpoint_delete(memtx->checkpoint);
+	checkpoint_delete(ckpt);
 	memtx->checkpoint = NULL;
 }
 
@@ -812,6 +1261,7 @@ memtx_engine_collect_garbage(struct engine *engine, const struct vclock *vclock)
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
 	xdir_collect_garbage(&memtx->snap_dir, vclock_sum(vclock),
 			     XDIR_GC_ASYNC);
+	xdir_collect_parts(&memtx->snap_dir, vclock_sum(vclock));
 	xdir_collect_inprogress(&memtx->snap_dir);
 }
 
@@ -820,9 +1270,24 @@ memtx_engine_backup(struct engine *engine, const struct vclock *vclock,
 		    engine_backup_cb cb, void *cb_arg)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    vclock_sum(vclock), NONE);
-	return cb(filename, cb_arg);
+	int64_t signature = vclock_sum(vclock);
+	char filename[PATH_MAX];
+	snprintf(filename, sizeof(filename), "%s",
+		 xdir_format_filename(&memtx->snap_dir, signature, NONE));
+	/* Look up the number of part files in the snapshot header. */
+	struct xlog_cursor cursor;
+	if (xlog_cursor_open(&cursor, filename) != 0)
+		return -1;
+	uint32_t part_count = cursor.meta.part_count;
+	xlog_cursor_close(&cursor, false);
+	if (cb(filename, cb_arg) != 0)
+		return -1;
+	for (uint32_t i = 1; i <= part_count; i++) {
+		if (cb(xdir_format_part_filename(&memtx->snap_dir, signature,
+						 i, NONE), cb_arg) != 0)
+			return -1;
+	}
+	return 0;
 }
 
 struct memtx_join_entry {
@@ -1124,6 +1589,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	memtx->state = MEMTX_INITIALIZED;
 	memtx->max_tuple_size = MAX_TUPLE_SIZE;
 	memtx->force_recovery = force_recovery;
+	memtx->checkpoint_threads = 1;
 
 	memtx->replica_join_cord = NULL;
 
@@ -1152,6 +1618,27 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_zdict_size(struct memtx_engine *memtx, size_t size)
+{
+	memtx->zdict_size = size;
+}
+
+void
+memtx_engine_set_recovery_threads(struct memtx_engine *memtx,
+				  int thread_count)
+{
+	memtx->recovery_threads = thread_count;
+}
+
+void
+memtx_engine_set_checkpoint_threads(struct memtx_engine *memtx,
+				    int thread_count)
+{
+	assert(thread_count > 0);
+	memtx->checkpoint_threads = thread_count;
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -1195,8 +1682,32 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end)
 	struct region *region = &fiber()->gc;
 	size_t region_svp = region_used(region);
 	struct field_map_builder builder;
-	if (tuple_field_map_create(format, data, true, &builder) != 0)
+	/*
+	 * Compressed values come from users only after recovery,
+	 * snapshot and WAL data is known to be valid.
+	 */
+	if (format->is_compressed &&
+	    tuple_compress_raw(format, &data, &end, region,
+			       memtx->state == MEMTX_OK) != 0)
 		goto end;
+	if (tuple_field_map_create(format, data, true, &builder) != 0) {
+		/*
+		 * Compression may have been dropped from the space
+		 * format while the space stored compressed values.
+		 * Such tuples are still read in their old format,
+		 * but a snapshot or a joining replica gets them as
+		 * is, so decompress them on recovery.
+		 */
+		if (format->is_compressed || memtx->state == MEMTX_OK)
+			goto end;
+		const char *orig_data = data;
+		if (tuple_decompress_all_raw(&data, &end, region) != 0 ||
+		    data == orig_data)
+			goto end;
+		diag_clear(diag_get());
+		if (tuple_field_map_create(format, data, true, &builder) != 0)
+			goto end;
+	}
 	uint32_t field_map_size = field_map_build_size(&builder);
 	/*
 	 * Data offset is calculated from the begin of the struct
@@ -1290,8 +1801,8 @@ memtx_tuple_chunk_new(struct tuple_format *format, struct tuple *tuple,
 	uint32_t sz = tuple_chunk_sz(data_sz);
 	struct tuple_chunk *tuple_chunk =
 		(struct tuple_chunk *) smalloc(&memtx->alloc, sz);
-	if (tuple == NULL) {
-		diag_set(OutOfMemory, sz, "smalloc", "tuple");
+	if (tuple_chunk == NULL) {
+		diag_set(OutOfMemory, sz, "smalloc", "tuple_chunk");
 		return NULL;
 	}
 	tuple_chunk->data_sz = data_sz;
@@ -1400,6 +1911,10 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (old_def->opts.hint != new_def->opts.hint)
 		return true;
+	if (old_def->opts.layout != new_def->opts.layout)
+		return true;
+	if (old_def->opts.normalized_keys != new_def->opts.normalized_keys)
+		return true;
 
 	const struct key_def *old_cmp_def, *new_cmp_def;
 	if (index_depends_on_pk(index)) {
@@ -117,8 +117,30 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Size of a zstd dictionary to train on snapshot data,
+	 * box.cfg.compression_dict_size. 0 if disabled.
+	 */
+	size_t zdict_size;
+	/**
+	 * zstd dictionary to compress the next snapshot with.
+	 * Trained on the data of the last snapshot or loaded
+	 * from it on recovery. NULL if there's none.
+	 */
+	struct xlog_zdict *zdict;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
+	/**
+	 * Number of threads decoding the snapshot and sorting
+	 * secondary keys on recovery, box.cfg.memtx_recovery_threads.
+	 * 0 if all the work is done by the tx thread.
+	 */
+	int recovery_threads;
+	/**
+	 * Max number of threads writing a snapshot, each to its
+	 * own file, box.cfg.memtx_checkpoint_threads.
+	 */
+	int checkpoint_threads;
 	/**
 	 * Cord being currently used to join replica. It is only
 	 * needed to be able to cancel it on shutdown.
@@ -222,6 +244,30 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+/**
+ * Set the size of a zstd dictionary to train on snapshot data.
+ * The dictionary is used for compression of the next snapshot.
+ * 0 disables dictionary compression.
+ */
+void
+memtx_engine_set_zdict_size(struct memtx_engine *memtx, size_t size);
+
+/**
+ * Set the number of threads decoding the snapshot and sorting
+ * secondary keys on recovery. 0 makes the tx thread do it all.
+ */
+void
+memtx_engine_set_recovery_threads(struct memtx_engine *memtx,
+				  int thread_count);
+
+/**
+ * Set the max number of threads writing a snapshot. If greater
+ * than 1, user spaces are split between several snapshot files.
+ */
+void
+memtx_engine_set_checkpoint_threads(struct memtx_engine *memtx,
+				    int thread_count);
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
@@ -258,7 +304,9 @@ extern struct tuple_format_vtab memtx_tuple_format_vtab;
 
 enum {
 	MEMTX_EXTENT_SIZE = 16 * 1024,
-	MEMTX_SLAB_SIZE = 4 * 1024 * 1024
+	MEMTX_SLAB_SIZE = 4 * 1024 * 1024,
+	/** Max number of threads writing a snapshot. */
+	MEMTX_CHECKPOINT_THREADS_MAX = 64,
 };
 
 /**
@@ -74,18 +74,248 @@ memtx_hash_equal_key(struct tuple *tuple, const char *key,
 #undef LIGHT_EQUAL
 #undef LIGHT_EQUAL_KEY
 
+#define SWISS_NAME _index
+#define SWISS_DATA_TYPE struct tuple *
+#define SWISS_KEY_TYPE const char *
+#define SWISS_CMP_ARG_TYPE struct key_def *
+#define SWISS_EQUAL(a, b, c) memtx_hash_equal(a, b, c)
+#define SWISS_EQUAL_KEY(a, b, c) memtx_hash_equal_key(a, b, c)
+#define SWISS_HASH(a, c) tuple_hash(a, c)
+
+#include "salad/swiss.h"
+
+#undef SWISS_NAME
+#undef SWISS_DATA_TYPE
+#undef SWISS_KEY_TYPE
+#undef SWISS_CMP_ARG_TYPE
+#undef SWISS_EQUAL
+#undef SWISS_EQUAL_KEY
+#undef SWISS_HASH
+
+/**
+ * Hash table of the index. The layout is chosen on index
+ * creation with the 'layout' index option.
+ */
+struct memtx_hash_table {
+	bool is_swiss;
+	union {
+		struct light_index_core light;
+		struct swiss_index_core swiss;
+	};
+};
+
+struct memtx_hash_table_iterator {
+	union {
+		struct light_index_iterator light;
+		struct swiss_index_iterator swiss;
+	};
+};
+
+/** Frozen state of a hash table, used by snapshot iterators. */
+struct memtx_hash_table_read_view {
+	union {
+		struct light_index_iterator light;
+		struct swiss_index_read_view swiss;
+	};
+};
+
+/* {{{ Hash table layout dispatch ************************************/
+
+static inline void
+memtx_hash_table_create(struct memtx_hash_table *table, bool is_swiss,
+			struct memtx_engine *memtx, struct key_def *key_def)
+{
+	table->is_swiss = is_swiss;
+	if (is_swiss)
+		swiss_index_create(&table->swiss, MEMTX_EXTENT_SIZE,
+				   memtx_index_extent_alloc,
+				   memtx_index_extent_free, memtx, key_def);
+	else
+		light_index_create(&table->light, MEMTX_EXTENT_SIZE,
+				   memtx_index_extent_alloc,
+				   memtx_index_extent_free, memtx, key_def);
+}
+
+static inline void
+memtx_hash_table_destroy(struct memtx_hash_table *table)
+{
+	if (table->is_swiss)
+		swiss_index_destroy(&table->swiss);
+	else
+		light_index_destroy(&table->light);
+}
+
+static inline void
+memtx_hash_table_set_arg(struct memtx_hash_table *table,
+			 struct key_def *key_def)
+{
+	if (table->is_swiss)
+		table->swiss.arg = key_def;
+	else
+		table->light.arg = key_def;
+}
+
+static inline uint32_t
+memtx_hash_table_count(struct memtx_hash_table *table)
+{
+	return table->is_swiss ? table->swiss.count : table->light.count;
+}
+
+static inline size_t
+memtx_hash_table_extent_count(struct memtx_hash_table *table)
+{
+	return table->is_swiss ? swiss_index_extent_count(&table->swiss) :
+	       matras_extent_count(&table->light.mtable);
+}
+
+/** Find a tuple by a key. Return NULL if not found. */
+static inline struct tuple *
+memtx_hash_table_find_key(struct memtx_hash_table *table, uint32_t hash,
+			  const char *key)
+{
+	if (table->is_swiss) {
+		uint32_t pos = swiss_index_find_key(&table->swiss, hash, key);
+		return pos != swiss_index_end ?
+		       swiss_index_get(&table->swiss, pos) : NULL;
+	}
+	uint32_t pos = light_index_find_key(&table->light, hash, key);
+	return pos != light_index_end ?
+	       light_index_get(&table->light, pos) : NULL;
+}
+
+/**
+ * Insert a tuple or replace a tuple with the same key, which is
+ * returned in @a replaced (NULL if none). Return -1 on memory
+ * error.
+ */
+static inline int
+memtx_hash_table_replace(struct memtx_hash_table *table, uint32_t hash,
+			 struct tuple *tuple, struct tuple **replaced)
+{
+	*replaced = NULL;
+	if (table->is_swiss) {
+		int rc = swiss_index_replace(&table->swiss, hash, tuple,
+					     replaced);
+		if (rc <= 0)
+			return rc;
+		return swiss_index_insert(&table->swiss, hash,
+					  tuple) != swiss_index_end ? 0 : -1;
+	}
+	uint32_t pos = light_index_replace(&table->light, hash, tuple,
+					   replaced);
+	if (pos == light_index_end)
+		pos = light_index_insert(&table->light, hash, tuple);
+	return pos != light_index_end ? 0 : -1;
+}
+
+/**
+ * Delete a tuple. Return 0 if ok, 1 if not found or -1 on
+ * memory error.
+ */
+static inline int
+memtx_hash_table_delete(struct memtx_hash_table *table, uint32_t hash,
+			struct tuple *tuple)
+{
+	if (table->is_swiss)
+		return swiss_index_delete_value(&table->swiss, hash, tuple);
+	return light_index_delete_value(&table->light, hash, tuple);
+}
+
+static inline struct tuple *
+memtx_hash_table_random(struct memtx_hash_table *table, uint32_t rnd)
+{
+	if (table->is_swiss) {
+		uint32_t pos = swiss_index_random(&table->swiss, rnd);
+		return pos != swiss_index_end ?
+		       swiss_index_get(&table->swiss, pos) : NULL;
+	}
+	struct light_index_core *hash_table = &table->light;
+	if (hash_table->count == 0)
+		return NULL;
+	rnd %= (hash_table->table_size);
+	while (!light_index_pos_valid(hash_table, rnd)) {
+		rnd++;
+		rnd %= (hash_table->table_size);
+	}
+	return light_index_get(hash_table, rnd);
+}
+
+static inline void
+memtx_hash_table_iterator_begin(struct memtx_hash_table *table,
+				struct memtx_hash_table_iterator *it)
+{
+	if (table->is_swiss)
+		swiss_index_iterator_begin(&table->swiss, &it->swiss);
+	else
+		light_index_iterator_begin(&table->light, &it->light);
+}
+
+static inline void
+memtx_hash_table_iterator_key(struct memtx_hash_table *table,
+			      struct memtx_hash_table_iterator *it,
+			      uint32_t hash, const char *key)
+{
+	if (table->is_swiss)
+		swiss_index_iterator_key(&table->swiss, &it->swiss, hash, key);
+	else
+		light_index_iterator_key(&table->light, &it->light, hash, key);
+}
+
+static inline struct tuple **
+memtx_hash_table_iterator_get_and_next(struct memtx_hash_table *table,
+				       struct memtx_hash_table_iterator *it)
+{
+	if (table->is_swiss)
+		return swiss_index_iterator_get_and_next(&table->swiss,
+							 &it->swiss);
+	return light_index_iterator_get_and_next(&table->light, &it->light);
+}
+
+static inline void
+memtx_hash_table_read_view_create(struct memtx_hash_table *table,
+				  struct memtx_hash_table_read_view *rv)
+{
+	if (table->is_swiss) {
+		swiss_index_read_view_create(&table->swiss, &rv->swiss);
+	} else {
+		light_index_iterator_begin(&table->light, &rv->light);
+		light_index_iterator_freeze(&table->light, &rv->light);
+	}
+}
+
+static inline struct tuple **
+memtx_hash_table_read_view_get_and_next(struct memtx_hash_table *table,
+					struct memtx_hash_table_read_view *rv)
+{
+	if (table->is_swiss)
+		return swiss_index_read_view_get_and_next(&rv->swiss);
+	return light_index_iterator_get_and_next(&table->light, &rv->light);
+}
+
+static inline void
+memtx_hash_table_read_view_destroy(struct memtx_hash_table *table,
+				   struct memtx_hash_table_read_view *rv)
+{
+	if (table->is_swiss)
+		swiss_index_read_view_destroy(&rv->swiss);
+	else
+		light_index_iterator_destroy(&table->light, &rv->light);
+}
+
+/* }}} */
+
 struct memtx_hash_index {
 	struct index base;
-	struct light_index_core hash_table;
+	struct memtx_hash_table hash_table;
 	struct memtx_gc_task gc_task;
-	struct light_index_iterator gc_iterator;
+	struct memtx_hash_table_iterator gc_iterator;
 };
 
 /* {{{ MemtxHash Iterators ****************************************/
 
 struct hash_iterator {
 	struct iterator base; /* Must be the first member. */
-	struct light_index_iterator iterator;
+	struct memtx_hash_table_iterator iterator;
 	/** Memory pool the iterator was allocated from. */
 	struct mempool *pool;
 };
@@ -108,8 +338,9 @@ hash_iterator_ge_base(struct iterator *ptr, struct tuple **ret)
 	assert(ptr->free == hash_iterator_free);
 	struct hash_iterator *it = (struct hash_iterator *) ptr;
 	struct memtx_hash_index *index = (struct memtx_hash_index *)ptr->index;
-	struct tuple **res = light_index_iterator_get_and_next(&index->hash_table,
-							       &it->iterator);
+	struct tuple **res =
+		memtx_hash_table_iterator_get_and_next(&index->hash_table,
+						       &it->iterator);
 	*ret = res != NULL ? *res : NULL;
 	return 0;
 }
@@ -121,11 +352,12 @@ hash_iterator_gt_base(struct iterator *ptr, struct tuple **ret)
 	ptr->next = hash_iterator_ge_base;
 	struct hash_iterator *it = (struct hash_iterator *) ptr;
 	struct memtx_hash_index *index = (struct memtx_hash_index *)ptr->index;
-	struct tuple **res = light_index_iterator_get_and_next(&index->hash_table,
-							       &it->iterator);
+	struct tuple **res =
+		memtx_hash_table_iterator_get_and_next(&index->hash_table,
+						       &it->iterator);
 	if (res != NULL)
-		res = light_index_iterator_get_and_next(&index->hash_table,
-							&it->iterator);
+		res = memtx_hash_table_iterator_get_and_next(&index->hash_table,
+							     &it->iterator);
 	*ret = res != NULL ? *res : NULL;
 	return 0;
 }
@@ -185,7 +417,7 @@ hash_iterator_eq(struct iterator *it, struct tuple **ret)
 static void
 memtx_hash_index_free(struct memtx_hash_index *index)
 {
-	light_index_destroy(&index->hash_table);
+	memtx_hash_table_destroy(&index->hash_table);
 	free(index);
 }
 
@@ -204,12 +436,13 @@ memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 
 	struct memtx_hash_index *index = container_of(task,
 			struct memtx_hash_index, gc_task);
-	struct light_index_core *hash = &index->hash_table;
-	struct light_index_iterator *itr = &index->gc_iterator;
+	struct memtx_hash_table *hash = &index->hash_table;
+	struct memtx_hash_table_iterator *itr = &index->gc_iterator;
 
 	struct tuple **res;
 	unsigned int loops = 0;
-	while ((res = light_index_iterator_get_and_next(hash, itr)) != NULL) {
+	while ((res = memtx_hash_table_iterator_get_and_next(hash,
+							     itr)) != NULL) {
 		tuple_unref(*res);
 		if (++loops >= YIELD_LOOPS) {
 			*done = false;
@@ -244,8 +477,8 @@ memtx_hash_index_destroy(struct index *base)
 		 * background task in order not to block tx thread.
 		 */
 		index->gc_task.vtab = &memtx_hash_index_gc_vtab;
-		light_index_iterator_begin(&index->hash_table,
-					   &index->gc_iterator);
+		memtx_hash_table_iterator_begin(&index->hash_table,
+						&index->gc_iterator);
 		memtx_engine_schedule_gc(memtx, &index->gc_task);
 	} else {
 		/*
@@ -260,21 +493,21 @@ static void
 memtx_hash_index_update_def(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	index->hash_table.arg = index->base.def->key_def;
+	memtx_hash_table_set_arg(&index->hash_table, index->base.def->key_def);
 }
 
 static ssize_t
 memtx_hash_index_size(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	return index->hash_table.count;
+	return memtx_hash_table_count(&index->hash_table);
 }
 
 static ssize_t
 memtx_hash_index_bsize(struct index *base)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	return matras_extent_count(&index->hash_table.mtable) *
+	return memtx_hash_table_extent_count(&index->hash_table) *
 					MEMTX_EXTENT_SIZE;
 }
 
@@ -282,17 +515,7 @@ static int
 memtx_hash_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
-
-	*result = NULL;
-	if (hash_table->count == 0)
-		return 0;
-	rnd %= (hash_table->table_size);
-	while (!light_index_pos_valid(hash_table, rnd)) {
-		rnd++;
-		rnd %= (hash_table->table_size);
-	}
-	*result = light_index_get(hash_table, rnd);
+	*result = memtx_hash_table_random(&index->hash_table, rnd);
 	return 0;
 }
 
@@ -318,9 +541,9 @@ memtx_hash_index_get(struct index *base, const char *key,
 	struct space *space = space_by_id(base->def->space_id);
 	*result = NULL;
 	uint32_t h = key_hash(key, base->def->key_def);
-	uint32_t k = light_index_find_key(&index->hash_table, h, key);
-	if (k != light_index_end) {
-		struct tuple *tuple = light_index_get(&index->hash_table, k);
+	struct tuple *tuple = memtx_hash_table_find_key(&index->hash_table,
+							h, key);
+	if (tuple != NULL) {
 		uint32_t iid = base->def->iid;
 		struct txn *txn = in_txn();
 		bool is_rw = txn != NULL;
@@ -336,34 +559,35 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple **result)
 {
 	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
+	struct memtx_hash_table *hash_table = &index->hash_table;
 
 	if (new_tuple) {
 		uint32_t h = tuple_hash(new_tuple, base->def->key_def);
 		struct tuple *dup_tuple = NULL;
-		uint32_t pos = light_index_replace(hash_table, h, new_tuple,
-						   &dup_tuple);
-		if (pos == light_index_end)
-			pos = light_index_insert(hash_table, h, new_tuple);
+		int rc = memtx_hash_table_replace(hash_table, h, new_tuple,
+						  &dup_tuple);
 
 		ERROR_INJECT(ERRINJ_INDEX_ALLOC,
 		{
-			light_index_delete(hash_table, pos);
-			pos = light_index_end;
+			memtx_hash_table_delete(hash_table, h, new_tuple);
+			rc = -1;
 		});
 
-		if (pos == light_index_end) {
-			diag_set(OutOfMemory, (ssize_t)hash_table->count,
+		if (rc != 0) {
+			diag_set(OutOfMemory,
+				 (ssize_t)memtx_hash_table_count(hash_table),
 				 "hash_table", "key");
 			return -1;
 		}
 		uint32_t errcode = replace_check_dup(old_tuple,
 						     dup_tuple, mode);
 		if (errcode) {
-			light_index_delete(hash_table, pos);
+			memtx_hash_table_delete(hash_table, h, new_tuple);
 			if (dup_tuple) {
-				uint32_t pos = light_index_insert(hash_table, h, dup_tuple);
-				if (pos == light_index_end) {
+				struct tuple *unused;
+				if (memtx_hash_table_replace(hash_table, h,
+							     dup_tuple,
+							     &unused) != 0) {
 					panic("Failed to allocate memory in "
 					      "recover of int hash_table");
 				}
@@ -383,7 +607,7 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 
 	if (old_tuple) {
 		uint32_t h = tuple_hash(old_tuple, base->def->key_def);
-		int res = light_index_delete_value(hash_table, h, old_tuple);
+		int res = memtx_hash_table_delete(hash_table, h, old_tuple);
 		assert(res == 0); (void) res;
 	}
 	*result = old_tuple;
@@ -408,26 +632,29 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	iterator_create(&it->base, base);
 	it->pool = &memtx->iterator_pool;
 	it->base.free = hash_iterator_free;
-	light_index_iterator_begin(&index->hash_table, &it->iterator);
+	memtx_hash_table_iterator_begin(&index->hash_table, &it->iterator);
 
 	switch (type) {
 	case ITER_GT:
 		if (part_count != 0) {
-			light_index_iterator_key(&index->hash_table, &it->iterator,
+			memtx_hash_table_iterator_key(&index->hash_table,
+					&it->iterator,
 					key_hash(key, base->def->key_def), key);
 			it->base.next = hash_iterator_gt;
 		} else {
-			light_index_iterator_begin(&index->hash_table, &it->iterator);
+			memtx_hash_table_iterator_begin(&index->hash_table,
+							&it->iterator);
 			it->base.next = hash_iterator_ge;
 		}
 		break;
 	case ITER_ALL:
-		light_index_iterator_begin(&index->hash_table, &it->iterator);
+		memtx_hash_table_iterator_begin(&index->hash_table,
+						&it->iterator);
 		it->base.next = hash_iterator_ge;
 		break;
 	case ITER_EQ:
 		assert(part_count > 0);
-		light_index_iterator_key(&index->hash_table, &it->iterator,
+		memtx_hash_table_iterator_key(&index->hash_table, &it->iterator,
 				key_hash(key, base->def->key_def), key);
 		it->base.next = hash_iterator_eq;
 		break;
@@ -443,7 +670,7 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 struct hash_snapshot_iterator {
 	struct snapshot_iterator base;
 	struct memtx_hash_index *index;
-	struct light_index_iterator iterator;
+	struct memtx_hash_table_read_view read_view;
 	struct memtx_tx_snapshot_cleaner cleaner;
 };
 
@@ -460,7 +687,8 @@ hash_snapshot_iterator_free(struct snapshot_iterator *iterator)
 		(struct hash_snapshot_iterator *) iterator;
 	memtx_leave_delayed_free_mode((struct memtx_engine *)
 				      it->index->base.engine);
-	light_index_iterator_destroy(&it->index->hash_table, &it->iterator);
+	memtx_hash_table_read_view_destroy(&it->index->hash_table,
+					   &it->read_view);
 	index_unref(&it->index->base);
 	memtx_tx_snapshot_cleaner_destroy(&it->cleaner);
 	free(iterator);
@@ -478,12 +706,12 @@ hash_snapshot_iterator_next(struct snapshot_iterator *iterator,
 	assert(iterator->free == hash_snapshot_iterator_free);
 	struct hash_snapshot_iterator *it =
 		(struct hash_snapshot_iterator *) iterator;
-	struct light_index_core *hash_table = &it->index->hash_table;
+	struct memtx_hash_table *hash_table = &it->index->hash_table;
 
 	while (true) {
 		struct tuple **res =
-			light_index_iterator_get_and_next(hash_table,
-			                                  &it->iterator);
+			memtx_hash_table_read_view_get_and_next(hash_table,
+							&it->read_view);
 		if (res == NULL) {
 			*data = NULL;
 			return 0;
@@ -521,8 +749,7 @@ memtx_hash_index_create_snapshot_iterator(struct index *base)
 	it->base.free = hash_snapshot_iterator_free;
 	it->index = index;
 	index_ref(base);
-	light_index_iterator_begin(&index->hash_table, &it->iterator);
-	light_index_iterator_freeze(&index->hash_table, &it->iterator);
+	memtx_hash_table_read_view_create(&index->hash_table, &it->read_view);
 	memtx_enter_delayed_free_mode((struct memtx_engine *)base->engine);
 	return (struct snapshot_iterator *) it;
 }
@@ -544,8 +771,11 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .random = */ memtx_hash_index_random,
 	/* .count = */ memtx_hash_index_count,
 	/* .get = */ memtx_hash_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_hash_index_replace,
 	/* .create_iterator = */ memtx_hash_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		memtx_hash_index_create_snapshot_iterator,
 	/* .stat = */ generic_index_stat,
@@ -573,9 +803,9 @@ memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
 		return NULL;
 	}
 
-	light_index_create(&index->hash_table, MEMTX_EXTENT_SIZE,
-			   memtx_index_extent_alloc, memtx_index_extent_free,
-			   memtx, index->base.def->key_def);
+	memtx_hash_table_create(&index->hash_table,
+				def->opts.layout == HASH_INDEX_LAYOUT_SWISS,
+				memtx, index->base.def->key_def);
 	return &index->base;
 }
 
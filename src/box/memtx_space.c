@@ -34,6 +34,7 @@
 #include "txn.h"
 #include "memtx_tx.h"
 #include "tuple.h"
+#include "tuple_compression.h"
 #include "xrow_update.h"
 #include "xrow.h"
 #include "memtx_hash.h"
@@ -405,9 +406,14 @@ memtx_space_execute_update(struct space *space, struct txn *txn,
 	uint32_t new_size = 0, bsize;
 	struct tuple_format *format = space->format;
 	const char *old_data = tuple_data_range(old_tuple, &bsize);
+	const char *old_data_end = old_data + bsize;
+	/* Update operations apply to the original field values. */
+	if (tuple_decompress_raw(tuple_format(old_tuple), &old_data,
+				 &old_data_end, &fiber()->gc) != 0)
+		return -1;
 	const char *new_data =
 		xrow_update_execute(request->tuple, request->tuple_end,
-				    old_data, old_data + bsize, format,
+				    old_data, old_data_end, format,
 				    &new_size, request->index_base, NULL);
 	if (new_data == NULL)
 		return -1;
@@ -491,6 +497,10 @@ memtx_space_execute_upsert(struct space *space, struct txn *txn,
 	} else {
 		uint32_t new_size = 0, bsize;
 		const char *old_data = tuple_data_range(old_tuple, &bsize);
+		const char *old_data_end = old_data + bsize;
+		if (tuple_decompress_raw(tuple_format(old_tuple), &old_data,
+					 &old_data_end, &fiber()->gc) != 0)
+			return -1;
 		/*
 		 * Update the tuple.
 		 * xrow_upsert_execute() fails on totally wrong
@@ -500,7 +510,7 @@ memtx_space_execute_upsert(struct space *space, struct txn *txn,
 		uint64_t column_mask = COLUMN_MASK_FULL;
 		const char *new_data =
 			xrow_upsert_execute(request->ops, request->ops_end,
-					    old_data, old_data + bsize,
+					    old_data, old_data_end,
 					    format, &new_size,
 					    request->index_base, false,
 					    &column_mask);
@@ -637,6 +647,13 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 			return -1;
 		}
 	}
+	if (index_def->type != HASH &&
+	    index_def->opts.layout != HASH_INDEX_LAYOUT_LIGHT) {
+		diag_set(ClientError, ER_MODIFY_INDEX,
+			 index_def->name, space_name(space),
+			 "layout is only supported by HASH index");
+		return -1;
+	}
 	switch (index_def->type) {
 	case HASH:
 		if (! index_def->opts.is_unique) {
@@ -659,7 +676,31 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 		}
 		break;
 	case TREE:
-		/* TREE index has no limitations. */
+		if (!index_def->opts.normalized_keys)
+			break;
+		if (key_def->is_multikey || key_def->for_func_index) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "multikey and functional index can't use "
+				 "normalized keys");
+			return -1;
+		}
+		if (!index_def->opts.hint) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 "normalized keys can't be used without hints");
+			return -1;
+		}
+		enum field_type type =
+			key_def_unnormalizable_type(index_def->cmp_def);
+		if (type != field_type_MAX) {
+			diag_set(ClientError, ER_MODIFY_INDEX,
+				 index_def->name, space_name(space),
+				 tt_sprintf("normalized keys are not supported "
+					    "for field type '%s'",
+					    field_type_strs[type]));
+			return -1;
+		}
 		break;
 	case RTREE:
 		if (key_def->part_count != 1) {
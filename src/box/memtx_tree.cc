@@ -117,6 +117,7 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 			       (b)->part_count, (b)->hint, arg)
 #define BPS_TREE_IS_IDENTICAL(a, b) memtx_tree_data_is_equal(&a, &b)
 #define BPS_TREE_NO_DEBUG 1
+#define BPS_INNER_CHILD_CARDS
 #define bps_tree_arg_t struct key_def *
 
 #define BPS_TREE_NAMESPACE NS_NO_HINT
@@ -132,12 +133,25 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #define BPS_TREE_NAMESPACE NS_USE_HINT
 #define bps_tree_elem_t struct memtx_tree_data<true>
 #define bps_tree_key_t struct memtx_tree_key_data<true> *
+/*
+ * Hints of multikey and functional indexes and normalized keys
+ * don't follow the order of tuples, see key_def_set_hint_func().
+ */
+#define BPS_TREE_ELEM_HINT(elem) ((elem).hint)
+#define BPS_TREE_KEY_HINT(key) ((key)->hint)
+#define BPS_TREE_HINT_NONE HINT_NONE
+#define BPS_TREE_HINT_IS_ORDERED(arg)\
+	(!(arg)->is_multikey && !(arg)->for_func_index && !(arg)->is_normalized)
 
 #include "salad/bps_tree.h"
 
 #undef BPS_TREE_NAMESPACE
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
+#undef BPS_TREE_ELEM_HINT
+#undef BPS_TREE_KEY_HINT
+#undef BPS_TREE_HINT_NONE
+#undef BPS_TREE_HINT_IS_ORDERED
 
 #undef BPS_TREE_NAME
 #undef BPS_TREE_BLOCK_SIZE
@@ -146,6 +160,7 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #undef BPS_TREE_COMPARE_KEY
 #undef BPS_TREE_IS_IDENTICAL
 #undef BPS_TREE_NO_DEBUG
+#undef BPS_INNER_CHILD_CARDS
 #undef bps_tree_arg_t
 
 using namespace NS_NO_HINT;
@@ -197,6 +212,17 @@ struct memtx_tree_index {
 	memtx_tree_t<USE_HINT> tree;
 	struct memtx_tree_data<USE_HINT> *build_array;
 	size_t build_array_size, build_array_alloc_size;
+	/**
+	 * Set if build_array has been sorted by
+	 * memtx_tree_index_sort_build_array().
+	 */
+	bool build_array_is_sorted;
+	/**
+	 * Set if elements own normalized keys stored in hints.
+	 * Cached here, because the index definition is gone by
+	 * the time the background garbage collection runs.
+	 */
+	bool is_normalized;
 	struct memtx_gc_task gc_task;
 	memtx_tree_iterator_t<USE_HINT> gc_iterator;
 };
@@ -223,12 +249,45 @@ memtx_tree_qcompare(const void* a, const void *b, void *c)
 			     data_b->hint, key_def);
 }
 
+/**
+ * Build a normalized key of a tuple in the engine memory and
+ * return it as the tuple comparison hint, see key_def_set_normalized().
+ */
+static int
+memtx_tree_normalized_key_new(struct tuple *tuple, struct key_def *cmp_def,
+			      hint_t *hint)
+{
+	assert(cmp_def->is_normalized);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t size;
+	const char *key = tuple_normalized_key(tuple, cmp_def, region, &size);
+	if (key != NULL)
+		key = tuple_chunk_new(tuple, key, size);
+	region_truncate(region, region_svp);
+	if (key == NULL)
+		return -1;
+	*hint = (hint_t)key;
+	return 0;
+}
+
+/** Free the normalized key of a tree element, if any. */
+template <bool USE_HINT>
+static inline void
+memtx_tree_normalized_key_delete(const struct memtx_tree_data<USE_HINT> *data)
+{
+	if (USE_HINT && data->hint != HINT_NONE)
+		tuple_chunk_delete(data->tuple, (const char *)data->hint);
+}
+
 /* {{{ MemtxTree Iterators ****************************************/
 template <bool USE_HINT>
 struct tree_iterator {
 	struct iterator base;
 	memtx_tree_iterator_t<USE_HINT> tree_iterator;
 	enum iterator_type type;
+	/** Number of tuples to skip on the first iteration. */
+	uint32_t offset;
 	struct memtx_tree_key_data<USE_HINT> key_data;
 	struct memtx_tree_data<USE_HINT> current;
 	/** Memory pool the iterator was allocated from. */
@@ -254,6 +313,22 @@ get_tree_iterator(struct iterator *it)
 	return (struct tree_iterator<USE_HINT> *) it;
 }
 
+/**
+ * Return the last element returned by an iterator to look up its
+ * position in the tree by. Normalized keys of tuples deleted from
+ * the tree are freed, so tuples are compared field by field.
+ */
+template <bool USE_HINT>
+static inline struct memtx_tree_data<USE_HINT>
+tree_iterator_current(struct tree_iterator<USE_HINT> *it,
+		      memtx_tree_t<USE_HINT> *tree)
+{
+	struct memtx_tree_data<USE_HINT> current = it->current;
+	if (USE_HINT && memtx_tree_cmp_def(tree)->is_normalized)
+		current.set_hint(HINT_NONE);
+	return current;
+}
+
 template <bool USE_HINT>
 static void
 tree_iterator_free(struct iterator *iterator)
@@ -285,7 +360,7 @@ tree_iterator_next_base(struct iterator *iterator, struct tuple **ret)
 		memtx_tree_iterator_get_elem(&index->tree, &it->tree_iterator);
 	if (check == NULL || !memtx_tree_data_is_equal(check, &it->current)) {
 		it->tree_iterator = memtx_tree_upper_bound_elem(&index->tree,
-								it->current, NULL);
+				tree_iterator_current(it, &index->tree), NULL);
 	} else {
 		memtx_tree_iterator_next(&index->tree, &it->tree_iterator);
 	}
@@ -316,7 +391,7 @@ tree_iterator_prev_base(struct iterator *iterator, struct tuple **ret)
 		memtx_tree_iterator_get_elem(&index->tree, &it->tree_iterator);
 	if (check == NULL || !memtx_tree_data_is_equal(check, &it->current)) {
 		it->tree_iterator = memtx_tree_lower_bound_elem(&index->tree,
-								it->current, NULL);
+				tree_iterator_current(it, &index->tree), NULL);
 	}
 	memtx_tree_iterator_prev(&index->tree, &it->tree_iterator);
 	tuple_unref(it->current.tuple);
@@ -346,7 +421,7 @@ tree_iterator_next_equal_base(struct iterator *iterator, struct tuple **ret)
 		memtx_tree_iterator_get_elem(&index->tree, &it->tree_iterator);
 	if (check == NULL || !memtx_tree_data_is_equal(check, &it->current)) {
 		it->tree_iterator = memtx_tree_upper_bound_elem(&index->tree,
-								it->current, NULL);
+				tree_iterator_current(it, &index->tree), NULL);
 	} else {
 		memtx_tree_iterator_next(&index->tree, &it->tree_iterator);
 	}
@@ -383,7 +458,7 @@ tree_iterator_prev_equal_base(struct iterator *iterator, struct tuple **ret)
 		memtx_tree_iterator_get_elem(&index->tree, &it->tree_iterator);
 	if (check == NULL || !memtx_tree_data_is_equal(check, &it->current)) {
 		it->tree_iterator = memtx_tree_lower_bound_elem(&index->tree,
-								it->current, NULL);
+				tree_iterator_current(it, &index->tree), NULL);
 	}
 	memtx_tree_iterator_prev(&index->tree, &it->tree_iterator);
 	tuple_unref(it->current.tuple);
@@ -479,6 +554,59 @@ tree_iterator_set_next_method(struct tree_iterator<USE_HINT> *it)
 	}
 }
 
+/**
+ * Position the iterator it->offset tuples past the first one
+ * matching the search criteria. Uses the subtree cardinalities
+ * kept in the tree, so the cost does not depend on the offset.
+ * Returns false if there is no tuple to position to.
+ */
+template <bool USE_HINT>
+static bool
+tree_iterator_start_at_offset(struct tree_iterator<USE_HINT> *it,
+			      memtx_tree_t<USE_HINT> *tree)
+{
+	enum iterator_type type = it->type;
+	size_t size = memtx_tree_size(tree);
+	size_t pos;
+	bool exact = false;
+	if (it->key_data.key == 0) {
+		pos = iterator_type_is_reverse(type) ? size : 0;
+	} else if (type == ITER_ALL || type == ITER_EQ ||
+		   type == ITER_GE || type == ITER_LT) {
+		memtx_tree_lower_bound_get_offset(tree, &it->key_data,
+						  &exact, &pos);
+		if (type == ITER_EQ && !exact)
+			return false;
+	} else { // ITER_GT, ITER_REQ, ITER_LE
+		memtx_tree_upper_bound_get_offset(tree, &it->key_data,
+						  &exact, &pos);
+		if (type == ITER_REQ && !exact)
+			return false;
+	}
+	if (iterator_type_is_reverse(type)) {
+		/* See the comment in tree_iterator_start(). */
+		if (pos <= it->offset)
+			return false;
+		pos -= it->offset + 1;
+	} else {
+		pos += it->offset;
+		if (pos >= size)
+			return false;
+	}
+	it->tree_iterator = memtx_tree_iterator_at(tree, pos);
+	if (type == ITER_EQ || type == ITER_REQ) {
+		struct memtx_tree_data<USE_HINT> *res =
+			memtx_tree_iterator_get_elem(tree, &it->tree_iterator);
+		if (tuple_compare_with_key(res->tuple, res->hint,
+					   it->key_data.key,
+					   it->key_data.part_count,
+					   it->key_data.hint,
+					   memtx_tree_cmp_def(tree)) != 0)
+			return false;
+	}
+	return true;
+}
+
 template <bool USE_HINT>
 static int
 tree_iterator_start(struct iterator *iterator, struct tuple **ret)
@@ -492,7 +620,10 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	enum iterator_type type = it->type;
 	bool exact = false;
 	assert(it->current.tuple == NULL);
-	if (it->key_data.key == 0) {
+	if (it->offset != 0) {
+		if (!tree_iterator_start_at_offset(it, tree))
+			return 0;
+	} else if (it->key_data.key == 0) {
 		if (iterator_type_is_reverse(it->type))
 			it->tree_iterator = memtx_tree_iterator_last(tree);
 		else
@@ -563,6 +694,11 @@ template <bool USE_HINT>
 static void
 memtx_tree_index_free(struct memtx_tree_index<USE_HINT> *index)
 {
+	if (index->is_normalized) {
+		/* The build was aborted. */
+		for (size_t i = 0; i < index->build_array_size; i++)
+			memtx_tree_normalized_key_delete(&index->build_array[i]);
+	}
 	memtx_tree_destroy(&index->tree);
 	free(index->build_array);
 	free(index);
@@ -592,6 +728,8 @@ memtx_tree_index_gc_run(struct memtx_gc_task *task, bool *done)
 		struct memtx_tree_data<USE_HINT> *res =
 			memtx_tree_iterator_get_elem(tree, itr);
 		memtx_tree_iterator_next(tree, itr);
+		if (index->is_normalized)
+			memtx_tree_normalized_key_delete(res);
 		tuple_unref(res->tuple);
 		if (++loops >= YIELD_LOOPS) {
 			*done = false;
@@ -642,6 +780,17 @@ memtx_tree_index_destroy(struct index *base)
 		 * Secondary index. Destruction is fast, no need to
 		 * hand over to background fiber.
 		 */
+		memtx_tree_t<USE_HINT> *tree = &index->tree;
+		if (index->is_normalized) {
+			memtx_tree_iterator_t<USE_HINT> itr =
+				memtx_tree_iterator_first(tree);
+			struct memtx_tree_data<USE_HINT> *res;
+			while ((res = memtx_tree_iterator_get_elem(tree,
+							&itr)) != NULL) {
+				memtx_tree_normalized_key_delete(res);
+				memtx_tree_iterator_next(tree, &itr);
+			}
+		}
 		memtx_tree_index_free(index);
 	}
 }
@@ -659,6 +808,10 @@ memtx_tree_index_update_def(struct index *base)
 	 * NULLs. To correctly compare these NULLs extended key
 	 * def must be used. For details @sa tuple_compare.cc.
 	 */
+	if (def->opts.normalized_keys) {
+		key_def_set_normalized(def->key_def);
+		key_def_set_normalized(def->cmp_def);
+	}
 	index->tree.arg = def->opts.is_unique && !def->key_def->is_nullable ?
 						def->key_def : def->cmp_def;
 }
@@ -707,7 +860,48 @@ memtx_tree_index_count(struct index *base, enum iterator_type type,
 {
 	if (type == ITER_ALL)
 		return memtx_tree_index_size<USE_HINT>(base); /* optimization */
-	return generic_index_count(base, type, key, part_count);
+	/*
+	 * With MVCC some of the tuples stored in the tree may be
+	 * invisible to the current transaction, so they have to
+	 * be checked one by one.
+	 */
+	if (memtx_tx_manager_use_mvcc_engine || type > ITER_GT)
+		return generic_index_count(base, type, key, part_count);
+	if (part_count == 0)
+		return memtx_tree_index_size<USE_HINT>(base);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT)
+		key_data.set_hint(key_hint(key, part_count, cmp_def));
+	size_t size = memtx_tree_size(&index->tree);
+	size_t lower = 0, upper = 0;
+	bool exact;
+	if (type != ITER_GT && type != ITER_LE)
+		memtx_tree_lower_bound_get_offset(&index->tree, &key_data,
+						  &exact, &lower);
+	if (type != ITER_GE && type != ITER_LT)
+		memtx_tree_upper_bound_get_offset(&index->tree, &key_data,
+						  &exact, &upper);
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		return upper - lower;
+	case ITER_GE:
+		return size - lower;
+	case ITER_GT:
+		return size - upper;
+	case ITER_LT:
+		return lower;
+	case ITER_LE:
+		return upper;
+	default:
+		unreachable();
+	}
+	return 0;
 }
 
 template <bool USE_HINT>
@@ -795,6 +989,76 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 	return 0;
 }
 
+/**
+ * :replace() function for an index with normalized keys, see
+ * memtx_tree_index_replace(). A normalized key is built for each
+ * tuple inserted into the index and freed when the tuple is
+ * deleted from it.
+ */
+static int
+memtx_tree_normalized_index_replace(struct index *base,
+				    struct tuple *old_tuple,
+				    struct tuple *new_tuple,
+				    enum dup_replace_mode mode,
+				    struct tuple **result)
+{
+	struct memtx_tree_index<true> *index =
+		(struct memtx_tree_index<true> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	if (new_tuple != NULL) {
+		struct memtx_tree_data<true> new_data;
+		new_data.tuple = new_tuple;
+		if (memtx_tree_normalized_key_new(new_tuple, cmp_def,
+						  &new_data.hint) != 0)
+			return -1;
+		struct memtx_tree_data<true> dup_data;
+		dup_data.tuple = NULL;
+
+		/* Try to optimistically replace the new_tuple. */
+		if (memtx_tree_insert(&index->tree, new_data, &dup_data) != 0) {
+			memtx_tree_normalized_key_delete(&new_data);
+			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
+				 "memtx_tree_index", "replace");
+			return -1;
+		}
+
+		uint32_t errcode = replace_check_dup(old_tuple,
+						     dup_data.tuple, mode);
+		if (errcode) {
+			memtx_tree_delete(&index->tree, new_data);
+			memtx_tree_normalized_key_delete(&new_data);
+			if (dup_data.tuple != NULL)
+				memtx_tree_insert(&index->tree, dup_data, NULL);
+			struct space *sp = space_cache_find(base->def->space_id);
+			if (sp != NULL)
+				diag_set(ClientError, errcode, base->def->name,
+					 space_name(sp));
+			return -1;
+		}
+		if (dup_data.tuple != NULL) {
+			memtx_tree_normalized_key_delete(&dup_data);
+			*result = dup_data.tuple;
+			return 0;
+		}
+	}
+	if (old_tuple != NULL) {
+		/*
+		 * There's no need to build the normalized key of
+		 * the old tuple to find it, without a key it's
+		 * compared field by field.
+		 */
+		struct memtx_tree_data<true> old_data, deleted_data;
+		old_data.tuple = old_tuple;
+		old_data.hint = HINT_NONE;
+		deleted_data.tuple = NULL;
+		memtx_tree_delete_value(&index->tree, old_data, &deleted_data);
+		if (deleted_data.tuple != NULL)
+			memtx_tree_normalized_key_delete(&deleted_data);
+	}
+	*result = old_tuple;
+	return 0;
+}
+
 /**
  * Perform tuple insertion by given multikey index.
  * In case of replacement, all old tuple entries are deleted
@@ -1220,9 +1484,33 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 		it->key_data.set_hint(key_hint(key, part_count, cmp_def));
 	invalidate_tree_iterator(&it->tree_iterator);
 	it->current.tuple = NULL;
+	it->offset = 0;
 	return (struct iterator *)it;
 }
 
+template <bool USE_HINT>
+static struct iterator *
+memtx_tree_index_create_iterator_with_offset(struct index *base,
+					     enum iterator_type type,
+					     const char *key,
+					     uint32_t part_count,
+					     uint32_t offset)
+{
+	/*
+	 * With MVCC the tree may contain tuples invisible to
+	 * the current transaction, they must not be counted.
+	 */
+	if (memtx_tx_manager_use_mvcc_engine)
+		return generic_index_create_iterator_with_offset(base, type,
+				key, part_count, offset);
+	struct iterator *it = memtx_tree_index_create_iterator<USE_HINT>(base,
+				type, key, part_count);
+	if (it == NULL)
+		return NULL;
+	get_tree_iterator<USE_HINT>(it)->offset = offset;
+	return it;
+}
+
 template <bool USE_HINT>
 static void
 memtx_tree_index_begin_build(struct index *base)
@@ -1319,6 +1607,22 @@ memtx_tree_index_build_next_multikey(struct index *base, struct tuple *tuple)
 	return 0;
 }
 
+static int
+memtx_tree_normalized_index_build_next(struct index *base, struct tuple *tuple)
+{
+	struct memtx_tree_index<true> *index =
+		(struct memtx_tree_index<true> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	hint_t hint;
+	if (memtx_tree_normalized_key_new(tuple, cmp_def, &hint) != 0)
+		return -1;
+	if (memtx_tree_index_build_array_append(index, tuple, hint) != 0) {
+		tuple_chunk_delete(tuple, (const char *)hint);
+		return -1;
+	}
+	return 0;
+}
+
 static int
 memtx_tree_func_index_build_next(struct index *base, struct tuple *tuple)
 {
@@ -1401,9 +1705,11 @@ memtx_tree_index_end_build(struct index *base)
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
-	qsort_arg(index->build_array, index->build_array_size,
-		  sizeof(index->build_array[0]),
-		  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	if (!index->build_array_is_sorted) {
+		qsort_arg(index->build_array, index->build_array_size,
+			  sizeof(index->build_array[0]),
+			  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	}
 	if (cmp_def->is_multikey) {
 		/*
 		 * Multikey index may have equal(in terms of
@@ -1424,6 +1730,20 @@ memtx_tree_index_end_build(struct index *base)
 	index->build_array = NULL;
 	index->build_array_size = 0;
 	index->build_array_alloc_size = 0;
+	index->build_array_is_sorted = false;
+}
+
+template <bool USE_HINT>
+static void
+memtx_tree_index_sort_build_array_tpl(struct index *base)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	qsort_arg_st(index->build_array, index->build_array_size,
+		     sizeof(index->build_array[0]),
+		     memtx_tree_qcompare<USE_HINT>, cmp_def);
+	index->build_array_is_sorted = true;
 }
 
 template <bool USE_HINT>
@@ -1537,8 +1857,11 @@ static const struct index_vtab memtx_tree_no_hint_index_vtab = {
 	/* .random = */ memtx_tree_index_random<false>,
 	/* .count = */ memtx_tree_index_count<false>,
 	/* .get = */ memtx_tree_index_get<false>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace<false>,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<false>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<false>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<false>,
 	/* .stat = */ generic_index_stat,
@@ -1567,8 +1890,11 @@ static const struct index_vtab memtx_tree_use_hint_index_vtab = {
 	/* .random = */ memtx_tree_index_random<true>,
 	/* .count = */ memtx_tree_index_count<true>,
 	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace<true>,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<true>,
 	/* .stat = */ generic_index_stat,
@@ -1580,6 +1906,39 @@ static const struct index_vtab memtx_tree_use_hint_index_vtab = {
 	/* .end_build = */ memtx_tree_index_end_build<true>,
 };
 
+static const struct index_vtab memtx_tree_normalized_index_vtab = {
+	/* .destroy = */ memtx_tree_index_destroy<true>,
+	/* .commit_create = */ generic_index_commit_create,
+	/* .abort_create = */ generic_index_abort_create,
+	/* .commit_modify = */ generic_index_commit_modify,
+	/* .commit_drop = */ generic_index_commit_drop,
+	/* .update_def = */ memtx_tree_index_update_def<true>,
+	/* .depends_on_pk = */ memtx_tree_index_depends_on_pk,
+	/* .def_change_requires_rebuild = */
+		memtx_index_def_change_requires_rebuild,
+	/* .size = */ memtx_tree_index_size<true>,
+	/* .bsize = */ memtx_tree_index_bsize<true>,
+	/* .min = */ generic_index_min,
+	/* .max = */ generic_index_max,
+	/* .random = */ memtx_tree_index_random<true>,
+	/* .count = */ memtx_tree_index_count<true>,
+	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
+	/* .replace = */ memtx_tree_normalized_index_replace,
+	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
+	/* .create_snapshot_iterator = */
+		memtx_tree_index_create_snapshot_iterator<true>,
+	/* .stat = */ generic_index_stat,
+	/* .compact = */ generic_index_compact,
+	/* .reset_stat = */ generic_index_reset_stat,
+	/* .begin_build = */ memtx_tree_index_begin_build<true>,
+	/* .reserve = */ memtx_tree_index_reserve<true>,
+	/* .build_next = */ memtx_tree_normalized_index_build_next,
+	/* .end_build = */ memtx_tree_index_end_build<true>,
+};
+
 static const struct index_vtab memtx_tree_index_multikey_vtab = {
 	/* .destroy = */ memtx_tree_index_destroy<true>,
 	/* .commit_create = */ generic_index_commit_create,
@@ -1597,8 +1956,11 @@ static const struct index_vtab memtx_tree_index_multikey_vtab = {
 	/* .random = */ memtx_tree_index_random<true>,
 	/* .count = */ memtx_tree_index_count<true>,
 	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace_multikey,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<true>,
 	/* .stat = */ generic_index_stat,
@@ -1627,8 +1989,11 @@ static const struct index_vtab memtx_tree_func_index_vtab = {
 	/* .random = */ memtx_tree_index_random<true>,
 	/* .count = */ memtx_tree_index_count<true>,
 	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_func_index_replace,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<true>,
 	/* .stat = */ generic_index_stat,
@@ -1663,8 +2028,11 @@ static const struct index_vtab memtx_tree_disabled_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ generic_index_count,
 	/* .get = */ generic_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ disabled_index_replace,
 	/* .create_iterator = */ generic_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		generic_index_create_snapshot_iterator,
 	/* .stat = */ generic_index_stat,
@@ -1695,6 +2063,12 @@ memtx_tree_index_new_tpl(struct memtx_engine *memtx, struct index_def *def,
 		return NULL;
 	}
 
+	if (def->opts.normalized_keys) {
+		assert(USE_HINT);
+		key_def_set_normalized(index->base.def->key_def);
+		key_def_set_normalized(index->base.def->cmp_def);
+		index->is_normalized = true;
+	}
 	/* See comment to memtx_tree_index_update_def(). */
 	struct key_def *cmp_def;
 	cmp_def = def->opts.is_unique && !def->key_def->is_nullable ?
@@ -1705,6 +2079,15 @@ memtx_tree_index_new_tpl(struct memtx_engine *memtx, struct index_def *def,
 	return &index->base;
 }
 
+void
+memtx_tree_index_sort_build_array(struct index *index)
+{
+	if (index->vtab == &memtx_tree_no_hint_index_vtab)
+		memtx_tree_index_sort_build_array_tpl<false>(index);
+	else
+		memtx_tree_index_sort_build_array_tpl<true>(index);
+}
+
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 {
@@ -1716,6 +2099,8 @@ memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 			vtab = &memtx_tree_func_index_vtab;
 	} else if (def->key_def->is_multikey) {
 		vtab = &memtx_tree_index_multikey_vtab;
+	} else if (def->opts.normalized_keys) {
+		vtab = &memtx_tree_normalized_index_vtab;
 	} else if (def->opts.hint) {
 		vtab = &memtx_tree_use_hint_index_vtab;
 	} else {
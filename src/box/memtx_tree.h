@@ -42,6 +42,17 @@ struct memtx_engine;
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Sort the keys added to a tree index with index_build_next()
+ * so that index_end_build() doesn't have to. Accesses nothing
+ * but the keys and the tuples they point to, hence may be called
+ * from a thread other than tx while the index is being built.
+ * The keys are sorted in the calling thread only, because the
+ * callers already sort several indexes in parallel.
+ */
+void
+memtx_tree_index_sort_build_array(struct index *index);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -364,6 +364,23 @@ recovery_finalize(struct recovery *r)
 	recovery_close_log(r);
 }
 
+void
+recovery_skip_log(struct recovery *r)
+{
+	if (xlog_cursor_is_open(&r->cursor)) {
+		say_info("done `%s'", r->cursor.name);
+		xlog_cursor_close(&r->cursor, false);
+	}
+	/*
+	 * The rows of the WALs following the closed one might
+	 * have been skipped as well so the next WAL must be
+	 * looked up by the recovery vclock as if it were the
+	 * first WAL to recover from, see recovery_open_log().
+	 */
+	r->cursor.state = XLOG_CURSOR_NEW;
+	trigger_run_xc(&r->on_close_log, NULL);
+}
+
 
 /* }}} */
 
@@ -86,6 +86,16 @@ recovery_stop_local(struct recovery *r);
 void
 recovery_finalize(struct recovery *r);
 
+/**
+ * Close the current WAL, if any, without reading it till
+ * the end. Used by a replication relay that receives rows
+ * bypassing WAL files once it learns that the WAL has been
+ * rotated: the recovery vclock must include all rows of the
+ * WAL by that time.
+ */
+void
+recovery_skip_log(struct recovery *r);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
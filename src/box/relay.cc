@@ -54,6 +54,12 @@
 #include "wal.h"
 #include "txn_limbo.h"
 #include "raft.h"
+#include "small/ibuf.h"
+
+enum {
+	/** Max size of a chunk of rows read from the WAL memory ring. */
+	RELAY_RING_READ_SIZE = 128 * 1024,
+};
 
 /**
  * Cbus message to send status updates from relay to tx thread.
@@ -102,6 +108,16 @@ struct relay {
 	struct replica *replica;
 	/** WAL event watcher. */
 	struct wal_watcher wal_watcher;
+	/**
+	 * Set if the relay has caught up with WAL and reads
+	 * new rows from the WAL memory ring rather than from
+	 * xlog files.
+	 */
+	bool is_ring_reader;
+	/** Position of the next record to read from the WAL ring. */
+	uint64_t ring_pos;
+	/** Buffer for records read from the WAL ring. */
+	struct ibuf ring_buf;
 	/** Relay reader cond. */
 	struct fiber_cond reader_cond;
 	/** Relay diagnostics. */
@@ -506,6 +522,74 @@ relay_set_error(struct relay *relay, struct error *e)
 		diag_set_error(&relay->diag, e);
 }
 
+/**
+ * Send rows from the WAL memory ring until there are no more
+ * rows in it. Returns false if the relay has fallen behind the
+ * ring and has to read xlog files.
+ */
+static bool
+relay_recover_ring(struct relay *relay)
+{
+	struct recovery *r = relay->r;
+	while (true) {
+		ibuf_reset(&relay->ring_buf);
+		ssize_t size = wal_ring_read(&relay->ring_pos,
+					     &relay->ring_buf,
+					     RELAY_RING_READ_SIZE);
+		if (size < 0) {
+			if (!diag_is_empty(diag_get()))
+				diag_log();
+			return false;
+		}
+		if (size == 0)
+			return true;
+		const char *data = relay->ring_buf.rpos;
+		const char *end = data + size;
+		while (data < end) {
+			struct wal_ring_rec rec;
+			memcpy(&rec, data, sizeof(rec));
+			data += sizeof(rec);
+			if (rec.size == 0) {
+				/* WAL was rotated. */
+				recovery_skip_log(r);
+				continue;
+			}
+			struct xrow_header row;
+			const char *pos = data;
+			data += rec.size;
+			xrow_header_decode_xc(&row, &pos, data, true);
+			if (row.lsn <= vclock_get(&r->vclock, row.replica_id))
+				continue;
+			vclock_follow_xrow(&r->vclock, &row);
+			xstream_write_xc(&relay->stream, &row);
+		}
+	}
+}
+
+/**
+ * Send rows written to WAL since the last call. Rows are read
+ * from the WAL memory ring if the relay has caught up with WAL,
+ * otherwise from xlog files.
+ */
+static void
+relay_recover_wals(struct relay *relay, bool scan_dir)
+{
+	if (relay->is_ring_reader) {
+		if (relay_recover_ring(relay))
+			return;
+		/* Rows were evicted before we read them. */
+		relay->is_ring_reader = false;
+		scan_dir = true;
+	}
+	recover_remaining_wals(relay->r, &relay->stream, NULL, scan_dir);
+	/*
+	 * Try to switch to the ring. If rows get evicted before
+	 * we read them, we'll retry on the next WAL event.
+	 */
+	if (wal_ring_seek(&relay->r->vclock, &relay->ring_pos) == 0)
+		relay->is_ring_reader = relay_recover_ring(relay);
+}
+
 static void
 relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 {
@@ -523,8 +607,7 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		return;
 	}
 	try {
-		recover_remaining_wals(relay->r, &relay->stream, NULL,
-				       (events & WAL_EVENT_ROTATE) != 0);
+		relay_recover_wals(relay, (events & WAL_EVENT_ROTATE) != 0);
 	} catch (Exception *e) {
 		relay_set_error(relay, e);
 		fiber_cancel(fiber());
@@ -671,6 +754,9 @@ relay_subscribe_f(va_list ap)
 	if (!relay->replica->anon)
 		relay_send_is_raft_enabled(relay, &raft_enabler, true);
 
+	relay->is_ring_reader = false;
+	ibuf_create(&relay->ring_buf, &cord()->slabc, RELAY_RING_READ_SIZE);
+
 	/*
 	 * Setup garbage collection trigger.
 	 * Not needed for anonymous replicas, since they
@@ -779,6 +865,7 @@ relay_subscribe_f(va_list ap)
 		    NULL, NULL, cbus_process);
 	cbus_endpoint_destroy(&relay->endpoint, cbus_process);
 
+	ibuf_destroy(&relay->ring_buf);
 	relay_exit(relay);
 	return -1;
 }
@@ -886,7 +973,8 @@ relay_restart_recovery(struct relay *relay)
 	rlist_swap(&relay->r->on_close_log, &r->on_close_log);
 	recovery_delete(relay->r);
 	relay->r = r;
-	recover_remaining_wals(relay->r, &relay->stream, NULL, true);
+	relay->is_ring_reader = false;
+	relay_recover_wals(relay, true);
 }
 
 struct relay_raft_msg {
@@ -0,0 +1,583 @@
+/*
+ * Copyright 2010-2020, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "snap_reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pmatomic.h>
+
+#include "cbus.h"
+#include "diag.h"
+#include "error.h"
+#include "fiber.h"
+#include "say.h"
+#include "trivia/util.h"
+#include "xlog.h"
+#include "xrow.h"
+
+enum {
+	/**
+	 * Max number of tx blocks that have been read from the
+	 * file, but haven't been consumed yet.
+	 */
+	SNAP_READER_WINDOW = 64,
+	/** Initial size of the array of rows decoded from a block. */
+	SNAP_BLOCK_ROWS_MIN = 64,
+};
+
+/** A thread decompressing tx blocks and decoding rows. */
+struct snap_decoder {
+	struct cord cord;
+	/** Pipe from the reader thread to the decoder. */
+	struct cpipe decoder_pipe;
+	/** Pipe from the decoder to the consumer thread. */
+	struct cpipe tx_pipe;
+	/** Decompression context, used only by the decoder thread. */
+	ZSTD_DStream *zdctx;
+	/** Route of a tx block. */
+	struct cmsg_hop route[2];
+};
+
+/**
+ * A tx block going from the reader thread through a decoder
+ * to the consumer thread and back to the reader thread.
+ */
+struct snap_block {
+	struct cmsg base;
+	struct snap_reader *reader;
+	/** Decoder thread the block was sent to. */
+	struct snap_decoder *decoder;
+	/** Sequence number of the block in the file. */
+	int64_t seq;
+	/** Raw block data read from the file, freed once decoded. */
+	char *raw;
+	/** Size of the raw block data. */
+	size_t raw_size;
+	/**
+	 * Dictionary to decompress the block with. Owned by
+	 * the message if it is the last one, see @is_last.
+	 */
+	struct xlog_zdict *zdict;
+	/** Decompressed rows, referenced by @rows. */
+	char *data;
+	/** Decoded rows. */
+	struct xrow_header *rows;
+	/** Number of decoded rows. */
+	int row_count;
+	/**
+	 * 0 if the block was read and decoded successfully,
+	 * -1 otherwise, in which case the error is in @diag.
+	 */
+	int rc;
+	/** Error that occurred while reading or decoding the block. */
+	struct diag diag;
+	/**
+	 * Set for the last message sent by the reader thread.
+	 * It carries no rows, only the result of reading the
+	 * file and the file dictionary.
+	 */
+	bool is_last;
+	/** Set in the last message if the eof marker was read. */
+	bool is_eof;
+	/** Number of part files, set in the last message. */
+	uint32_t part_count;
+};
+
+struct snap_reader {
+	/** Path to the snapshot file. */
+	char *filename;
+	/** Reader thread. */
+	struct cord cord;
+	/** Decoder threads. */
+	struct snap_decoder *decoders;
+	/** Number of decoder threads. */
+	int decoder_count;
+	/** Set by the consumer to stop reading. Accessed atomically. */
+	bool is_cancelled;
+	/*
+	 * Members used only by the reader thread.
+	 */
+	/** Index of the decoder to send the next block to. */
+	int next_decoder;
+	/** Number of blocks sent and not released yet. */
+	int in_flight;
+	/** Preallocated last message, see snap_block::is_last. */
+	struct snap_block *last;
+	/*
+	 * Members used only by the consumer thread.
+	 */
+	/** Endpoint receiving decoded blocks. */
+	struct cbus_endpoint endpoint;
+	/** Pipe returning consumed blocks to the reader thread. */
+	struct cpipe reader_pipe;
+	/** Decoded blocks that arrived out of order. */
+	struct snap_block *window[SNAP_READER_WINDOW];
+	/** Sequence number of the next block to consume. */
+	int64_t next_seq;
+	/** Block rows are currently returned from. */
+	struct snap_block *current;
+	/** Index of the next row to return from @current. */
+	int current_row;
+	/** Set if a block failed to be read or decoded. */
+	bool is_failed;
+	/** Set once the last message has been consumed. */
+	bool is_done;
+	/** Set if the eof marker was read. */
+	bool is_eof;
+	/** Number of part files listed in the file header. */
+	uint32_t part_count;
+	/** Dictionary loaded from the file header. */
+	struct xlog_zdict *zdict;
+};
+
+static void
+snap_block_create(struct snap_block *block, struct snap_reader *reader,
+		  int64_t seq)
+{
+	memset(block, 0, sizeof(*block));
+	block->reader = reader;
+	block->seq = seq;
+	diag_create(&block->diag);
+}
+
+/**
+ * Decompress a tx block and decode its rows. The rows are
+ * copied out of the tx cursor buffer, because it is allocated
+ * on the decoder thread slab cache.
+ */
+static int
+snap_block_decode(struct snap_block *block, ZSTD_DStream *zdctx)
+{
+	const char *data = block->raw;
+	struct xlog_tx_cursor tx_cursor;
+	ssize_t rc = xlog_tx_cursor_create(&tx_cursor, &data,
+					   data + block->raw_size, zdctx,
+					   block->zdict);
+	if (rc > 0)
+		diag_set(XlogError, "tx block is truncated");
+	if (rc != 0)
+		return -1;
+	size_t size = ibuf_used(&tx_cursor.rows);
+	if (size > 0) {
+		block->data = malloc(size);
+		if (block->data == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "snapshot rows");
+			xlog_tx_cursor_destroy(&tx_cursor);
+			return -1;
+		}
+		memcpy(block->data, tx_cursor.rows.rpos, size);
+	}
+	xlog_tx_cursor_destroy(&tx_cursor);
+
+	const char *pos = block->data;
+	const char *end = pos + size;
+	int capacity = 0;
+	while (pos < end) {
+		if (block->row_count == capacity) {
+			capacity = MAX(capacity * 2, SNAP_BLOCK_ROWS_MIN);
+			size_t rows_size = capacity * sizeof(*block->rows);
+			struct xrow_header *rows = realloc(block->rows,
+							   rows_size);
+			if (rows == NULL) {
+				diag_set(OutOfMemory, rows_size, "realloc",
+					 "snapshot rows");
+				return -1;
+			}
+			block->rows = rows;
+		}
+		struct xrow_header *row = &block->rows[block->row_count];
+		if (xrow_header_decode(row, &pos, end, false) != 0) {
+			diag_set(XlogError, "can't parse row");
+			return -1;
+		}
+		block->row_count++;
+	}
+	return 0;
+}
+
+/** Decode a tx block, called in a decoder thread. */
+static void
+snap_decode_f(struct cmsg *base)
+{
+	struct snap_block *block = (struct snap_block *)base;
+	if (block->is_last)
+		return;
+	if (snap_block_decode(block, block->decoder->zdctx) != 0) {
+		block->rc = -1;
+		diag_move(diag_get(), &block->diag);
+	}
+	free(block->raw);
+	block->raw = NULL;
+}
+
+/** Deliver a decoded tx block to the consumer thread. */
+static void
+snap_deliver_f(struct cmsg *base)
+{
+	struct snap_block *block = (struct snap_block *)base;
+	struct snap_reader *reader = block->reader;
+	struct snap_block **slot =
+		&reader->window[block->seq % SNAP_READER_WINDOW];
+	assert(*slot == NULL);
+	*slot = block;
+}
+
+/** Free a consumed tx block, called in the reader thread. */
+static void
+snap_release_f(struct cmsg *base)
+{
+	struct snap_block *block = (struct snap_block *)base;
+	struct snap_reader *reader = block->reader;
+	assert(reader->in_flight > 0);
+	reader->in_flight--;
+	free(block);
+}
+
+/** Decoder thread routine. */
+static int
+snap_decoder_f(va_list ap)
+{
+	struct snap_decoder *decoder = va_arg(ap, struct snap_decoder *);
+	decoder->zdctx = ZSTD_createDStream();
+	if (decoder->zdctx == NULL)
+		panic("failed to create snapshot decompression context");
+	struct cbus_endpoint endpoint;
+	cpipe_create(&decoder->tx_pipe, "snap.tx");
+	cbus_endpoint_create(&endpoint, cord_name(&decoder->cord),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&decoder->tx_pipe);
+	ZSTD_freeDStream(decoder->zdctx);
+	return 0;
+}
+
+/** Start decoder threads, called in the reader thread. */
+static void
+snap_reader_start_decoders(struct snap_reader *reader)
+{
+	for (int i = 0; i < reader->decoder_count; i++) {
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "snap.decode.%d", i);
+		struct snap_decoder *decoder = &reader->decoders[i];
+		if (cord_costart(&decoder->cord, name, snap_decoder_f,
+				 decoder) != 0)
+			panic("failed to start snapshot decoder thread");
+		cpipe_create(&decoder->decoder_pipe, name);
+		decoder->route[0].f = snap_decode_f;
+		decoder->route[0].pipe = &decoder->tx_pipe;
+		decoder->route[1].f = snap_deliver_f;
+		decoder->route[1].pipe = NULL;
+	}
+}
+
+/** Stop decoder threads, called in the reader thread. */
+static void
+snap_reader_stop_decoders(struct snap_reader *reader)
+{
+	for (int i = 0; i < reader->decoder_count; i++) {
+		struct snap_decoder *decoder = &reader->decoders[i];
+		cbus_stop_loop(&decoder->decoder_pipe);
+		cpipe_destroy(&decoder->decoder_pipe);
+		if (cord_cojoin(&decoder->cord) != 0)
+			panic("failed to join snapshot decoder thread");
+	}
+}
+
+/**
+ * Send a tx block to a decoder thread, called in the reader
+ * thread. Blocks until the number of blocks in flight drops
+ * below the limit.
+ */
+static void
+snap_reader_send(struct snap_reader *reader, struct cbus_endpoint *endpoint,
+		 struct snap_block *block)
+{
+	cbus_process(endpoint);
+	while (reader->in_flight >= SNAP_READER_WINDOW) {
+		fiber_yield();
+		cbus_process(endpoint);
+	}
+	struct snap_decoder *decoder = &reader->decoders[reader->next_decoder];
+	reader->next_decoder = (reader->next_decoder + 1) %
+			       reader->decoder_count;
+	block->decoder = decoder;
+	cmsg_init(&block->base, decoder->route);
+	reader->in_flight++;
+	/* Don't wait for the end of the event loop iteration. */
+	cpipe_push_input(&decoder->decoder_pipe, &block->base);
+	cpipe_deliver_now(&decoder->decoder_pipe);
+}
+
+/** Read a tx block and send it to a decoder thread. */
+static int
+snap_reader_read_block(struct snap_reader *reader,
+		       struct cbus_endpoint *endpoint,
+		       struct xlog_cursor *cursor, int64_t seq)
+{
+	const char *data;
+	size_t size;
+	int rc = xlog_cursor_next_tx_raw(cursor, &data, &size);
+	if (rc != 0)
+		return rc;
+	struct snap_block *block = malloc(sizeof(*block));
+	if (block == NULL) {
+		diag_set(OutOfMemory, sizeof(*block), "malloc",
+			 "struct snap_block");
+		return -1;
+	}
+	snap_block_create(block, reader, seq);
+	block->raw = malloc(size);
+	if (block->raw == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "snapshot block");
+		free(block);
+		return -1;
+	}
+	memcpy(block->raw, data, size);
+	block->raw_size = size;
+	block->zdict = cursor->zdict;
+	snap_reader_send(reader, endpoint, block);
+	return 0;
+}
+
+/** Reader thread routine. */
+static int
+snap_reader_f(va_list ap)
+{
+	struct snap_reader *reader = va_arg(ap, struct snap_reader *);
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "snap.reader",
+			     fiber_schedule_cb, fiber());
+	snap_reader_start_decoders(reader);
+
+	int64_t seq = 0;
+	struct xlog_cursor cursor;
+	int rc = xlog_cursor_open(&cursor, reader->filename);
+	bool is_open = rc == 0;
+	while (rc == 0 && !pm_atomic_load(&reader->is_cancelled))
+		rc = snap_reader_read_block(reader, &endpoint, &cursor, seq++);
+
+	/* Report the result of reading in the last message. */
+	struct snap_block *last = reader->last;
+	snap_block_create(last, reader, seq);
+	last->is_last = true;
+	if (rc < 0) {
+		last->rc = -1;
+		diag_move(diag_get(), &last->diag);
+	}
+	if (is_open) {
+		last->is_eof = xlog_cursor_is_eof(&cursor);
+		last->part_count = cursor.meta.part_count;
+		last->zdict = cursor.zdict;
+		cursor.zdict = NULL;
+	}
+	snap_reader_send(reader, &endpoint, last);
+
+	/* Wait for all blocks to be consumed. */
+	cbus_process(&endpoint);
+	while (reader->in_flight > 0) {
+		fiber_yield();
+		cbus_process(&endpoint);
+	}
+	snap_reader_stop_decoders(reader);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	if (is_open)
+		xlog_cursor_close(&cursor, false);
+	return 0;
+}
+
+struct snap_reader *
+snap_reader_new(const char *filename, int thread_count)
+{
+	assert(thread_count > 0);
+	struct snap_reader *reader = calloc(1, sizeof(*reader));
+	if (reader == NULL) {
+		diag_set(OutOfMemory, sizeof(*reader), "calloc",
+			 "struct snap_reader");
+		return NULL;
+	}
+	reader->filename = strdup(filename);
+	reader->decoders = calloc(thread_count, sizeof(*reader->decoders));
+	reader->last = malloc(sizeof(*reader->last));
+	if (reader->filename == NULL || reader->decoders == NULL ||
+	    reader->last == NULL) {
+		diag_set(OutOfMemory, sizeof(*reader->decoders) * thread_count,
+			 "malloc", "snapshot reader");
+		goto fail;
+	}
+	reader->decoder_count = thread_count;
+	if (cbus_endpoint_create(&reader->endpoint, "snap.tx",
+				 fiber_schedule_cb, fiber()) != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "snapshot reader",
+			 "concurrent use");
+		goto fail;
+	}
+	if (cord_costart(&reader->cord, "snap.reader", snap_reader_f,
+			 reader) != 0) {
+		cbus_endpoint_destroy(&reader->endpoint, cbus_process);
+		goto fail;
+	}
+	cpipe_create(&reader->reader_pipe, "snap.reader");
+	return reader;
+fail:
+	free(reader->last);
+	free(reader->decoders);
+	free(reader->filename);
+	free(reader);
+	return NULL;
+}
+
+/**
+ * Return a consumed block to the reader thread so that it can
+ * read more blocks.
+ */
+static void
+snap_reader_release(struct snap_reader *reader, struct snap_block *block)
+{
+	static const struct cmsg_hop route[] = {
+		{ snap_release_f, NULL },
+	};
+	free(block->data);
+	free(block->rows);
+	diag_destroy(&block->diag);
+	cmsg_init(&block->base, route);
+	cpipe_push_input(&reader->reader_pipe, &block->base);
+	cpipe_deliver_now(&reader->reader_pipe);
+}
+
+/** Wait for the next block in the file order. */
+static struct snap_block *
+snap_reader_wait(struct snap_reader *reader)
+{
+	struct snap_block **slot =
+		&reader->window[reader->next_seq % SNAP_READER_WINDOW];
+	cbus_process(&reader->endpoint);
+	while (*slot == NULL) {
+		fiber_yield();
+		cbus_process(&reader->endpoint);
+	}
+	struct snap_block *block = *slot;
+	*slot = NULL;
+	assert(block->seq == reader->next_seq);
+	reader->next_seq++;
+	return block;
+}
+
+int
+snap_reader_next(struct snap_reader *reader, struct xrow_header *row)
+{
+	if (reader->is_failed)
+		return -1;
+	while (true) {
+		struct snap_block *block = reader->current;
+		if (block != NULL) {
+			if (reader->current_row < block->row_count) {
+				*row = block->rows[reader->current_row++];
+				return 0;
+			}
+			reader->current = NULL;
+			snap_reader_release(reader, block);
+		}
+		if (reader->is_done)
+			return 1;
+		block = snap_reader_wait(reader);
+		if (block->rc != 0) {
+			reader->is_failed = true;
+			reader->is_done = block->is_last;
+			diag_move(&block->diag, diag_get());
+			snap_reader_release(reader, block);
+			/* Don't read the rest of the file. */
+			pm_atomic_store(&reader->is_cancelled, true);
+			return -1;
+		}
+		if (block->is_last) {
+			reader->is_done = true;
+			reader->is_eof = block->is_eof;
+			reader->part_count = block->part_count;
+			reader->zdict = block->zdict;
+			snap_reader_release(reader, block);
+			return 1;
+		}
+		reader->current = block;
+		reader->current_row = 0;
+	}
+}
+
+bool
+snap_reader_is_eof(struct snap_reader *reader)
+{
+	return reader->is_eof;
+}
+
+uint32_t
+snap_reader_part_count(struct snap_reader *reader)
+{
+	return reader->part_count;
+}
+
+struct xlog_zdict *
+snap_reader_steal_zdict(struct snap_reader *reader)
+{
+	struct xlog_zdict *zdict = reader->zdict;
+	reader->zdict = NULL;
+	return zdict;
+}
+
+void
+snap_reader_delete(struct snap_reader *reader)
+{
+	if (reader->current != NULL) {
+		snap_reader_release(reader, reader->current);
+		reader->current = NULL;
+	}
+	if (!reader->is_done) {
+		/* Stop reading and drain the pipeline. */
+		pm_atomic_store(&reader->is_cancelled, true);
+		while (true) {
+			struct snap_block *block = snap_reader_wait(reader);
+			bool is_last = block->is_last;
+			if (is_last && block->zdict != NULL)
+				xlog_zdict_unref(block->zdict);
+			snap_reader_release(reader, block);
+			if (is_last)
+				break;
+		}
+	}
+	cpipe_destroy(&reader->reader_pipe);
+	if (cord_cojoin(&reader->cord) != 0)
+		panic("failed to join snapshot reader thread");
+	cbus_endpoint_destroy(&reader->endpoint, cbus_process);
+	if (reader->zdict != NULL)
+		xlog_zdict_unref(reader->zdict);
+	free(reader->decoders);
+	free(reader->filename);
+	free(reader);
+}
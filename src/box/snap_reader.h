@@ -0,0 +1,106 @@
+#pragma once
+/*
+ * Copyright 2010-2020, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct snap_reader;
+struct xrow_header;
+struct xlog_zdict;
+
+enum {
+	/** Max number of snapshot decoding threads. */
+	SNAP_READER_THREADS_MAX = 64,
+};
+
+/**
+ * Open a snapshot file for reading with a pipeline of threads:
+ * a reader thread reads raw tx blocks from the file and hands
+ * them over to @a thread_count decoding threads, which
+ * decompress the blocks and decode rows. The caller receives
+ * decoded rows in the file order with snap_reader_next().
+ *
+ * Returns NULL and sets diag if failed to allocate the reader
+ * or start the reader thread. Errors reading the file,
+ * including errors opening it, are reported by
+ * snap_reader_next().
+ */
+struct snap_reader *
+snap_reader_new(const char *filename, int thread_count);
+
+/**
+ * Stop the reader threads, if they are still running, and
+ * free the reader.
+ */
+void
+snap_reader_delete(struct snap_reader *reader);
+
+/**
+ * Get the next row from a snapshot. The row stays valid until
+ * the next call.
+ *
+ * @retval 0 success
+ * @retval 1 end of file
+ * @retval -1 error, check diag
+ */
+int
+snap_reader_next(struct snap_reader *reader, struct xrow_header *row);
+
+/**
+ * Return true if the whole file, including the eof marker,
+ * has been read.
+ */
+bool
+snap_reader_is_eof(struct snap_reader *reader);
+
+/**
+ * Return the number of part files listed in the file header,
+ * see xdir_create_xlog_part(). Must be called after
+ * snap_reader_next() returned 1.
+ */
+uint32_t
+snap_reader_part_count(struct snap_reader *reader);
+
+/**
+ * Take the zstd dictionary loaded from the file header,
+ * if any. The caller is responsible for unreferencing it.
+ * Must be called after snap_reader_next() returned 1.
+ */
+struct xlog_zdict *
+snap_reader_steal_zdict(struct snap_reader *reader);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
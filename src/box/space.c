@@ -40,6 +40,7 @@
 #include "txn.h"
 #include "memtx_tx.h"
 #include "tuple.h"
+#include "tuple_compression.h"
 #include "xrow_update.h"
 #include "request.h"
 #include "xrow.h"
@@ -410,6 +411,9 @@ after_old_tuple_lookup:;
 		}
 		old_data = tuple_data_range(old_tuple, &old_size);
 		old_data_end = old_data + old_size;
+		if (tuple_decompress_raw(tuple_format(old_tuple), &old_data,
+					 &old_data_end, &fiber()->gc) != 0)
+			return -1;
 		new_data = xrow_update_execute(request->tuple,
 					       request->tuple_end, old_data,
 					       old_data_end,
@@ -443,6 +447,9 @@ after_old_tuple_lookup:;
 		}
 		old_data = tuple_data_range(old_tuple, &old_size);
 		old_data_end = old_data + old_size;
+		if (tuple_decompress_raw(tuple_format(old_tuple), &old_data,
+					 &old_data_end, &fiber()->gc) != 0)
+			return -1;
 		new_data = xrow_upsert_execute(request->ops, request->ops_end,
 					       old_data, old_data_end,
 					       space->format, &new_size,
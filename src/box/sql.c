@@ -46,6 +46,7 @@
 #include "space_def.h"
 #include "index_def.h"
 #include "tuple.h"
+#include "tuple_compression.h"
 #include "fiber.h"
 #include "small/region.h"
 #include "session.h"
@@ -363,6 +364,7 @@ sql_ephemeral_space_create(uint32_t field_count, struct sql_key_info *key_info)
 		field->nullable_action = ON_CONFLICT_ACTION_NONE;
 		field->default_value = NULL;
 		field->default_value_expr = NULL;
+		field->compression = COMPRESSION_TYPE_NONE;
 		if (def != NULL && i < def->part_count) {
 			assert(def->parts[i].type < field_type_MAX);
 			field->type = def->parts[i].type;
@@ -938,6 +940,8 @@ cursor_advance(BtCursor *pCur, int *pRes)
 	struct tuple *tuple;
 	if (iterator_next(pCur->iter, &tuple) != 0)
 		return -1;
+	if (tuple != NULL && (tuple = tuple_decompress(tuple)) == NULL)
+		return -1;
 	if (pCur->last_tuple)
 		box_tuple_unref(pCur->last_tuple);
 	if (tuple) {
@@ -37,6 +37,7 @@
 #include "small/small.h"
 #include "xrow_update.h"
 #include "coll_id_cache.h"
+#include "tuple_compression.h"
 
 static struct mempool tuple_iterator_pool;
 static struct small_alloc runtime_alloc;
@@ -385,6 +386,8 @@ tuple_free(void)
 
 	tuple_format_free();
 
+	tuple_compression_free();
+
 	coll_id_cache_destroy();
 
 	bigref_list_destroy();
@@ -149,8 +149,36 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
 	return 0;
 }
 
+static inline void
+tuple_bloom_add_part(struct tuple_bloom *bloom, uint32_t i, uint32_t hash)
+{
+	if (bloom->type == BLOOM_TYPE_SPLIT_BLOCK)
+		bloom_split_add(&bloom->parts[i], hash);
+	else
+		bloom_add(&bloom->parts[i], hash);
+}
+
+static inline bool
+tuple_bloom_maybe_has_part(const struct tuple_bloom *bloom, uint32_t i,
+			   uint32_t hash)
+{
+	if (bloom->type == BLOOM_TYPE_SPLIT_BLOCK)
+		return bloom_split_maybe_has(&bloom->parts[i], hash);
+	return bloom_maybe_has(&bloom->parts[i], hash);
+}
+
+static double
+tuple_bloom_part_fpr(const struct tuple_bloom *bloom, uint32_t i,
+		     uint32_t count)
+{
+	if (bloom->type == BLOOM_TYPE_SPLIT_BLOCK)
+		return bloom_split_fpr(&bloom->parts[i], count);
+	return bloom_fpr(&bloom->parts[i], count);
+}
+
 struct tuple_bloom *
-tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
+tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr,
+		enum bloom_type type)
 {
 	uint32_t part_count = builder->part_count;
 	size_t size = sizeof(struct tuple_bloom) +
@@ -162,6 +190,7 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 	}
 
 	bloom->is_legacy = false;
+	bloom->type = type;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -177,9 +206,12 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 		 */
 		double part_fpr = fpr;
 		for (uint32_t j = 0; j < i; j++)
-			part_fpr /= bloom_fpr(&bloom->parts[j], count);
+			part_fpr /= tuple_bloom_part_fpr(bloom, j, count);
 		part_fpr = MIN(part_fpr, 0.5);
-		if (bloom_create(&bloom->parts[i], count, part_fpr) != 0) {
+		int rc = type == BLOOM_TYPE_SPLIT_BLOCK ?
+			 bloom_split_create(&bloom->parts[i], count, part_fpr) :
+			 bloom_create(&bloom->parts[i], count, part_fpr);
+		if (rc != 0) {
 			diag_set(OutOfMemory, 0, "bloom_create",
 				 "tuple bloom part");
 			tuple_bloom_delete(bloom);
@@ -187,7 +219,7 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 		}
 		bloom->part_count++;
 		for (uint32_t k = 0; k < count; k++)
-			bloom_add(&bloom->parts[i], hash_arr->values[k]);
+			tuple_bloom_add_part(bloom, i, hash_arr->values[k]);
 	}
 	return bloom;
 }
@@ -222,7 +254,7 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 						  &key_def->parts[i],
 						  multikey_idx);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (!tuple_bloom_maybe_has_part(bloom, i, hash))
 			return false;
 	}
 	return true;
@@ -251,7 +283,7 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 		total_size += tuple_hash_field(&h, &carry, &key,
 					       key_def->parts[i].coll);
 		uint32_t hash = PMurHash32_Result(h, carry, total_size);
-		if (!bloom_maybe_has(&bloom->parts[i], hash))
+		if (!tuple_bloom_maybe_has_part(bloom, i, hash))
 			return false;
 	}
 	return true;
@@ -318,7 +350,7 @@ tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf)
 }
 
 struct tuple_bloom *
-tuple_bloom_decode(const char **data)
+tuple_bloom_decode(const char **data, enum bloom_type type)
 {
 	uint32_t part_count = mp_decode_array(data);
 	struct tuple_bloom *bloom = malloc(sizeof(*bloom) +
@@ -331,6 +363,7 @@ tuple_bloom_decode(const char **data)
 	}
 
 	bloom->is_legacy = false;
+	bloom->type = type;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -355,6 +388,7 @@ tuple_bloom_decode_legacy(const char **data)
 	}
 
 	bloom->is_legacy = true;
+	bloom->type = BLOOM_TYPE_CLASSIC;
 	bloom->part_count = 1;
 
 	if (mp_decode_array(data) != 4)
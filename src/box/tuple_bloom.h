@@ -58,6 +58,8 @@ struct tuple_bloom {
 	 * (see tuple_bloom_decode_legacy).
 	 */
 	bool is_legacy;
+	/** Layout of the bloom filters. */
+	enum bloom_type type;
 	/** Number of key parts. */
 	uint32_t part_count;
 	/** Array of bloom filters, one per each partial key. */
@@ -154,10 +156,12 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
  * Create a new tuple bloom filter.
  * @param builder - bloom filter builder
  * @param fpr - desired false positive rate
+ * @param type - layout of the bloom filters
  * @return bloom filter on success or NULL on OOM
  */
 struct tuple_bloom *
-tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr);
+tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr,
+		enum bloom_type type);
 
 /**
  * Delete a tuple bloom filter.
@@ -203,6 +207,8 @@ tuple_bloom_size(const struct tuple_bloom *bloom);
 
 /**
  * Encode a tuple bloom filter in MsgPack.
+ * The layout of the bloom filters isn't encoded and must be
+ * stored by the caller.
  * @param bloom - bloom filter
  * @param buf - buffer where to store the bloom filter
  * @return pointer to the first byte following encoded data
@@ -214,10 +220,11 @@ tuple_bloom_encode(const struct tuple_bloom *bloom, char *buf);
  * Decode a tuple bloom filter from MsgPack.
  * @param data - pointer to buffer storing encoded bloom filter;
  *  on success it is advanced by the number of decoded bytes
+ * @param type - layout of the encoded bloom filters
  * @return the decoded bloom on success or NULL on OOM
  */
 struct tuple_bloom *
-tuple_bloom_decode(const char **data);
+tuple_bloom_decode(const char **data, enum bloom_type type);
 
 /**
  * Decode a legacy bloom filter from MsgPack.
@@ -32,6 +32,7 @@
 #include "tuple.h"
 #include "coll/coll.h"
 #include "trivia/util.h" /* NOINLINE */
+#include <small/region.h>
 #include <math.h>
 #include "lib/core/decimal.h"
 #include "lib/core/mp_decimal.h"
@@ -1033,6 +1034,26 @@ field_compare_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare<FIELD_TYPE_INTEGER>(const char **field_a, const char **field_b)
+{
+	return mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					    *field_b, mp_typeof(**field_b));
+}
+
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+					   const char **field_b)
+{
+	int r = mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					     *field_b, mp_typeof(**field_b));
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple comparator */
 namespace /* local symbols */ {
 
@@ -1221,6 +1242,27 @@ field_compare_with_key_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_INTEGER>(const char **field,
+					   const char **key)
+{
+	return mp_compare_integer_with_type(*field, mp_typeof(**field),
+					    *key, mp_typeof(**key));
+}
+
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+						    const char **field_b)
+{
+	int r = mp_compare_integer_with_type(*field_a, mp_typeof(**field_a),
+					     *field_b, mp_typeof(**field_b));
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple with key comparator */
 namespace /* local symbols */ {
 
@@ -1437,6 +1479,221 @@ func_index_compare_with_key(struct tuple *tuple, hint_t tuple_hint,
 
 /* }}} tuple_compare_with_key */
 
+/* {{{ tuple_compare_any */
+
+/*
+ * Comparators above are generated for a few field layouts
+ * known in advance. The comparators below are specialized by
+ * field types only, while field numbers are taken from the key
+ * definition at run time, so they fit a key definition of up to
+ * three parts of the most popular types in any fields. This
+ * saves a switch on the field type per part and allows the
+ * compiler to inline field comparison.
+ */
+namespace /* local symbols */ {
+
+template <int ...TYPES> struct FieldCompareAny {};
+
+template <int TYPE, int TYPE2, int ...MORE_TYPES>
+struct FieldCompareAny<TYPE, TYPE2, MORE_TYPES...>
+{
+	inline static int compare(const struct key_part *part,
+				  struct tuple *tuple_a,
+				  struct tuple *tuple_b,
+				  struct tuple_format *format_a,
+				  struct tuple_format *format_b,
+				  const char *field_a,
+				  const char *field_b)
+	{
+		int r = field_compare_and_next<TYPE>(&field_a, &field_b);
+		if (r != 0)
+			return r;
+		if (part[1].fieldno != part[0].fieldno + 1) {
+			field_a = tuple_field_raw(format_a, tuple_data(tuple_a),
+						  tuple_field_map(tuple_a),
+						  part[1].fieldno);
+			field_b = tuple_field_raw(format_b, tuple_data(tuple_b),
+						  tuple_field_map(tuple_b),
+						  part[1].fieldno);
+		}
+		return FieldCompareAny<TYPE2, MORE_TYPES...>::
+			compare(part + 1, tuple_a, tuple_b, format_a,
+				format_b, field_a, field_b);
+	}
+};
+
+template <int TYPE>
+struct FieldCompareAny<TYPE>
+{
+	inline static int compare(const struct key_part *,
+				  struct tuple *,
+				  struct tuple *,
+				  struct tuple_format *,
+				  struct tuple_format *,
+				  const char *field_a,
+				  const char *field_b)
+	{
+		return field_compare<TYPE>(&field_a, &field_b);
+	}
+};
+
+template <int ...TYPES>
+struct TupleCompareAny
+{
+	static int compare(struct tuple *tuple_a, hint_t tuple_a_hint,
+			   struct tuple *tuple_b, hint_t tuple_b_hint,
+			   struct key_def *key_def)
+	{
+		assert(key_def->part_count == sizeof...(TYPES));
+		int rc = hint_cmp(tuple_a_hint, tuple_b_hint);
+		if (rc != 0)
+			return rc;
+		const struct key_part *part = key_def->parts;
+		struct tuple_format *format_a = tuple_format(tuple_a);
+		struct tuple_format *format_b = tuple_format(tuple_b);
+		const char *field_a, *field_b;
+		field_a = tuple_field_raw(format_a, tuple_data(tuple_a),
+					  tuple_field_map(tuple_a),
+					  part->fieldno);
+		field_b = tuple_field_raw(format_b, tuple_data(tuple_b),
+					  tuple_field_map(tuple_b),
+					  part->fieldno);
+		return FieldCompareAny<TYPES...>::
+			compare(part, tuple_a, tuple_b, format_a,
+				format_b, field_a, field_b);
+	}
+};
+
+template <int ...TYPES> struct FieldCompareWithKeyAny {};
+
+template <int TYPE, int TYPE2, int ...MORE_TYPES>
+struct FieldCompareWithKeyAny<TYPE, TYPE2, MORE_TYPES...>
+{
+	inline static int compare(const struct key_part *part,
+				  uint32_t part_count,
+				  struct tuple *tuple,
+				  struct tuple_format *format,
+				  const char *field,
+				  const char *key)
+	{
+		if (part_count == 1)
+			return field_compare_with_key<TYPE>(&field, &key);
+		int r = field_compare_with_key_and_next<TYPE>(&field, &key);
+		if (r != 0)
+			return r;
+		if (part[1].fieldno != part[0].fieldno + 1) {
+			field = tuple_field_raw(format, tuple_data(tuple),
+						tuple_field_map(tuple),
+						part[1].fieldno);
+		}
+		return FieldCompareWithKeyAny<TYPE2, MORE_TYPES...>::
+			compare(part + 1, part_count - 1, tuple, format,
+				field, key);
+	}
+};
+
+template <int TYPE>
+struct FieldCompareWithKeyAny<TYPE>
+{
+	inline static int compare(const struct key_part *,
+				  uint32_t,
+				  struct tuple *,
+				  struct tuple_format *,
+				  const char *field,
+				  const char *key)
+	{
+		return field_compare_with_key<TYPE>(&field, &key);
+	}
+};
+
+template <int ...TYPES>
+struct TupleCompareWithKeyAny
+{
+	static int
+	compare(struct tuple *tuple, hint_t tuple_hint,
+		const char *key, uint32_t part_count,
+		hint_t key_hint, struct key_def *key_def)
+	{
+		assert(key_def->part_count == sizeof...(TYPES));
+		assert(part_count <= key_def->part_count);
+		/* Part count can be 0 in wildcard searches. */
+		if (part_count == 0)
+			return 0;
+		int rc = hint_cmp(tuple_hint, key_hint);
+		if (rc != 0)
+			return rc;
+		const struct key_part *part = key_def->parts;
+		struct tuple_format *format = tuple_format(tuple);
+		const char *field = tuple_field_raw(format, tuple_data(tuple),
+						    tuple_field_map(tuple),
+						    part->fieldno);
+		return FieldCompareWithKeyAny<TYPES...>::
+			compare(part, part_count, tuple, format, field, key);
+	}
+};
+
+} /* end of anonymous namespace */
+
+struct comparator_any_signature {
+	tuple_compare_t f;
+	tuple_compare_with_key_t f_wk;
+	uint32_t p[4];
+};
+
+#define COMPARATOR_ANY(...) \
+	{ TupleCompareAny<__VA_ARGS__>::compare, \
+	  TupleCompareWithKeyAny<__VA_ARGS__>::compare, \
+	  { __VA_ARGS__, UINT32_MAX } },
+
+/**
+ * field1 type, field2 type, ...
+ */
+static const comparator_any_signature cmp_any_arr[] = {
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
+	COMPARATOR_ANY(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
+};
+
+#undef COMPARATOR_ANY
+
+/* }}} tuple_compare_any */
+
 /* {{{ tuple_hint */
 
 /**
@@ -1902,9 +2159,36 @@ key_def_set_hint_func(struct key_def *def)
 		key_def_set_hint_func<type, false>(def);
 }
 
+static hint_t
+key_hint_none(const char *key, uint32_t part_count, struct key_def *key_def)
+{
+	(void)key;
+	(void)part_count;
+	(void)key_def;
+	return HINT_NONE;
+}
+
+static hint_t
+key_hint_none(struct tuple *tuple, struct key_def *key_def)
+{
+	(void)tuple;
+	(void)key_def;
+	return HINT_NONE;
+}
+
 static void
 key_def_set_hint_func(struct key_def *def)
 {
+	if (def->is_normalized) {
+		/*
+		 * Hints of tuples are pointers to normalized keys
+		 * set by the index, see tuple_normalized_key().
+		 * Keys are compared with tuples field by field.
+		 */
+		def->key_hint = key_hint_none;
+		def->tuple_hint = key_hint_none;
+		return;
+	}
 	if (def->is_multikey || def->for_func_index) {
 		def->key_hint = key_hint_stub;
 		def->tuple_hint = key_hint_stub;
@@ -1951,6 +2235,260 @@ key_def_set_hint_func(struct key_def *def)
 
 /* }}} tuple_hint */
 
+/* {{{ normalized_key */
+
+/**
+ * A normalized key is a byte string built from all key parts of
+ * a tuple such that comparing two normalized keys with memcmp()
+ * gives the same result as comparing the tuples with the key
+ * definition. It starts with a 32-bit big-endian length of the
+ * string that follows. Key parts are encoded as follows:
+ *
+ *  - A nullable part starts with 0 if it's NULL (and then has no
+ *    more bytes) and 1 otherwise.
+ *
+ *  - An integer is encoded as 0 for a negative value and 1
+ *    otherwise followed by 8 bytes of the value in big-endian
+ *    order.
+ *
+ *  - A boolean is encoded as a single byte, 0 or 1.
+ *
+ *  - A string or a varbinary is copied byte by byte with each
+ *    zero byte escaped as 0x00 0xff and terminated with 0x00 0x00
+ *    so that a prefix is less than the string it prefixes. If
+ *    there's an ICU collation, its sort key is used instead of
+ *    the string. Sort keys never contain zero bytes.
+ *
+ * Like tuple_compare_slowpath(), primary key parts are only
+ * encoded if there's a NULL among the secondary key parts of a
+ * nullable key definition.
+ */
+
+enum field_type
+key_def_unnormalizable_type(const struct key_def *key_def)
+{
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		switch (key_def->parts[i].type) {
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_BOOLEAN:
+		case FIELD_TYPE_STRING:
+		case FIELD_TYPE_VARBINARY:
+			break;
+		default:
+			return key_def->parts[i].type;
+		}
+	}
+	return field_type_MAX;
+}
+
+/**
+ * Allocate @a size more bytes of a normalized key being built on
+ * the region.
+ */
+static inline char *
+normalized_key_alloc(struct region *region, size_t size, uint32_t *total)
+{
+	char *buf = (char *)region_alloc(region, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc", "normalized key");
+		return NULL;
+	}
+	*total += size;
+	return buf;
+}
+
+/** Append an escaped and terminated byte string to a normalized key. */
+static int
+normalized_key_append_bytes(struct region *region, const char *s,
+			    uint32_t len, uint32_t *total)
+{
+	uint32_t zero_count = 0;
+	for (const char *z = s; (z = (const char *)memchr(z, 0,
+						s + len - z)) != NULL; z++)
+		zero_count++;
+	char *buf = normalized_key_alloc(region, len + zero_count + 2, total);
+	if (buf == NULL)
+		return -1;
+	for (uint32_t i = 0; i < len; i++) {
+		*buf++ = s[i];
+		if (s[i] == 0)
+			*buf++ = (char)0xff;
+	}
+	*buf++ = 0;
+	*buf++ = 0;
+	return 0;
+}
+
+/** Append a terminated ICU sort key of a string to a normalized key. */
+static int
+normalized_key_append_sort_key(struct region *region, const char *s,
+			       uint32_t len, struct coll *coll,
+			       uint32_t *total)
+{
+	assert(coll->type == COLL_TYPE_ICU);
+	size_t capacity = 4 * (size_t)len + 16;
+	while (true) {
+		char *buf = (char *)region_reserve(region, capacity + 2);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, capacity + 2, "region_reserve",
+				 "normalized key");
+			return -1;
+		}
+		size_t size = coll->hint(s, len, buf, capacity, coll);
+		if (size < capacity) {
+			/*
+			 * The sort key fits, it may be truncated
+			 * otherwise. The space has been reserved,
+			 * so the allocation can't fail.
+			 */
+			char *key = normalized_key_alloc(region, size + 2,
+							 total);
+			assert(key == buf);
+			(void)key;
+			buf[size] = 0;
+			buf[size + 1] = 0;
+			return 0;
+		}
+		capacity *= 2;
+	}
+}
+
+/** Append a key part of a tuple to a normalized key. */
+static int
+normalized_key_append_part(struct region *region, const char *field,
+			   struct key_part *part, uint32_t *total)
+{
+	char *buf;
+	if (part->is_nullable) {
+		buf = normalized_key_alloc(region, 1, total);
+		if (buf == NULL)
+			return -1;
+		if (field == NULL || mp_typeof(*field) == MP_NIL) {
+			*buf = 0;
+			return 0;
+		}
+		*buf = 1;
+	}
+	assert(field != NULL);
+	const char *s;
+	uint32_t len;
+	switch (mp_typeof(*field)) {
+	case MP_UINT:
+	case MP_INT:
+		buf = normalized_key_alloc(region, 1 + sizeof(uint64_t), total);
+		if (buf == NULL)
+			return -1;
+		if (mp_typeof(*field) == MP_UINT) {
+			*buf = 1;
+			mp_store_u64(buf + 1, mp_decode_uint(&field));
+		} else {
+			/*
+			 * Two's complement keeps the order of negative
+			 * values when they are compared as unsigned.
+			 */
+			*buf = 0;
+			mp_store_u64(buf + 1, (uint64_t)mp_decode_int(&field));
+		}
+		return 0;
+	case MP_BOOL:
+		buf = normalized_key_alloc(region, 1, total);
+		if (buf == NULL)
+			return -1;
+		*buf = mp_decode_bool(&field) ? 1 : 0;
+		return 0;
+	case MP_STR:
+		s = mp_decode_str(&field, &len);
+		if (part->coll != NULL && part->coll->type == COLL_TYPE_ICU) {
+			return normalized_key_append_sort_key(region, s, len,
+							      part->coll,
+							      total);
+		}
+		return normalized_key_append_bytes(region, s, len, total);
+	case MP_BIN:
+		s = mp_decode_bin(&field, &len);
+		return normalized_key_append_bytes(region, s, len, total);
+	default:
+		unreachable();
+		return 0;
+	}
+}
+
+const char *
+tuple_normalized_key(struct tuple *tuple, struct key_def *key_def,
+		     struct region *region, uint32_t *size)
+{
+	assert(key_def_unnormalizable_type(key_def) == field_type_MAX);
+	assert(!key_def->is_multikey && !key_def->for_func_index);
+	size_t region_svp = region_used(region);
+	uint32_t total = 0;
+	if (normalized_key_alloc(region, sizeof(uint32_t), &total) == NULL)
+		return NULL;
+	bool was_null_met = false;
+	uint32_t part_count = key_def->is_nullable ?
+			      key_def->unique_part_count : key_def->part_count;
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		if (i == part_count && !was_null_met)
+			break;
+		struct key_part *part = &key_def->parts[i];
+		const char *field = tuple_field_by_part(tuple, part,
+							MULTIKEY_NONE);
+		if (field == NULL || mp_typeof(*field) == MP_NIL)
+			was_null_met = true;
+		if (normalized_key_append_part(region, field, part,
+					       &total) != 0)
+			goto fail;
+	}
+	char *key;
+	key = (char *)region_join(region, total);
+	if (key == NULL) {
+		diag_set(OutOfMemory, total, "region_join", "normalized key");
+		goto fail;
+	}
+	mp_store_u32(key, total - sizeof(uint32_t));
+	*size = total;
+	return key;
+fail:
+	region_truncate(region, region_svp);
+	return NULL;
+}
+
+/** Compare two normalized keys, see tuple_normalized_key(). */
+static inline int
+normalized_key_compare(const char *key_a, const char *key_b)
+{
+	uint32_t size_a = mp_load_u32(&key_a);
+	uint32_t size_b = mp_load_u32(&key_b);
+	int rc = memcmp(key_a, key_b, MIN(size_a, size_b));
+	if (rc != 0)
+		return rc;
+	return size_a < size_b ? -1 : size_a > size_b;
+}
+
+/**
+ * A normalized key def tuple compare. Hints are expected to be
+ * pointers to normalized keys of the tuples. If any of them is
+ * missing, the tuples are compared field by field.
+ */
+template<bool is_nullable, bool has_optional_parts, bool has_json_paths>
+static int
+tuple_compare_normalized(struct tuple *tuple_a, hint_t tuple_a_hint,
+			 struct tuple *tuple_b, hint_t tuple_b_hint,
+			 struct key_def *key_def)
+{
+	assert(key_def->is_normalized);
+	if (tuple_a_hint == HINT_NONE || tuple_b_hint == HINT_NONE) {
+		return tuple_compare_slowpath<is_nullable, has_optional_parts,
+					      has_json_paths, false>
+				(tuple_a, HINT_NONE, tuple_b, HINT_NONE,
+				 key_def);
+	}
+	return normalized_key_compare((const char *)tuple_a_hint,
+				      (const char *)tuple_b_hint);
+}
+
+/* }}} normalized_key */
+
 static void
 key_def_set_compare_func_fast(struct key_def *def)
 {
@@ -1990,6 +2528,24 @@ key_def_set_compare_func_fast(struct key_def *def)
 			break;
 		}
 	}
+	/*
+	 * Then look for comparators specialized by field types,
+	 * which fit any field numbers.
+	 */
+	for (uint32_t k = 0; k < lengthof(cmp_any_arr) &&
+			     (cmp == NULL || cmp_wk == NULL); k++) {
+		uint32_t i = 0;
+		for (; i < def->part_count; i++)
+			if (def->parts[i].type != cmp_any_arr[k].p[i])
+				break;
+		if (i == def->part_count &&
+		    cmp_any_arr[k].p[i] == UINT32_MAX) {
+			if (cmp == NULL)
+				cmp = cmp_any_arr[k].f;
+			if (cmp_wk == NULL)
+				cmp_wk = cmp_any_arr[k].f_wk;
+		}
+	}
 	if (cmp == NULL) {
 		cmp = is_sequential ?
 			tuple_compare_sequential<false, false> :
@@ -2051,6 +2607,20 @@ key_def_set_compare_func_for_func_index(struct key_def *def)
 	def->tuple_compare_with_key = func_index_compare_with_key<is_nullable>;
 }
 
+template<bool is_nullable, bool has_optional_parts>
+static void
+key_def_set_compare_func_normalized(struct key_def *def)
+{
+	assert(def->is_normalized);
+	if (def->has_json_paths) {
+		def->tuple_compare = tuple_compare_normalized
+				<is_nullable, has_optional_parts, true>;
+	} else {
+		def->tuple_compare = tuple_compare_normalized
+				<is_nullable, has_optional_parts, false>;
+	}
+}
+
 void
 key_def_set_compare_func(struct key_def *def)
 {
@@ -2092,6 +2662,13 @@ key_def_set_compare_func(struct key_def *def)
 	if (key_def_incomparable_type(def) != field_type_MAX) {
 		def->tuple_compare = NULL;
 		def->tuple_compare_with_key = NULL;
+	} else if (def->is_normalized) {
+		if (def->is_nullable && def->has_optional_parts)
+			key_def_set_compare_func_normalized<true, true>(def);
+		else if (def->is_nullable)
+			key_def_set_compare_func_normalized<true, false>(def);
+		else
+			key_def_set_compare_func_normalized<false, false>(def);
 	}
 	key_def_set_hint_func(def);
 }
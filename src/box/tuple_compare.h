@@ -31,12 +31,15 @@
  * SUCH DAMAGE.
  */
 #include <stdint.h>
+#include "field_def.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
 struct key_def;
+struct tuple;
+struct region;
 
 /**
  * Hints are now used for two purposes - passing the index of the
@@ -76,6 +79,33 @@ typedef uint64_t hint_t;
 void
 key_def_set_compare_func(struct key_def *def);
 
+/**
+ * Return the first field type of @a key_def that can't be
+ * encoded in a normalized key, or field_type_MAX if all key
+ * parts can be normalized.
+ */
+enum field_type
+key_def_unnormalizable_type(const struct key_def *key_def);
+
+/**
+ * Build a normalized key of a tuple, i.e. a byte string such that
+ * normalized keys of two tuples compare with memcmp() the same way
+ * as the tuples compare with @a key_def. A key def marked with
+ * key_def_set_normalized() expects pointers to normalized keys
+ * as tuple hints.
+ *
+ * @param tuple Tuple to build the key of.
+ * @param key_def Key definition, must be normalizable, see
+ *                key_def_unnormalizable_type().
+ * @param region Region to allocate the key on.
+ * @param[out] size Size of the key.
+ * @retval NULL Memory error.
+ * @retval not NULL Normalized key.
+ */
+const char *
+tuple_normalized_key(struct tuple *tuple, struct key_def *key_def,
+		     struct region *region, uint32_t *size);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
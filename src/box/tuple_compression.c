@@ -0,0 +1,383 @@
+/*
+ * Copyright 2010-2020, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "tuple_compression.h"
+
+#define ZSTD_STATIC_LINKING_ONLY
+#include "zstd.h"
+#include "small/region.h"
+
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "field_def.h"
+#include "trivia/util.h"
+#include "tuple_format.h"
+
+enum {
+	/**
+	 * Values shorter than this are never compressed:
+	 * zstd frame overhead eats up any gain on them.
+	 */
+	TUPLE_COMPRESSION_MIN_SIZE = 64,
+	/** Compression level of zstd. */
+	TUPLE_ZSTD_LEVEL = 3,
+};
+
+/**
+ * Compression contexts. Tuples are created and given out to
+ * users in the tx thread only, so the contexts are shared by
+ * all tuples.
+ */
+static ZSTD_CCtx *tuple_zctx;
+static ZSTD_DCtx *tuple_zdctx;
+
+/**
+ * Compress a field value and append it to @a region as
+ * an MP_COMPRESSION value.
+ *
+ * @param[out] size Size of the appended value or 0, if the
+ *             value doesn't shrink and must be stored as is.
+ */
+static int
+tuple_field_compress(const char *field, const char *field_end,
+		     struct region *region, size_t *size)
+{
+	if (tuple_zctx == NULL) {
+		tuple_zctx = ZSTD_createCCtx();
+		if (tuple_zctx == NULL) {
+			diag_set(ClientError, ER_COMPRESSION,
+				 "failed to create context");
+			return -1;
+		}
+	}
+	size_t len = field_end - field;
+	size_t bound = ZSTD_compressBound(len);
+	/* Header of the largest possible MP_EXT value. */
+	size_t header_size = mp_sizeof_extl(1 + bound) + 1;
+	char *buf = region_reserve(region, header_size + bound);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, header_size + bound,
+			 "region_reserve", "buf");
+		return -1;
+	}
+	char *zdata = buf + header_size;
+	size_t zsize = ZSTD_compressCCtx(tuple_zctx, zdata, bound,
+					 field, len, TUPLE_ZSTD_LEVEL);
+	if (ZSTD_isError(zsize)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZSTD_getErrorName(zsize));
+		return -1;
+	}
+	*size = mp_sizeof_ext(1 + zsize);
+	if (*size >= len) {
+		*size = 0;
+		return 0;
+	}
+	char *pos = mp_encode_extl(buf, MP_COMPRESSION, 1 + zsize);
+	*pos++ = COMPRESSION_TYPE_ZSTD;
+	memmove(pos, zdata, zsize);
+	/* Commit the reserved memory, the address stays the same. */
+	char *committed = region_alloc(region, *size);
+	assert(committed == buf);
+	(void)committed;
+	return 0;
+}
+
+/**
+ * Decompress an MP_COMPRESSION value and append the original
+ * value to @a region.
+ *
+ * @param[out] value The appended value.
+ * @param[out] size Size of the appended value.
+ */
+static int
+tuple_field_decompress(const char *field, struct region *region,
+		       const char **value, size_t *size)
+{
+	int8_t type;
+	uint32_t len = mp_decode_extl(&field, &type);
+	assert(type == MP_COMPRESSION);
+	if (len == 0 || (uint8_t)*field != COMPRESSION_TYPE_ZSTD) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 "unknown compression type");
+		return -1;
+	}
+	field++;
+	len--;
+	unsigned long long orig_size = ZSTD_getFrameContentSize(field, len);
+	if (orig_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+	    orig_size == ZSTD_CONTENTSIZE_ERROR || orig_size == 0 ||
+	    orig_size > UINT32_MAX) {
+		diag_set(ClientError, ER_DECOMPRESSION, "invalid frame");
+		return -1;
+	}
+	/* Don't trust the size the frame claims to hold. */
+	unsigned long long bound = ZSTD_decompressBound(field, len);
+	if (bound == ZSTD_CONTENTSIZE_ERROR || orig_size > bound) {
+		diag_set(ClientError, ER_DECOMPRESSION, "invalid frame");
+		return -1;
+	}
+	if (tuple_zdctx == NULL) {
+		tuple_zdctx = ZSTD_createDCtx();
+		if (tuple_zdctx == NULL) {
+			diag_set(ClientError, ER_DECOMPRESSION,
+				 "failed to create context");
+			return -1;
+		}
+	}
+	char *buf = region_alloc(region, orig_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, orig_size, "region_alloc", "buf");
+		return -1;
+	}
+	size_t rc = ZSTD_decompressDCtx(tuple_zdctx, buf, orig_size,
+					field, len);
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_DECOMPRESSION, ZSTD_getErrorName(rc));
+		return -1;
+	}
+	const char *end = buf;
+	if (rc != orig_size || mp_check(&end, buf + orig_size) != 0 ||
+	    end != buf + orig_size) {
+		diag_set(ClientError, ER_DECOMPRESSION, "invalid MsgPack");
+		return -1;
+	}
+	*value = buf;
+	*size = orig_size;
+	return 0;
+}
+
+/**
+ * Check a value of field @a fieldno that is compressed already,
+ * i.e. it must decompress to a value of the field type.
+ */
+static int
+tuple_field_check_compressed(struct tuple_field *f, uint32_t fieldno,
+			     const char *field, struct region *region)
+{
+	size_t region_svp = region_used(region);
+	const char *value;
+	size_t size;
+	int rc = tuple_field_decompress(field, region, &value, &size);
+	if (rc == 0 && !field_mp_type_is_compatible(f->type, value,
+					tuple_field_is_nullable(f))) {
+		diag_set(ClientError, ER_FIELD_TYPE,
+			 int2str(fieldno + TUPLE_INDEX_BASE),
+			 field_type_strs[f->type]);
+		rc = -1;
+	}
+	region_truncate(region, region_svp);
+	return rc;
+}
+
+/** Append a copy of [@a data, @a data_end) to @a region. */
+static int
+region_append(struct region *region, const char *data,
+	      const char *data_end)
+{
+	size_t size = data_end - data;
+	if (size == 0)
+		return 0;
+	char *buf = region_alloc(region, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc", "buf");
+		return -1;
+	}
+	memcpy(buf, data, size);
+	return 0;
+}
+
+/**
+ * Compress or decompress top-level fields of tuple data.
+ * The result is built on @a region piece by piece: untouched
+ * chunks of the original data are copied as is. If @a format
+ * is NULL, all compressed fields are decompressed.
+ */
+static int
+tuple_transform_raw(struct tuple_format *format, const char **data,
+		    const char **data_end, struct region *region,
+		    bool is_compress, bool check_compressed)
+{
+	assert(format != NULL || !is_compress);
+	if (format != NULL && !format->is_compressed)
+		return 0;
+	const char *pos = *data;
+	uint32_t field_count = mp_decode_array(&pos);
+	if (format != NULL) {
+		field_count = MIN(field_count,
+				  tuple_format_field_count(format));
+	}
+	/* Start of the original data not copied yet. */
+	const char *chunk = *data;
+	size_t total = 0;
+	bool is_changed = false;
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		struct tuple_field *f = format != NULL ?
+					tuple_format_field(format, i) : NULL;
+		if (f != NULL && f->compression == COMPRESSION_TYPE_NONE)
+			continue;
+		size_t size;
+		if (is_compress) {
+			if (mp_is_compressed(field)) {
+				/*
+				 * The value escapes the format check,
+				 * so check what it decompresses to
+				 * unless it's known to be valid.
+				 */
+				if (check_compressed &&
+				    tuple_field_check_compressed(f, i, field,
+								 region) != 0)
+					return -1;
+				continue;
+			}
+			if (pos - field < TUPLE_COMPRESSION_MIN_SIZE)
+				continue;
+			/*
+			 * The compressed value escapes the format
+			 * check, so check the original one here.
+			 */
+			if (!field_mp_type_is_compatible(f->type, field,
+						tuple_field_is_nullable(f))) {
+				diag_set(ClientError, ER_FIELD_TYPE,
+					 int2str(i + TUPLE_INDEX_BASE),
+					 field_type_strs[f->type]);
+				return -1;
+			}
+			if (region_append(region, chunk, field) != 0)
+				return -1;
+			total += field - chunk;
+			if (tuple_field_compress(field, pos, region,
+						 &size) != 0)
+				return -1;
+			if (size == 0) {
+				/* Keep the value in the next chunk. */
+				chunk = field;
+				continue;
+			}
+		} else {
+			if (!mp_is_compressed(field))
+				continue;
+			if (region_append(region, chunk, field) != 0)
+				return -1;
+			total += field - chunk;
+			const char *value;
+			if (tuple_field_decompress(field, region, &value,
+						   &size) != 0)
+				return -1;
+		}
+		total += size;
+		chunk = pos;
+		is_changed = true;
+	}
+	if (!is_changed)
+		return 0;
+	if (region_append(region, chunk, *data_end) != 0)
+		return -1;
+	total += *data_end - chunk;
+	char *result = region_join(region, total);
+	if (result == NULL) {
+		diag_set(OutOfMemory, total, "region_join", "result");
+		return -1;
+	}
+	*data = result;
+	*data_end = result + total;
+	return 0;
+}
+
+int
+tuple_compress_raw(struct tuple_format *format, const char **data,
+		   const char **data_end, struct region *region,
+		   bool check_compressed)
+{
+	return tuple_transform_raw(format, data, data_end, region, true,
+				   check_compressed);
+}
+
+int
+tuple_decompress_raw(struct tuple_format *format, const char **data,
+		     const char **data_end, struct region *region)
+{
+	return tuple_transform_raw(format, data, data_end, region, false,
+				   false);
+}
+
+int
+tuple_decompress_all_raw(const char **data, const char **data_end,
+			 struct region *region)
+{
+	return tuple_transform_raw(NULL, data, data_end, region, false,
+				   false);
+}
+
+struct tuple *
+tuple_decompress_slow(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	assert(format->is_compressed);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t bsize;
+	const char *data = tuple_data_range(tuple, &bsize);
+	const char *data_end = data + bsize;
+	struct tuple *ret = NULL;
+	if (tuple_decompress_raw(format, &data, &data_end, region) != 0)
+		goto out;
+	if (data == tuple_data(tuple)) {
+		/* Nothing is compressed in this very tuple. */
+		ret = tuple;
+		goto out;
+	}
+	if (format->decompressed_format == NULL) {
+		struct tuple_format *decompressed_format =
+			tuple_format_new(&tuple_format_runtime->vtab, NULL,
+					 NULL, 0, NULL, 0, 0, format->dict,
+					 false, false);
+		if (decompressed_format == NULL)
+			goto out;
+		tuple_format_ref(decompressed_format);
+		format->decompressed_format = decompressed_format;
+	}
+	ret = tuple_new(format->decompressed_format, data, data_end);
+out:
+	region_truncate(region, region_svp);
+	return ret;
+}
+
+void
+tuple_compression_free(void)
+{
+	ZSTD_freeCCtx(tuple_zctx);
+	tuple_zctx = NULL;
+	ZSTD_freeDCtx(tuple_zdctx);
+	tuple_zdctx = NULL;
+}
@@ -0,0 +1,142 @@
+#ifndef TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED
+#define TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED
+/*
+ * Copyright 2010-2020, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <msgpuck.h>
+#include "mp_extension_types.h"
+#include "tuple.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Top-level fields marked with a compression type in a space
+ * format are stored as MP_EXT values of type MP_COMPRESSION:
+ *
+ * +--------+---------------------------------------+
+ * | MP_EXT | compression type | compressed MsgPack |
+ * +--------+---------------------------------------+
+ *
+ * Compressed fields can't be indexed, so comparators, hashers
+ * and key extractors never see them. Tuples are decompressed
+ * when they are given out to a user.
+ */
+
+struct region;
+struct tuple_format;
+
+/** Check if MsgPack @a data is a compressed value. */
+static inline bool
+mp_is_compressed(const char *data)
+{
+	if (mp_typeof(*data) != MP_EXT)
+		return false;
+	int8_t type;
+	mp_decode_extl(&data, &type);
+	return type == MP_COMPRESSION;
+}
+
+/**
+ * Compress fields of tuple data according to @a format.
+ * Values that are too small or don't shrink are left as is,
+ * as well as already compressed ones.
+ *
+ * @param format Format of the tuple.
+ * @param[in, out] data Tuple data. Set to the compressed
+ *        copy allocated on @a region, if any field was
+ *        compressed.
+ * @param[in, out] data_end End of the tuple data.
+ * @param region Region to allocate the copy on.
+ * @param check_compressed Check that already compressed values
+ *        decompress to values of the field type. May be unset
+ *        only for data that is known to be valid, e.g. read
+ *        from a snapshot.
+ *
+ * @retval  0 Success.
+ * @retval -1 A compressed field has a wrong type or a memory,
+ *            compression or decompression error occurred.
+ */
+int
+tuple_compress_raw(struct tuple_format *format, const char **data,
+		   const char **data_end, struct region *region,
+		   bool check_compressed);
+
+/**
+ * Decompress fields of tuple data stored in @a format.
+ * Arguments are the same as for tuple_compress_raw().
+ */
+int
+tuple_decompress_raw(struct tuple_format *format, const char **data,
+		     const char **data_end, struct region *region);
+
+/**
+ * Decompress all compressed fields of tuple data, no matter
+ * what format it is stored in. Used for data of tuples that
+ * were stored before compression was dropped from the space
+ * format. Arguments are the same as for tuple_compress_raw().
+ */
+int
+tuple_decompress_all_raw(const char **data, const char **data_end,
+			 struct region *region);
+
+/** Slow path of tuple_decompress(). */
+struct tuple *
+tuple_decompress_slow(struct tuple *tuple);
+
+/**
+ * Return a copy of @a tuple with all fields decompressed or
+ * the tuple itself, if it has no compressed fields. The copy
+ * is a runtime tuple with zero reference counter, so it is
+ * freed when the caller drops the last reference to it.
+ *
+ * @retval NULL Memory or decompression error.
+ */
+static inline struct tuple *
+tuple_decompress(struct tuple *tuple)
+{
+	if (likely(!tuple_format(tuple)->is_compressed))
+		return tuple;
+	return tuple_decompress_slow(tuple);
+}
+
+/** Free compression contexts. */
+void
+tuple_compression_free(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED */
@@ -103,6 +103,52 @@ tuple_extract_key_sequential(struct tuple *tuple, struct key_def *key_def,
 								    key_size);
 }
 
+/**
+ * Optimized version of tuple_extract_key() for non-sequential
+ * key defs of a few parts. Unlike the general-purpose
+ * version, it looks up every field once and doesn't need to
+ * check for optional parts, so the loops are unrolled.
+ * @copydoc tuple_extract_key()
+ */
+template <uint32_t part_count>
+static char *
+tuple_extract_key_fixed(struct tuple *tuple, struct key_def *key_def,
+			int multikey_idx, uint32_t *key_size)
+{
+	(void)multikey_idx;
+	assert(key_def->part_count == part_count);
+	assert(!key_def->has_optional_parts);
+	assert(!key_def->has_json_paths);
+	assert(!key_def->for_func_index);
+	const char *data = tuple_data(tuple);
+	struct tuple_format *format = tuple_format(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	const char *field[part_count], *field_end[part_count];
+	uint32_t bsize = mp_sizeof_array(part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		field[i] = tuple_field_raw(format, data, field_map,
+					   key_def->parts[i].fieldno);
+		assert(field[i] != NULL);
+		field_end[i] = field[i];
+		mp_next(&field_end[i]);
+		bsize += field_end[i] - field[i];
+	}
+	char *key = (char *) region_alloc(&fiber()->gc, bsize);
+	if (key == NULL) {
+		diag_set(OutOfMemory, bsize, "region", "tuple_extract_key");
+		return NULL;
+	}
+	char *key_buf = mp_encode_array(key, part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		memcpy(key_buf, field[i], field_end[i] - field[i]);
+		key_buf += field_end[i] - field[i];
+	}
+	assert(key_buf == key + bsize);
+	if (key_size != NULL)
+		*key_size = bsize;
+	return key;
+}
+
 /**
  * General-purpose implementation of tuple_extract_key()
  * @copydoc tuple_extract_key()
@@ -382,6 +428,24 @@ key_def_set_extract_func_plain(struct key_def *def)
 					 has_optional_parts, false, false>;
 		def->tuple_extract_key_raw = tuple_extract_key_slowpath_raw
 					<has_optional_parts, false>;
+		if (has_optional_parts)
+			return;
+		switch (def->part_count) {
+		case 1:
+			def->tuple_extract_key = tuple_extract_key_fixed<1>;
+			break;
+		case 2:
+			def->tuple_extract_key = tuple_extract_key_fixed<2>;
+			break;
+		case 3:
+			def->tuple_extract_key = tuple_extract_key_fixed<3>;
+			break;
+		case 4:
+			def->tuple_extract_key = tuple_extract_key_fixed<4>;
+			break;
+		default:
+			break;
+		}
 	}
 }
 
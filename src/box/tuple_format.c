@@ -32,6 +32,7 @@
 #include "fiber.h"
 #include "json/json.h"
 #include "tuple_format.h"
+#include "tuple_compression.h"
 #include "coll_id_cache.h"
 #include "tt_static.h"
 
@@ -97,6 +98,9 @@ tuple_format_cmp(const struct tuple_format *format1,
 		if (field_a->is_key_part != field_b->is_key_part)
 			return (int)field_a->is_key_part -
 				(int)field_b->is_key_part;
+		if (field_a->compression != field_b->compression)
+			return (int)field_a->compression -
+				(int)field_b->compression;
 	}
 
 	return 0;
@@ -120,6 +124,7 @@ tuple_format_hash(struct tuple_format *format)
 		TUPLE_FIELD_MEMBER_HASH(f, coll_id, h, carry, size)
 		TUPLE_FIELD_MEMBER_HASH(f, nullable_action, h, carry, size)
 		TUPLE_FIELD_MEMBER_HASH(f, is_key_part, h, carry, size)
+		TUPLE_FIELD_MEMBER_HASH(f, compression, h, carry, size)
 	}
 #undef TUPLE_FIELD_MEMBER_HASH
 	return PMurHash32_Result(h, carry, size);
@@ -153,6 +158,7 @@ tuple_field_new(void)
 	field->offset_slot = TUPLE_OFFSET_SLOT_NIL;
 	field->coll_id = COLL_NONE;
 	field->nullable_action = ON_CONFLICT_ACTION_NONE;
+	field->compression = COMPRESSION_TYPE_NONE;
 	field->multikey_required_fields = NULL;
 	return field;
 }
@@ -451,6 +457,9 @@ tuple_format_create(struct tuple_format *format, struct key_def * const *keys,
 		}
 		field->coll = coll;
 		field->coll_id = cid;
+		field->compression = fields[i].compression;
+		if (field->compression != COMPRESSION_TYPE_NONE)
+			format->is_compressed = true;
 	}
 
 	int current_slot = 0;
@@ -478,6 +487,21 @@ tuple_format_create(struct tuple_format *format, struct key_def * const *keys,
 		}
 	}
 
+	/*
+	 * A compressed field is stored as an opaque blob, so
+	 * neither the field nor its JSON paths can be indexed.
+	 */
+	for (uint32_t i = 0; format->is_compressed && i < field_count; ++i) {
+		struct tuple_field *field = tuple_format_field(format, i);
+		if (field->compression != COMPRESSION_TYPE_NONE &&
+		    (field->is_key_part || !json_token_is_leaf(&field->token))) {
+			diag_set(ClientError, ER_WRONG_SPACE_FORMAT,
+				 i + TUPLE_INDEX_BASE,
+				 "compressed field can't be indexed");
+			return -1;
+		}
+	}
+
 	assert(tuple_format_field(format, 0)->offset_slot == TUPLE_OFFSET_SLOT_NIL
 	       || json_token_is_multikey(&tuple_format_field(format, 0)->token));
 	size_t field_map_size = -current_slot * sizeof(uint32_t);
@@ -676,6 +700,8 @@ tuple_format_alloc(struct key_def * const *keys, uint16_t key_count,
 	format->exact_field_count = 0;
 	format->min_field_count = 0;
 	format->epoch = 0;
+	format->is_compressed = false;
+	format->decompressed_format = NULL;
 	return format;
 error:
 	tuple_format_destroy_fields(format);
@@ -765,6 +791,8 @@ tuple_format_delete(struct tuple_format *format)
 {
 	tuple_format_remove_from_hash(format);
 	tuple_format_deregister(format);
+	if (format->decompressed_format != NULL)
+		tuple_format_unref(format->decompressed_format);
 	tuple_format_destroy(format);
 	free(format);
 }
@@ -1166,10 +1194,13 @@ tuple_format_iterator_next(struct tuple_format_iterator *it,
 	}
 	/*
 	 * Check if field mp_type is compatible with type
-	 * defined in format.
+	 * defined in format. Compressed values are checked
+	 * when they are stored, see tuple_compress_raw().
 	 */
 	bool is_nullable = tuple_field_is_nullable(field);
-	if (!field_mp_type_is_compatible(field->type, entry->data, is_nullable) != 0) {
+	if (!(field->compression != COMPRESSION_TYPE_NONE &&
+	      mp_is_compressed(entry->data)) &&
+	    !field_mp_type_is_compatible(field->type, entry->data, is_nullable) != 0) {
 		diag_set(ClientError, ER_FIELD_TYPE,
 			 tuple_field_path(field),
 			 field_type_strs[field->type]);
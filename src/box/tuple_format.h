@@ -134,6 +134,8 @@ struct tuple_field {
 	struct coll *coll;
 	/** Collation identifier. */
 	uint32_t coll_id;
+	/** Compression of the field value in stored tuples. */
+	enum compression_type compression;
 	/**
 	 * Bitmap of fields that must be present in a tuple
 	 * conforming to the multikey subtree. Not NULL only
@@ -193,6 +195,14 @@ struct tuple_format {
 	 * be shared with other ephemeral spaces.
 	 */
 	bool is_ephemeral;
+	/** True if at least one field of the format is compressed. */
+	bool is_compressed;
+	/**
+	 * Runtime format of decompressed copies of tuples of
+	 * this format. Shares the dictionary with this format.
+	 * Created on demand, see tuple_decompress().
+	 */
+	struct tuple_format *decompressed_format;
 	/**
 	 * Size of minimal field map of tuple where each indexed
 	 * field has own offset slot (in bytes). The real tuple
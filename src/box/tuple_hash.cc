@@ -183,15 +183,83 @@ struct TupleHash<FIELD_TYPE_UNSIGNED> {
 	}
 };
 
+/**
+ * Tuple hasher for fields which do not follow each other.
+ * Each field is looked up by its number taken from the key
+ * definition, while the field types are known in advance.
+ */
+template <int TYPE, int ...MORE_TYPES> struct TupleFieldHashAny { };
+
+template <int TYPE, int TYPE2, int ...MORE_TYPES>
+struct TupleFieldHashAny<TYPE, TYPE2, MORE_TYPES...> {
+	static void hash(struct tuple_format *format, const char *data,
+			 const uint32_t *field_map,
+			 const struct key_part *part, uint32_t *ph,
+			 uint32_t *pcarry, uint32_t *ptotal_size)
+	{
+		TupleFieldHashAny<TYPE>::hash(format, data, field_map, part,
+					      ph, pcarry, ptotal_size);
+		TupleFieldHashAny<TYPE2, MORE_TYPES...>::
+			hash(format, data, field_map, part + 1,
+			     ph, pcarry, ptotal_size);
+	}
+};
+
+template <int TYPE>
+struct TupleFieldHashAny<TYPE> {
+	static void hash(struct tuple_format *format, const char *data,
+			 const uint32_t *field_map,
+			 const struct key_part *part, uint32_t *ph,
+			 uint32_t *pcarry, uint32_t *ptotal_size)
+	{
+		const char *field = tuple_field_raw(format, data, field_map,
+						    part->fieldno);
+		*ptotal_size += field_hash<TYPE>(ph, pcarry, &field);
+	}
+};
+
+template <int TYPE, int ...MORE_TYPES>
+struct TupleHashAny
+{
+	static uint32_t hash(struct tuple *tuple, struct key_def *key_def)
+	{
+		assert(!key_def->is_multikey);
+		assert(key_def->part_count == 1 + sizeof...(MORE_TYPES));
+		uint32_t h = HASH_SEED;
+		uint32_t carry = 0;
+		uint32_t total_size = 0;
+		TupleFieldHashAny<TYPE, MORE_TYPES...>::
+			hash(tuple_format(tuple), tuple_data(tuple),
+			     tuple_field_map(tuple), key_def->parts,
+			     &h, &carry, &total_size);
+		return PMurHash32_Result(h, carry, total_size);
+	}
+};
+
+/**
+ * A single field is always sequential, but keep the hash
+ * consistent with KeyHash<FIELD_TYPE_UNSIGNED> anyway.
+ */
+template <>
+struct TupleHashAny<FIELD_TYPE_UNSIGNED> {
+	static uint32_t	hash(struct tuple *tuple, struct key_def *key_def)
+	{
+		return TupleHash<FIELD_TYPE_UNSIGNED>::hash(tuple, key_def);
+	}
+};
+
 }; /* namespace { */
 
 #define HASHER(...) \
 	{ KeyHash<__VA_ARGS__>::hash, TupleHash<__VA_ARGS__>::hash, \
-		{ __VA_ARGS__, UINT32_MAX } },
+		TupleHashAny<__VA_ARGS__>::hash, { __VA_ARGS__, UINT32_MAX } },
 
 struct hasher_signature {
 	key_hash_t kf;
+	/** Tuple hasher for sequential fields. */
 	tuple_hash_t tf;
+	/** Tuple hasher for fields located anywhere. */
+	tuple_hash_t tf_any;
 	uint32_t p[64];
 };
 
@@ -201,18 +269,43 @@ struct hasher_signature {
 static const hasher_signature hash_arr[] = {
 	HASHER(FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_INTEGER)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED)
+	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
+	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING)
 	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
 	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING  , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER , FIELD_TYPE_STRING)
+	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_UNSIGNED, FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_STRING  , FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
+	HASHER(FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER , FIELD_TYPE_INTEGER)
 };
 
 #undef HASHER
@@ -226,6 +319,7 @@ key_hash_slowpath(const char *key, struct key_def *key_def);
 
 void
 key_def_set_hash_func(struct key_def *key_def) {
+	bool is_sequential = true;
 	if (key_def->is_nullable || key_def->has_json_paths)
 		goto slowpath;
 	/*
@@ -235,7 +329,7 @@ key_def_set_hash_func(struct key_def *key_def) {
 	for (uint32_t i = 1; i < key_def->part_count; i++) {
 		if (key_def->parts[i - 1].fieldno + 1 !=
 		    key_def->parts[i].fieldno)
-			goto slowpath;
+			is_sequential = false;
 	}
 	if (key_def_has_collation(key_def)) {
 		/* Precalculated comparators don't use collation */
@@ -253,7 +347,9 @@ key_def_set_hash_func(struct key_def *key_def) {
 			}
 		}
 		if (i == key_def->part_count && hash_arr[k].p[i] == UINT32_MAX){
-			key_def->tuple_hash = hash_arr[k].tf;
+			key_def->tuple_hash = is_sequential ?
+					      hash_arr[k].tf :
+					      hash_arr[k].tf_any;
 			key_def->key_hash = hash_arr[k].kf;
 			return;
 		}
@@ -295,11 +295,32 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_append_int(h, "tx", vy_tx_manager_mem_used(env->xm));
 	info_append_int(h, "level0", lsregion_used(&env->mem_env.allocator));
 	info_append_int(h, "tuple_cache", env->cache_env.mem_used);
+	info_append_int(h, "page_cache", env->run_env.page_cache.mem_used);
 	info_append_int(h, "page_index", env->lsm_env.page_index_size);
 	info_append_int(h, "bloom_filter", env->lsm_env.bloom_size);
 	info_table_end(h); /* memory */
 }
 
+static void
+vy_info_append_page_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_page_cache *cache = &env->run_env.page_cache;
+	info_table_begin(h, "page_cache");
+	info_append_int(h, "hit", cache->hit);
+	info_append_int(h, "miss", cache->miss);
+	info_table_end(h); /* page_cache */
+}
+
+static void
+vy_info_append_readahead(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_run_env *run_env = &env->run_env;
+	info_table_begin(h, "readahead");
+	info_append_int(h, "pages", run_env->readahead_pages);
+	info_append_int(h, "wasted", run_env->readahead_wasted);
+	info_table_end(h); /* readahead */
+}
+
 static void
 vy_info_append_disk(struct vy_env *env, struct info_handler *h)
 {
@@ -318,6 +339,8 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *h)
 	info_begin(h);
 	vy_info_append_tx(env, h);
 	vy_info_append_memory(env, h);
+	vy_info_append_page_cache(env, h);
+	vy_info_append_readahead(env, h);
 	vy_info_append_disk(env, h);
 	vy_info_append_scheduler(env, h);
 	vy_info_append_regulator(env, h);
@@ -582,6 +605,13 @@ vinyl_engine_check_space_def(struct space_def *def)
 			 def->name, "engine does not support temporary flag");
 		return -1;
 	}
+	for (uint32_t i = 0; i < def->field_count; i++) {
+		if (def->fields[i].compression != COMPRESSION_TYPE_NONE) {
+			diag_set(ClientError, ER_ALTER_SPACE, def->name,
+				 "engine does not support field compression");
+			return -1;
+		}
+	}
 	return 0;
 }
 
@@ -1253,25 +1283,21 @@ vy_is_committed(struct vy_env *env, struct vy_lsm *lsm)
 }
 
 /**
- * Get a full tuple by a tuple read from a secondary index.
+ * Make a primary key to look up the full tuple corresponding
+ * to a tuple read from a secondary index.
  * @param lsm         LSM tree from which the tuple was read.
- * @param tx          Current transaction.
- * @param rv          Read view.
  * @param entry       Tuple read from a secondary index.
- * @param[out] result The found tuple is stored here. Must be
+ * @param[out] key    The primary key is stored here. Must be
  *                    unreferenced after usage.
  *
  * @param  0 Success.
- * @param -1 Memory error or read error.
+ * @param -1 Memory error.
  */
 static int
-vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
-			  const struct vy_read_view **rv,
-			  struct vy_entry entry, struct vy_entry *result)
+vy_get_by_secondary_tuple_prepare(struct vy_lsm *lsm, struct vy_entry entry,
+				  struct vy_entry *key)
 {
-	int rc = 0;
 	assert(lsm->index_id > 0);
-
 	/*
 	 * Lookup the full tuple by a secondary statement.
 	 * There are two cases: the secondary statement may be
@@ -1281,27 +1307,46 @@ vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
 	 * the tuple cache or level 0, in which case we may pass
 	 * it immediately to the iterator.
 	 */
-	struct vy_entry key;
 	if (vy_stmt_is_key(entry.stmt)) {
-		key.stmt = vy_stmt_extract_key(entry.stmt, lsm->pk_in_cmp_def,
-					       lsm->env->key_format,
-					       MULTIKEY_NONE);
-		if (key.stmt == NULL)
+		key->stmt = vy_stmt_extract_key(entry.stmt,
+						lsm->pk_in_cmp_def,
+						lsm->env->key_format,
+						MULTIKEY_NONE);
+		if (key->stmt == NULL)
 			return -1;
 	} else {
-		key.stmt = entry.stmt;
-		tuple_ref(key.stmt);
+		key->stmt = entry.stmt;
+		tuple_ref(key->stmt);
 	}
-	key.hint = vy_stmt_hint(key.stmt, lsm->pk->cmp_def);
-
+	key->hint = vy_stmt_hint(key->stmt, lsm->pk->cmp_def);
 	lsm->pk->stat.lookup++;
+	return 0;
+}
 
-	struct vy_entry pk_entry;
-	if (vy_point_lookup(lsm->pk, tx, rv, key, &pk_entry) != 0) {
-		rc = -1;
-		goto out;
-	}
-
+/**
+ * Check a tuple found in the primary index by the key returned
+ * by vy_get_by_secondary_tuple_prepare() and, if it matches the
+ * tuple read from the secondary index, track and cache it.
+ * @param lsm         LSM tree from which the tuple was read.
+ * @param tx          Current transaction.
+ * @param rv          Read view.
+ * @param entry       Tuple read from a secondary index.
+ * @param key         Primary key used for the lookup.
+ * @param pk_entry    Tuple found in the primary index. The
+ *                    function takes the reference.
+ * @param[out] result The found tuple is stored here. Must be
+ *                    unreferenced after usage.
+ *
+ * @param  0 Success.
+ * @param -1 Memory error.
+ */
+static int
+vy_get_by_secondary_tuple_finish(struct vy_lsm *lsm, struct vy_tx *tx,
+				 const struct vy_read_view **rv,
+				 struct vy_entry entry, struct vy_entry key,
+				 struct vy_entry pk_entry,
+				 struct vy_entry *result)
+{
 	bool match = false;
 	struct vy_entry full_entry;
 	if (pk_entry.stmt != NULL) {
@@ -1336,7 +1381,7 @@ vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
 		 */
 		vy_cache_on_write(&lsm->cache, entry, NULL);
 		*result = vy_entry_none();
-		goto out;
+		return 0;
 	}
 
 	/*
@@ -1349,8 +1394,7 @@ vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
 	 */
 	if (tx != NULL && vy_tx_track_point(tx, lsm->pk, pk_entry) != 0) {
 		tuple_unref(pk_entry.stmt);
-		rc = -1;
-		goto out;
+		return -1;
 	}
 
 	if ((*rv)->vlsn == INT64_MAX) {
@@ -1360,11 +1404,120 @@ vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
 
 	vy_stmt_counter_acct_tuple(&lsm->pk->stat.get, pk_entry.stmt);
 	*result = full_entry;
-out:
+	return 0;
+}
+
+/**
+ * Get a full tuple by a tuple read from a secondary index.
+ * @param lsm         LSM tree from which the tuple was read.
+ * @param tx          Current transaction.
+ * @param rv          Read view.
+ * @param entry       Tuple read from a secondary index.
+ * @param[out] result The found tuple is stored here. Must be
+ *                    unreferenced after usage.
+ *
+ * @param  0 Success.
+ * @param -1 Memory error or read error.
+ */
+static int
+vy_get_by_secondary_tuple(struct vy_lsm *lsm, struct vy_tx *tx,
+			  const struct vy_read_view **rv,
+			  struct vy_entry entry, struct vy_entry *result)
+{
+	struct vy_entry key;
+	if (vy_get_by_secondary_tuple_prepare(lsm, entry, &key) != 0)
+		return -1;
+	int rc = 0;
+	struct vy_entry pk_entry;
+	if (vy_point_lookup(lsm->pk, tx, rv, key, &pk_entry) != 0)
+		rc = -1;
+	else
+		rc = vy_get_by_secondary_tuple_finish(lsm, tx, rv, entry, key,
+						      pk_entry, result);
 	tuple_unref(key.stmt);
 	return rc;
 }
 
+/**
+ * Replace tuples read from a secondary index with the full
+ * tuples corresponding to them. All full tuples are looked up
+ * in the primary index at once, see vy_point_lookup_many().
+ * @param lsm         LSM tree from which the tuples were read.
+ * @param tx          Current transaction.
+ * @param rv          Read view.
+ * @param[in,out] entries Tuples read from a secondary index,
+ *                    replaced with full tuples or nothing if
+ *                    there's no matching full tuple.
+ * @param count       Number of entries.
+ *
+ * @param  0 Success.
+ * @param -1 Memory error or read error. All entries are
+ *           unreferenced and cleared in this case.
+ */
+static int
+vy_get_many_by_secondary_tuples(struct vy_lsm *lsm, struct vy_tx *tx,
+				const struct vy_read_view **rv,
+				struct vy_entry *entries, int count)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	struct vy_entry *keys =
+		region_alloc_array(region, typeof(keys[0]), count, &size);
+	struct vy_entry *pk_entries =
+		region_alloc_array(region, typeof(pk_entries[0]), count,
+				   &size);
+	int *pos = region_alloc_array(region, typeof(pos[0]), count, &size);
+	int rc = 0;
+	int key_count = 0;
+	if (keys == NULL || pk_entries == NULL || pos == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "keys");
+		rc = -1;
+		goto out;
+	}
+	for (int i = 0; i < count; i++) {
+		if (entries[i].stmt == NULL)
+			continue;
+		rc = vy_get_by_secondary_tuple_prepare(lsm, entries[i],
+						       &keys[key_count]);
+		if (rc != 0)
+			break;
+		pos[key_count++] = i;
+	}
+	if (rc == 0 && vy_point_lookup_many(lsm->pk, tx, rv, keys, key_count,
+					    pk_entries) == 0) {
+		for (int j = 0; j < key_count; j++) {
+			struct vy_entry *entry = &entries[pos[j]];
+			if (rc != 0) {
+				if (pk_entries[j].stmt != NULL)
+					tuple_unref(pk_entries[j].stmt);
+				continue;
+			}
+			struct vy_entry partial = *entry;
+			*entry = vy_entry_none();
+			rc = vy_get_by_secondary_tuple_finish(lsm, tx, rv,
+							      partial, keys[j],
+							      pk_entries[j],
+							      entry);
+			tuple_unref(partial.stmt);
+		}
+	} else {
+		rc = -1;
+	}
+	for (int j = 0; j < key_count; j++)
+		tuple_unref(keys[j].stmt);
+out:
+	if (rc != 0) {
+		for (int i = 0; i < count; i++) {
+			if (entries[i].stmt != NULL)
+				tuple_unref(entries[i].stmt);
+			entries[i] = vy_entry_none();
+		}
+	}
+	region_truncate(region, region_svp);
+	return rc;
+}
+
 /**
  * Get a tuple from a vinyl space by key.
  * @param lsm         LSM tree in which search.
@@ -1485,6 +1638,80 @@ vy_get_by_raw_key(struct vy_lsm *lsm, struct vy_tx *tx,
 	return rc;
 }
 
+/**
+ * Get tuples from a vinyl space by full keys. Works like vy_get()
+ * called for each key, but looks up all keys at once so that
+ * disk reads are shared and issued in parallel.
+ * @param lsm         LSM tree in which search.
+ * @param tx          Current transaction.
+ * @param rv          Read view.
+ * @param keys        Array of full keys.
+ * @param key_count   Number of keys.
+ * @param[out] result The tuple found by the i-th key is stored
+ *                    in result[i], or NULL if there's no such
+ *                    tuple. Must be unreferenced after usage.
+ *
+ * @param  0 Success.
+ * @param -1 Memory error or read error.
+ */
+static int
+vy_get_many(struct vy_lsm *lsm, struct vy_tx *tx,
+	    const struct vy_read_view **rv,
+	    const struct vy_entry *keys, int key_count,
+	    struct tuple **result)
+{
+	double start_time = ev_monotonic_now(loop());
+	assert(tx == NULL || tx->state == VINYL_TX_READY);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	struct vy_entry *entries =
+		region_alloc_array(region, typeof(entries[0]), key_count,
+				   &size);
+	if (entries == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "entries");
+		return -1;
+	}
+
+	lsm->stat.lookup += key_count;
+
+	for (int i = 0; i < key_count; i++) {
+		assert(vy_stmt_is_full_key(keys[i].stmt, lsm->cmp_def));
+		if (tx != NULL && vy_tx_track_point(tx, lsm, keys[i]) != 0)
+			goto fail;
+	}
+	if (vy_point_lookup_many(lsm, tx, rv, keys, key_count, entries) != 0)
+		goto fail;
+	if (lsm->index_id > 0 &&
+	    vy_get_many_by_secondary_tuples(lsm, tx, rv, entries,
+					    key_count) != 0)
+		goto fail;
+	for (int i = 0; i < key_count; i++) {
+		if ((*rv)->vlsn == INT64_MAX) {
+			vy_cache_add(&lsm->cache, entries[i],
+				     vy_entry_none(), keys[i], ITER_EQ);
+		}
+		result[i] = entries[i].stmt;
+		if (result[i] != NULL)
+			vy_stmt_counter_acct_tuple(&lsm->stat.get, result[i]);
+	}
+	region_truncate(region, region_svp);
+
+	double latency = ev_monotonic_now(loop()) - start_time;
+	latency_collect(&lsm->stat.latency, latency);
+
+	if (latency > lsm->env->too_long_threshold) {
+		say_warn_ratelimited("%s: get_many(%d keys) "
+				     "took too long: %.3f sec",
+				     vy_lsm_name(lsm), key_count, latency);
+	}
+	return 0;
+fail:
+	region_truncate(region, region_svp);
+	return -1;
+}
+
 /**
  * Check if insertion of a new tuple violates unique constraint
  * of the primary index.
@@ -2686,6 +2913,20 @@ vinyl_engine_set_cache(struct engine *engine, size_t quota)
 	vy_cache_env_set_quota(&env->cache_env, quota);
 }
 
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_page_cache_quota(&env->run_env, quota);
+}
+
+void
+vinyl_engine_set_readahead(struct engine *engine, int pages)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_readahead(&env->run_env, pages);
+}
+
 int
 vinyl_engine_set_memory(struct engine *engine, size_t size)
 {
@@ -2731,6 +2972,13 @@ vinyl_engine_set_snap_io_rate_limit(struct engine *engine, double limit)
 	vy_regulator_reset_dump_bandwidth(&env->regulator, limit_in_bytes);
 }
 
+void
+vinyl_engine_set_zdict_size(struct engine *engine, size_t size)
+{
+	struct vy_env *env = vy_env(engine);
+	env->run_env.zdict_size = size;
+}
+
 /** }}} Environment */
 
 /* {{{ Checkpoint */
@@ -3784,6 +4032,64 @@ vinyl_index_get(struct index *index, const char *key,
 	return 0;
 }
 
+static int
+vinyl_index_get_many(struct index *index, const char *keys,
+		     uint32_t key_count, struct tuple **ret)
+{
+	assert(index->def->opts.is_unique);
+
+	struct vy_lsm *lsm = vy_lsm(index);
+	struct vy_env *env = vy_env(index->engine);
+	struct vy_tx *tx = in_txn() ? in_txn()->engine_tx : NULL;
+	const struct vy_read_view **rv = (tx != NULL ? vy_tx_read_view(tx) :
+					  &env->xm->p_global_read_view);
+
+	if (tx != NULL && tx->state == VINYL_TX_ABORT) {
+		diag_set(ClientError, ER_TRANSACTION_CONFLICT);
+		return -1;
+	}
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	struct vy_entry *key_entries =
+		region_alloc_array(region, typeof(key_entries[0]), key_count,
+				   &size);
+	if (key_entries == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "keys");
+		return -1;
+	}
+	int rc = 0;
+	uint32_t i;
+	for (i = 0; i < key_count; i++) {
+		uint32_t part_count = mp_decode_array(&keys);
+		assert(index->def->key_def->part_count == part_count);
+		struct tuple *key = vy_key_new(env->key_format,
+					       keys, part_count);
+		if (key == NULL) {
+			rc = -1;
+			break;
+		}
+		key_entries[i].stmt = key;
+		key_entries[i].hint = vy_stmt_hint(key, lsm->cmp_def);
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&keys);
+	}
+	if (rc == 0) {
+		/*
+		 * Make sure the LSM tree isn't deleted while we are
+		 * reading from it.
+		 */
+		vy_lsm_ref(lsm);
+		rc = vy_get_many(lsm, tx, rv, key_entries, key_count, ret);
+		vy_lsm_unref(lsm);
+	}
+	for (uint32_t j = 0; j < i; j++)
+		tuple_unref(key_entries[j].stmt);
+	region_truncate(region, region_svp);
+	return rc;
+}
+
 /*** }}} Cursor */
 
 /* {{{ Index build */
@@ -4576,8 +4882,11 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ generic_index_count,
 	/* .get = */ vinyl_index_get,
+	/* .get_many = */ vinyl_index_get_many,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		vinyl_index_create_snapshot_iterator,
 	/* .stat = */ vinyl_index_stat,
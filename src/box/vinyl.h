@@ -57,6 +57,18 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *handler);
 void
 vinyl_engine_set_cache(struct engine *engine, size_t quota);
 
+/**
+ * Update vinyl page cache size.
+ */
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota);
+
+/**
+ * Update the number of pages read ahead on sequential scans.
+ */
+void
+vinyl_engine_set_readahead(struct engine *engine, int pages);
+
 /**
  * Update vinyl memory size.
  */
@@ -88,6 +100,13 @@ vinyl_engine_set_too_long_threshold(struct engine *engine,
 void
 vinyl_engine_set_snap_io_rate_limit(struct engine *engine, double limit);
 
+/**
+ * Update the size of a zstd dictionary trained for compression
+ * of runs.
+ */
+void
+vinyl_engine_set_zdict_size(struct engine *engine, size_t size);
+
 #ifdef __cplusplus
 } /* extern "C" */
 
@@ -279,6 +279,8 @@ vy_lsm_delete(struct vy_lsm *lsm)
 	if (lsm->pk_in_cmp_def != NULL)
 		key_def_delete(lsm->pk_in_cmp_def);
 	histogram_delete(lsm->run_hist);
+	if (lsm->zdict != NULL)
+		xlog_zdict_unref(lsm->zdict);
 	vy_lsm_stat_destroy(&lsm->stat);
 	vy_cache_destroy(&lsm->cache);
 	tuple_format_unref(lsm->mem_format);
@@ -60,6 +60,7 @@ struct vy_mem_env;
 struct vy_recovery;
 struct vy_run;
 struct vy_run_env;
+struct xlog_zdict;
 
 typedef void
 (*vy_upsert_thresh_cb)(struct vy_lsm *lsm, struct vy_entry entry, void *arg);
@@ -255,6 +256,12 @@ struct vy_lsm {
 	 * linked by vy_run->in_lsm.
 	 */
 	struct rlist runs;
+	/**
+	 * zstd dictionary to compress the next run with,
+	 * trained on the data of the last written run.
+	 * NULL if there's none.
+	 */
+	struct xlog_zdict *zdict;
 	/** Number of entries in all ranges. */
 	int run_count;
 	/**
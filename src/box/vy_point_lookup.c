@@ -36,6 +36,7 @@
 
 #include <small/region.h>
 #include <small/rlist.h>
+#include <third_party/qsort_arg.h>
 
 #include "fiber.h"
 
@@ -296,6 +297,274 @@ done:
 	return 0;
 }
 
+/** State of a key looked up by vy_point_lookup_many(). */
+struct vy_point_lookup_key {
+	/** Key to look up. */
+	struct vy_entry key;
+	/** Statements found in the transaction write set and cache. */
+	struct vy_history history;
+	/** Statements found in memory. */
+	struct vy_history mem_history;
+	/** Statements found on disk. */
+	struct vy_history disk_history;
+};
+
+static int
+vy_point_lookup_key_cmp(const void *a, const void *b, void *arg)
+{
+	const struct vy_point_lookup_key *k1 =
+		*(const struct vy_point_lookup_key **)a;
+	const struct vy_point_lookup_key *k2 =
+		*(const struct vy_point_lookup_key **)b;
+	return vy_entry_compare(k1->key, k2->key, (struct key_def *)arg);
+}
+
+/**
+ * Scan all slices of a range for keys that belong to the range.
+ * Slices are scanned one by one, newest first. For each slice,
+ * pages needed by all keys whose history isn't terminal yet are
+ * read in parallel, see vy_run_iterator_prefetch().
+ */
+static int
+vy_point_lookup_scan_slices_many(struct vy_lsm *lsm,
+				 const struct vy_read_view **rv,
+				 struct vy_range *range,
+				 struct vy_point_lookup_key **keys,
+				 int key_count)
+{
+	struct region *region = &fiber()->gc;
+	int slice_count = range->slice_count;
+	size_t size;
+	struct vy_slice **slices =
+		region_alloc_array(region, typeof(slices[0]), slice_count,
+				   &size);
+	if (slices == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "slices");
+		return -1;
+	}
+	struct vy_run_iterator *itrs =
+		region_alloc_array(region, typeof(itrs[0]), key_count, &size);
+	if (itrs == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "itrs");
+		return -1;
+	}
+	struct vy_point_lookup_key **itr_keys =
+		region_alloc_array(region, typeof(itr_keys[0]), key_count,
+				   &size);
+	if (itr_keys == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "itr_keys");
+		return -1;
+	}
+	int i = 0;
+	struct vy_slice *slice;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		vy_slice_pin(slice);
+		slices[i++] = slice;
+	}
+	assert(i == slice_count);
+	int rc = 0;
+	for (i = 0; i < slice_count; i++) {
+		int itr_count = 0;
+		for (int j = 0; rc == 0 && j < key_count; j++) {
+			struct vy_point_lookup_key *k = keys[j];
+			if (vy_history_is_terminal(&k->disk_history))
+				continue;
+			vy_run_iterator_open(&itrs[itr_count],
+					     &lsm->stat.disk.iterator,
+					     slices[i], ITER_EQ, k->key, rv,
+					     lsm->cmp_def, lsm->key_def,
+					     lsm->disk_format);
+			itr_keys[itr_count++] = k;
+		}
+		vy_run_iterator_prefetch(itrs, itr_count);
+		for (int j = 0; j < itr_count; j++) {
+			if (rc == 0) {
+				struct vy_history slice_history;
+				vy_history_create(&slice_history,
+						  &lsm->env->history_node_pool);
+				rc = vy_run_iterator_next(&itrs[j],
+							  &slice_history);
+				vy_history_splice(&itr_keys[j]->disk_history,
+						  &slice_history);
+			}
+			vy_run_iterator_close(&itrs[j]);
+		}
+		vy_slice_unpin(slices[i]);
+	}
+	return rc;
+}
+
+/**
+ * Look up sorted keys on disk. Keys falling in the same range
+ * go one after another and are looked up together.
+ */
+static int
+vy_point_lookup_scan_disk_many(struct vy_lsm *lsm,
+			       const struct vy_read_view **rv,
+			       struct vy_point_lookup_key **keys,
+			       int key_count)
+{
+	int begin = 0;
+	while (begin < key_count) {
+		struct vy_range *range;
+		range = vy_range_tree_find_by_key(&lsm->range_tree, ITER_EQ,
+						  keys[begin]->key);
+		assert(range != NULL);
+		int end = begin + 1;
+		while (end < key_count &&
+		       (range->end.stmt == NULL ||
+			vy_entry_compare(keys[end]->key, range->end,
+					 lsm->cmp_def) < 0))
+			end++;
+		if (vy_point_lookup_scan_slices_many(lsm, rv, range,
+						     keys + begin,
+						     end - begin) != 0)
+			return -1;
+		begin = end;
+	}
+	return 0;
+}
+
+int
+vy_point_lookup_many(struct vy_lsm *lsm, struct vy_tx *tx,
+		     const struct vy_read_view **rv,
+		     const struct vy_entry *keys, int key_count,
+		     struct vy_entry *ret)
+{
+	assert(tx == NULL || tx->state == VINYL_TX_READY);
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	struct vy_point_lookup_key *lookups =
+		region_alloc_array(region, typeof(lookups[0]), key_count,
+				   &size);
+	if (lookups == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "lookups");
+		return -1;
+	}
+	/* Keys that have to be looked up in memory and on disk. */
+	struct vy_point_lookup_key **pending =
+		region_alloc_array(region, typeof(pending[0]), key_count,
+				   &size);
+	/* Keys that have to be looked up on disk. */
+	struct vy_point_lookup_key **disk =
+		region_alloc_array(region, typeof(disk[0]), key_count, &size);
+	if (pending == NULL || disk == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "keys");
+		region_truncate(region, region_svp);
+		return -1;
+	}
+
+	int rc = 0;
+	int pending_count = 0;
+	int disk_count = 0;
+	uint32_t mem_version, mem_list_version;
+	for (int i = 0; i < key_count; i++) {
+		struct vy_point_lookup_key *k = &lookups[i];
+		/* All key parts must be set for a point lookup. */
+		assert(vy_stmt_is_full_key(keys[i].stmt, lsm->cmp_def));
+		k->key = keys[i];
+		vy_history_create(&k->history, &lsm->env->history_node_pool);
+		vy_history_create(&k->mem_history,
+				  &lsm->env->history_node_pool);
+		vy_history_create(&k->disk_history,
+				  &lsm->env->history_node_pool);
+		ret[i] = vy_entry_none();
+		if (rc != 0)
+			continue;
+		rc = vy_point_lookup_scan_txw(lsm, tx, k->key, &k->history);
+		if (rc != 0 || vy_history_is_terminal(&k->history))
+			continue;
+		rc = vy_point_lookup_scan_cache(lsm, rv, k->key, &k->history);
+		if (rc != 0 || vy_history_is_terminal(&k->history))
+			continue;
+		pending[pending_count++] = k;
+	}
+	if (rc != 0)
+		goto done;
+
+	/*
+	 * Sort the keys so that keys stored next to each other
+	 * on disk are looked up together.
+	 */
+	qsort_arg(pending, pending_count, sizeof(pending[0]),
+		  vy_point_lookup_key_cmp, lsm->cmp_def);
+restart:
+	disk_count = 0;
+	for (int i = 0; i < pending_count; i++) {
+		struct vy_point_lookup_key *k = pending[i];
+		vy_history_cleanup(&k->mem_history);
+		vy_history_cleanup(&k->disk_history);
+		rc = vy_point_lookup_scan_mems(lsm, rv, k->key,
+					       &k->mem_history);
+		if (rc != 0)
+			goto done;
+		if (!vy_history_is_terminal(&k->mem_history))
+			disk[disk_count++] = k;
+	}
+
+	/* Save version before yield */
+	mem_version = lsm->mem->version;
+	mem_list_version = lsm->mem_list_version;
+
+	rc = vy_point_lookup_scan_disk_many(lsm, rv, disk, disk_count);
+	if (rc != 0)
+		goto done;
+
+	if (tx != NULL && tx->state == VINYL_TX_ABORT) {
+		/* See the comment in vy_point_lookup(). */
+		diag_set(ClientError, ER_TRANSACTION_CONFLICT);
+		rc = -1;
+		goto done;
+	}
+
+	/*
+	 * Reread the memory level if it changed while we were
+	 * reading disk, see vy_point_lookup().
+	 */
+	if (mem_list_version != lsm->mem_list_version)
+		goto restart;
+
+	if (mem_version != lsm->mem->version) {
+		for (int i = 0; i < disk_count; i++) {
+			struct vy_point_lookup_key *k = disk[i];
+			vy_history_cleanup(&k->mem_history);
+			rc = vy_point_lookup_scan_mems(lsm, rv, k->key,
+						       &k->mem_history);
+			if (rc != 0)
+				goto done;
+			if (vy_history_is_terminal(&k->mem_history))
+				vy_history_cleanup(&k->disk_history);
+		}
+	}
+
+done:
+	for (int i = 0; i < key_count; i++) {
+		struct vy_point_lookup_key *k = &lookups[i];
+		vy_history_splice(&k->history, &k->mem_history);
+		vy_history_splice(&k->history, &k->disk_history);
+		if (rc == 0) {
+			int upserts_applied;
+			rc = vy_history_apply(&k->history, lsm->cmp_def,
+					      false, &upserts_applied, &ret[i]);
+			lsm->stat.upsert.applied += upserts_applied;
+		}
+		vy_history_cleanup(&k->history);
+	}
+	region_truncate(region, region_svp);
+
+	if (rc != 0) {
+		for (int i = 0; i < key_count; i++) {
+			if (ret[i].stmt != NULL)
+				tuple_unref(ret[i].stmt);
+			ret[i] = vy_entry_none();
+		}
+		return -1;
+	}
+	return 0;
+}
+
 int
 vy_point_lookup_mem(struct vy_lsm *lsm, const struct vy_read_view **rv,
 		    struct vy_entry key, struct vy_entry *ret)
@@ -70,6 +70,23 @@ vy_point_lookup(struct vy_lsm *lsm, struct vy_tx *tx,
 		const struct vy_read_view **rv,
 		struct vy_entry key, struct vy_entry *ret);
 
+/**
+ * Look up tuples by several keys at once. Works like calling
+ * vy_point_lookup() for each key, but looks up the keys on disk
+ * together: the keys are sorted and, for each run, bloom filters
+ * are checked and the pages needed by all keys are read by reader
+ * threads in parallel, each page only once.
+ *
+ * The tuple found by @keys[i] is returned in @ret[i] with its
+ * reference counter elevated or set to vy_entry_none() if the key
+ * isn't found. On failure, no tuples are returned.
+ */
+int
+vy_point_lookup_many(struct vy_lsm *lsm, struct vy_tx *tx,
+		     const struct vy_read_view **rv,
+		     const struct vy_entry *keys, int key_count,
+		     struct vy_entry *ret);
+
 /**
  * Look up a tuple by key in memory.
  *
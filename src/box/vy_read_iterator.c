@@ -79,6 +79,14 @@ vy_read_iterator_reserve(struct vy_read_iterator *itr, uint32_t capacity)
 		vy_history_create(&new_src[i].history,
 				  &itr->lsm->env->history_node_pool);
 		vy_history_splice(&new_src[i].history, &itr->src[i].history);
+		if (i >= itr->disk_src) {
+			/* Move pages read ahead by the run iterator. */
+			struct rlist *readahead =
+				&new_src[i].run_iterator.readahead;
+			rlist_create(readahead);
+			rlist_splice(readahead,
+				     &itr->src[i].run_iterator.readahead);
+		}
 	}
 	free(itr->src);
 	itr->src = new_src;
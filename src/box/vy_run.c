@@ -85,6 +85,8 @@ struct vy_run_reader {
 	struct cpipe reader_pipe;
 	/** Pipe from the reader thread to tx. */
 	struct cpipe tx_pipe;
+	/** Route for reading a page ahead and returning it to tx. */
+	struct cmsg_hop readahead_route[2];
 };
 
 /** Cbus task for vinyl page read. */
@@ -111,6 +113,55 @@ struct vy_page_read_task {
 	struct vy_page *page;
 };
 
+/**
+ * Page read by a reader thread without blocking the fiber that
+ * requested it. Used for reading pages ahead of a run iterator,
+ * see vy_run_iterator_readahead(), and for reading pages needed
+ * by a batch of point lookups, see vy_run_iterator_prefetch().
+ */
+struct vy_page_readahead {
+	/** Message sent to the reader thread and back to tx. */
+	struct cmsg cmsg;
+	/** Run the page is read from. Referenced. */
+	struct vy_run *run;
+	/** Number of the page in the run. */
+	uint32_t page_no;
+	/** Page metadata. */
+	struct vy_page_info *page_info;
+	/** Page being read. */
+	struct vy_page *page;
+	/** Set when the page is returned to tx. */
+	bool is_done;
+	/** Set if the page couldn't be read. */
+	bool is_failed;
+	/** In case of failure the error is stored here. */
+	struct diag diag;
+	/**
+	 * Set if the iterator doesn't need the page anymore.
+	 * Such a page is freed as soon as it is returned to tx.
+	 */
+	bool is_orphan;
+	/** Signaled when the page is returned to tx. */
+	struct fiber_cond cond;
+	/** Link in vy_run_iterator::readahead. */
+	struct rlist in_itr;
+};
+
+static void
+vy_page_readahead_read_f(struct cmsg *cmsg);
+
+static void
+vy_page_readahead_complete_f(struct cmsg *cmsg);
+
+static void
+vy_page_cache_create(struct vy_page_cache *cache);
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache);
+
+static void
+vy_page_cache_evict_run(struct vy_page_cache *cache, struct vy_run *run);
+
 /** Destructor for env->zdctx_key thread-local variable */
 static void
 vy_free_zdctx(void *arg)
@@ -156,6 +207,12 @@ vy_run_env_start_readers(struct vy_run_env *env)
 				 vy_run_reader_f, reader) != 0)
 			panic("failed to start vinyl reader thread");
 		cpipe_create(&reader->reader_pipe, name);
+
+		struct cmsg_hop *route = reader->readahead_route;
+		route[0].f = vy_page_readahead_read_f;
+		route[0].pipe = &reader->tx_pipe;
+		route[1].f = vy_page_readahead_complete_f;
+		route[1].pipe = NULL;
 	}
 	env->next_reader = 0;
 }
@@ -183,6 +240,9 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 	tt_pthread_key_create(&env->zdctx_key, vy_free_zdctx);
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
+	mempool_create(&env->readahead_pool, cord_slab_cache(),
+		       sizeof(struct vy_page_readahead));
+	vy_page_cache_create(&env->page_cache);
 }
 
 /**
@@ -193,6 +253,8 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_page_cache_destroy(&env->page_cache);
+	mempool_destroy(&env->readahead_pool);
 	mempool_destroy(&env->read_task_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
@@ -283,6 +345,7 @@ vy_run_new(struct vy_run_env *env, int64_t id)
 	run->id = id;
 	run->dump_lsn = -1;
 	run->fd = -1;
+	run->format_version = XLOG_FORMAT_V13;
 	run->refs = 1;
 	rlist_create(&run->in_lsm);
 	rlist_create(&run->in_unused);
@@ -315,8 +378,11 @@ void
 vy_run_delete(struct vy_run *run)
 {
 	assert(run->refs == 0);
+	vy_page_cache_evict_run(&run->env->page_cache, run);
 	if (run->fd >= 0 && close(run->fd) < 0)
 		say_syserror("close failed");
+	if (run->zdict != NULL)
+		xlog_zdict_unref(run->zdict);
 	vy_run_clear(run);
 	TRASH(run);
 	free(run);
@@ -679,7 +745,14 @@ vy_run_info_decode(struct vy_run_info *run_info,
 				return -1;
 			break;
 		case VY_RUN_INFO_BLOOM:
-			run_info->bloom = tuple_bloom_decode(&pos);
+			run_info->bloom = tuple_bloom_decode(&pos,
+							BLOOM_TYPE_CLASSIC);
+			if (run_info->bloom == NULL)
+				return -1;
+			break;
+		case VY_RUN_INFO_BLOOM_SPLIT_BLOCK:
+			run_info->bloom = tuple_bloom_decode(&pos,
+							BLOOM_TYPE_SPLIT_BLOCK);
 			if (run_info->bloom == NULL)
 				return -1;
 			break;
@@ -702,6 +775,155 @@ vy_run_info_decode(struct vy_run_info *run_info,
 	return 0;
 }
 
+/* {{{ Key prefix compression */
+
+/*
+ * With key prefix compression enabled, a statement body that
+ * shares a long enough prefix with the body of the previous
+ * statement of the page is stored as
+ *
+ *   {VY_ROW_PREFIX_SIZE: <prefix size>, VY_ROW_PREFIX_SUFFIX: <rest>}
+ *
+ * Statements at restart points, i.e. every restart_interval-th
+ * statement of a page, are always stored in full so that a page
+ * can be searched without restoring every statement.
+ */
+
+static void
+vy_prefix_buf_destroy(struct vy_prefix_buf *buf)
+{
+	free(buf->data);
+	buf->data = NULL;
+	buf->size = buf->capacity = 0;
+}
+
+/**
+ * Replace the body stored in a buffer with the first @a prefix
+ * bytes of it followed by @a suffix.
+ */
+static int
+vy_prefix_buf_set(struct vy_prefix_buf *buf, uint32_t prefix,
+		  const char *suffix, uint32_t suffix_size)
+{
+	assert(prefix <= buf->size);
+	uint32_t size = prefix + suffix_size;
+	if (size > buf->capacity) {
+		uint32_t capacity = MAX(buf->capacity * 2, size);
+		char *data = realloc(buf->data, capacity);
+		if (data == NULL) {
+			diag_set(OutOfMemory, capacity, "realloc",
+				 "statement body");
+			return -1;
+		}
+		buf->data = data;
+		buf->capacity = capacity;
+	}
+	memcpy(buf->data + prefix, suffix, suffix_size);
+	buf->size = size;
+	return 0;
+}
+
+/**
+ * Encode the body of a statement written to a page with key
+ * prefix compression. The body of the previous statement is
+ * stored in @a prev and is replaced with the new one.
+ *
+ * @param xrow       Statement to encode. Its body is replaced
+ *                   with the compressed one allocated on region
+ *                   if it makes the statement smaller.
+ * @param prev       Body of the previous statement.
+ * @param is_restart Set if the statement is a restart point.
+ *
+ * @retval 0 Success.
+ * @retval -1 Memory error.
+ */
+static int
+vy_row_prefix_encode(struct xrow_header *xrow, struct vy_prefix_buf *prev,
+		     bool is_restart)
+{
+	assert(xrow->bodycnt == 1);
+	const char *body = xrow->body[0].iov_base;
+	uint32_t size = xrow->body[0].iov_len;
+	uint32_t prefix = 0;
+	if (!is_restart) {
+		uint32_t max_prefix = MIN(size, prev->size);
+		while (prefix < max_prefix && body[prefix] == prev->data[prefix])
+			prefix++;
+	}
+	if (vy_prefix_buf_set(prev, 0, body, size) != 0)
+		return -1;
+	uint32_t suffix_size = size - prefix;
+	size_t new_size = mp_sizeof_map(2) +
+			  mp_sizeof_uint(VY_ROW_PREFIX_SIZE) +
+			  mp_sizeof_uint(prefix) +
+			  mp_sizeof_uint(VY_ROW_PREFIX_SUFFIX) +
+			  mp_sizeof_bin(suffix_size);
+	if (new_size >= size)
+		return 0;
+	char *pos = region_alloc(&fiber()->gc, new_size);
+	if (pos == NULL) {
+		diag_set(OutOfMemory, new_size, "region", "statement body");
+		return -1;
+	}
+	xrow->body[0].iov_base = pos;
+	xrow->body[0].iov_len = new_size;
+	pos = mp_encode_map(pos, 2);
+	pos = mp_encode_uint(pos, VY_ROW_PREFIX_SIZE);
+	pos = mp_encode_uint(pos, prefix);
+	pos = mp_encode_uint(pos, VY_ROW_PREFIX_SUFFIX);
+	pos = mp_encode_bin(pos, body + prefix, suffix_size);
+	assert(pos == (char *)xrow->body[0].iov_base + new_size);
+	return 0;
+}
+
+/**
+ * Restore the body of a statement read from a page with key
+ * prefix compression. The body of the previous statement of
+ * the page must be stored in @a buf unless the statement is
+ * stored in full. On success, the statement body points to
+ * the restored body stored in @a buf.
+ *
+ * @retval 0 Success.
+ * @retval -1 Memory error or invalid body.
+ */
+static int
+vy_row_prefix_decode(struct xrow_header *xrow, struct vy_prefix_buf *buf)
+{
+	if (xrow->bodycnt == 0)
+		return 0;
+	const char *pos = xrow->body[0].iov_base;
+	const char *suffix = pos;
+	uint32_t suffix_size = xrow->body[0].iov_len;
+	uint64_t prefix = 0;
+	const char *key = pos;
+	if (mp_typeof(*key) == MP_MAP && mp_decode_map(&key) == 2 &&
+	    mp_typeof(*key) == MP_UINT &&
+	    mp_decode_uint(&key) == VY_ROW_PREFIX_SIZE) {
+		/* The body is checked by xrow_header_decode(). */
+		if (mp_typeof(*key) != MP_UINT)
+			goto error;
+		prefix = mp_decode_uint(&key);
+		if (mp_typeof(*key) != MP_UINT ||
+		    mp_decode_uint(&key) != VY_ROW_PREFIX_SUFFIX ||
+		    mp_typeof(*key) != MP_BIN)
+			goto error;
+		suffix = mp_decode_bin(&key, &suffix_size);
+		if (prefix > buf->size)
+			goto error;
+	}
+	if (vy_prefix_buf_set(buf, prefix, suffix, suffix_size) != 0)
+		return -1;
+	xrow->body[0].iov_base = buf->data;
+	xrow->body[0].iov_len = buf->size;
+	return 0;
+error:
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 "Invalid prefix compressed statement");
+	return -1;
+}
+
+/* }}} Key prefix compression */
+
 static struct vy_page *
 vy_page_new(const struct vy_page_info *page_info)
 {
@@ -729,6 +951,13 @@ vy_page_new(const struct vy_page_info *page_info)
 		free(page);
 		return NULL;
 	}
+	page->restart_interval = 0;
+	memset(&page->body, 0, sizeof(page->body));
+	page->body_stmt_no = UINT32_MAX;
+	page->refs = 1;
+	page->run = NULL;
+	page->is_protected = false;
+	rlist_create(&page->in_cache);
 	return page;
 }
 
@@ -737,6 +966,7 @@ vy_page_delete(struct vy_page *page)
 {
 	uint32_t *row_index = page->row_index;
 	char *data = page->data;
+	vy_prefix_buf_destroy(&page->body);
 #if !defined(NDEBUG)
 	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
 	memset(data, '#', page->unpacked_size);
@@ -747,9 +977,225 @@ vy_page_delete(struct vy_page *page)
 	free(page);
 }
 
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/* {{{ vy_page_cache */
+
+/** Size of memory taken by a page. */
+static inline size_t
+vy_page_mem_used(struct vy_page *page)
+{
+	return sizeof(*page) + page->unpacked_size +
+	       page->row_count * sizeof(*page->row_index) +
+	       page->body.capacity;
+}
+
+static void
+vy_page_cache_create(struct vy_page_cache *cache)
+{
+	memset(cache, 0, sizeof(*cache));
+	rlist_create(&cache->probation);
+	rlist_create(&cache->protected);
+}
+
+/** Remove a page from the cache and drop the cache reference. */
+static void
+vy_page_cache_remove(struct vy_page_cache *cache, struct vy_page *page)
+{
+	assert(page->run != NULL);
+	assert(page->run->cached_pages[page->page_no] == page);
+	size_t size = vy_page_mem_used(page);
+	assert(cache->mem_used >= size);
+	cache->mem_used -= size;
+	if (page->is_protected) {
+		assert(cache->protected_size >= size);
+		cache->protected_size -= size;
+		page->is_protected = false;
+	}
+	rlist_del_entry(page, in_cache);
+	page->run->cached_pages[page->page_no] = NULL;
+	page->run = NULL;
+	vy_page_unref(page);
+}
+
+/**
+ * Evict least recently used pages until the cache fits in
+ * the quota. Pages that haven't been reused go first.
+ */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->quota) {
+		struct rlist *lru = !rlist_empty(&cache->probation) ?
+				    &cache->probation : &cache->protected;
+		assert(!rlist_empty(lru));
+		vy_page_cache_remove(cache, rlist_first_entry(lru,
+						struct vy_page, in_cache));
+	}
+}
+
+/**
+ * Move least recently used pages from the protected segment
+ * to the probation segment until the former fits in its share
+ * of the quota.
+ */
+static void
+vy_page_cache_demote(struct vy_page_cache *cache)
+{
+	size_t limit = cache->quota / 100 * VY_PAGE_CACHE_PROTECTED_PCT;
+	while (cache->protected_size > limit) {
+		struct vy_page *page = rlist_first_entry(&cache->protected,
+							 struct vy_page,
+							 in_cache);
+		cache->protected_size -= vy_page_mem_used(page);
+		page->is_protected = false;
+		rlist_move_tail_entry(&cache->probation, page, in_cache);
+	}
+}
+
+/**
+ * Look up a page of a run in the cache. A found page is moved
+ * to the protected segment. Returns NULL if the page isn't cached.
+ */
+static struct vy_page *
+vy_page_cache_lookup(struct vy_page_cache *cache, struct vy_run *run,
+		     uint32_t page_no)
+{
+	if (cache->quota == 0)
+		return NULL;
+	struct vy_page *page = run->cached_pages != NULL ?
+			       run->cached_pages[page_no] : NULL;
+	if (page == NULL) {
+		cache->miss++;
+		return NULL;
+	}
+	cache->hit++;
+	if (!page->is_protected) {
+		page->is_protected = true;
+		cache->protected_size += vy_page_mem_used(page);
+	}
+	rlist_move_tail_entry(&cache->protected, page, in_cache);
+	vy_page_cache_demote(cache);
+	return page;
+}
+
+/**
+ * Store a page just read from a run in the probation segment
+ * of the cache. Caching is best effort, so nothing is reported
+ * if the page can't be stored.
+ */
+static void
+vy_page_cache_put(struct vy_page_cache *cache, struct vy_run *run,
+		  struct vy_page *page)
+{
+	assert(page->run == NULL);
+	size_t size = vy_page_mem_used(page);
+	if (size > cache->quota)
+		return;
+	if (run->cached_pages == NULL) {
+		run->cached_pages = calloc(run->info.page_count,
+					   sizeof(*run->cached_pages));
+		if (run->cached_pages == NULL)
+			return;
+	}
+	/*
+	 * The page could have been loaded by another fiber
+	 * while we were waiting for the read to complete.
+	 */
+	if (run->cached_pages[page->page_no] != NULL)
+		return;
+	run->cached_pages[page->page_no] = page;
+	page->run = run;
+	vy_page_ref(page);
+	rlist_add_tail_entry(&cache->probation, page, in_cache);
+	cache->mem_used += size;
+	vy_page_cache_evict(cache);
+}
+
+/**
+ * Check if a page of a run is stored in the cache without
+ * touching the LRU lists or the lookup statistics.
+ */
+static bool
+vy_page_cache_has(struct vy_page_cache *cache, struct vy_run *run,
+		  uint32_t page_no)
+{
+	return cache->quota > 0 && run->cached_pages != NULL &&
+	       run->cached_pages[page_no] != NULL;
+}
+
+/**
+ * Account a change of the memory taken by a cached page, which
+ * happens when the buffer for restored statement bodies grows.
+ * The cache is trimmed to the quota on the next insertion.
+ */
+static void
+vy_page_cache_resize(struct vy_page_cache *cache, struct vy_page *page,
+		     size_t old_size)
+{
+	assert(page->run != NULL);
+	size_t size = vy_page_mem_used(page);
+	cache->mem_used += size - old_size;
+	if (page->is_protected)
+		cache->protected_size += size - old_size;
+}
+
+/** Remove all pages of a run from the cache. */
+static void
+vy_page_cache_evict_run(struct vy_page_cache *cache, struct vy_run *run)
+{
+	if (run->cached_pages == NULL)
+		return;
+	for (uint32_t page_no = 0; page_no < run->info.page_count; page_no++) {
+		struct vy_page *page = run->cached_pages[page_no];
+		if (page != NULL)
+			vy_page_cache_remove(cache, page);
+	}
+	free(run->cached_pages);
+	run->cached_pages = NULL;
+}
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache)
+{
+	cache->quota = 0;
+	vy_page_cache_evict(cache);
+}
+
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota)
+{
+	struct vy_page_cache *cache = &env->page_cache;
+	cache->quota = quota;
+	vy_page_cache_demote(cache);
+	vy_page_cache_evict(cache);
+}
+
+/* }}} vy_page_cache */
+
+void
+vy_run_env_set_readahead(struct vy_run_env *env, uint32_t pages)
+{
+	env->readahead = pages;
+}
+
+/** Decode a statement of a page as it is stored. */
 static int
-vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
-	     struct xrow_header *xrow)
+vy_page_raw_xrow(struct vy_page *page, uint32_t stmt_no,
+		 struct xrow_header *xrow)
 {
 	assert(stmt_no < page->row_count);
 	const char *data = page->data + page->row_index[stmt_no];
@@ -759,6 +1205,52 @@ vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	return xrow_header_decode(xrow, &data, data_end, false);
 }
 
+/**
+ * Decode a statement of a page. If the page is stored with key
+ * prefix compression, the statement body is restored in
+ * vy_page::body and stays valid until the next call.
+ */
+static int
+vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
+	     struct xrow_header *xrow)
+{
+	if (page->restart_interval == 0)
+		return vy_page_raw_xrow(page, stmt_no, xrow);
+	if (vy_page_raw_xrow(page, stmt_no, xrow) != 0)
+		return -1;
+	if (page->body_stmt_no == stmt_no) {
+		xrow->body[0].iov_base = page->body.data;
+		xrow->body[0].iov_len = page->body.size;
+		return 0;
+	}
+	/*
+	 * Restore the body starting from the closest restart point
+	 * or the previous statement if its body is at hand.
+	 */
+	uint32_t first = stmt_no - stmt_no % page->restart_interval;
+	if (page->body_stmt_no != UINT32_MAX &&
+	    page->body_stmt_no >= first && page->body_stmt_no < stmt_no)
+		first = page->body_stmt_no + 1;
+	page->body_stmt_no = UINT32_MAX;
+	size_t old_size = vy_page_mem_used(page);
+	int rc = 0;
+	struct xrow_header prev;
+	for (uint32_t i = first; i < stmt_no && rc == 0; i++) {
+		rc = vy_page_raw_xrow(page, i, &prev);
+		if (rc == 0)
+			rc = vy_row_prefix_decode(&prev, &page->body);
+	}
+	if (rc == 0)
+		rc = vy_row_prefix_decode(xrow, &page->body);
+	if (page->run != NULL && vy_page_mem_used(page) != old_size)
+		vy_page_cache_resize(&page->run->env->page_cache, page,
+				     old_size);
+	if (rc != 0)
+		return -1;
+	page->body_stmt_no = stmt_no;
+	return 0;
+}
+
 /* {{{ vy_run_iterator vy_run_iterator support functions */
 
 /**
@@ -791,6 +1283,11 @@ vy_page_stmt(struct vy_page *page, uint32_t stmt_no,
  * In terms of STL, makes lower_bound for EQ,GE,LT and upper_bound for GT,LE
  * Additionally *equal_key argument is set to true if the found value is
  * equal to given key (set to false otherwise).
+ *
+ * If the page is stored with key prefix compression, the binary
+ * search runs over restart points and is followed by a linear
+ * search between two neighboring restart points.
+ *
  * @retval position in the page
  */
 static uint32_t
@@ -798,18 +1295,19 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 		 struct key_def *cmp_def, struct tuple_format *format,
 		 enum iterator_type iterator_type, bool *equal_key)
 {
+	uint32_t interval = MAX(page->restart_interval, 1);
 	uint32_t beg = 0;
-	uint32_t end = page->row_count;
+	uint32_t end = (page->row_count + interval - 1) / interval;
 	*equal_key = false;
 	/* for upper bound we change zero comparison result to -1 */
 	int zero_cmp = (iterator_type == ITER_GT ||
 			iterator_type == ITER_LE ? -1 : 0);
 	while (beg != end) {
 		uint32_t mid = beg + (end - beg) / 2;
-		struct vy_entry fnd_key = vy_page_stmt(page, mid, cmp_def,
-						       format);
+		struct vy_entry fnd_key = vy_page_stmt(page, mid * interval,
+						       cmp_def, format);
 		if (fnd_key.stmt == NULL)
-			return end;
+			return MIN(end * interval, page->row_count);
 		int cmp = vy_entry_compare(fnd_key, key, cmp_def);
 		cmp = cmp ? cmp : zero_cmp;
 		*equal_key = *equal_key || cmp == 0;
@@ -819,41 +1317,72 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 			end = mid;
 		tuple_unref(fnd_key.stmt);
 	}
-	return end;
+	if (end == 0)
+		return 0;
+	/* The position is after the restart point end - 1. */
+	uint32_t pos = (end - 1) * interval + 1;
+	uint32_t pos_end = MIN(end * interval, page->row_count);
+	for (; pos < pos_end; pos++) {
+		struct vy_entry fnd_key = vy_page_stmt(page, pos, cmp_def,
+						       format);
+		if (fnd_key.stmt == NULL)
+			return pos_end;
+		int cmp = vy_entry_compare(fnd_key, key, cmp_def);
+		cmp = cmp ? cmp : zero_cmp;
+		*equal_key = *equal_key || cmp == 0;
+		tuple_unref(fnd_key.stmt);
+		if (cmp >= 0)
+			break;
+	}
+	return pos;
 }
 
+static void
+vy_run_iterator_readahead_discard(struct vy_run_iterator *itr);
+
 /**
  * End iteration and free cached data.
  */
 static void
 vy_run_iterator_stop(struct vy_run_iterator *itr)
 {
+	vy_run_iterator_readahead_discard(itr);
 	if (itr->curr.stmt != NULL) {
 		tuple_unref(itr->curr.stmt);
 		itr->curr = vy_entry_none();
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
 
 static int
 vy_row_index_decode(uint32_t *row_index, uint32_t row_count,
-		    struct xrow_header *xrow)
+		    uint32_t *restart_interval, struct xrow_header *xrow)
 {
 	assert(xrow->type == VY_RUN_ROW_INDEX);
 	const char *pos = xrow->body->iov_base;
 	uint32_t map_size = mp_decode_map(&pos);
 	uint32_t map_item;
 	uint32_t size = 0;
+	const char *data = NULL;
+	*restart_interval = 0;
 	for (map_item = 0; map_item < map_size; ++map_item) {
 		uint32_t key = mp_decode_uint(&pos);
 		switch (key) {
 		case VY_ROW_INDEX_DATA:
 			size = mp_decode_binl(&pos);
+			data = pos;
+			pos += size;
+			break;
+		case VY_ROW_INDEX_RESTART_INTERVAL:
+			*restart_interval = mp_decode_uint(&pos);
+			break;
+		default:
+			mp_next(&pos);
 			break;
 		}
 	}
@@ -866,7 +1395,7 @@ vy_row_index_decode(uint32_t *row_index, uint32_t row_count,
 		return -1;
 	}
 	for (uint32_t i = 0; i < row_count; ++i) {
-		row_index[i] = mp_load_u32(&pos);
+		row_index[i] = mp_load_u32(&data);
 	}
 	assert(pos == xrow->body->iov_base + xrow->body->iov_len);
 	return 0;
@@ -924,7 +1453,8 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 	const char *data_end = data + readen;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
-	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
+	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx,
+			   run->zdict) != 0)
 		goto error;
 
 	struct xrow_header xrow;
@@ -939,8 +1469,16 @@ vy_page_read(struct vy_page *page, const struct vy_page_info *page_info,
 				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
 		goto error;
 	}
-	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
+	if (vy_row_index_decode(page->row_index, page->row_count,
+				&page->restart_interval, &xrow) != 0)
+		goto error;
+	if (page->restart_interval > 0 &&
+	    run->format_version < XLOG_FORMAT_V14) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Key prefix compression is not supported "
+			 "by the file format version");
 		goto error;
+	}
 	region_truncate(&fiber()->gc, region_svp);
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
 		diag_set(ClientError, ER_INJECTION, "vinyl page read");
@@ -995,9 +1533,283 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	return 0;
 }
 
+/* {{{ Page readahead */
+
+/**
+ * Callback invoked by a reader thread upon receiving a page
+ * to read ahead.
+ */
+static void
+vy_page_readahead_read_f(struct cmsg *cmsg)
+{
+	struct vy_page_readahead *ra = container_of(cmsg,
+				struct vy_page_readahead, cmsg);
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(ra->run->env);
+	if (zdctx == NULL ||
+	    vy_page_read(ra->page, ra->page_info, ra->run, zdctx) != 0) {
+		ra->is_failed = true;
+		diag_move(diag_get(), &ra->diag);
+	}
+}
+
+static void
+vy_page_readahead_delete(struct vy_page_readahead *ra)
+{
+	struct vy_run_env *env = ra->run->env;
+	if (ra->page != NULL)
+		vy_page_unref(ra->page);
+	diag_destroy(&ra->diag);
+	fiber_cond_destroy(&ra->cond);
+	vy_run_unref(ra->run);
+	mempool_free(&env->readahead_pool, ra);
+}
+
+/**
+ * Callback invoked by the tx thread upon receiving a page
+ * read ahead by a reader thread.
+ */
+static void
+vy_page_readahead_complete_f(struct cmsg *cmsg)
+{
+	struct vy_page_readahead *ra = container_of(cmsg,
+				struct vy_page_readahead, cmsg);
+	ra->is_done = true;
+	if (ra->is_orphan)
+		vy_page_readahead_delete(ra);
+	else
+		fiber_cond_signal(&ra->cond);
+}
+
+/**
+ * Send a page of a run to a reader thread to be read without
+ * waiting for the result. Returns NULL on memory error.
+ */
+static struct vy_page_readahead *
+vy_page_readahead_start(struct vy_run *run, uint32_t page_no)
+{
+	struct vy_run_env *env = run->env;
+	assert(env->reader_pool != NULL);
+
+	struct vy_page_readahead *ra = mempool_alloc(&env->readahead_pool);
+	if (ra == NULL) {
+		diag_set(OutOfMemory, sizeof(*ra),
+			 "mempool", "vy_page_readahead");
+		return NULL;
+	}
+	ra->page_info = vy_run_page_info(run, page_no);
+	ra->page = vy_page_new(ra->page_info);
+	if (ra->page == NULL) {
+		mempool_free(&env->readahead_pool, ra);
+		return NULL;
+	}
+	ra->page->page_no = page_no;
+	ra->page_no = page_no;
+	ra->run = run;
+	vy_run_ref(run);
+	ra->is_done = false;
+	ra->is_failed = false;
+	ra->is_orphan = false;
+	diag_create(&ra->diag);
+	fiber_cond_create(&ra->cond);
+	rlist_create(&ra->in_itr);
+
+	/* Pick a reader thread. */
+	struct vy_run_reader *reader;
+	reader = &env->reader_pool[env->next_reader++];
+	env->next_reader %= env->reader_pool_size;
+
+	cmsg_init(&ra->cmsg, reader->readahead_route);
+	cpipe_push(&reader->reader_pipe, &ra->cmsg);
+	return ra;
+}
+
+/** Wait until a page sent to a reader thread is returned to tx. */
+static void
+vy_page_readahead_wait(struct vy_page_readahead *ra)
+{
+	bool cancellable = fiber_set_cancellable(false);
+	while (!ra->is_done)
+		fiber_cond_wait(&ra->cond);
+	fiber_set_cancellable(cancellable);
+}
+
+/**
+ * Account a page read by a reader thread to iterator statistics
+ * and store it in the page cache, just like a page read by
+ * vy_run_iterator_load_page().
+ */
+static void
+vy_page_readahead_acct(struct vy_page_readahead *ra,
+		       struct vy_run_iterator_stat *stat)
+{
+	assert(ra->is_done && !ra->is_failed);
+	struct vy_page_info *page_info = ra->page_info;
+	stat->read.rows += page_info->row_count;
+	stat->read.bytes += page_info->unpacked_size;
+	stat->read.bytes_compressed += page_info->size;
+	stat->read.pages++;
+	vy_page_cache_put(&ra->run->env->page_cache, ra->run, ra->page);
+}
+
+/**
+ * Send a page of the iterated run to a reader thread to be
+ * read ahead.
+ *
+ * @retval 0 success
+ * @retval -1 memory error
+ */
+static int
+vy_run_iterator_readahead_page(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_run *run = itr->slice->run;
+	struct vy_page_readahead *ra = vy_page_readahead_start(run, page_no);
+	if (ra == NULL)
+		return -1;
+	rlist_add_tail_entry(&itr->readahead, ra, in_itr);
+	itr->readahead_count++;
+	run->env->readahead_pages++;
+	return 0;
+}
+
+/** Drop a page read ahead by an iterator. */
+static void
+vy_run_iterator_readahead_drop(struct vy_run_iterator *itr,
+			       struct vy_page_readahead *ra)
+{
+	assert(itr->readahead_count > 0);
+	rlist_del_entry(ra, in_itr);
+	itr->readahead_count--;
+	ra->run->env->readahead_wasted++;
+	if (ra->is_done)
+		vy_page_readahead_delete(ra);
+	else
+		ra->is_orphan = true;
+}
+
+/** Drop all pages read ahead by an iterator. */
+static void
+vy_run_iterator_readahead_discard(struct vy_run_iterator *itr)
+{
+	struct vy_page_readahead *ra, *tmp;
+	rlist_foreach_entry_safe(ra, &itr->readahead, in_itr, tmp)
+		vy_run_iterator_readahead_drop(itr, ra);
+	assert(itr->readahead_count == 0);
+}
+
+/**
+ * Check if the iterator is going to load the page following
+ * the current one in the scan order. Equality lookups never
+ * count as sequential: a key spanning a page boundary doesn't
+ * mean the iterator is going to scan further.
+ */
+static bool
+vy_run_iterator_is_sequential(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	if (itr->curr_page == NULL)
+		return false;
+	if (itr->iterator_type == ITER_EQ || itr->iterator_type == ITER_REQ)
+		return false;
+	uint32_t curr_page_no = itr->curr_page->page_no;
+	if (itr->iterator_type == ITER_LE || itr->iterator_type == ITER_LT)
+		return page_no + 1 == curr_page_no;
+	return page_no == curr_page_no + 1;
+}
+
+/**
+ * Take a page read ahead by the iterator, waiting for the read
+ * to complete if necessary. Pages preceding the given page in
+ * the scan order are dropped. The page is set to NULL if it
+ * wasn't read ahead.
+ *
+ * @retval 0 success
+ * @retval -1 read error
+ */
+static NODISCARD int
+vy_run_iterator_readahead_take(struct vy_run_iterator *itr, uint32_t page_no,
+			       struct vy_page **result)
+{
+	bool is_reverse = itr->iterator_type == ITER_LE ||
+			  itr->iterator_type == ITER_LT;
+	struct vy_page_readahead *ra = NULL;
+	*result = NULL;
+	while (!rlist_empty(&itr->readahead)) {
+		ra = rlist_first_entry(&itr->readahead,
+				       struct vy_page_readahead, in_itr);
+		if (ra->page_no == page_no)
+			break;
+		if (is_reverse ? ra->page_no < page_no :
+				 ra->page_no > page_no)
+			return 0;
+		vy_run_iterator_readahead_drop(itr, ra);
+		ra = NULL;
+	}
+	if (ra == NULL)
+		return 0;
+
+	vy_page_readahead_wait(ra);
+	rlist_del_entry(ra, in_itr);
+	itr->readahead_count--;
+	if (ra->is_failed) {
+		diag_move(&ra->diag, diag_get());
+		vy_page_readahead_delete(ra);
+		return -1;
+	}
+	if (fiber_is_cancelled()) {
+		diag_set(FiberIsCancelled);
+		vy_page_readahead_delete(ra);
+		return -1;
+	}
+	vy_page_readahead_acct(ra, itr->stat);
+	*result = ra->page;
+	ra->page = NULL;
+	vy_page_readahead_delete(ra);
+	return 0;
+}
+
+/**
+ * Read ahead pages following the given one in the scan order,
+ * up to vy_run_env::readahead pages in total, so that a long
+ * scan doesn't have to wait for each page to be read once it
+ * gets to it. Pages stored in the page cache and pages beyond
+ * the iterated slice are skipped.
+ */
+static void
+vy_run_iterator_readahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_slice *slice = itr->slice;
+	struct vy_run *run = slice->run;
+	struct vy_run_env *env = run->env;
+	/* Use blocking I/O during WAL recovery. */
+	if (env->reader_pool == NULL || env->readahead == 0)
+		return;
+
+	bool is_reverse = itr->iterator_type == ITER_LE ||
+			  itr->iterator_type == ITER_LT;
+	int64_t step = is_reverse ? -1 : 1;
+	int64_t last = (int64_t)page_no + step * env->readahead;
+	last = is_reverse ? MAX(last, (int64_t)slice->first_page_no) :
+			    MIN(last, (int64_t)slice->last_page_no);
+	int64_t next = page_no;
+	if (!rlist_empty(&itr->readahead)) {
+		next = rlist_last_entry(&itr->readahead,
+					struct vy_page_readahead,
+					in_itr)->page_no;
+	}
+	for (next += step; next * step <= last * step; next += step) {
+		if (vy_page_cache_has(&env->page_cache, run, next))
+			continue;
+		if (vy_run_iterator_readahead_page(itr, next) != 0)
+			break;
+	}
+}
+
+/* }}} Page readahead */
+
 /**
  * Read a page from disk given its number.
- * The function caches two most recently read pages.
+ * The function caches two most recently read pages in the
+ * iterator and looks up the shared page cache and the pages
+ * read ahead before going to disk.
  *
  * @retval 0 success
  * @retval -1 critical error
@@ -1013,6 +1825,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 
 	/* Check cache */
 	struct vy_page *page = NULL;
+	bool is_sequential = false;
 	if (itr->curr_page != NULL &&
 	    itr->curr_page->page_no == page_no) {
 		page = itr->curr_page;
@@ -1020,6 +1833,31 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		   itr->prev_page->page_no == page_no) {
 		SWAP(itr->prev_page, itr->curr_page);
 		page = itr->curr_page;
+	} else {
+		/*
+		 * Pages read ahead are only useful as long as
+		 * the iterator moves page by page.
+		 */
+		is_sequential = vy_run_iterator_is_sequential(itr, page_no);
+		if (!is_sequential)
+			vy_run_iterator_readahead_discard(itr);
+		else if (vy_run_iterator_readahead_take(itr, page_no,
+							&page) != 0)
+			return -1;
+		if (page == NULL) {
+			page = vy_page_cache_lookup(&env->page_cache,
+						    slice->run, page_no);
+			if (page != NULL)
+				vy_page_ref(page);
+		}
+		if (page != NULL) {
+			if (itr->prev_page != NULL)
+				vy_page_unref(itr->prev_page);
+			itr->prev_page = itr->curr_page;
+			itr->curr_page = page;
+		}
+		if (is_sequential)
+			vy_run_iterator_readahead(itr, page_no);
 	}
 	if (page != NULL) {
 		if (key.stmt != NULL)
@@ -1067,10 +1905,11 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 
 	/* Update cache */
 	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
+		vy_page_unref(itr->prev_page);
 	itr->prev_page = itr->curr_page;
 	itr->curr_page = page;
 	page->page_no = page_no;
+	vy_page_cache_put(&env->page_cache, slice->run, page);
 
 	/* Update read statistics. */
 	itr->stat->read.rows += page_info->row_count;
@@ -1482,6 +2321,8 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->curr_pos.page_no = slice->run->info.page_count;
 	itr->curr_page = NULL;
 	itr->prev_page = NULL;
+	rlist_create(&itr->readahead);
+	itr->readahead_count = 0;
 	itr->search_started = false;
 
 	/*
@@ -1639,6 +2480,110 @@ vy_run_iterator_close(struct vy_run_iterator *itr)
 	TRASH(itr);
 }
 
+void
+vy_run_iterator_prefetch(struct vy_run_iterator *itrs, int count)
+{
+	if (count == 0)
+		return;
+	struct vy_slice *slice = itrs[0].slice;
+	struct vy_run *run = slice->run;
+	struct vy_run_env *env = run->env;
+	struct tuple_bloom *bloom = run->info.bloom;
+	/* Use blocking I/O during WAL recovery. */
+	if (env->reader_pool == NULL)
+		return;
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	uint32_t *page_no = region_alloc_array(region, typeof(page_no[0]),
+					       count, &size);
+	if (page_no == NULL)
+		return;
+	struct vy_page_readahead **reads;
+	reads = region_alloc_array(region, typeof(reads[0]), count, &size);
+	if (reads == NULL) {
+		region_truncate(region, region_svp);
+		return;
+	}
+
+	/*
+	 * Find the page each key may be stored in. Keys are sorted
+	 * so keys falling in the same page go one after another and
+	 * the page is read only once.
+	 */
+	int read_count = 0;
+	for (int i = 0; i < count; i++) {
+		struct vy_run_iterator *itr = &itrs[i];
+		assert(itr->slice == slice);
+		assert(itr->iterator_type == ITER_EQ);
+		assert(!itr->search_started);
+		/*
+		 * Keys are sorted, so once a key is past the slice
+		 * end, so are all the rest. A partial key equal to
+		 * the slice end may still match statements in it.
+		 */
+		if (slice->end.stmt != NULL &&
+		    vy_entry_compare(itr->key, slice->end,
+				     itr->cmp_def) > 0) {
+			count = i;
+			break;
+		}
+		page_no[i] = run->info.page_count;
+		if (bloom != NULL &&
+		    !vy_bloom_maybe_has(bloom, itr->key, itr->key_def))
+			continue;
+		if (slice->begin.stmt != NULL &&
+		    vy_entry_compare(itr->key, slice->begin,
+				     itr->cmp_def) < 0)
+			continue;
+		bool equal_key;
+		page_no[i] = vy_page_index_find_page(run, itr->key,
+						     itr->cmp_def, ITER_EQ,
+						     &equal_key);
+		if (page_no[i] > slice->last_page_no)
+			page_no[i] = run->info.page_count;
+		if (page_no[i] == run->info.page_count ||
+		    vy_page_cache_has(&env->page_cache, run, page_no[i]) ||
+		    (read_count > 0 &&
+		     reads[read_count - 1]->page_no == page_no[i]))
+			continue;
+		reads[read_count] = vy_page_readahead_start(run, page_no[i]);
+		if (reads[read_count] == NULL) {
+			/* The rest of the pages will be read as usual. */
+			diag_clear(diag_get());
+			count = i;
+			break;
+		}
+		read_count++;
+	}
+	for (int i = 0; i < read_count; i++)
+		vy_page_readahead_wait(reads[i]);
+
+	/*
+	 * Hand the pages over to the iterators. If a page failed
+	 * to be read, the iterator will read it by itself and
+	 * report the error.
+	 */
+	for (int i = 0, j = 0; i < count && j < read_count; i++) {
+		if (page_no[i] == run->info.page_count)
+			continue;
+		while (j < read_count && reads[j]->page_no < page_no[i])
+			j++;
+		if (j < read_count && reads[j]->page_no == page_no[i] &&
+		    !reads[j]->is_failed) {
+			itrs[i].curr_page = reads[j]->page;
+			vy_page_ref(reads[j]->page);
+		}
+	}
+	for (int i = 0; i < read_count; i++) {
+		if (!reads[i]->is_failed)
+			vy_page_readahead_acct(reads[i], itrs[0].stat);
+		vy_page_readahead_delete(reads[i]);
+	}
+	region_truncate(region, region_svp);
+}
+
 /* }}} vy_run_iterator API implementation */
 
 /** Account a page to run statistics. */
@@ -1767,6 +2712,9 @@ vy_run_recover(struct vy_run *run, const char *dir,
 		goto fail_close;
 	}
 	run->fd = cursor.fd;
+	run->format_version = meta->version;
+	run->zdict = cursor.zdict;
+	cursor.zdict = NULL;
 	xlog_cursor_close(&cursor, true);
 	return 0;
 
@@ -1779,11 +2727,16 @@ fail:
 	return -1;
 }
 
-/* dump statement to the run page buffers (stmt header and data) */
+/*
+ * dump statement to the run page buffers (stmt header and data),
+ * if @a prev_body is not NULL, the statement body is stored with
+ * key prefix compression
+ */
 static int
 vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
 		 struct vy_page_info *info, struct key_def *key_def,
-		 bool is_primary)
+		 bool is_primary, struct xlog_zdict_sampler *sampler,
+		 struct vy_prefix_buf *prev_body, uint32_t restart_interval)
 {
 	struct xrow_header xrow;
 	int rc = (is_primary ?
@@ -1794,6 +2747,17 @@ vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
 	if (rc != 0)
 		return -1;
 
+	if (sampler != NULL) {
+		for (int i = 0; i < xrow.bodycnt; i++) {
+			xlog_zdict_sampler_add(sampler, xrow.body[i].iov_base,
+					       xrow.body[i].iov_len);
+		}
+	}
+	if (prev_body != NULL &&
+	    vy_row_prefix_encode(&xrow, prev_body,
+				 info->row_count % restart_interval == 0) != 0)
+		return -1;
+
 	ssize_t row_size;
 	if ((row_size = xlog_write_row(data_xlog, &xrow)) < 0)
 		return -1;
@@ -1808,31 +2772,42 @@ vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
  *
  * @param row_index row index
  * @param row_count size of row index
+ * @param restart_interval restart interval of a page with key
+ *        prefix compression, 0 if it is disabled
  * @param[out] xrow xrow to fill.
  * @retval 0 for success
  * @retval -1 for error
  */
 static int
 vy_row_index_encode(const uint32_t *row_index, uint32_t row_count,
-		    struct xrow_header *xrow)
+		    uint32_t restart_interval, struct xrow_header *xrow)
 {
 	memset(xrow, 0, sizeof(*xrow));
 	xrow->type = VY_RUN_ROW_INDEX;
 
-	size_t size = mp_sizeof_map(1) +
+	uint32_t map_size = restart_interval > 0 ? 2 : 1;
+	size_t size = mp_sizeof_map(map_size) +
 		      mp_sizeof_uint(VY_ROW_INDEX_DATA) +
 		      mp_sizeof_bin(sizeof(uint32_t) * row_count);
+	if (restart_interval > 0) {
+		size += mp_sizeof_uint(VY_ROW_INDEX_RESTART_INTERVAL) +
+			mp_sizeof_uint(restart_interval);
+	}
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
 		diag_set(OutOfMemory, size, "region", "row index");
 		return -1;
 	}
 	xrow->body->iov_base = pos;
-	pos = mp_encode_map(pos, 1);
+	pos = mp_encode_map(pos, map_size);
 	pos = mp_encode_uint(pos, VY_ROW_INDEX_DATA);
 	pos = mp_encode_binl(pos, sizeof(uint32_t) * row_count);
 	for (uint32_t i = 0; i < row_count; ++i)
 		pos = mp_store_u32(pos, row_index[i]);
+	if (restart_interval > 0) {
+		pos = mp_encode_uint(pos, VY_ROW_INDEX_RESTART_INTERVAL);
+		pos = mp_encode_uint(pos, restart_interval);
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	assert(xrow->body->iov_len == size);
 	xrow->bodycnt = 1;
@@ -1990,6 +2965,15 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	uint32_t key_count = 6;
 	if (run_info->bloom != NULL)
 		key_count++;
+	/*
+	 * Split block bloom filters are stored under a separate
+	 * key so that older versions ignore them instead of
+	 * misinterpreting.
+	 */
+	uint32_t bloom_key = VY_RUN_INFO_BLOOM;
+	if (run_info->bloom != NULL &&
+	    run_info->bloom->type == BLOOM_TYPE_SPLIT_BLOCK)
+		bloom_key = VY_RUN_INFO_BLOOM_SPLIT_BLOCK;
 
 	size_t size = mp_sizeof_map(key_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
@@ -2001,7 +2985,7 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	size += mp_sizeof_uint(VY_RUN_INFO_PAGE_COUNT) +
 		mp_sizeof_uint(run_info->page_count);
 	if (run_info->bloom != NULL)
-		size += mp_sizeof_uint(VY_RUN_INFO_BLOOM) +
+		size += mp_sizeof_uint(bloom_key) +
 			tuple_bloom_size(run_info->bloom);
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
@@ -2028,7 +3012,7 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, VY_RUN_INFO_PAGE_COUNT);
 	pos = mp_encode_uint(pos, run_info->page_count);
 	if (run_info->bloom != NULL) {
-		pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM);
+		pos = mp_encode_uint(pos, bloom_key);
 		pos = tuple_bloom_encode(run_info->bloom, pos);
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
@@ -2112,7 +3096,9 @@ int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression)
+		     uint64_t page_size, uint32_t restart_interval,
+		     double bloom_fpr, enum bloom_type bloom_type,
+		     bool no_compression, struct xlog_zdict_sampler *sampler)
 {
 	memset(writer, 0, sizeof(*writer));
 	writer->run = run;
@@ -2122,8 +3108,11 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->cmp_def = cmp_def;
 	writer->key_def = key_def;
 	writer->page_size = page_size;
+	writer->restart_interval = restart_interval;
 	writer->bloom_fpr = bloom_fpr;
+	writer->bloom_type = bloom_type;
 	writer->no_compression = no_compression;
+	writer->sampler = sampler;
 	if (bloom_fpr < 1) {
 		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
 		if (writer->bloom == NULL)
@@ -2156,10 +3145,16 @@ vy_run_writer_create_xlog(struct vy_run_writer *writer)
 	struct xlog_meta meta;
 	xlog_meta_create(&meta, XLOG_META_TYPE_RUN, &INSTANCE_UUID,
 			 NULL, NULL);
+	/* Older versions can't read prefix compressed pages. */
+	if (writer->restart_interval > 0)
+		meta.version = XLOG_FORMAT_V14;
+	writer->run->format_version = meta.version;
 	struct xlog_opts opts = xlog_opts_default;
 	opts.rate_limit = writer->run->env->snap_io_rate_limit;
 	opts.sync_interval = VY_RUN_SYNC_INTERVAL;
 	opts.no_compression = writer->no_compression;
+	if (!writer->no_compression)
+		opts.zdict = writer->run->zdict;
 	if (xlog_create(&writer->data_xlog, path, 0, &meta, &opts) != 0)
 		return -1;
 	return 0;
@@ -2231,7 +3226,10 @@ vy_run_writer_write_to_page(struct vy_run_writer *writer, struct vy_entry entry)
 	}
 	*offset = page->unpacked_size;
 	if (vy_run_dump_stmt(entry, &writer->data_xlog, page,
-			     writer->cmp_def, writer->iid == 0) != 0)
+			     writer->cmp_def, writer->iid == 0,
+			     writer->sampler, writer->restart_interval > 0 ?
+			     &writer->prev_body : NULL,
+			     writer->restart_interval) != 0)
 		return -1;
 	int64_t lsn = vy_stmt_lsn(entry.stmt);
 	run->info.min_lsn = MIN(run->info.min_lsn, lsn);
@@ -2258,7 +3256,8 @@ vy_run_writer_end_page(struct vy_run_writer *writer)
 
 	struct xrow_header xrow;
 	uint32_t *row_index = (uint32_t *)writer->row_index_buf.rpos;
-	if (vy_row_index_encode(row_index, page->row_count, &xrow) < 0)
+	if (vy_row_index_encode(row_index, page->row_count,
+				writer->restart_interval, &xrow) < 0)
 		return -1;
 	ssize_t written = xlog_write_row(&writer->data_xlog, &xrow);
 	if (written < 0)
@@ -2316,6 +3315,7 @@ vy_run_writer_destroy(struct vy_run_writer *writer, bool reuse_fd)
 	if (writer->bloom != NULL)
 		tuple_bloom_builder_delete(writer->bloom);
 	ibuf_destroy(&writer->row_index_buf);
+	vy_prefix_buf_destroy(&writer->prev_body);
 }
 
 int
@@ -2362,7 +3362,8 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 
 	if (writer->bloom != NULL) {
 		run->info.bloom = tuple_bloom_new(writer->bloom,
-						  writer->bloom_fpr);
+						  writer->bloom_fpr,
+						  writer->bloom_type);
 		if (run->info.bloom == NULL)
 			goto out;
 	}
@@ -2412,6 +3413,17 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 	int64_t min_lsn = INT64_MAX;
 	struct tuple *prev_tuple = NULL;
 	char *page_min_key = NULL;
+	/*
+	 * Rows stored with key prefix compression are restored
+	 * from the previous row, while rows stored in full are
+	 * restored as is, so we don't need to know the format of
+	 * a page until its row index is read. Files of older
+	 * format versions can't have such rows.
+	 */
+	bool has_prefix = cursor.meta.version >= XLOG_FORMAT_V14;
+	run->format_version = cursor.meta.version;
+	struct vy_prefix_buf body;
+	memset(&body, 0, sizeof(body));
 
 	struct tuple_bloom_builder *bloom_builder = NULL;
 	if (opts->bloom_fpr < 1) {
@@ -2441,6 +3453,9 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 				continue;
 			}
 			++page_row_count;
+			if (has_prefix &&
+			    vy_row_prefix_decode(&xrow, &body) != 0)
+				goto close_err;
 			struct tuple *tuple = vy_stmt_decode(&xrow, format);
 			if (tuple == NULL)
 				goto close_err;
@@ -2504,13 +3519,15 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		tuple_unref(prev_tuple);
 		prev_tuple = NULL;
 	}
+	vy_prefix_buf_destroy(&body);
 	region_truncate(region, mem_used);
 	run->fd = cursor.fd;
 	xlog_cursor_close(&cursor, true);
 
 	if (bloom_builder != NULL) {
 		run->info.bloom = tuple_bloom_new(bloom_builder,
-						  opts->bloom_fpr);
+						  opts->bloom_fpr,
+						  opts->bloom_type);
 		if (run->info.bloom == NULL)
 			goto close_err;
 		tuple_bloom_builder_delete(bloom_builder);
@@ -2535,6 +3552,7 @@ close_err:
 		tuple_unref(prev_tuple);
 	if (page_min_key != NULL)
 		free(page_min_key);
+	vy_prefix_buf_destroy(&body);
 	if (bloom_builder != NULL)
 		tuple_bloom_builder_delete(bloom_builder);
 	if (xlog_cursor_is_open(&cursor))
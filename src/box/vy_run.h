@@ -52,10 +52,49 @@ extern "C" {
 struct vy_history;
 struct vy_run_reader;
 
+enum {
+	/** Max share of the page cache quota taken by reused pages. */
+	VY_PAGE_CACHE_PROTECTED_PCT = 80,
+};
+
+/**
+ * Cache of pages read from run files, shared by all runs.
+ *
+ * The cache is a segmented LRU: a page read from disk goes to
+ * the probation segment and is moved to the protected segment
+ * when it is looked up again. The protected segment may take
+ * at most VY_PAGE_CACHE_PROTECTED_PCT percent of the quota, so
+ * pages loaded by a long scan only push out pages that haven't
+ * been reused yet.
+ *
+ * Used only from the tx thread.
+ */
+struct vy_page_cache {
+	/** Max size of cached pages, in bytes. 0 disables the cache. */
+	size_t quota;
+	/** Size of cached pages, in bytes. */
+	size_t mem_used;
+	/** Size of pages in the protected segment, in bytes. */
+	size_t protected_size;
+	/** Pages read only once, least recently used first. */
+	struct rlist probation;
+	/** Pages that were reused, least recently used first. */
+	struct rlist protected;
+	/** Number of lookups that found the page in the cache. */
+	int64_t hit;
+	/** Number of lookups that had to read the page from disk. */
+	int64_t miss;
+};
+
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
 	/** Write rate limit, in bytes per second. */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Size of a zstd dictionary to train on run data for
+	 * compression of runs, 0 if disabled.
+	 */
+	size_t zdict_size;
 	/** Mempool for struct vy_page_read_task */
 	struct mempool read_task_pool;
 	/** Key for thread-local ZSTD context */
@@ -69,6 +108,19 @@ struct vy_run_env {
 	 * processing the next read request.
 	 */
 	int next_reader;
+	/** Cache of pages read by run iterators. */
+	struct vy_page_cache page_cache;
+	/**
+	 * Max number of pages a run iterator reads ahead when
+	 * it detects a sequential scan, 0 disables readahead.
+	 */
+	uint32_t readahead;
+	/** Mempool for struct vy_page_readahead. */
+	struct mempool readahead_pool;
+	/** Number of pages read ahead by run iterators. */
+	int64_t readahead_pages;
+	/** Number of pages read ahead but never used. */
+	int64_t readahead_wasted;
 };
 
 /**
@@ -123,12 +175,27 @@ struct vy_run {
 	struct vy_page_info *page_info;
 	/** Run data file. */
 	int fd;
+	/**
+	 * zstd dictionary the run pages are compressed with,
+	 * stored in the data file header. NULL if there's none.
+	 */
+	struct xlog_zdict *zdict;
+	/**
+	 * Format version of the run data file. Pages may be stored
+	 * with key prefix compression only since XLOG_FORMAT_V14.
+	 */
+	enum xlog_format_version format_version;
 	/** Unique ID of this run. */
 	int64_t id;
 	/** Number of statements in this run. */
 	struct vy_disk_stmt_counter count;
 	/** Size of memory used for storing page index. */
 	size_t page_index_size;
+	/**
+	 * Pages of this run stored in the page cache, indexed by
+	 * page number. Allocated when the first page is cached.
+	 */
+	struct vy_page **cached_pages;
 	/** Max LSN stored on disk. */
 	int64_t dump_lsn;
 	/**
@@ -279,10 +346,30 @@ struct vy_run_iterator {
 	 */
 	struct vy_page *curr_page;
 	struct vy_page *prev_page;
+	/**
+	 * Pages being read ahead of curr_page in the scan order,
+	 * linked by vy_page_readahead::in_itr.
+	 */
+	struct rlist readahead;
+	/** Number of pages in the readahead list. */
+	uint32_t readahead_count;
 	/** Is false until first .._get or .._next_.. method is called */
 	bool search_started;
 };
 
+/**
+ * Body of a statement restored from key prefix compression.
+ * Allocated with malloc so that it can be used by any thread.
+ */
+struct vy_prefix_buf {
+	/** Restored body. */
+	char *data;
+	/** Size of the restored body. */
+	uint32_t size;
+	/** Size of the allocated memory. */
+	uint32_t capacity;
+};
+
 /**
  * Vinyl page stored in memory.
  */
@@ -297,6 +384,32 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/**
+	 * Number of statements between restart points if the
+	 * statements are stored with key prefix compression,
+	 * 0 otherwise. A statement at a restart point is always
+	 * stored in full.
+	 */
+	uint32_t restart_interval;
+	/**
+	 * Body of the statement last read from a page with key
+	 * prefix compression. Statements are usually read one
+	 * after another so the next one is restored in one step.
+	 */
+	struct vy_prefix_buf body;
+	/** Number of the statement stored in @body, UINT32_MAX if none. */
+	uint32_t body_stmt_no;
+	/**
+	 * Number of run iterators using the page plus one if
+	 * the page is stored in the page cache.
+	 */
+	int refs;
+	/** Run the page belongs to if cached, NULL otherwise. */
+	struct vy_run *run;
+	/** Set if the page is in the protected cache segment. */
+	bool is_protected;
+	/** Link in a page cache LRU list. */
+	struct rlist in_cache;
 };
 
 /**
@@ -330,6 +443,19 @@ vy_run_env_destroy(struct vy_run_env *env);
 void
 vy_run_env_enable_coio(struct vy_run_env *env);
 
+/**
+ * Set the max size of the page cache, evicting pages that
+ * don't fit in the new quota.
+ */
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota);
+
+/**
+ * Set the max number of pages a run iterator reads ahead.
+ */
+void
+vy_run_env_set_readahead(struct vy_run_env *env, uint32_t pages);
+
 /**
  * Return the size of a run bloom filter.
  */
@@ -548,6 +674,23 @@ vy_run_iterator_skip(struct vy_run_iterator *itr, struct vy_entry last,
 void
 vy_run_iterator_close(struct vy_run_iterator *itr);
 
+/**
+ * Prepare point lookups of several keys in a run slice. For each
+ * iterator, the bloom filter is checked and the page the key may
+ * be stored in is found. Then all pages that aren't cached are
+ * read in parallel by reader threads and given to the iterators,
+ * so the lookups don't have to wait for the pages one by one.
+ *
+ * All iterators must be open on the same slice with ITER_EQ and
+ * full keys and mustn't be started yet. Keys must be sorted so
+ * that a page needed by several keys is read only once.
+ *
+ * The function is best effort: pages that failed to be read are
+ * read again by the iterators themselves.
+ */
+void
+vy_run_iterator_prefetch(struct vy_run_iterator *itrs, int count);
+
 /**
  * Simple stream over a slice. @see vy_stmt_stream.
  */
@@ -608,16 +751,30 @@ struct vy_run_writer {
 	 * dumped.
 	 */
 	uint64_t page_size;
+	/**
+	 * Number of statements between restart points of a page,
+	 * 0 if key prefix compression is disabled.
+	 */
+	uint32_t restart_interval;
+	/** Body of the last written statement. */
+	struct vy_prefix_buf prev_body;
 	/**
 	 * Current page info capacity. Can grow with page number.
 	 */
 	uint32_t page_info_capacity;
 	/** Don't use compression while writing xlog files. */
 	bool no_compression;
+	/**
+	 * If not NULL, written statements are fed to this
+	 * sampler to train a compression dictionary.
+	 */
+	struct xlog_zdict_sampler *sampler;
 	/** Xlog to write data. */
 	struct xlog data_xlog;
 	/** Bloom filter false positive rate. */
 	double bloom_fpr;
+	/** Bloom filter layout. */
+	enum bloom_type bloom_type;
 	/** Bloom filter. */
 	struct tuple_bloom_builder *bloom;
 	/** Buffer of a current page row offsets. */
@@ -629,12 +786,19 @@ struct vy_run_writer {
 	struct vy_entry last;
 };
 
-/** Create a run writer to fill a run with statements. */
+/**
+ * Create a run writer to fill a run with statements.
+ * If compression is enabled, pages are compressed with
+ * vy_run::zdict, if set. If @a restart_interval is not 0,
+ * statements are stored with key prefix compression.
+ */
 int
 vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 		     const char *dirpath, uint32_t space_id, uint32_t iid,
 		     struct key_def *cmp_def, struct key_def *key_def,
-		     uint64_t page_size, double bloom_fpr, bool no_compression);
+		     uint64_t page_size, uint32_t restart_interval,
+		     double bloom_fpr, enum bloom_type bloom_type,
+		     bool no_compression, struct xlog_zdict_sampler *sampler);
 
 /**
  * Write a specified statement into a run.
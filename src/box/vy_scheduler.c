@@ -203,7 +203,16 @@ struct vy_task {
 	 * from another thread.
 	 */
 	double bloom_fpr;
+	enum bloom_type bloom_type;
 	int64_t page_size;
+	uint32_t page_restart_interval;
+	/**
+	 * Size of a compression dictionary to train on the data
+	 * written by this task, 0 if it shouldn't be trained.
+	 */
+	size_t zdict_size;
+	/** Dictionary trained on the data written by this task. */
+	struct xlog_zdict *new_zdict;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
 	 * It sends deferred DELETE statements generated during
@@ -272,6 +281,8 @@ vy_task_delete(struct vy_task *task)
 	assert(task->deferred_delete_in_progress == 0);
 	key_def_delete(task->cmp_def);
 	key_def_delete(task->key_def);
+	if (task->new_zdict != NULL)
+		xlog_zdict_unref(task->new_zdict);
 	vy_lsm_unref(task->lsm);
 	diag_destroy(&task->diag);
 	free(task);
@@ -1049,6 +1060,22 @@ vy_task_deferred_delete_iface = {
 	.destroy = vy_task_deferred_delete_destroy,
 };
 
+/**
+ * Install the compression dictionary trained by a task, so
+ * that the next compaction of the LSM tree uses it.
+ */
+static void
+vy_task_install_zdict(struct vy_task *task)
+{
+	struct vy_lsm *lsm = task->lsm;
+	if (task->new_zdict == NULL)
+		return;
+	if (lsm->zdict != NULL)
+		xlog_zdict_unref(lsm->zdict);
+	lsm->zdict = task->new_zdict;
+	task->new_zdict = NULL;
+}
+
 static int
 vy_task_write_run(struct vy_task *task, bool no_compression)
 {
@@ -1062,12 +1089,16 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 			       "vinyl dump"); return -1;});
 	ERROR_INJECT_SLEEP(ERRINJ_VY_RUN_WRITE_DELAY);
 
+	struct xlog_zdict_sampler sampler;
+	xlog_zdict_sampler_create(&sampler, task->zdict_size);
 	struct vy_run_writer writer;
 	if (vy_run_writer_create(&writer, task->new_run, lsm->env->path,
 				 lsm->space_id, lsm->index_id,
 				 task->cmp_def, task->key_def,
-				 task->page_size, task->bloom_fpr,
-				 no_compression) != 0)
+				 task->page_size, task->page_restart_interval,
+				 task->bloom_fpr, task->bloom_type,
+				 no_compression,
+				 task->zdict_size > 0 ? &sampler : NULL) != 0)
 		goto fail;
 
 	if (wi->iface->start(wi) != 0)
@@ -1100,11 +1131,21 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 	if (rc != 0)
 		goto fail_abort_writer;
 
+	/* Train a dictionary for the next compaction. */
+	if (task->zdict_size > 0 &&
+	    xlog_zdict_sampler_train(&sampler, task->zdict_size,
+				     &task->new_zdict) != 0) {
+		diag_log();
+		say_warn("%s: failed to train compression dictionary",
+			 vy_lsm_name(lsm));
+	}
+	xlog_zdict_sampler_destroy(&sampler);
 	return 0;
 
 fail_abort_writer:
 	vy_run_writer_abort(&writer);
 fail:
+	xlog_zdict_sampler_destroy(&sampler);
 	return -1;
 }
 
@@ -1137,6 +1178,8 @@ vy_task_dump_complete(struct vy_task *task)
 
 	assert(lsm->is_dumping);
 
+	vy_task_install_zdict(task);
+
 	if (vy_run_is_empty(new_run)) {
 		/*
 		 * In case the run is empty, we can discard the run
@@ -1396,7 +1439,15 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
+	task->bloom_type = lsm->opts.bloom_type;
 	task->page_size = lsm->opts.page_size;
+	task->page_restart_interval = lsm->opts.page_restart_interval;
+	/*
+	 * Dumped runs aren't compressed, but we train
+	 * a dictionary on them for the first compaction.
+	 */
+	if (lsm->zdict == NULL)
+		task->zdict_size = scheduler->run_env->zdict_size;
 
 	lsm->is_dumping = true;
 	vy_scheduler_update_lsm(scheduler, lsm);
@@ -1460,6 +1511,7 @@ vy_task_compaction_complete(struct vy_task *task)
 	 * and insert it into the range, but we still need to delete
 	 * compacted runs.
 	 */
+	vy_task_install_zdict(task);
 	if (!vy_run_is_empty(new_run)) {
 		new_slice = vy_slice_new(vy_log_next_id(), new_run,
 					 vy_entry_none(), vy_entry_none(),
@@ -1691,7 +1743,14 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
+	task->bloom_type = lsm->opts.bloom_type;
 	task->page_size = lsm->opts.page_size;
+	task->page_restart_interval = lsm->opts.page_restart_interval;
+	task->zdict_size = scheduler->run_env->zdict_size;
+	if (task->zdict_size > 0 && lsm->zdict != NULL) {
+		new_run->zdict = lsm->zdict;
+		xlog_zdict_ref(new_run->zdict);
+	}
 
 	/*
 	 * Remove the range we are going to compact from the heap
@@ -42,6 +42,10 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include "replication.h"
+#include "histogram.h"
+#include "info/info.h"
+#include "tt_pthread.h"
+#include "small/ibuf.h"
 
 enum {
 	/**
@@ -53,6 +57,12 @@ enum {
 	 * latency. 1 MB seems to be a well balanced choice.
 	 */
 	WAL_FALLOCATE_LEN = 1024 * 1024,
+	/**
+	 * Size of disk space to preallocate in direct I/O mode.
+	 * Writes bypass the page cache then, so extending the
+	 * file on write is relatively more expensive.
+	 */
+	WAL_FALLOCATE_LEN_DIRECT = 16 * 1024 * 1024,
 };
 
 const char *wal_mode_STRS[] = { "none", "write", "fsync", NULL };
@@ -71,6 +81,72 @@ wal_write_none_async(struct journal *, struct journal_entry *);
 static int
 wal_write_none(struct journal *, struct journal_entry *);
 
+/** A thread compressing WAL tx blocks. */
+struct wal_compress_worker {
+	struct cord cord;
+	/** Pipe from WAL to the worker. */
+	struct cpipe worker_pipe;
+	/** Pipe from the worker back to WAL. */
+	struct cpipe wal_pipe;
+	/** Compression context, used only by the worker thread. */
+	ZSTD_CCtx *zctx;
+	/** Route of a compression request. */
+	struct cmsg_hop route[2];
+};
+
+/**
+ * Compressor of WAL tx blocks: a pool of threads fed with
+ * blocks by WAL thread, so that compression of big
+ * transactions doesn't delay writing and syncing of others.
+ */
+struct wal_compressor {
+	struct xlog_compressor base;
+	/** Number of worker threads, compression is off if 0. */
+	int worker_count;
+	/** Worker threads. */
+	struct wal_compress_worker *workers;
+	/** Index of the worker to send the next block to. */
+	int next_worker;
+	/** WAL thread fiber receiving compressed blocks. */
+	struct fiber *fiber;
+	/** Signaled whenever a block gets compressed. */
+	struct fiber_cond cond;
+};
+
+/** A request to compress a tx block. */
+struct wal_compress_msg {
+	struct cmsg base;
+	struct wal_compressor *compressor;
+	struct wal_compress_worker *worker;
+	struct xlog_tx_block *block;
+};
+
+/**
+ * In-memory ring of rows recently written to WAL. Relays that
+ * have caught up with WAL read new rows from the ring rather
+ * than re-read and decode WAL files, falling back on files
+ * only if they lag behind the ring.
+ *
+ * The ring is a byte buffer of wal_ring_rec records addressed
+ * by ever-growing positions, a position being mapped to an
+ * offset in the buffer modulo its capacity. Records may wrap
+ * around the buffer end.
+ */
+struct wal_ring {
+	/** Protects the ring from concurrent access by relays. */
+	pthread_mutex_t mutex;
+	/** Ring buffer or NULL if the ring is disabled. */
+	char *data;
+	/** Size of the ring buffer. */
+	size_t capacity;
+	/** Position of the oldest record. */
+	uint64_t begin;
+	/** Position following the newest record. */
+	uint64_t end;
+	/** Vclock of the last row evicted from the ring. */
+	struct vclock vclock;
+};
+
 /*
  * WAL writer - maintain a Write Ahead Log for every change
  * in the data state.
@@ -103,6 +179,28 @@ struct wal_writer
 	 * rolled back too.
 	 */
 	struct journal_entry *last_entry;
+	/**
+	 * A setting from instance configuration - wal_commit_delay.
+	 * For how long a batch of requests may be kept in tx
+	 * waiting for more requests before it is sent to WAL.
+	 */
+	double commit_delay;
+	/**
+	 * A setting from instance configuration -
+	 * wal_max_batch_size. A batch exceeding this size is
+	 * sent to WAL regardless of wal_commit_delay.
+	 */
+	int64_t max_batch_size;
+	/** Timer sending a delayed batch to WAL. */
+	struct ev_timer commit_timer;
+	/** Number of batches written to WAL. */
+	int64_t batch_count;
+	/** Number of requests written to WAL. */
+	int64_t request_count;
+	/** Distribution of the number of requests in a batch. */
+	struct histogram *batch_hist;
+	/** Distribution of the size of a batch, in bytes. */
+	struct histogram *batch_size_hist;
 	/* ----------------- wal ------------------- */
 	/** A setting from instance configuration - wal_max_size */
 	int64_t wal_max_size;
@@ -154,6 +252,8 @@ struct wal_writer
 	bool checkpoint_triggered;
 	/** The current WAL file. */
 	struct xlog current_wal;
+	/** Compressor of the current WAL blocks. */
+	struct wal_compressor compressor;
 	/**
 	 * Used if there was a WAL I/O error and we need to
 	 * keep adding all incoming requests to the rollback
@@ -166,12 +266,16 @@ struct wal_writer
 	 * Used for replication relays.
 	 */
 	struct rlist watchers;
+	/** Memory ring of recently written rows. */
+	struct wal_ring ring;
 };
 
 struct wal_msg {
 	struct cmsg base;
 	/** Approximate size of this request when encoded. */
 	size_t approx_len;
+	/** Number of requests in the batch. */
+	int n_requests;
 	/** Input queue, on output contains all committed requests. */
 	struct stailq commit;
 	/**
@@ -212,6 +316,9 @@ wal_write_to_disk(struct cmsg *msg);
 static void
 tx_complete_batch(struct cmsg *msg);
 
+static void
+wal_commit_timer_cb(struct ev_loop *loop, struct ev_timer *timer, int events);
+
 static struct cmsg_hop wal_request_route[] = {
 	{wal_write_to_disk, &wal_writer_singleton.tx_prio_pipe},
 	{tx_complete_batch, NULL},
@@ -222,6 +329,7 @@ wal_msg_create(struct wal_msg *batch)
 {
 	cmsg_init(&batch->base, wal_request_route);
 	batch->approx_len = 0;
+	batch->n_requests = 0;
 	stailq_create(&batch->commit);
 	stailq_create(&batch->rollback);
 	vclock_create(&batch->vclock);
@@ -367,6 +475,10 @@ tx_complete_batch(struct cmsg *msg)
 	}
 	/* Update the tx vclock to the latest written by wal. */
 	vclock_copy(&replicaset.vclock, &batch->vclock);
+	writer->batch_count++;
+	writer->request_count += batch->n_requests;
+	histogram_collect(writer->batch_hist, batch->n_requests);
+	histogram_collect(writer->batch_size_hist, batch->approx_len);
 	tx_schedule_queue(&batch->commit);
 	mempool_free(&writer->msg_pool, container_of(msg, struct wal_msg, base));
 }
@@ -408,12 +520,15 @@ tx_notify_checkpoint(struct cmsg *msg)
 static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, int64_t wal_max_size,
+		  int compress_threads, bool direct_io,
 		  const struct tt_uuid *instance_uuid,
 		  wal_on_garbage_collection_f on_garbage_collection,
 		  wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
 	writer->wal_mode = wal_mode;
 	writer->wal_max_size = wal_max_size;
+	writer->compressor.worker_count = compress_threads;
+	writer->compressor.workers = NULL;
 
 	journal_create(&writer->base,
 		       wal_mode == WAL_NONE ?
@@ -423,6 +538,7 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	struct xlog_opts opts = xlog_opts_default;
 	opts.sync_is_async = true;
+	opts.direct_io = direct_io;
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid, &opts);
 	xlog_clear(&writer->current_wal);
 	if (wal_mode == WAL_FSYNC)
@@ -444,19 +560,449 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	mempool_create(&writer->msg_pool, &cord()->slabc,
 		       sizeof(struct wal_msg));
+
+	writer->commit_delay = 0;
+	writer->max_batch_size = INT64_MAX;
+	ev_timer_init(&writer->commit_timer, wal_commit_timer_cb, 0, 0);
+	writer->commit_timer.data = writer;
+	writer->batch_count = 0;
+	writer->request_count = 0;
+}
+
+/**
+ * Create histograms of WAL batches. Allocated separately from
+ * wal_writer_create(), since it can fail.
+ */
+static int
+wal_writer_create_stat(struct wal_writer *writer)
+{
+	static const int64_t batch_buckets[] = {
+		1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048,
+		4096, 8192,
+	};
+	static const int64_t batch_size_buckets[] = {
+		128, 256, 512, 1024, 4096, 16384, 65536, 262144,
+		1048576, 4194304, 16777216,
+	};
+	writer->batch_hist = histogram_new(batch_buckets,
+					   lengthof(batch_buckets));
+	writer->batch_size_hist = histogram_new(batch_size_buckets,
+						lengthof(batch_size_buckets));
+	if (writer->batch_hist == NULL || writer->batch_size_hist == NULL) {
+		diag_set(OutOfMemory, sizeof(struct histogram), "malloc",
+			 "struct histogram");
+		return -1;
+	}
+	return 0;
 }
 
+/* {{{ WAL memory ring */
+
+/**
+ * Create a WAL memory ring of the given capacity.
+ * Zero capacity means that the ring is disabled.
+ */
+static int
+wal_ring_create(struct wal_ring *ring, size_t capacity)
+{
+	tt_pthread_mutex_init(&ring->mutex, NULL);
+	ring->data = NULL;
+	ring->capacity = capacity;
+	ring->begin = ring->end = 0;
+	vclock_create(&ring->vclock);
+	if (capacity == 0)
+		return 0;
+	ring->data = malloc(capacity);
+	if (ring->data == NULL) {
+		diag_set(OutOfMemory, capacity, "malloc", "WAL ring");
+		return -1;
+	}
+	return 0;
+}
+
+static void
+wal_ring_destroy(struct wal_ring *ring)
+{
+	free(ring->data);
+	tt_pthread_mutex_destroy(&ring->mutex);
+}
+
+/** Copy data stored in the ring at the given position. */
+static void
+wal_ring_copy_out(struct wal_ring *ring, uint64_t pos,
+		  void *data, size_t size)
+{
+	assert(size <= ring->capacity);
+	size_t offset = pos % ring->capacity;
+	size_t len = MIN(size, ring->capacity - offset);
+	memcpy(data, ring->data + offset, len);
+	memcpy((char *)data + len, ring->data, size - len);
+}
+
+/** Append data to the ring, there must be enough room for it. */
+static void
+wal_ring_copy_in(struct wal_ring *ring, const void *data, size_t size)
+{
+	assert(ring->end + size - ring->begin <= ring->capacity);
+	size_t offset = ring->end % ring->capacity;
+	size_t len = MIN(size, ring->capacity - offset);
+	memcpy(ring->data + offset, data, len);
+	memcpy(ring->data, (const char *)data + len, size - len);
+	ring->end += size;
+}
+
+/**
+ * Drop all records from the ring. Used when a row can't be
+ * stored in the ring so that readers fall back on WAL files.
+ * @a vclock is the vclock of the last row written to WAL.
+ */
+static void
+wal_ring_reset(struct wal_ring *ring, const struct vclock *vclock)
+{
+	/*
+	 * Advance the end position so that readers that have
+	 * read everything up to the old end notice the loss.
+	 */
+	ring->end++;
+	ring->begin = ring->end;
+	vclock_copy(&ring->vclock, vclock);
+}
+
+/** Evict the oldest records to make room for @a size bytes. */
+static void
+wal_ring_reserve(struct wal_ring *ring, size_t size)
+{
+	assert(size <= ring->capacity);
+	while (ring->end + size - ring->begin > ring->capacity) {
+		struct wal_ring_rec rec;
+		wal_ring_copy_out(ring, ring->begin, &rec, sizeof(rec));
+		if (rec.size != 0 &&
+		    rec.lsn > vclock_get(&ring->vclock, rec.replica_id))
+			vclock_follow(&ring->vclock, rec.replica_id, rec.lsn);
+		ring->begin += sizeof(rec) + rec.size;
+	}
+}
+
+/**
+ * Append a row to the ring. Returns -1 if the row is too big
+ * to be stored in the ring or can't be encoded.
+ */
+static int
+wal_ring_append_row(struct wal_ring *ring, const struct xrow_header *row)
+{
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_header_encode(row, 0, iov, 0);
+	if (iovcnt < 0)
+		return -1;
+	struct wal_ring_rec rec;
+	rec.size = 0;
+	rec.replica_id = row->replica_id;
+	rec.lsn = row->lsn;
+	for (int i = 0; i < iovcnt; i++)
+		rec.size += iov[i].iov_len;
+	if (sizeof(rec) + rec.size > ring->capacity)
+		return -1;
+	wal_ring_reserve(ring, sizeof(rec) + rec.size);
+	wal_ring_copy_in(ring, &rec, sizeof(rec));
+	for (int i = 0; i < iovcnt; i++)
+		wal_ring_copy_in(ring, iov[i].iov_base, iov[i].iov_len);
+	return 0;
+}
+
+/**
+ * Append rows of the given journal entries, which have just
+ * been written to WAL, to the ring. @a vclock is the vclock
+ * of the last written row.
+ */
+static void
+wal_ring_write(struct wal_ring *ring, struct stailq *entries,
+	       const struct vclock *vclock)
+{
+	if (ring->data == NULL || stailq_empty(entries))
+		return;
+	tt_pthread_mutex_lock(&ring->mutex);
+	struct journal_entry *entry;
+	stailq_foreach_entry(entry, entries, fifo) {
+		struct xrow_header **row = entry->rows;
+		for (; row < entry->rows + entry->n_rows; row++) {
+			if (wal_ring_append_row(ring, *row) != 0) {
+				diag_clear(diag_get());
+				wal_ring_reset(ring, vclock);
+				goto out;
+			}
+		}
+	}
+out:
+	tt_pthread_mutex_unlock(&ring->mutex);
+}
+
+/**
+ * Append a mark of a WAL rotation to the ring so that relays
+ * reading rows from the ring know when they are done with
+ * a WAL file, see recovery_skip_log().
+ */
+static void
+wal_ring_write_rotate(struct wal_ring *ring, const struct vclock *vclock)
+{
+	if (ring->data == NULL)
+		return;
+	struct wal_ring_rec rec;
+	rec.size = 0;
+	rec.replica_id = 0;
+	rec.lsn = vclock_sum(vclock);
+	tt_pthread_mutex_lock(&ring->mutex);
+	wal_ring_reserve(ring, sizeof(rec));
+	wal_ring_copy_in(ring, &rec, sizeof(rec));
+	tt_pthread_mutex_unlock(&ring->mutex);
+}
+
+int
+wal_ring_seek(const struct vclock *vclock, uint64_t *pos)
+{
+	struct wal_ring *ring = &wal_writer_singleton.ring;
+	int rc = -1;
+	tt_pthread_mutex_lock(&ring->mutex);
+	if (ring->data == NULL)
+		goto out;
+	/* Check that no row following @vclock was evicted. */
+	int cmp = vclock_compare_ignore0(&ring->vclock, vclock);
+	if (cmp != 0 && cmp != -1)
+		goto out;
+	/*
+	 * Stop at the first row following @vclock or at the first
+	 * rotation mark not preceding it, whichever comes first:
+	 * skipping the mark would keep the reader on the previous
+	 * WAL file and hold back its garbage collection.
+	 */
+	int64_t signature = vclock_sum(vclock);
+	uint64_t p = ring->begin;
+	while (p < ring->end) {
+		struct wal_ring_rec rec;
+		wal_ring_copy_out(ring, p, &rec, sizeof(rec));
+		if (rec.size == 0 && rec.lsn >= signature)
+			break;
+		if (rec.size != 0 && rec.replica_id != 0 &&
+		    rec.lsn > vclock_get(vclock, rec.replica_id))
+			break;
+		p += sizeof(rec) + rec.size;
+	}
+	*pos = p;
+	rc = 0;
+out:
+	tt_pthread_mutex_unlock(&ring->mutex);
+	return rc;
+}
+
+ssize_t
+wal_ring_read(uint64_t *pos, struct ibuf *buf, size_t size)
+{
+	struct wal_ring *ring = &wal_writer_singleton.ring;
+	ssize_t rc = -1;
+	tt_pthread_mutex_lock(&ring->mutex);
+	if (*pos < ring->begin)
+		goto out;
+	assert(*pos <= ring->end);
+	uint64_t end = *pos;
+	while (end < ring->end) {
+		struct wal_ring_rec rec;
+		wal_ring_copy_out(ring, end, &rec, sizeof(rec));
+		if (end > *pos && end + sizeof(rec) + rec.size - *pos > size)
+			break;
+		end += sizeof(rec) + rec.size;
+	}
+	size_t len = end - *pos;
+	char *data = ibuf_alloc(buf, len);
+	if (data == NULL) {
+		diag_set(OutOfMemory, len, "ibuf_alloc", "WAL ring records");
+		goto out;
+	}
+	wal_ring_copy_out(ring, *pos, data, len);
+	*pos = end;
+	rc = len;
+out:
+	tt_pthread_mutex_unlock(&ring->mutex);
+	return rc;
+}
+
+/* }}} */
+
 /** Destroy a WAL writer structure. */
 static void
 wal_writer_destroy(struct wal_writer *writer)
 {
+	wal_ring_destroy(&writer->ring);
 	xdir_destroy(&writer->wal_dir);
+	if (writer->batch_hist != NULL)
+		histogram_delete(writer->batch_hist);
+	if (writer->batch_size_hist != NULL)
+		histogram_delete(writer->batch_size_hist);
 }
 
 /** WAL writer thread routine. */
 static int
 wal_writer_f(va_list ap);
 
+/** Compress a tx block, called in a compression thread. */
+static void
+wal_compress_f(struct cmsg *base)
+{
+	struct wal_compress_msg *msg = (struct wal_compress_msg *)base;
+	if (xlog_tx_block_compress(msg->block, msg->worker->zctx) != 0)
+		diag_move(diag_get(), &msg->block->diag);
+}
+
+/** Deliver a compressed tx block back to WAL thread. */
+static void
+wal_compress_complete_f(struct cmsg *base)
+{
+	struct wal_compress_msg *msg = (struct wal_compress_msg *)base;
+	msg->block->is_ready = true;
+	fiber_cond_broadcast(&msg->compressor->cond);
+	free(msg);
+}
+
+static void
+wal_compressor_submit(struct xlog_compressor *base,
+		      struct xlog_tx_block *block)
+{
+	struct wal_compressor *compressor =
+		container_of(base, struct wal_compressor, base);
+	struct wal_compress_msg *msg =
+		(struct wal_compress_msg *)malloc(sizeof(*msg));
+	if (msg == NULL) {
+		diag_set(OutOfMemory, sizeof(*msg), "malloc",
+			 "struct wal_compress_msg");
+		diag_move(diag_get(), &block->diag);
+		block->is_ready = true;
+		return;
+	}
+	struct wal_compress_worker *worker =
+		&compressor->workers[compressor->next_worker];
+	compressor->next_worker = (compressor->next_worker + 1) %
+				  compressor->worker_count;
+	cmsg_init(&msg->base, worker->route);
+	msg->compressor = compressor;
+	msg->worker = worker;
+	msg->block = block;
+	/*
+	 * Don't wait for the end of the event loop iteration,
+	 * WAL thread is going to encode more rows meanwhile.
+	 */
+	cpipe_push_input(&worker->worker_pipe, &msg->base);
+	cpipe_deliver_now(&worker->worker_pipe);
+}
+
+static void
+wal_compressor_wait(struct xlog_compressor *base,
+		    struct xlog_tx_block *block)
+{
+	struct wal_compressor *compressor =
+		container_of(base, struct wal_compressor, base);
+	while (!block->is_ready)
+		fiber_cond_wait(&compressor->cond);
+}
+
+/** Compression thread routine. */
+static int
+wal_compress_worker_f(va_list ap)
+{
+	struct wal_compress_worker *worker =
+		va_arg(ap, struct wal_compress_worker *);
+	worker->zctx = ZSTD_createCCtx();
+	if (worker->zctx == NULL)
+		panic("failed to create WAL compression context");
+	struct cbus_endpoint endpoint;
+	cpipe_create(&worker->wal_pipe, "wal.compress");
+	cbus_endpoint_create(&endpoint, cord_name(&worker->cord),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&worker->wal_pipe);
+	ZSTD_freeCCtx(worker->zctx);
+	return 0;
+}
+
+/** WAL thread fiber receiving compressed blocks. */
+static int
+wal_compressor_f(va_list ap)
+{
+	(void)ap;
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "wal.compress",
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	return 0;
+}
+
+/** Start compression threads, called in WAL thread. */
+static void
+wal_compressor_start(struct wal_compressor *compressor)
+{
+	assert(compressor->worker_count > 0);
+	compressor->base.submit = wal_compressor_submit;
+	compressor->base.wait = wal_compressor_wait;
+	compressor->next_worker = 0;
+	fiber_cond_create(&compressor->cond);
+
+	compressor->fiber = fiber_new("wal.compress", wal_compressor_f);
+	if (compressor->fiber == NULL)
+		panic("failed to start WAL compression fiber");
+	fiber_set_joinable(compressor->fiber, true);
+	fiber_start(compressor->fiber);
+
+	compressor->workers = calloc(compressor->worker_count,
+				     sizeof(*compressor->workers));
+	if (compressor->workers == NULL)
+		panic("failed to allocate WAL compression threads");
+	for (int i = 0; i < compressor->worker_count; i++) {
+		char name[FIBER_NAME_MAX];
+		snprintf(name, sizeof(name), "wal.compress.%d", i);
+		struct wal_compress_worker *worker = &compressor->workers[i];
+		if (cord_costart(&worker->cord, name, wal_compress_worker_f,
+				 worker) != 0)
+			panic("failed to start WAL compression thread");
+		cpipe_create(&worker->worker_pipe, name);
+		worker->route[0].f = wal_compress_f;
+		worker->route[0].pipe = &worker->wal_pipe;
+		worker->route[1].f = wal_compress_complete_f;
+		worker->route[1].pipe = NULL;
+	}
+}
+
+/**
+ * Stop compression threads, called in WAL thread when there
+ * are no blocks in flight.
+ */
+static void
+wal_compressor_stop(struct wal_compressor *compressor)
+{
+	for (int i = 0; i < compressor->worker_count; i++) {
+		struct wal_compress_worker *worker = &compressor->workers[i];
+		cbus_stop_loop(&worker->worker_pipe);
+		cpipe_destroy(&worker->worker_pipe);
+		if (cord_cojoin(&worker->cord) != 0)
+			panic("failed to join WAL compression thread");
+	}
+	free(compressor->workers);
+	compressor->workers = NULL;
+	fiber_cancel(compressor->fiber);
+	fiber_join(compressor->fiber);
+	fiber_cond_destroy(&compressor->cond);
+}
+
+/**
+ * Hand tx blocks of the current WAL over to compression
+ * threads, if there are any.
+ */
+static void
+wal_set_compressor(struct wal_writer *writer)
+{
+	if (writer->compressor.worker_count > 0)
+		xlog_set_compressor(&writer->current_wal,
+				    &writer->compressor.base);
+}
+
 static int
 wal_open_f(struct cbus_call_msg *msg)
 {
@@ -465,7 +1011,10 @@ wal_open_f(struct cbus_call_msg *msg)
 	const char *path = xdir_format_filename(&writer->wal_dir,
 				vclock_sum(&writer->vclock), NONE);
 	assert(!xlog_is_open(&writer->current_wal));
-	return xlog_open(&writer->current_wal, path, &writer->wal_dir.opts);
+	if (xlog_open(&writer->current_wal, path, &writer->wal_dir.opts) != 0)
+		return -1;
+	wal_set_compressor(writer);
+	return 0;
 }
 
 /**
@@ -528,15 +1077,21 @@ wal_open(struct wal_writer *writer)
 
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
-	 int64_t wal_max_size, const struct tt_uuid *instance_uuid,
+	 int64_t wal_max_size, int compress_threads, bool direct_io,
+	 int64_t ring_size, const struct tt_uuid *instance_uuid,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold)
 {
 	/* Initialize the state. */
 	struct wal_writer *writer = &wal_writer_singleton;
 	wal_writer_create(writer, wal_mode, wal_dirname, wal_max_size,
-			  instance_uuid, on_garbage_collection,
-			  on_checkpoint_threshold);
+			  compress_threads, direct_io, instance_uuid,
+			  on_garbage_collection, on_checkpoint_threshold);
+	if (wal_writer_create_stat(writer) != 0)
+		return -1;
+	if (wal_ring_create(&writer->ring,
+			    wal_mode == WAL_NONE ? 0 : ring_size) != 0)
+		return -1;
 
 	/* Start WAL thread. */
 	if (cord_costart(&writer->cord, "wal", wal_writer_f, NULL) != 0)
@@ -555,6 +1110,7 @@ wal_enable(void)
 
 	/* Initialize the writer vclock from the recovery state. */
 	vclock_copy(&writer->vclock, &replicaset.vclock);
+	vclock_copy(&writer->ring.vclock, &writer->vclock);
 
 	/*
 	 * Scan the WAL directory to build an index of all
@@ -578,6 +1134,7 @@ wal_free(void)
 {
 	struct wal_writer *writer = &wal_writer_singleton;
 
+	ev_timer_stop(loop(), &writer->commit_timer);
 	cbus_stop_loop(&writer->wal_pipe);
 
 	if (cord_join(&writer->cord)) {
@@ -765,6 +1322,59 @@ wal_set_checkpoint_threshold(int64_t threshold)
 	fiber_set_cancellable(cancellable);
 }
 
+/** Send requests delayed by wal_commit_delay to WAL. */
+static void
+wal_commit_timer_cb(struct ev_loop *loop, struct ev_timer *timer, int events)
+{
+	(void)loop;
+	(void)events;
+	struct wal_writer *writer = (struct wal_writer *)timer->data;
+	cpipe_flush_input(&writer->wal_pipe);
+}
+
+void
+wal_set_commit_delay(double delay)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	writer->commit_delay = delay;
+	if (delay == 0) {
+		ev_timer_stop(loop(), &writer->commit_timer);
+		cpipe_flush_input(&writer->wal_pipe);
+	}
+}
+
+void
+wal_set_max_batch_size(int64_t size)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	writer->max_batch_size = size;
+}
+
+void
+wal_stat(struct info_handler *h)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	char buf[1024];
+	info_begin(h);
+	info_append_int(h, "batches", writer->batch_count);
+	info_append_int(h, "requests", writer->request_count);
+	histogram_snprint(buf, sizeof(buf), writer->batch_hist);
+	info_append_str(h, "batch_histogram", buf);
+	histogram_snprint(buf, sizeof(buf), writer->batch_size_hist);
+	info_append_str(h, "batch_size_histogram", buf);
+	info_end(h);
+}
+
+void
+wal_reset_stat(void)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	writer->batch_count = 0;
+	writer->request_count = 0;
+	histogram_reset(writer->batch_hist);
+	histogram_reset(writer->batch_size_hist);
+}
+
 struct wal_gc_msg
 {
 	struct cbus_call_msg base;
@@ -855,12 +1465,14 @@ wal_opt_rotate(struct wal_writer *writer)
 		diag_log();
 		return -1;
 	}
+	wal_set_compressor(writer);
 	/*
 	 * Keep track of the new WAL vclock. Required for garbage
 	 * collection, see wal_collect_garbage().
 	 */
 	xdir_add_vclock(&writer->wal_dir, &writer->vclock);
 
+	wal_ring_write_rotate(&writer->ring, &writer->vclock);
 	wal_notify_watchers(writer, WAL_EVENT_ROTATE);
 	return 0;
 }
@@ -892,12 +1504,18 @@ wal_fallocate(struct wal_writer *writer, size_t len)
 	 * given length to get a rough upper bound estimate.
 	 */
 	len *= 2;
+	size_t chunk = WAL_FALLOCATE_LEN;
+	if (l->opts.direct_io) {
+		/* Account for the padding added on flush. */
+		len += 2 * XLOG_DIO_ALIGN;
+		chunk = WAL_FALLOCATE_LEN_DIRECT;
+	}
 
 retry:
 	if (errinj == NULL || errinj->iparam == 0) {
 		if (l->allocated >= len)
 			goto out;
-		if (xlog_fallocate(l, MAX(len, WAL_FALLOCATE_LEN)) == 0)
+		if (xlog_fallocate(l, MAX(len, chunk)) == 0)
 			goto out;
 	} else {
 		errinj->iparam--;
@@ -1165,6 +1783,8 @@ done:
 		stailq_concat(&wal_msg->rollback, &rollback);
 		wal_begin_rollback();
 	}
+	/* Let relays read the written rows from memory. */
+	wal_ring_write(&writer->ring, &wal_msg->commit, &writer->vclock);
 	fiber_gc();
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 	ERROR_INJECT_SLEEP(ERRINJ_RELAY_FASTER_THAN_TX);
@@ -1189,6 +1809,9 @@ wal_writer_f(va_list ap)
 	 */
 	cpipe_create(&writer->tx_prio_pipe, "tx_prio");
 
+	if (writer->compressor.worker_count > 0)
+		wal_compressor_start(&writer->compressor);
+
 	cbus_loop(&endpoint);
 
 	/*
@@ -1214,6 +1837,9 @@ wal_writer_f(va_list ap)
 	if (xlog_is_open(&vy_log_writer.xlog))
 		xlog_close(&vy_log_writer.xlog, false);
 
+	if (writer->compressor.workers != NULL)
+		wal_compressor_stop(&writer->compressor);
+
 	cpipe_destroy(&writer->tx_prio_pipe);
 	return 0;
 }
@@ -1265,7 +1891,21 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 		 * thread right away.
 		 */
 		stailq_add_tail_entry(&batch->commit, entry, fifo);
-		cpipe_push(&writer->wal_pipe, &batch->base);
+		if (writer->commit_delay > 0) {
+			/*
+			 * Don't schedule the flush at the end of
+			 * the event loop iteration, the commit
+			 * timer will do it.
+			 */
+			cpipe_push_input(&writer->wal_pipe, &batch->base);
+			if (!ev_is_active(&writer->commit_timer)) {
+				ev_timer_set(&writer->commit_timer,
+					     writer->commit_delay, 0);
+				ev_timer_start(loop(), &writer->commit_timer);
+			}
+		} else {
+			cpipe_push(&writer->wal_pipe, &batch->base);
+		}
 	}
 	/*
 	 * Remember last entry sent to WAL. In case of rollback
@@ -1274,11 +1914,21 @@ wal_write_async(struct journal *journal, struct journal_entry *entry)
 	 */
 	writer->last_entry = entry;
 	batch->approx_len += entry->approx_len;
+	batch->n_requests++;
 	writer->wal_pipe.n_input += entry->n_rows * XROW_IOVMAX;
 #ifndef NDEBUG
 	++errinj(ERRINJ_WAL_WRITE_COUNT, ERRINJ_INT)->iparam;
 #endif
-	cpipe_flush_input(&writer->wal_pipe);
+	/*
+	 * With wal_commit_delay set, let the batch grow until
+	 * the commit timer fires or it gets big enough.
+	 */
+	if (writer->commit_delay == 0 ||
+	    (int64_t)batch->approx_len >= writer->max_batch_size ||
+	    writer->wal_pipe.n_input >= writer->wal_pipe.max_input) {
+		ev_timer_stop(loop(), &writer->commit_timer);
+		cpipe_flush_input(&writer->wal_pipe);
+	}
 	return 0;
 
 fail:
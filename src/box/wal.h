@@ -40,6 +40,8 @@
 struct fiber;
 struct wal_writer;
 struct tt_uuid;
+struct info_handler;
+struct ibuf;
 
 enum wal_mode { WAL_NONE = 0, WAL_WRITE, WAL_FSYNC, WAL_MODE_MAX };
 
@@ -77,12 +79,30 @@ typedef void (*wal_on_garbage_collection_f)(const struct vclock *vclock);
  */
 typedef void (*wal_on_checkpoint_threshold_f)(void);
 
+enum {
+	/** Max number of WAL compression threads. */
+	WAL_COMPRESS_THREADS_MAX = 64,
+};
+
 /**
  * Start WAL thread and initialize WAL writer.
+ *
+ * If @a compress_threads is not 0, transactions big enough to
+ * be compressed are compressed by that many threads rather
+ * than by WAL thread itself.
+ *
+ * If @a direct_io is set, WAL files are written with O_DIRECT
+ * from page-aligned buffers, bypassing the page cache.
+ *
+ * If @a ring_size is not 0, WAL thread keeps up to that many
+ * bytes of the most recently written rows in memory so that
+ * relays can read them without re-reading WAL files, see
+ * wal_ring_read().
  */
 int
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
-	 int64_t wal_max_size, const struct tt_uuid *instance_uuid,
+	 int64_t wal_max_size, int compress_threads, bool direct_io,
+	 int64_t ring_size, const struct tt_uuid *instance_uuid,
 	 wal_on_garbage_collection_f on_garbage_collection,
 	 wal_on_checkpoint_threshold_f on_checkpoint_threshold);
 
@@ -180,6 +200,56 @@ void
 wal_clear_watcher(struct wal_watcher *watcher,
 		  void (*process_cb)(struct cbus_endpoint *));
 
+/**
+ * Header of a record stored in the WAL memory ring.
+ * Followed by an encoded row, see xrow_header_encode().
+ */
+struct wal_ring_rec {
+	/**
+	 * Size of the encoded row following the header or 0
+	 * if the record marks a WAL rotation.
+	 */
+	uint32_t size;
+	/** Replica id of the row. */
+	uint32_t replica_id;
+	/**
+	 * LSN of the row. For a rotation mark, the signature
+	 * of the new WAL.
+	 */
+	int64_t lsn;
+};
+
+/**
+ * Find the first row in the WAL memory ring that is not
+ * included in @a vclock and return its position in @a pos.
+ * A rotation mark of a WAL starting at or after @a vclock
+ * stops the search as well.
+ * Returns -1 if the ring is disabled or rows following
+ * @a vclock have already been evicted from it.
+ * Rows with zero replica id are not taken into account,
+ * since they are never relayed.
+ *
+ * Safe to call from any thread.
+ */
+int
+wal_ring_seek(const struct vclock *vclock, uint64_t *pos);
+
+/**
+ * Copy records starting at position @a pos from the WAL
+ * memory ring to @a buf and advance the position. Only
+ * whole records are copied, up to @a size bytes, but at
+ * least one record if there is any.
+ *
+ * Returns the number of copied bytes, 0 if there are no
+ * new records, -1 if the records at @a pos have already
+ * been evicted or on memory allocation error (diag is set
+ * in the latter case only).
+ *
+ * Safe to call from any thread.
+ */
+ssize_t
+wal_ring_read(uint64_t *pos, struct ibuf *buf, size_t size);
+
 void
 wal_atfork(void);
 
@@ -237,6 +307,32 @@ wal_commit_checkpoint(struct wal_checkpoint *checkpoint);
 void
 wal_set_checkpoint_threshold(int64_t threshold);
 
+/**
+ * Set for how long requests may be kept in TX to be written
+ * to WAL in a bigger batch. Zero means that requests are sent
+ * to WAL at the end of the current event loop iteration.
+ */
+void
+wal_set_commit_delay(double delay);
+
+/**
+ * Set the size of a batch of requests which is sent to WAL
+ * without waiting for wal_commit_delay to expire.
+ */
+void
+wal_set_max_batch_size(int64_t size);
+
+/**
+ * Report statistics of WAL batches: the number of batches and
+ * requests written and distributions of the batch sizes.
+ */
+void
+wal_stat(struct info_handler *h);
+
+/** Reset the statistics reported by wal_stat(). */
+void
+wal_reset_stat(void);
+
 /**
  * Remove WAL files that are not needed by consumers reading
  * rows at @vclock or newer.
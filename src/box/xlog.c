@@ -34,11 +34,13 @@
 #include <ctype.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
 #include "exception.h"
 #include "crc32.h"
 #include "fio.h"
 #include "third_party/tarantool_eio.h"
 #include <msgpuck.h>
+#include <zdict.h>
 
 #include "coio_file.h"
 #include "tt_static.h"
@@ -96,6 +98,7 @@ const struct xlog_opts xlog_opts_default = {
 	.free_cache = false,
 	.sync_is_async = false,
 	.no_compression = false,
+	.direct_io = false,
 };
 
 /* {{{ struct xlog_meta */
@@ -114,7 +117,10 @@ enum {
 #define VCLOCK_KEY "VClock"
 #define VERSION_KEY "Version"
 #define PREV_VCLOCK_KEY "PrevVClock"
+#define ZDICT_KEY "Dictionary"
+#define PARTS_KEY "Parts"
 
+static const char v14[] = "0.14";
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
 
@@ -125,6 +131,7 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		 const struct vclock *prev_vclock)
 {
 	snprintf(meta->filetype, sizeof(meta->filetype), "%s", filetype);
+	meta->version = XLOG_FORMAT_V13;
 	meta->instance_uuid = *instance_uuid;
 	if (vclock != NULL)
 		vclock_copy(&meta->vclock, vclock);
@@ -134,6 +141,8 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 		vclock_copy(&meta->prev_vclock, prev_vclock);
 	else
 		vclock_clear(&meta->prev_vclock);
+	meta->zdict_size = 0;
+	meta->part_count = 0;
 }
 
 /**
@@ -157,7 +166,8 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 		"%s\n"
 		VERSION_KEY ": %s\n"
 		INSTANCE_UUID_KEY ": %s\n",
-		meta->filetype, v13, PACKAGE_VERSION,
+		meta->filetype,
+		meta->version == XLOG_FORMAT_V14 ? v14 : v13, PACKAGE_VERSION,
 		tt_uuid_str(&meta->instance_uuid));
 	if (vclock_is_set(&meta->vclock)) {
 		SNPRINT(total, snprintf, buf, size, VCLOCK_KEY ": %s\n",
@@ -167,6 +177,14 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 		SNPRINT(total, snprintf, buf, size, PREV_VCLOCK_KEY ": %s\n",
 			vclock_to_string(&meta->prev_vclock));
 	}
+	if (meta->zdict_size > 0) {
+		SNPRINT(total, snprintf, buf, size, ZDICT_KEY ": %u\n",
+			(unsigned)meta->zdict_size);
+	}
+	if (meta->part_count > 0) {
+		SNPRINT(total, snprintf, buf, size, PARTS_KEY ": %u\n",
+			(unsigned)meta->part_count);
+	}
 	SNPRINT(total, snprintf, buf, size, "\n");
 	assert(total > 0);
 	return total;
@@ -236,7 +254,7 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 	assert(pos <= end);
 
 	/*
-	 * Parse version string, i.e. "0.12" or "0.13"
+	 * Parse version string, i.e. "0.12", "0.13" or "0.14"
 	 */
 	char version[10];
 	eol = (const char *)memchr(pos, '\n', end - pos);
@@ -248,8 +266,13 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 	version[eol - pos] = '\0';
 	pos = eol + 1;
 	assert(pos <= end);
-	if (strncmp(version, v12, sizeof(v12)) != 0 &&
-	    strncmp(version, v13, sizeof(v13)) != 0) {
+	if (strncmp(version, v12, sizeof(v12)) == 0) {
+		meta->version = XLOG_FORMAT_V12;
+	} else if (strncmp(version, v13, sizeof(v13)) == 0) {
+		meta->version = XLOG_FORMAT_V13;
+	} else if (strncmp(version, v14, sizeof(v14)) == 0) {
+		meta->version = XLOG_FORMAT_V14;
+	} else {
 		diag_set(XlogError,
 			  "unsupported file format version %s",
 			  version);
@@ -308,6 +331,30 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 			 */
 			if (parse_vclock(val, val_end, &meta->prev_vclock) != 0)
 				return -1;
+		} else if (xlog_meta_key_equal(key, key_end, ZDICT_KEY)) {
+			/*
+			 * Dictionary: <size>
+			 */
+			char *size_end;
+			unsigned long size = strtoul(val, &size_end, 10);
+			if (size_end != val_end || size == 0 ||
+			    size > XLOG_ZDICT_SIZE_MAX) {
+				diag_set(XlogError, "can't parse dictionary size");
+				return -1;
+			}
+			meta->zdict_size = size;
+		} else if (xlog_meta_key_equal(key, key_end, PARTS_KEY)) {
+			/*
+			 * Parts: <count>
+			 */
+			char *count_end;
+			unsigned long count = strtoul(val, &count_end, 10);
+			if (count_end != val_end || count == 0 ||
+			    count > UINT32_MAX) {
+				diag_set(XlogError, "can't parse part count");
+				return -1;
+			}
+			meta->part_count = count;
 		} else if (xlog_meta_key_equal(key, key_end, VERSION_KEY)) {
 			/* Ignore Version: for now */
 		} else {
@@ -324,6 +371,202 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 
 /* struct xlog }}} */
 
+/* {{{ zstd dictionaries */
+
+enum {
+	/** Compression level used for tx blocks. */
+	XLOG_ZSTD_LEVEL = 3,
+	/**
+	 * Sampled data should be about this many times bigger
+	 * than the dictionary trained on it.
+	 */
+	XLOG_ZDICT_SAMPLE_RATIO = 100,
+	/**
+	 * Don't train a dictionary on less sampled data than
+	 * this many times the dictionary size.
+	 */
+	XLOG_ZDICT_SAMPLE_RATIO_MIN = 10,
+	/** Max size of sampled data. */
+	XLOG_ZDICT_SAMPLE_SIZE_MAX = 16 * 1024 * 1024,
+};
+
+struct xlog_zdict *
+xlog_zdict_new(const char *data, size_t size)
+{
+	uint32_t id = ZSTD_getDictID_fromDict(data, size);
+	if (id == 0) {
+		diag_set(XlogError, "invalid zstd dictionary");
+		return NULL;
+	}
+	struct xlog_zdict *zdict = (struct xlog_zdict *)
+		malloc(sizeof(*zdict) + size);
+	if (zdict == NULL) {
+		diag_set(OutOfMemory, sizeof(*zdict) + size, "malloc",
+			 "struct xlog_zdict");
+		return NULL;
+	}
+	zdict->refs = 1;
+	zdict->id = id;
+	zdict->size = size;
+	memcpy(zdict->data, data, size);
+	zdict->cdict = ZSTD_createCDict(zdict->data, size, XLOG_ZSTD_LEVEL);
+	zdict->ddict = ZSTD_createDDict(zdict->data, size);
+	if (zdict->cdict == NULL || zdict->ddict == NULL) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 "failed to load dictionary");
+		xlog_zdict_delete(zdict);
+		return NULL;
+	}
+	return zdict;
+}
+
+void
+xlog_zdict_delete(struct xlog_zdict *zdict)
+{
+	ZSTD_freeCDict(zdict->cdict);
+	ZSTD_freeDDict(zdict->ddict);
+	free(zdict);
+}
+
+/**
+ * Begin compression of a frame, with a dictionary
+ * if @a zdict isn't NULL.
+ */
+static void
+xlog_zdict_compress_begin(ZSTD_CCtx *zctx, const struct xlog_zdict *zdict)
+{
+	if (zdict != NULL)
+		ZSTD_compressBegin_usingCDict(zctx, zdict->cdict);
+	else
+		ZSTD_compressBegin(zctx, XLOG_ZSTD_LEVEL);
+}
+
+/**
+ * Begin decompression of a frame. The frame stores the ID of
+ * the dictionary it was compressed with, if any, so we check
+ * that it matches @a zdict.
+ */
+static int
+xlog_zdict_decompress_begin(ZSTD_DStream *zdctx,
+			    const struct xlog_zdict *zdict,
+			    const char *data, const char *data_end)
+{
+	uint32_t id = ZSTD_getDictID_fromFrame(data, data_end - data);
+	if (id == 0) {
+		ZSTD_initDStream(zdctx);
+		return 0;
+	}
+	if (zdict == NULL || zdict->id != id) {
+		diag_set(ClientError, ER_DECOMPRESSION,
+			 tt_sprintf("unknown dictionary %u", (unsigned)id));
+		return -1;
+	}
+	ZSTD_initDStream_usingDDict(zdctx, zdict->ddict);
+	return 0;
+}
+
+void
+xlog_zdict_sampler_create(struct xlog_zdict_sampler *sampler,
+			  size_t dict_size)
+{
+	memset(sampler, 0, sizeof(*sampler));
+	sampler->size_max = MIN(dict_size * XLOG_ZDICT_SAMPLE_RATIO,
+				(size_t)XLOG_ZDICT_SAMPLE_SIZE_MAX);
+	sampler->stride = 1;
+}
+
+void
+xlog_zdict_sampler_destroy(struct xlog_zdict_sampler *sampler)
+{
+	free(sampler->data);
+	free(sampler->sizes);
+}
+
+/**
+ * Drop every other sample and sample data twice as rarely
+ * from now on.
+ */
+static void
+xlog_zdict_sampler_thin(struct xlog_zdict_sampler *sampler)
+{
+	char *src = sampler->data;
+	char *dst = sampler->data;
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < sampler->count; i++) {
+		size_t size = sampler->sizes[i];
+		if (i % 2 == 1) {
+			memmove(dst, src, size);
+			dst += size;
+			sampler->sizes[count++] = size;
+		}
+		src += size;
+	}
+	sampler->size = dst - sampler->data;
+	sampler->count = count;
+	sampler->stride *= 2;
+}
+
+void
+xlog_zdict_sampler_add(struct xlog_zdict_sampler *sampler,
+		       const char *data, size_t size)
+{
+	if (++sampler->seen % sampler->stride != 0)
+		return;
+	if (size > sampler->size_max)
+		return;
+	while (sampler->size + size > sampler->size_max) {
+		xlog_zdict_sampler_thin(sampler);
+		if (sampler->seen % sampler->stride != 0)
+			return;
+	}
+	if (sampler->data == NULL) {
+		sampler->data = (char *)malloc(sampler->size_max);
+		if (sampler->data == NULL)
+			return;
+	}
+	if (sampler->count == sampler->capacity) {
+		uint32_t capacity = MAX(sampler->capacity * 2, 1024U);
+		size_t *sizes = (size_t *)realloc(sampler->sizes,
+						  capacity * sizeof(*sizes));
+		if (sizes == NULL)
+			return;
+		sampler->sizes = sizes;
+		sampler->capacity = capacity;
+	}
+	memcpy(sampler->data + sampler->size, data, size);
+	sampler->size += size;
+	sampler->sizes[sampler->count++] = size;
+}
+
+int
+xlog_zdict_sampler_train(struct xlog_zdict_sampler *sampler,
+			 size_t dict_size, struct xlog_zdict **zdict)
+{
+	assert(dict_size >= XLOG_ZDICT_SIZE_MIN &&
+	       dict_size <= XLOG_ZDICT_SIZE_MAX);
+	*zdict = NULL;
+	if (sampler->size < dict_size * XLOG_ZDICT_SAMPLE_RATIO_MIN)
+		return 0;
+	char *buf = (char *)malloc(dict_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, dict_size, "malloc", "dictionary");
+		return -1;
+	}
+	size_t size = ZDICT_trainFromBuffer(buf, dict_size, sampler->data,
+					    sampler->sizes, sampler->count);
+	if (ZDICT_isError(size)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZDICT_getErrorName(size));
+		free(buf);
+		return -1;
+	}
+	*zdict = xlog_zdict_new(buf, size);
+	free(buf);
+	return *zdict != NULL ? 0 : -1;
+}
+
+/* }}} */
+
 /* {{{ struct xdir */
 
 void
@@ -658,6 +901,16 @@ xdir_format_filename(struct xdir *dir, int64_t signature,
 					      inprogress_suffix : "");
 }
 
+const char *
+xdir_format_part_filename(struct xdir *dir, int64_t signature,
+			  uint32_t part, enum log_suffix suffix)
+{
+	return tt_snprintf(PATH_MAX, "%s/%020lld.%u%s%s",
+			   dir->dirname, (long long) signature,
+			   (unsigned) part, dir->filename_ext,
+			   suffix == INPROGRESS ? inprogress_suffix : "");
+}
+
 static void
 xdir_say_gc(int result, int errorno, const char *filename)
 {
@@ -722,6 +975,35 @@ xdir_collect_inprogress(struct xdir *xdir)
 	closedir(dh);
 }
 
+void
+xdir_collect_parts(struct xdir *dir, int64_t signature)
+{
+	const char *dirname = dir->dirname;
+	DIR *dh = opendir(dirname);
+	if (dh == NULL) {
+		if (errno != ENOENT)
+			say_syserror("error reading directory '%s'", dirname);
+		return;
+	}
+	struct dirent *dent;
+	while ((dent = readdir(dh)) != NULL) {
+		/* <signature>.<part>.<ext> */
+		char *dot;
+		long long file_signature = strtoll(dent->d_name, &dot, 10);
+		if (*dot != '.' || dot == dent->d_name ||
+		    file_signature >= signature)
+			continue;
+		char *ext;
+		strtoul(dot + 1, &ext, 10);
+		if (ext == dot + 1 || strcmp(ext, dir->filename_ext) != 0)
+			continue;
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/%s", dirname, dent->d_name);
+		xdir_say_gc(unlink(path), errno, path);
+	}
+	closedir(dh);
+}
+
 void
 xdir_add_vclock(struct xdir *xdir, const struct vclock *vclock)
 {
@@ -763,6 +1045,12 @@ xlog_rename(struct xlog *l)
 	return 0;
 }
 
+static int
+xlog_dio_enable(struct xlog *log);
+
+static int
+xlog_dio_disable(struct xlog *log);
+
 static int
 xlog_init(struct xlog *xlog, const struct xlog_opts *opts)
 {
@@ -770,6 +1058,7 @@ xlog_init(struct xlog *xlog, const struct xlog_opts *opts)
 	xlog->opts = *opts;
 	xlog->sync_time = ev_monotonic_time();
 	xlog->is_autocommit = true;
+	stailq_create(&xlog->blocks);
 	obuf_create(&xlog->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	obuf_create(&xlog->zbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	if (!opts->no_compression) {
@@ -795,6 +1084,9 @@ xlog_destroy(struct xlog *xlog)
 {
 	assert(xlog->obuf.slabc == &cord()->slabc);
 	assert(xlog->zbuf.slabc == &cord()->slabc);
+	assert(stailq_empty(&xlog->blocks));
+	if (xlog->dio != NULL && xlog_dio_disable(xlog) != 0)
+		diag_log();
 	obuf_destroy(&xlog->obuf);
 	obuf_destroy(&xlog->zbuf);
 	ZSTD_freeCCtx(xlog->zctx);
@@ -823,6 +1115,8 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 		goto err;
 
 	xlog->meta = *meta;
+	if (opts->zdict != NULL)
+		xlog->meta.zdict_size = opts->zdict->size;
 	xlog->is_inprogress = true;
 	snprintf(xlog->filename, sizeof(xlog->filename), "%s%s", name, inprogress_suffix);
 
@@ -868,6 +1162,19 @@ xlog_create(struct xlog *xlog, const char *name, int flags,
 	}
 
 	xlog->offset = meta_len; /* first log starts after meta */
+
+	/* Write the dictionary, if any, right after meta */
+	if (opts->zdict != NULL) {
+		if (fio_writen(xlog->fd, opts->zdict->data,
+			       opts->zdict->size) < 0) {
+			diag_set(SystemError, "%s: failed to write "
+				 "dictionary", xlog->filename);
+			goto err_write;
+		}
+		xlog->offset += opts->zdict->size;
+	}
+	if (opts->direct_io && xlog_dio_enable(xlog) != 0)
+		goto err_write;
 	return 0;
 err_write:
 	close(xlog->fd);
@@ -942,6 +1249,8 @@ no_eof:
 			goto err_read;
 		}
 	}
+	if (opts->direct_io && xlog_dio_enable(xlog) != 0)
+		goto err_read;
 	return 0;
 err_read:
 	close(xlog->fd);
@@ -1010,6 +1319,44 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	return 0;
 }
 
+int
+xdir_create_xlog_part(struct xdir *dir, struct xlog *xlog,
+		      const struct vclock *vclock, uint32_t part,
+		      uint32_t part_count, const struct xlog_opts *opts)
+{
+	int64_t signature = vclock_sum(vclock);
+	assert(signature >= 0);
+	assert(!tt_uuid_is_nil(dir->instance_uuid));
+	assert(dir->suffix == INPROGRESS);
+	assert(part <= part_count);
+
+	struct xlog_meta meta;
+	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
+			 vclock, NULL);
+	/*
+	 * Older versions would recover from the main file only
+	 * and silently lose the data stored in the part files.
+	 */
+	if (part_count > 0)
+		meta.version = XLOG_FORMAT_V14;
+	const char *filename;
+	if (part == 0) {
+		meta.part_count = part_count;
+		filename = xdir_format_filename(dir, signature, NONE);
+	} else {
+		filename = xdir_format_part_filename(dir, signature,
+						     part, NONE);
+		/*
+		 * The main file doesn't exist, otherwise we
+		 * wouldn't write the set, so the part file is
+		 * garbage.
+		 */
+		if (unlink(filename) == 0)
+			say_info("removed stale %s", filename);
+	}
+	return xlog_create(xlog, filename, dir->open_wflags, &meta, opts);
+}
+
 ssize_t
 xlog_fallocate(struct xlog *log, size_t len)
 {
@@ -1046,36 +1393,19 @@ xlog_fallocate(struct xlog *log, size_t len)
 }
 
 /**
- * Write a sequence of uncompressed xrow objects.
- *
- * @retval -1 error
- * @retval >= 0 the number of bytes written
+ * Encode a fixheader of a tx block of @a len bytes with
+ * checksum @a crc32c.
  */
-static off_t
-xlog_tx_write_plain(struct xlog *log)
+static void
+xlog_encode_fixheader(char *fixheader, log_magic_t magic, size_t len,
+		      uint32_t crc32c)
 {
-	/**
-	 * We created an obuf savepoint at start of xlog_tx,
-	 * now populate it with data.
-	 */
-	char *fixheader = (char *)log->obuf.iov[0].iov_base;
-	*(log_magic_t *)fixheader = row_marker;
+	*(log_magic_t *)fixheader = magic;
 	char *data = fixheader + sizeof(log_magic_t);
-
-	data = mp_encode_uint(data,
-			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE);
+	data = mp_encode_uint(data, len);
 	/* Encode crc32 for previous row */
 	data = mp_encode_uint(data, 0);
 	/* Encode crc32 for current row */
-	uint32_t crc32c = 0;
-	struct iovec *iov;
-	size_t offset = XLOG_FIXHEADER_SIZE;
-	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
-		crc32c = crc32_calc(crc32c,
-				    (char *)iov->iov_base + offset,
-				    iov->iov_len - offset);
-		offset = 0;
-	}
 	data = mp_encode_uint(data, crc32c);
 	/*
 	 * Encode a padding, to ensure the resulting
@@ -1089,162 +1419,527 @@ xlog_tx_write_plain(struct xlog *log)
 			data += padding - 1;
 		}
 	}
+}
 
-	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
-		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		return -1;
-	});
+/* {{{ Direct I/O */
 
-	ssize_t written = fio_writevn(log->fd, log->obuf.iov, log->obuf.pos + 1);
-	if (written < 0) {
-		diag_set(SystemError, "failed to write to '%s' file",
-			 log->filename);
-		return -1;
-	}
-	return obuf_size(&log->obuf);
-}
+enum {
+	/** Size of a direct I/O write buffer. */
+	XLOG_DIO_BUF_SIZE = 1024 * 1024,
+	/** Number of direct I/O write buffers. */
+	XLOG_DIO_BUF_COUNT = 2,
+};
+
+/** A direct I/O write buffer. */
+struct xlog_dio_buf {
+	/** Direct I/O state this buffer belongs to. */
+	struct xlog_dio *dio;
+	/** Page-aligned memory, XLOG_DIO_BUF_SIZE bytes. */
+	char *data;
+	/** Number of bytes used. */
+	size_t used;
+	/** File offset to write the buffer at, page-aligned. */
+	off_t offset;
+	/** Set while the buffer is being written by a coio thread. */
+	bool in_flight;
+	/** errno of a failed background write or 0. */
+	int error;
+};
 
 /**
- * Write a compressed block of xrow objects.
- * @retval -1  error
- * @retval >= 0 the number of bytes written
+ * Direct I/O state of an xlog: a ring of buffers, so that
+ * a full buffer is written in background while rows go to
+ * the next one.
  */
-static off_t
-xlog_tx_write_zstd(struct xlog *log)
-{
-	char *fixheader = (char *)obuf_alloc(&log->zbuf,
-					     XLOG_FIXHEADER_SIZE);
+struct xlog_dio {
+	/** The file opened with O_DIRECT. */
+	int fd;
+	struct xlog_dio_buf bufs[XLOG_DIO_BUF_COUNT];
+	/** Index of the buffer being filled. */
+	int cur;
+	/** Number of rows buffered since the last flush. */
+	int64_t rows;
+	/** Signaled when a background write completes. */
+	struct fiber_cond cond;
+};
 
-	uint32_t crc32c = 0;
-	struct iovec *iov;
-	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
-	size_t offset = XLOG_FIXHEADER_SIZE;
-	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
-		/* Estimate max output buffer size. */
-		size_t zmax_size = ZSTD_compressBound(iov->iov_len - offset);
-		/* Allocate a destination buffer. */
-		void *zdst = obuf_reserve(&log->zbuf, zmax_size);
-		if (!zdst) {
-			diag_set(OutOfMemory, zmax_size, "runtime arena",
-				  "compression buffer");
-			goto error;
-		}
-		size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
-				    const void *, size_t);
-		/*
-		 * If it's the last iov or the last
-		 * log has 0 bytes, end the stream.
-		 */
-		if (iov == log->obuf.iov + log->obuf.pos ||
-		    !(iov + 1)->iov_len) {
-			fcompress = ZSTD_compressEnd;
-		} else {
-			fcompress = ZSTD_compressContinue;
-		}
-		size_t zsize = fcompress(log->zctx, zdst, zmax_size,
-					 (char *)iov->iov_base + offset,
-					 iov->iov_len - offset);
-		if (ZSTD_isError(zsize)) {
-			diag_set(ClientError, ER_COMPRESSION,
-				 ZSTD_getErrorName(zsize));
-			goto error;
-		}
-		/* Advance output buffer to the end of compressed data. */
-		obuf_alloc(&log->zbuf, zsize);
-		/* Update crc32c */
-		crc32c = crc32_calc(crc32c, (char *)zdst, zsize);
-		/* Discount fixheader size for all iovs after first. */
-		offset = 0;
+static void
+xlog_dio_delete(struct xlog_dio *dio)
+{
+	for (int i = 0; i < XLOG_DIO_BUF_COUNT; i++) {
+		assert(!dio->bufs[i].in_flight);
+		free(dio->bufs[i].data);
 	}
+	fiber_cond_destroy(&dio->cond);
+	close(dio->fd);
+	free(dio);
+}
 
-	*(log_magic_t *)fixheader = zrow_marker;
-	char *data;
-	data = fixheader + sizeof(log_magic_t);
-	data = mp_encode_uint(data,
-			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
-	data = mp_encode_uint(data, crc32c);
-	/* Encode padding */
-	ssize_t padding;
-	padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
+static struct xlog_dio *
+xlog_dio_new(int fd)
+{
+	struct xlog_dio *dio = (struct xlog_dio *)calloc(1, sizeof(*dio));
+	if (dio == NULL) {
+		diag_set(OutOfMemory, sizeof(*dio), "calloc",
+			 "struct xlog_dio");
+		return NULL;
+	}
+	dio->fd = fd;
+	fiber_cond_create(&dio->cond);
+	for (int i = 0; i < XLOG_DIO_BUF_COUNT; i++) {
+		struct xlog_dio_buf *buf = &dio->bufs[i];
+		buf->dio = dio;
+		if (posix_memalign((void **)&buf->data, XLOG_DIO_ALIGN,
+				   XLOG_DIO_BUF_SIZE) != 0) {
+			diag_set(OutOfMemory, XLOG_DIO_BUF_SIZE,
+				 "posix_memalign", "xlog direct I/O buffer");
+			xlog_dio_delete(dio);
+			return NULL;
 		}
 	}
+	return dio;
+}
 
-	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
-		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		obuf_reset(&log->zbuf);
-		goto error;
-	});
-
-	ssize_t written;
-	written = fio_writevn(log->fd, log->zbuf.iov,
-			      log->zbuf.pos + 1);
-	if (written < 0) {
-		diag_set(SystemError, "failed to write to '%s' file",
+/**
+ * Start the current buffer at the page the end of the file
+ * falls on and load the partial page written so far into it,
+ * so that it's rewritten in full by the next aligned write.
+ */
+static int
+xlog_dio_load_tail(struct xlog *log)
+{
+	struct xlog_dio *dio = log->dio;
+	struct xlog_dio_buf *buf = &dio->bufs[dio->cur];
+	size_t tail = log->offset % XLOG_DIO_ALIGN;
+	buf->offset = log->offset - tail;
+	buf->used = tail;
+	if (tail == 0)
+		return 0;
+	ssize_t n = fio_pread(log->fd, buf->data, tail, buf->offset);
+	if (n != (ssize_t)tail) {
+		if (n >= 0)
+			errno = EIO;
+		diag_set(SystemError, "failed to read file '%s'",
 			 log->filename);
-		goto error;
+		return -1;
 	}
-	obuf_reset(&log->zbuf);
-	return written;
-error:
-	obuf_reset(&log->zbuf);
-	return -1;
+	return 0;
 }
 
-/* file syncing and posix_fadvise() should be rounded by a page boundary */
-#define SYNC_MASK		(4096 - 1)
-#define SYNC_ROUND_DOWN(size)	((size) & ~(4096 - 1))
-#define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
-
 /**
- * Writes xlog batch to file
+ * Switch an xlog open for writing to direct I/O. Whole pages
+ * are written with a separate O_DIRECT descriptor, while the
+ * partial page at the end goes through the page cache, see
+ * xlog_dio_flush(). Proceeds with buffered I/O if the file
+ * system doesn't support O_DIRECT.
  */
-static ssize_t
-xlog_tx_write(struct xlog *log)
+static int
+xlog_dio_enable(struct xlog *log)
 {
-	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
+	assert(log->dio == NULL);
+#ifdef O_DIRECT
+	int fd = open(log->filename, O_WRONLY | O_DIRECT);
+	if (fd < 0) {
+		if (errno == EINVAL)
+			goto not_supported;
+		diag_set(SystemError, "%s: failed to enable direct I/O",
+			 log->filename);
+		return -1;
+	}
+	log->dio = xlog_dio_new(fd);
+	if (log->dio == NULL) {
+		close(fd);
+		return -1;
+	}
+	if (xlog_dio_load_tail(log) != 0) {
+		xlog_dio_delete(log->dio);
+		log->dio = NULL;
+		return -1;
+	}
+	return 0;
+not_supported:
+#endif /* O_DIRECT */
+	say_warn("%s: direct I/O is not supported, proceeding without it",
+		 log->filename);
+	return 0;
+}
+
+/** Wait for the background write of direct I/O buffers. */
+static int
+xlog_dio_wait(struct xlog *log)
+{
+	struct xlog_dio *dio = log->dio;
+	int rc = 0;
+	for (int i = 0; i < XLOG_DIO_BUF_COUNT; i++) {
+		struct xlog_dio_buf *buf = &dio->bufs[i];
+		while (buf->in_flight)
+			fiber_cond_wait(&dio->cond);
+		if (buf->error != 0) {
+			errno = buf->error;
+			buf->error = 0;
+			diag_set(SystemError, "failed to write to '%s' file",
+				 log->filename);
+			rc = -1;
+		}
+	}
+	return rc;
+}
+
+/** Throw away the data buffered and not written yet. */
+static int
+xlog_dio_reset(struct xlog *log)
+{
+	if (xlog_dio_wait(log) != 0)
+		diag_clear(diag_get());
+	log->dio->rows = 0;
+	return xlog_dio_load_tail(log);
+}
+
+/**
+ * Switch an xlog back to buffered I/O. Direct I/O writes are done
+ * at explicit offsets, so the file position is moved to the end
+ * of the data written so far for the following writes to go there.
+ */
+static int
+xlog_dio_disable(struct xlog *log)
+{
+	if (xlog_dio_wait(log) != 0)
+		diag_clear(diag_get());
+	xlog_dio_delete(log->dio);
+	log->dio = NULL;
+	if (lseek(log->fd, log->offset, SEEK_SET) < 0) {
+		diag_set(SystemError, "%s: failed to seek", log->filename);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+xlog_dio_write_cb(eio_req *req)
+{
+	struct xlog_dio_buf *buf = (struct xlog_dio_buf *)req->data;
+	if (req->result < 0)
+		buf->error = req->errorno;
+	else if ((size_t)req->result != buf->used)
+		buf->error = EIO;
+	buf->in_flight = false;
+	fiber_cond_broadcast(&buf->dio->cond);
+	return 0;
+}
+
+/**
+ * Start writing the current buffer, which must be full, in
+ * background and switch to the next one. Writes are issued
+ * one at a time to keep them ordered for concurrent readers.
+ */
+static int
+xlog_dio_submit(struct xlog *log)
+{
+	struct xlog_dio *dio = log->dio;
+	struct xlog_dio_buf *buf = &dio->bufs[dio->cur];
+	assert(buf->used == XLOG_DIO_BUF_SIZE);
+	if (xlog_dio_wait(log) != 0)
+		return -1;
+	if (eio_write(dio->fd, buf->data, buf->used, buf->offset, 0,
+		      xlog_dio_write_cb, buf) == NULL) {
+		diag_set(OutOfMemory, sizeof(eio_req), "eio_write",
+			 "eio_req");
+		return -1;
+	}
+	buf->in_flight = true;
+	dio->cur = (dio->cur + 1) % XLOG_DIO_BUF_COUNT;
+	struct xlog_dio_buf *next = &dio->bufs[dio->cur];
+	assert(!next->in_flight);
+	next->offset = buf->offset + buf->used;
+	next->used = 0;
+	return 0;
+}
+
+/** Append data to direct I/O buffers. */
+static ssize_t
+xlog_dio_append(struct xlog *log, const struct iovec *iov, int iovcnt)
+{
+	struct xlog_dio *dio = log->dio;
+	ssize_t total = 0;
+	for (int i = 0; i < iovcnt; i++) {
+		const char *src = (const char *)iov[i].iov_base;
+		size_t len = iov[i].iov_len;
+		while (len > 0) {
+			struct xlog_dio_buf *buf = &dio->bufs[dio->cur];
+			size_t n = MIN(len, XLOG_DIO_BUF_SIZE - buf->used);
+			memcpy(buf->data + buf->used, src, n);
+			buf->used += n;
+			src += n;
+			len -= n;
+			total += n;
+			if (buf->used == XLOG_DIO_BUF_SIZE &&
+			    xlog_dio_submit(log) != 0)
+				return -1;
+		}
+	}
+	return total;
+}
+
+/** Write @a len bytes of @a data at @a offset of @a fd. */
+static int
+xlog_dio_pwrite(struct xlog *log, int fd, const char *data, size_t len,
+		off_t offset)
+{
+	if (len == 0)
 		return 0;
-	ssize_t written;
+	ssize_t n = pwrite(fd, data, len, offset);
+	if (n != (ssize_t)len) {
+		if (n >= 0)
+			errno = EIO;
+		diag_set(SystemError, "failed to write to '%s' file",
+			 log->filename);
+		return -1;
+	}
+	return 0;
+}
 
-	if (!log->opts.no_compression &&
-	    obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
-		written = xlog_tx_write_zstd(log);
-	} else {
-		written = xlog_tx_write_plain(log);
+/**
+ * Write out the buffered data. Whole pages go with direct I/O,
+ * the partial page at the end through the page cache, so the
+ * file never grows past the data, which concurrent readers rely
+ * on. The partial page stays in the buffer and is rewritten
+ * in full at the same offset by the next write, which doesn't
+ * change the bytes readers may already have seen.
+ *
+ * @retval -1 error
+ * @retval >= 0 the number of bytes written
+ */
+static ssize_t
+xlog_dio_flush(struct xlog *log)
+{
+	struct xlog_dio *dio = log->dio;
+	struct xlog_dio_buf *buf = &dio->bufs[dio->cur];
+	off_t end = buf->offset + buf->used;
+	if (end == log->offset)
+		return 0;
+	if (xlog_dio_wait(log) != 0)
+		return -1;
+	assert(buf->offset % XLOG_DIO_ALIGN == 0);
+	size_t tail = buf->used % XLOG_DIO_ALIGN;
+	size_t aligned = buf->used - tail;
+	if (xlog_dio_pwrite(log, dio->fd, buf->data, aligned,
+			    buf->offset) != 0 ||
+	    xlog_dio_pwrite(log, log->fd, buf->data + aligned, tail,
+			    buf->offset + aligned) != 0)
+		return -1;
+	memmove(buf->data, buf->data + aligned, tail);
+	buf->offset += aligned;
+	buf->used = tail;
+	return end - log->offset;
+}
+
+/* }}} Direct I/O */
+
+/**
+ * Write data at the end of the file. With direct I/O the data
+ * is only buffered until xlog_flush().
+ *
+ * @retval -1 error
+ * @retval >= 0 the number of bytes written
+ */
+static ssize_t
+xlog_write_iov(struct xlog *log, struct iovec *iov, int iovcnt)
+{
+	if (log->dio != NULL)
+		return xlog_dio_append(log, iov, iovcnt);
+	ssize_t written = fio_writevn(log->fd, iov, iovcnt);
+	if (written < 0) {
+		diag_set(SystemError, "failed to write to '%s' file",
+			 log->filename);
+		return -1;
 	}
-	ERROR_INJECT(ERRINJ_WAL_WRITE, {
+	return written;
+}
+
+/**
+ * Write a sequence of uncompressed xrow objects.
+ *
+ * @retval -1 error
+ * @retval >= 0 the number of bytes written
+ */
+static off_t
+xlog_tx_write_plain(struct xlog *log, struct obuf *rows)
+{
+	/**
+	 * We created an obuf savepoint at start of xlog_tx,
+	 * now populate it with data.
+	 */
+	char *fixheader = (char *)rows->iov[0].iov_base;
+	/* Encode crc32 for current row */
+	uint32_t crc32c = 0;
+	struct iovec *iov;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	for (iov = rows->iov; iov->iov_len; ++iov) {
+		crc32c = crc32_calc(crc32c,
+				    (char *)iov->iov_base + offset,
+				    iov->iov_len - offset);
+		offset = 0;
+	}
+	xlog_encode_fixheader(fixheader, row_marker,
+			      obuf_size(rows) - XLOG_FIXHEADER_SIZE, crc32c);
+
+	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		written = -1;
+		return -1;
 	});
 
-	obuf_reset(&log->obuf);
-	/*
-	 * Simplify recovery after a temporary write failure:
-	 * truncate the file to the best known good write
-	 * position.
-	 */
-	if (written < 0) {
-		if (lseek(log->fd, log->offset, SEEK_SET) < 0 ||
-		    ftruncate(log->fd, log->offset) != 0)
-			panic_syserror("failed to truncate xlog after write error");
-		log->allocated = 0;
+	if (xlog_write_iov(log, rows->iov, rows->pos + 1) < 0)
 		return -1;
+	return obuf_size(rows);
+}
+
+/**
+ * Write a compressed block of xrow objects.
+ * @retval -1  error
+ * @retval >= 0 the number of bytes written
+ */
+static off_t
+xlog_tx_write_zstd(struct xlog *log)
+{
+	char *fixheader = (char *)obuf_alloc(&log->zbuf,
+					     XLOG_FIXHEADER_SIZE);
+
+	uint32_t crc32c = 0;
+	struct iovec *iov;
+	xlog_zdict_compress_begin(log->zctx, log->opts.zdict);
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
+		/* Estimate max output buffer size. */
+		size_t zmax_size = ZSTD_compressBound(iov->iov_len - offset);
+		/* Allocate a destination buffer. */
+		void *zdst = obuf_reserve(&log->zbuf, zmax_size);
+		if (!zdst) {
+			diag_set(OutOfMemory, zmax_size, "runtime arena",
+				  "compression buffer");
+			goto error;
+		}
+		size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
+				    const void *, size_t);
+		/*
+		 * If it's the last iov or the last
+		 * log has 0 bytes, end the stream.
+		 */
+		if (iov == log->obuf.iov + log->obuf.pos ||
+		    !(iov + 1)->iov_len) {
+			fcompress = ZSTD_compressEnd;
+		} else {
+			fcompress = ZSTD_compressContinue;
+		}
+		size_t zsize = fcompress(log->zctx, zdst, zmax_size,
+					 (char *)iov->iov_base + offset,
+					 iov->iov_len - offset);
+		if (ZSTD_isError(zsize)) {
+			diag_set(ClientError, ER_COMPRESSION,
+				 ZSTD_getErrorName(zsize));
+			goto error;
+		}
+		/* Advance output buffer to the end of compressed data. */
+		obuf_alloc(&log->zbuf, zsize);
+		/* Update crc32c */
+		crc32c = crc32_calc(crc32c, (char *)zdst, zsize);
+		/* Discount fixheader size for all iovs after first. */
+		offset = 0;
 	}
+
+	xlog_encode_fixheader(fixheader, zrow_marker,
+			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
+
+	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		obuf_reset(&log->zbuf);
+		goto error;
+	});
+
+	ssize_t written;
+	written = xlog_write_iov(log, log->zbuf.iov, log->zbuf.pos + 1);
+	if (written < 0)
+		goto error;
+	obuf_reset(&log->zbuf);
+	return written;
+error:
+	obuf_reset(&log->zbuf);
+	return -1;
+}
+
+int
+xlog_tx_block_compress(struct xlog_tx_block *block, ZSTD_CCtx *zctx)
+{
+	assert(block->zdata == NULL);
+	struct obuf *rows = &block->rows;
+	/* Estimate max output buffer size. */
+	size_t zmax_size = XLOG_FIXHEADER_SIZE;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	struct iovec *iov;
+	for (iov = rows->iov; iov->iov_len; ++iov) {
+		zmax_size += ZSTD_compressBound(iov->iov_len - offset);
+		offset = 0;
+	}
+	char *zdata = (char *)malloc(zmax_size);
+	if (zdata == NULL) {
+		diag_set(OutOfMemory, zmax_size, "malloc",
+			 "compression buffer");
+		return -1;
+	}
+	char *zdst = zdata + XLOG_FIXHEADER_SIZE;
+	char *zend = zdata + zmax_size;
+	uint32_t crc32c = 0;
+	xlog_zdict_compress_begin(zctx, block->zdict);
+	offset = XLOG_FIXHEADER_SIZE;
+	for (iov = rows->iov; iov->iov_len; ++iov) {
+		size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
+				    const void *, size_t);
+		/*
+		 * If it's the last iov or the last
+		 * log has 0 bytes, end the stream.
+		 */
+		if (iov == rows->iov + rows->pos || !(iov + 1)->iov_len)
+			fcompress = ZSTD_compressEnd;
+		else
+			fcompress = ZSTD_compressContinue;
+		size_t zsize = fcompress(zctx, zdst, zend - zdst,
+					 (char *)iov->iov_base + offset,
+					 iov->iov_len - offset);
+		if (ZSTD_isError(zsize)) {
+			diag_set(ClientError, ER_COMPRESSION,
+				 ZSTD_getErrorName(zsize));
+			free(zdata);
+			return -1;
+		}
+		crc32c = crc32_calc(crc32c, zdst, zsize);
+		zdst += zsize;
+		offset = 0;
+	}
+	xlog_encode_fixheader(zdata, zrow_marker,
+			      zdst - zdata - XLOG_FIXHEADER_SIZE, crc32c);
+	block->zdata = zdata;
+	block->zsize = zdst - zdata;
+	return 0;
+}
+
+/* file syncing and posix_fadvise() should be rounded by a page boundary */
+#define SYNC_MASK		(4096 - 1)
+#define SYNC_ROUND_DOWN(size)	((size) & ~(4096 - 1))
+#define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
+
+/**
+ * Account @a written bytes holding @a rows rows appended to
+ * the file and sync the file if it's time to.
+ */
+static void
+xlog_tx_write_complete(struct xlog *log, ssize_t written, int64_t rows)
+{
 	if (log->allocated > (size_t)written)
 		log->allocated -= written;
 	else
 		log->allocated = 0;
 	log->offset += written;
-	log->rows += log->tx_rows;
-	log->tx_rows = 0;
+	log->rows += rows;
 	if ((log->opts.sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->opts.sync_interval)) ||
 	    (log->opts.rate_limit && log->offset >=
@@ -1283,6 +1978,184 @@ xlog_tx_write(struct xlog *log)
 		}
 		log->synced_size = log->offset;
 	}
+}
+
+/**
+ * Simplify recovery after a temporary write failure:
+ * truncate the file to the best known good write
+ * position.
+ */
+static void
+xlog_tx_write_rollback(struct xlog *log)
+{
+	if (log->dio != NULL && xlog_dio_reset(log) != 0)
+		panic("failed to reset direct I/O buffers after write error");
+	if (lseek(log->fd, log->offset, SEEK_SET) < 0 ||
+	    ftruncate(log->fd, log->offset) != 0)
+		panic_syserror("failed to truncate xlog after write error");
+	log->allocated = 0;
+}
+
+static void
+xlog_tx_block_delete(struct xlog_tx_block *block)
+{
+	obuf_destroy(&block->rows);
+	free(block->zdata);
+	diag_destroy(&block->diag);
+	free(block);
+}
+
+/**
+ * Wait for the tx blocks handed over to the compressor and
+ * throw them away.
+ */
+static void
+xlog_tx_discard_blocks(struct xlog *log)
+{
+	while (!stailq_empty(&log->blocks)) {
+		struct xlog_tx_block *block = stailq_shift_entry(
+			&log->blocks, struct xlog_tx_block, in_xlog);
+		if (!block->is_ready)
+			log->compressor->wait(log->compressor, block);
+		xlog_tx_block_delete(block);
+	}
+}
+
+/**
+ * Hand the buffered rows over to the compressor. The rows
+ * are written to the file by xlog_flush().
+ *
+ * @retval 0 success
+ * @retval -1 error, all blocks not written yet are discarded
+ */
+static ssize_t
+xlog_tx_submit(struct xlog *log, bool compress)
+{
+	struct xlog_tx_block *block =
+		(struct xlog_tx_block *)malloc(sizeof(*block));
+	if (block == NULL) {
+		diag_set(OutOfMemory, sizeof(*block), "malloc",
+			 "struct xlog_tx_block");
+		obuf_reset(&log->obuf);
+		log->tx_rows = 0;
+		xlog_tx_discard_blocks(log);
+		return -1;
+	}
+	/* The block takes the buffer, start a new one. */
+	block->rows = log->obuf;
+	obuf_create(&log->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	block->n_rows = log->tx_rows;
+	log->tx_rows = 0;
+	block->compress = compress;
+	block->zdict = log->opts.zdict;
+	block->zdata = NULL;
+	block->zsize = 0;
+	block->is_ready = !compress;
+	diag_create(&block->diag);
+	stailq_add_tail_entry(&log->blocks, block, in_xlog);
+	if (compress)
+		log->compressor->submit(log->compressor, block);
+	return 0;
+}
+
+/**
+ * Write the tx blocks handed over to the compressor in the
+ * order of submission. A block is written as soon as it's
+ * ready, while the following ones may still be compressed.
+ * The blocks are written all or nothing.
+ */
+static ssize_t
+xlog_tx_write_blocks(struct xlog *log)
+{
+	ssize_t total = 0;
+	int64_t rows = 0;
+	while (!stailq_empty(&log->blocks)) {
+		struct xlog_tx_block *block = stailq_shift_entry(
+			&log->blocks, struct xlog_tx_block, in_xlog);
+		if (!block->is_ready)
+			log->compressor->wait(log->compressor, block);
+		assert(block->is_ready);
+		ssize_t written;
+		if (!diag_is_empty(&block->diag)) {
+			diag_move(&block->diag, diag_get());
+			written = -1;
+		} else if (block->zdata != NULL) {
+			written = block->zsize;
+			ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
+				diag_set(ClientError, ER_INJECTION,
+					 "xlog write injection");
+				written = -1;
+			});
+			struct iovec iov = {block->zdata, block->zsize};
+			if (written > 0)
+				written = xlog_write_iov(log, &iov, 1);
+		} else {
+			written = xlog_tx_write_plain(log, &block->rows);
+		}
+		ERROR_INJECT(ERRINJ_WAL_WRITE, {
+			diag_set(ClientError, ER_INJECTION,
+				 "xlog write injection");
+			written = -1;
+		});
+		rows += block->n_rows;
+		xlog_tx_block_delete(block);
+		if (written < 0) {
+			xlog_tx_discard_blocks(log);
+			xlog_tx_write_rollback(log);
+			return -1;
+		}
+		total += written;
+	}
+	if (log->dio != NULL) {
+		/* Written out by xlog_flush(). */
+		log->dio->rows += rows;
+		return 0;
+	}
+	xlog_tx_write_complete(log, total, rows);
+	return total;
+}
+
+/**
+ * Writes xlog batch to file
+ */
+static ssize_t
+xlog_tx_write(struct xlog *log)
+{
+	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
+		return 0;
+	bool compress = !log->opts.no_compression &&
+			obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD;
+	/*
+	 * Once there's a block in flight, all the following
+	 * blocks must be written after it, compressed or not.
+	 */
+	if (log->compressor != NULL &&
+	    (compress || !stailq_empty(&log->blocks)))
+		return xlog_tx_submit(log, compress);
+
+	ssize_t written;
+	if (compress)
+		written = xlog_tx_write_zstd(log);
+	else
+		written = xlog_tx_write_plain(log, &log->obuf);
+	ERROR_INJECT(ERRINJ_WAL_WRITE, {
+		diag_set(ClientError, ER_INJECTION, "xlog write injection");
+		written = -1;
+	});
+
+	obuf_reset(&log->obuf);
+	if (written < 0) {
+		xlog_tx_write_rollback(log);
+		return -1;
+	}
+	if (log->dio != NULL) {
+		/* Written out by xlog_flush(). */
+		log->dio->rows += log->tx_rows;
+		log->tx_rows = 0;
+		return 0;
+	}
+	xlog_tx_write_complete(log, written, log->tx_rows);
+	log->tx_rows = 0;
 	return written;
 }
 
@@ -1386,6 +2259,7 @@ xlog_tx_rollback(struct xlog *log)
 	log->is_autocommit = true;
 	log->tx_rows = 0;
 	obuf_reset(&log->obuf);
+	xlog_tx_discard_blocks(log);
 }
 
 /**
@@ -1396,9 +2270,24 @@ ssize_t
 xlog_flush(struct xlog *log)
 {
 	assert(log->is_autocommit);
-	if (log->obuf.used == 0)
-		return 0;
-	return xlog_tx_write(log);
+	ssize_t written = 0;
+	if (log->obuf.used != 0)
+		written = xlog_tx_write(log);
+	if (written == 0 && !stailq_empty(&log->blocks)) {
+		/* The rows went to the compressor, write them now. */
+		written = xlog_tx_write_blocks(log);
+	}
+	if (written == 0 && log->dio != NULL) {
+		/* The rows are buffered for direct I/O. */
+		written = xlog_dio_flush(log);
+		if (written < 0) {
+			xlog_tx_write_rollback(log);
+			return -1;
+		}
+		xlog_tx_write_complete(log, written, log->dio->rows);
+		log->dio->rows = 0;
+	}
+	return written;
 }
 
 static int
@@ -1449,6 +2338,9 @@ xlog_write_eof(struct xlog *l)
 		diag_set(SystemError, "ftruncate() failed");
 		return -1;
 	}
+	/* The eof marker isn't aligned, write it as is. */
+	if (l->dio != NULL && xlog_dio_disable(l) != 0)
+		return -1;
 
 	if (fio_writen(l->fd, &eof_marker, sizeof(eof_marker)) < 0) {
 		diag_set(SystemError, "write() failed");
@@ -1672,7 +2564,8 @@ xlog_fixheader_decode(struct xlog_fixheader *fixheader,
 
 int
 xlog_tx_decode(const char *data, const char *data_end,
-	       char *rows, char *rows_end, ZSTD_DStream *zdctx)
+	       char *rows, char *rows_end, ZSTD_DStream *zdctx,
+	       const struct xlog_zdict *zdict)
 {
 	/* Decode fixheader */
 	struct xlog_fixheader fixheader;
@@ -1711,7 +2604,8 @@ xlog_tx_decode(const char *data, const char *data_end,
 
 	/* Decompress zstd rows */
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	if (xlog_zdict_decompress_begin(zdctx, zdict, data, data_end) != 0)
+		return -1;
 	int rc = xlog_cursor_decompress(&rows, rows_end, &data, data_end,
 					zdctx);
 	if (rc < 0) {
@@ -1735,7 +2629,7 @@ xlog_tx_decode(const char *data, const char *data_end,
 ssize_t
 xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 		      const char **data, const char *data_end,
-		      ZSTD_DStream *zdctx)
+		      ZSTD_DStream *zdctx, const struct xlog_zdict *zdict)
 {
 	const char *rpos = *data;
 	struct xlog_fixheader fixheader;
@@ -1777,7 +2671,10 @@ xlog_tx_cursor_create(struct xlog_tx_cursor *tx_cursor,
 	};
 
 	assert(fixheader.magic == zrow_marker);
-	ZSTD_initDStream(zdctx);
+	if (xlog_zdict_decompress_begin(zdctx, zdict, rpos, data_end) != 0) {
+		ibuf_destroy(&tx_cursor->rows);
+		return -1;
+	}
 	int rc;
 	do {
 		if (ibuf_reserve(&tx_cursor->rows,
@@ -1854,6 +2751,27 @@ xlog_cursor_find_tx_magic(struct xlog_cursor *i)
 	return 0;
 }
 
+/**
+ * Called when an eof marker is found at the cursor position.
+ * Checks that there is no more data in the file and switches
+ * the cursor to the EOF state.
+ */
+static int
+xlog_cursor_read_eof(struct xlog_cursor *i)
+{
+	int rc = xlog_cursor_ensure(i, sizeof(log_magic_t) + sizeof(char));
+	if (rc < 0)
+		return -1;
+	if (rc == 0) {
+		diag_set(XlogError, "%s: has some data after "
+			  "eof marker at %lld", i->name,
+			  xlog_cursor_pos(i));
+		return -1;
+	}
+	i->state = XLOG_CURSOR_EOF;
+	return 1;
+}
+
 int
 xlog_cursor_next_tx(struct xlog_cursor *i)
 {
@@ -1868,13 +2786,14 @@ xlog_cursor_next_tx(struct xlog_cursor *i)
 		return 1;
 	if (load_u32(i->rbuf.rpos) == eof_marker) {
 		/* eof marker found */
-		goto eof_found;
+		return xlog_cursor_read_eof(i);
 	}
 
 	ssize_t to_load;
 	while ((to_load = xlog_tx_cursor_create(&i->tx_cursor,
 						(const char **)&i->rbuf.rpos,
-						i->rbuf.wpos, i->zdctx)) > 0) {
+						i->rbuf.wpos, i->zdctx,
+						i->zdict)) > 0) {
 		/* not enough data in read buffer */
 		int rc = xlog_cursor_ensure(i, ibuf_used(&i->rbuf) + to_load);
 		if (rc < 0)
@@ -1887,23 +2806,39 @@ xlog_cursor_next_tx(struct xlog_cursor *i)
 
 	i->state = XLOG_CURSOR_TX;
 	return 0;
-eof_found:
-	/*
-	 * A eof marker is read, check that there is no
-	 * more data in the file.
-	 */
-	rc = xlog_cursor_ensure(i, sizeof(log_magic_t) + sizeof(char));
+}
 
-	if (rc < 0)
-		return -1;
-	if (rc == 0) {
-		diag_set(XlogError, "%s: has some data after "
-			  "eof marker at %lld", i->name,
-			  xlog_cursor_pos(i));
+int
+xlog_cursor_next_tx_raw(struct xlog_cursor *i, const char **data,
+			size_t *size)
+{
+	int rc;
+	assert(xlog_cursor_is_open(i));
+	assert(i->state != XLOG_CURSOR_TX);
+
+	/* load at least magic to check eof */
+	rc = xlog_cursor_ensure(i, sizeof(log_magic_t));
+	if (rc != 0)
+		return rc;
+	if (load_u32(i->rbuf.rpos) == eof_marker)
+		return xlog_cursor_read_eof(i);
+
+	rc = xlog_cursor_ensure(i, XLOG_FIXHEADER_SIZE);
+	if (rc != 0)
+		return rc;
+	struct xlog_fixheader fixheader;
+	const char *pos = i->rbuf.rpos;
+	if (xlog_fixheader_decode(&fixheader, &pos, i->rbuf.wpos) != 0)
 		return -1;
-	}
-	i->state = XLOG_CURSOR_EOF;
-	return 1;
+	size_t len = XLOG_FIXHEADER_SIZE + fixheader.len;
+	rc = xlog_cursor_ensure(i, len);
+	if (rc != 0)
+		return rc;
+	*data = i->rbuf.rpos;
+	*size = len;
+	i->rbuf.rpos += len;
+	i->state = XLOG_CURSOR_ACTIVE;
+	return 0;
 }
 
 int
@@ -1954,6 +2889,21 @@ xlog_cursor_next(struct xlog_cursor *cursor,
 	return 0;
 }
 
+/**
+ * Load the dictionary following the file meta to the cursor.
+ * The dictionary must be in the read buffer already.
+ */
+static int
+xlog_cursor_load_zdict(struct xlog_cursor *i)
+{
+	assert(ibuf_used(&i->rbuf) >= i->meta.zdict_size);
+	i->zdict = xlog_zdict_new(i->rbuf.rpos, i->meta.zdict_size);
+	if (i->zdict == NULL)
+		return -1;
+	i->rbuf.rpos += i->meta.zdict_size;
+	return 0;
+}
+
 int
 xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 {
@@ -1979,6 +2929,17 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 		diag_set(XlogError, "Unexpected end of file, run with 'force_recovery = true'");
 		goto error;
 	}
+	if (i->meta.zdict_size > 0) {
+		rc = xlog_cursor_ensure(i, i->meta.zdict_size);
+		if (rc == -1)
+			goto error;
+		if (rc > 0) {
+			diag_set(XlogError, "Unexpected end of file");
+			goto error;
+		}
+		if (xlog_cursor_load_zdict(i) != 0)
+			goto error;
+	}
 	snprintf(i->name, sizeof(i->name), "%s", name);
 	i->zdctx = ZSTD_createDStream();
 	if (i->zdctx == NULL) {
@@ -1989,6 +2950,8 @@ xlog_cursor_openfd(struct xlog_cursor *i, int fd, const char *name)
 	i->state = XLOG_CURSOR_ACTIVE;
 	return 0;
 error:
+	if (i->zdict != NULL)
+		xlog_zdict_unref(i->zdict);
 	ibuf_destroy(&i->rbuf);
 	return -1;
 }
@@ -2032,10 +2995,12 @@ xlog_cursor_openmem(struct xlog_cursor *i, const char *data, size_t size,
 			     (const char *)i->rbuf.wpos);
 	if (rc < 0)
 		goto error;
-	if (rc > 0) {
+	if (rc > 0 || ibuf_used(&i->rbuf) < i->meta.zdict_size) {
 		diag_set(XlogError, "Unexpected end of file");
 		goto error;
 	}
+	if (i->meta.zdict_size > 0 && xlog_cursor_load_zdict(i) != 0)
+		goto error;
 	snprintf(i->name, sizeof(i->name), "%s", name);
 	i->zdctx = ZSTD_createDStream();
 	if (i->zdctx == NULL) {
@@ -2046,6 +3011,8 @@ xlog_cursor_openmem(struct xlog_cursor *i, const char *data, size_t size,
 	i->state = XLOG_CURSOR_ACTIVE;
 	return 0;
 error:
+	if (i->zdict != NULL)
+		xlog_zdict_unref(i->zdict);
 	ibuf_destroy(&i->rbuf);
 	return -1;
 }
@@ -2061,6 +3028,10 @@ xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 	if (i->state == XLOG_CURSOR_TX)
 		xlog_tx_cursor_destroy(&i->tx_cursor);
 	ZSTD_freeDStream(i->zdctx);
+	if (i->zdict != NULL) {
+		xlog_zdict_unref(i->zdict);
+		i->zdict = NULL;
+	}
 	i->state = (i->state == XLOG_CURSOR_EOF ?
 		    XLOG_CURSOR_EOF_CLOSED : XLOG_CURSOR_CLOSED);
 	/*
@@ -32,6 +32,7 @@
  */
 #include <stdio.h>
 #include <stdbool.h>
+#include <assert.h>
 #include <sys/stat.h>
 #include "uuid/tt_uuid.h"
 #include "vclock/vclock.h"
@@ -41,9 +42,13 @@
 
 #include "small/ibuf.h"
 #include "small/obuf.h"
+#include "salad/stailq.h"
+#include "diag.h"
 
 struct iovec;
 struct xrow_header;
+struct xlog_dio;
+struct xlog_zdict;
 
 #if defined(__cplusplus)
 extern "C" {
@@ -82,6 +87,34 @@ struct xlog_opts {
 	 * to be read frequently, e.g. L1 run files in Vinyl.
 	 */
 	bool no_compression;
+	/**
+	 * If this flag is set, the xlog writer bypasses the page
+	 * cache with O_DIRECT. Rows are accumulated in page-aligned
+	 * buffers and written out on xlog_flush(). The partial page
+	 * at the end of the file is written through the page cache
+	 * and rewritten with direct I/O by the next flush.
+	 *
+	 * This option is useful for WAL files, so that commit
+	 * latency doesn't depend on the page cache writeback.
+	 */
+	bool direct_io;
+	/**
+	 * zstd dictionary to compress tx blocks with or NULL.
+	 * The dictionary is stored in the file header, right
+	 * after the meta, and must outlive the xlog.
+	 *
+	 * This option is useful for files with lots of small
+	 * similar tuples, e.g. snapshots and vinyl runs.
+	 */
+	struct xlog_zdict *zdict;
+};
+
+enum {
+	/**
+	 * Alignment of file offsets, sizes and memory of direct
+	 * I/O writes.
+	 */
+	XLOG_DIO_ALIGN = 4096,
 };
 
 extern const struct xlog_opts xlog_opts_default;
@@ -204,6 +237,14 @@ const char *
 xdir_format_filename(struct xdir *dir, int64_t signature,
 		     enum log_suffix suffix);
 
+/**
+ * Return the name of a part file of a file with the given
+ * signature, see xdir_create_xlog_part().
+ */
+const char *
+xdir_format_part_filename(struct xdir *dir, int64_t signature,
+			  uint32_t part, enum log_suffix suffix);
+
 /**
  * Return true if the given directory index has files whose
  * signature is less than specified.
@@ -246,6 +287,14 @@ xdir_collect_garbage(struct xdir *dir, int64_t signature, unsigned flags);
 void
 xdir_collect_inprogress(struct xdir *xdir);
 
+/**
+ * Remove part files whose signature is less than specified,
+ * see xdir_create_xlog_part(). Part files aren't indexed so
+ * the directory is scanned for them.
+ */
+void
+xdir_collect_parts(struct xdir *dir, int64_t signature);
+
 /**
  * Return LSN and vclock (unless @vclock is NULL) of the oldest
  * file in a directory or -1 if the directory is empty.
@@ -286,12 +335,30 @@ xdir_add_vclock(struct xdir *xdir, const struct vclock *vclock);
 
 /* {{{ xlog meta */
 
+/**
+ * Format version of a xlog file. A file is written with the
+ * oldest version that is able to describe its contents, so
+ * that files using new features are refused by older versions
+ * of Tarantool instead of being misread.
+ */
+enum xlog_format_version {
+	XLOG_FORMAT_V12 = 12,
+	XLOG_FORMAT_V13 = 13,
+	/**
+	 * Multi-part snapshots, vinyl runs with pages stored with
+	 * key prefix compression.
+	 */
+	XLOG_FORMAT_V14 = 14,
+};
+
 /**
  * A xlog meta info
  */
 struct xlog_meta {
 	/** Text file header: filetype */
 	char filetype[10];
+	/** Text file header: format version. */
+	enum xlog_format_version version;
 	/**
 	 * Text file header: instance uuid. We read
 	 * only logs with our own uuid, to avoid situations
@@ -312,10 +379,22 @@ struct xlog_meta {
 	 * directory for missing WALs.
 	 */
 	struct vclock prev_vclock;
+	/**
+	 * Text file header: size of the zstd dictionary stored
+	 * right after the header, 0 if there's none.
+	 */
+	uint32_t zdict_size;
+	/**
+	 * Text file header: number of part files the data set
+	 * is split into in addition to this file, 0 if there's
+	 * none. See xdir_create_xlog_part().
+	 */
+	uint32_t part_count;
 };
 
 /**
- * Initialize xlog meta struct.
+ * Initialize xlog meta struct. The format version is set to
+ * XLOG_FORMAT_V13, a writer using newer features must raise it.
  *
  * @vclock and @prev_vclock are optional: if the value is NULL,
  * the key won't be written to the xlog header.
@@ -328,6 +407,185 @@ xlog_meta_create(struct xlog_meta *meta, const char *filetype,
 
 /* }}} */
 
+/* {{{ zstd dictionaries */
+
+enum {
+	/** Min size of a zstd dictionary. */
+	XLOG_ZDICT_SIZE_MIN = 1024,
+	/** Max size of a zstd dictionary. */
+	XLOG_ZDICT_SIZE_MAX = 1024 * 1024,
+};
+
+/**
+ * A zstd dictionary for compression of tx blocks. Frames
+ * compressed with a dictionary store its ID, so a reader
+ * knows which blocks need the dictionary to be decoded.
+ *
+ * The reference counter isn't atomic, so a dictionary
+ * may only be referenced and unreferenced by one thread,
+ * though it may be used by many threads at the same time.
+ */
+struct xlog_zdict {
+	/** Reference counter. */
+	int refs;
+	/** Dictionary ID, never 0. */
+	uint32_t id;
+	/** Size of @data. */
+	size_t size;
+	/** Digested dictionary for compression. */
+	ZSTD_CDict *cdict;
+	/** Digested dictionary for decompression. */
+	ZSTD_DDict *ddict;
+	/** Dictionary content, as stored in the file header. */
+	char data[0];
+};
+
+/**
+ * Create a dictionary from its content. The content must
+ * be produced by the zstd dictionary builder.
+ *
+ * @retval NULL error, check diag
+ */
+struct xlog_zdict *
+xlog_zdict_new(const char *data, size_t size);
+
+/** Free a dictionary. */
+void
+xlog_zdict_delete(struct xlog_zdict *zdict);
+
+static inline void
+xlog_zdict_ref(struct xlog_zdict *zdict)
+{
+	assert(zdict->refs >= 0);
+	zdict->refs++;
+}
+
+static inline void
+xlog_zdict_unref(struct xlog_zdict *zdict)
+{
+	assert(zdict->refs > 0);
+	if (--zdict->refs == 0)
+		xlog_zdict_delete(zdict);
+}
+
+/**
+ * Samples of data to train a zstd dictionary on. The sampler
+ * may be fed with any amount of data: if there's too much,
+ * only each n-th piece is kept, so that the samples cover
+ * all the data evenly.
+ */
+struct xlog_zdict_sampler {
+	/** Concatenated samples. */
+	char *data;
+	/** Size of @data. */
+	size_t size;
+	/** Max size of @data. */
+	size_t size_max;
+	/** Sizes of the samples. */
+	size_t *sizes;
+	/** Number of samples. */
+	uint32_t count;
+	/** Number of elements allocated for @sizes. */
+	uint32_t capacity;
+	/** Only each @stride-th piece of data is sampled. */
+	uint64_t stride;
+	/** Number of pieces of data fed to the sampler. */
+	uint64_t seen;
+};
+
+/**
+ * Initialize a sampler for training a dictionary of the
+ * given size.
+ */
+void
+xlog_zdict_sampler_create(struct xlog_zdict_sampler *sampler,
+			  size_t dict_size);
+
+void
+xlog_zdict_sampler_destroy(struct xlog_zdict_sampler *sampler);
+
+/**
+ * Feed a piece of data to a sampler. Sampling is best effort
+ * so the function never fails.
+ */
+void
+xlog_zdict_sampler_add(struct xlog_zdict_sampler *sampler,
+		       const char *data, size_t size);
+
+/**
+ * Train a dictionary of the given size on the sampled data.
+ *
+ * @retval 0 success, @a zdict is set to the new dictionary
+ *         or to NULL if there's too little data for training
+ * @retval -1 error, check diag
+ */
+int
+xlog_zdict_sampler_train(struct xlog_zdict_sampler *sampler,
+			 size_t dict_size, struct xlog_zdict **zdict);
+
+/* }}} */
+
+/**
+ * A tx block - a sequence of encoded xrow objects written to
+ * an xlog under a single fixheader - handed over to an xlog
+ * compressor.
+ */
+struct xlog_tx_block {
+	/** Link in xlog::blocks. */
+	struct stailq_entry in_xlog;
+	/** Encoded rows, preceded by room for the fixheader. */
+	struct obuf rows;
+	/** Number of rows in the block. */
+	int64_t n_rows;
+	/** Whether the rows should be compressed. */
+	bool compress;
+	/** Dictionary to compress the rows with or NULL. */
+	const struct xlog_zdict *zdict;
+	/**
+	 * The compressed block, fixheader included, allocated
+	 * with malloc(). NULL if the block isn't compressed.
+	 */
+	char *zdata;
+	/** Size of @zdata. */
+	size_t zsize;
+	/** Set when the compressor is done with the block. */
+	bool is_ready;
+	/** Compression error, if any. */
+	struct diag diag;
+};
+
+/**
+ * Compress rows of a tx block into xlog_tx_block::zdata.
+ * Doesn't depend on any xlog state so may be called from
+ * any thread, given a compression context owned by it.
+ *
+ * @retval 0 success
+ * @retval -1 error, check diag
+ */
+int
+xlog_tx_block_compress(struct xlog_tx_block *block, ZSTD_CCtx *zctx);
+
+/**
+ * An xlog compressor compresses tx blocks out of the thread
+ * writing an xlog, so that the writer only writes them to
+ * disk. Blocks are still written in the order they were
+ * submitted in, so the file layout is the same as without
+ * a compressor.
+ */
+struct xlog_compressor {
+	/**
+	 * Start compression of a block. The compressor must set
+	 * xlog_tx_block::is_ready once it's done with the block.
+	 */
+	void
+	(*submit)(struct xlog_compressor *compressor,
+		  struct xlog_tx_block *block);
+	/** Wait until a submitted block is ready. */
+	void
+	(*wait)(struct xlog_compressor *compressor,
+		struct xlog_tx_block *block);
+};
+
 /**
  * A single log file - a snapshot, a vylog or a write ahead log.
  */
@@ -388,6 +646,22 @@ struct xlog {
 	 * Compressed output buffer
 	 */
 	struct obuf zbuf;
+	/**
+	 * If set, tx blocks big enough to be compressed are
+	 * handed over to this compressor instead of being
+	 * compressed in place. See xlog_set_compressor().
+	 */
+	struct xlog_compressor *compressor;
+	/**
+	 * Tx blocks handed over to the compressor and not
+	 * written yet, in the order of submission.
+	 */
+	struct stailq blocks;
+	/**
+	 * Direct I/O write buffers, set if the file is written
+	 * with O_DIRECT, see xlog_opts::direct_io.
+	 */
+	struct xlog_dio *dio;
 	/**
 	 * Synced file size
 	 */
@@ -427,6 +701,27 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Create a file of a data set split into several files that
+ * can be written and read independently. The main file, which
+ * has @a part equal to 0, is named as a usual xdir file and is
+ * the only one indexed by the xdir. It stores @a part_count in
+ * its header. Part files 1..part_count are named
+ * <signature>.<part>.<ext>. All files are created inprogress
+ * and should be renamed by the caller, part files first, so that
+ * the whole set appears atomically with the main file.
+ *
+ * A stale part file left from a failed attempt to write the
+ * same set is removed.
+ *
+ * @param opts options to write the file with, may differ from
+ *             the xdir options, e.g. in the rate limit.
+ */
+int
+xdir_create_xlog_part(struct xdir *dir, struct xlog *xlog,
+		      const struct vclock *vclock, uint32_t part,
+		      uint32_t part_count, const struct xlog_opts *opts);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -520,17 +815,33 @@ ssize_t
 xlog_tx_commit(struct xlog *log);
 
 /**
- * Discard xlog row buffer
+ * Discard xlog row buffer along with the tx blocks handed
+ * over to the compressor and not written yet.
  */
 void
 xlog_tx_rollback(struct xlog *log);
 
 /**
- * Flush buffered rows and sync file
+ * Flush buffered rows and sync file. Waits for the tx blocks
+ * handed over to the compressor and writes them. The blocks
+ * are written all or nothing.
  */
 ssize_t
 xlog_flush(struct xlog *log);
 
+/**
+ * Set a compressor for tx blocks of an xlog open for writing.
+ * Pass NULL to compress blocks in place. Must be called when
+ * the xlog has no blocks in flight, e.g. right after it has
+ * been created.
+ */
+static inline void
+xlog_set_compressor(struct xlog *log, struct xlog_compressor *compressor)
+{
+	assert(stailq_empty(&log->blocks));
+	log->compressor = compressor;
+}
+
 
 /**
  * Sync a log file. The exact action is defined
@@ -582,7 +893,7 @@ struct xlog_tx_cursor
 ssize_t
 xlog_tx_cursor_create(struct xlog_tx_cursor *cursor,
 		      const char **data, const char *data_end,
-		      ZSTD_DStream *zdctx);
+		      ZSTD_DStream *zdctx, const struct xlog_zdict *zdict);
 
 /**
  * Destroy xlog tx cursor and free all associated memory
@@ -620,13 +931,15 @@ xlog_tx_cursor_pos(struct xlog_tx_cursor *tx_cursor)
  * @param data_end the end of @a data buffer
  * @param[out] rows a buffer to store decoded rows
  * @param[out] rows_end the end of @a rows buffer
+ * @param zdctx zstd decompression context
+ * @param zdict dictionary the tx may be compressed with or NULL
  * @retval  0 success
  * @retval -1 error, check diag
  */
 int
 xlog_tx_decode(const char *data, const char *data_end,
 	       char *rows, char *rows_end,
-	       ZSTD_DStream *zdctx);
+	       ZSTD_DStream *zdctx, const struct xlog_zdict *zdict);
 
 /* }}} */
 
@@ -667,6 +980,12 @@ struct xlog_cursor {
 	struct xlog_tx_cursor tx_cursor;
 	/** ZSTD context for decompression */
 	ZSTD_DStream *zdctx;
+	/**
+	 * zstd dictionary stored in the file header or NULL.
+	 * Freed on close unless the caller takes it over by
+	 * resetting the pointer.
+	 */
+	struct xlog_zdict *zdict;
 };
 
 /**
@@ -743,6 +1062,21 @@ xlog_cursor_close(struct xlog_cursor *cursor, bool reuse_fd);
 int
 xlog_cursor_next_tx(struct xlog_cursor *cursor);
 
+/**
+ * Read next tx from xlog without decoding it. The tx block,
+ * including its fixheader, is returned in @a data and @a size
+ * and stays valid until the cursor is used again. It can be
+ * decoded with xlog_tx_cursor_create(), possibly in another
+ * thread.
+ * @param cursor cursor
+ * @retval 0 succes
+ * @retval 1 eof
+ * retval -1 error, check diag
+ */
+int
+xlog_cursor_next_tx_raw(struct xlog_cursor *cursor, const char **data,
+			size_t *size);
+
 /**
  * Fetch next xrow from current xlog tx
  *
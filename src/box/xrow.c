@@ -587,12 +587,25 @@ void
 iproto_reply_select(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
 		    uint32_t schema_version, uint32_t count)
 {
+	iproto_reply_select_with_data(buf, svp, sync, schema_version,
+				      count, 0, 0);
+}
+
+void
+iproto_reply_select_with_data(struct obuf *buf, struct obuf_svp *svp,
+			      uint64_t sync, uint32_t schema_version,
+			      uint32_t count, size_t data_size,
+			      uint32_t extra_key_count)
+{
+	/* The body map size must fit into a fixmap. */
+	assert(extra_key_count < 15);
 	char *pos = (char *) obuf_svp_to_ptr(buf, svp);
 	iproto_header_encode(pos, IPROTO_OK, sync, schema_version,
 			        obuf_size(buf) - svp->used -
-				IPROTO_HEADER_LEN);
+				IPROTO_HEADER_LEN + data_size);
 
 	struct iproto_body_bin body = iproto_body_bin;
+	body.m_body += extra_key_count;
 	body.v_data_len = mp_bswap_u32(count);
 
 	memcpy(pos + IPROTO_HEADER_LEN, &body, sizeof(body));
@@ -705,9 +718,15 @@ error:
 		return -1;
 	}
 
+	/*
+	 * Projection and position keys make sense only for
+	 * SELECT, other request types skip them as unknown.
+	 */
+	bool is_select = row->type == IPROTO_SELECT;
 	uint32_t size = mp_decode_map(&data);
 	for (uint32_t i = 0; i < size; i++) {
-		if (! iproto_dml_body_has_key(data, end)) {
+		if (is_select ? !iproto_select_body_has_key(data, end) :
+		    !iproto_dml_body_has_key(data, end)) {
 			if (mp_check(&data, end) != 0 ||
 			    mp_check(&data, end) != 0)
 				goto error;
@@ -755,6 +774,23 @@ error:
 			request->tuple_meta = value;
 			request->tuple_meta_end = data;
 			break;
+		case IPROTO_FIELDS:
+			request->fields = value;
+			request->fields_end = data;
+			break;
+		case IPROTO_KEY_ONLY:
+			request->key_only = mp_decode_bool(&value);
+			break;
+		case IPROTO_FETCH_POSITION:
+			request->fetch_position = mp_decode_bool(&value);
+			break;
+		case IPROTO_AFTER_POSITION: {
+			uint32_t len;
+			request->after_position = mp_decode_str(&value, &len);
+			request->after_position_end =
+				request->after_position + len;
+			break;
+		}
 		default:
 			break;
 		}
@@ -764,6 +800,11 @@ error:
 				   "packet end");
 		return -1;
 	}
+	if (request->fields != NULL && request->key_only) {
+		xrow_on_decode_err(start, end, ER_ILLEGAL_PARAMS,
+				   "fields and key_only can't be used together");
+		return -1;
+	}
 done:
 	if (key_map) {
 		enum iproto_key key = (enum iproto_key) bit_ctz_u64(key_map);
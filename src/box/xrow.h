@@ -172,8 +172,21 @@ struct request {
 	/** Tuple metadata. */
 	const char *tuple_meta;
 	const char *tuple_meta_end;
-	/** Base field offset for UPDATE/UPSERT, e.g. 0 for C and 1 for Lua. */
+	/**
+	 * Base field offset for UPDATE/UPSERT and SELECT fields,
+	 * e.g. 0 for C and 1 for Lua.
+	 */
 	int index_base;
+	/** SELECT result projection, see IPROTO_FIELDS. */
+	const char *fields;
+	const char *fields_end;
+	/** SELECT returns the index key parts only. */
+	bool key_only;
+	/** SELECT starts after this position. */
+	const char *after_position;
+	const char *after_position_end;
+	/** SELECT returns the position of the last tuple. */
+	bool fetch_position;
 };
 
 /**
@@ -594,6 +607,19 @@ void
 iproto_reply_select(struct obuf *buf, struct obuf_svp *svp, uint64_t sync,
 		    uint32_t schema_version, uint32_t count);
 
+/**
+ * Same as iproto_reply_select(), but @a data_size bytes of the
+ * result set are not stored in @a buf: the caller sends them
+ * right after the buffer contents. Besides, the caller may
+ * write @a extra_key_count more body keys after the result
+ * set, e.g. IPROTO_POSITION.
+ */
+void
+iproto_reply_select_with_data(struct obuf *buf, struct obuf_svp *svp,
+			      uint64_t sync, uint32_t schema_version,
+			      uint32_t count, size_t data_size,
+			      uint32_t extra_key_count);
+
 /**
  * Encode iproto header with IPROTO_OK response code.
  * @param out Encode to.
@@ -17,6 +17,7 @@ EXPORT(box_error_last)
 EXPORT(box_error_message)
 EXPORT(box_error_set)
 EXPORT(box_error_type)
+EXPORT(box_get_many)
 EXPORT(box_ibuf_read_range)
 EXPORT(box_ibuf_reserve)
 EXPORT(box_ibuf_write_range)
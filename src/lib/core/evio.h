@@ -121,6 +121,22 @@ evio_service_listen(struct evio_service *service);
 void
 evio_service_stop(struct evio_service *service);
 
+/**
+ * Start accepting connections on a socket listened by @a src
+ * in the event loop of @a dst. Used to share one listening
+ * socket among several threads. The socket is still owned by
+ * @a src and must outlive @a dst attachment.
+ */
+void
+evio_service_attach(struct evio_service *dst, const struct evio_service *src);
+
+/**
+ * Stop accepting connections on a socket attached with
+ * evio_service_attach(). Doesn't close the socket.
+ */
+void
+evio_service_detach(struct evio_service *service);
+
 int
 evio_socket(struct ev_io *coio, int domain, int type, int protocol);
 
@@ -44,6 +44,13 @@ enum mp_extension_type {
     MP_DECIMAL = 1,
     MP_UUID = 2,
     MP_ERROR = 3,
+    /*
+     * Reserved for compressed tuple fields. Ids below 16 are
+     * left to upstream (4 is already taken by MP_DATETIME
+     * there), and the id must stay below 32 to fit the
+     * field_ext_type masks.
+     */
+    MP_COMPRESSION = 16,
     mp_extension_type_MAX,
 };
 
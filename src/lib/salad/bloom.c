@@ -39,6 +39,8 @@
 #include <assert.h>
 #include <string.h>
 
+const char *bloom_type_strs[] = { "classic", "split_block" };
+
 int
 bloom_create(struct bloom *bloom, uint32_t number_of_values,
 	     double false_positive_rate)
@@ -101,3 +103,99 @@ bloom_load_table(struct bloom *bloom, const char *table)
 	memcpy(bloom->table, table, size);
 	return 0;
 }
+
+/**
+ * Return the least number of blocks a split block bloom filter
+ * with the given number of hash functions needs to store values
+ * with the given false positive rate.
+ */
+static uint32_t
+bloom_split_table_size(uint16_t hash_count, uint32_t number_of_values,
+		       double false_positive_rate)
+{
+	struct bloom bloom;
+	bloom.hash_count = hash_count;
+	/*
+	 * bloom_split_fpr() sums O(values per block) terms, so
+	 * don't start the search from tiny tables. A classic bloom
+	 * filter with the optimal number of hash functions needs
+	 * -ln(fpr) / ln(2)^2 bits per value and a split block one
+	 * can't do better, so its size is a good first guess.
+	 */
+	double bits = -log(false_positive_rate) / (log(2) * log(2)) *
+		      number_of_values;
+	double blocks = bits / (BLOOM_SPLIT_WORDS * sizeof(uint64_t) *
+				CHAR_BIT);
+	bloom.table_size = blocks < 1 ? 1 :
+			   blocks > UINT32_MAX / 2 ? UINT32_MAX / 2 : blocks;
+	/* fpr(lo) > false_positive_rate >= fpr(hi), fpr(0) = 1. */
+	uint32_t lo = 0;
+	uint32_t hi = bloom.table_size;
+	while (bloom_split_fpr(&bloom, number_of_values) >
+	       false_positive_rate) {
+		if (bloom.table_size > UINT32_MAX / 2)
+			return bloom.table_size;
+		lo = bloom.table_size;
+		bloom.table_size *= 2;
+		hi = bloom.table_size;
+	}
+	while (hi - lo > 1) {
+		bloom.table_size = lo + (hi - lo) / 2;
+		if (bloom_split_fpr(&bloom, number_of_values) >
+		    false_positive_rate)
+			lo = bloom.table_size;
+		else
+			hi = bloom.table_size;
+	}
+	return hi;
+}
+
+int
+bloom_split_create(struct bloom *bloom, uint32_t number_of_values,
+		   double false_positive_rate)
+{
+	/*
+	 * There is no simple formula for the optimal hash_count,
+	 * so pick the one that gives the smallest table.
+	 */
+	bloom->table_size = UINT32_MAX;
+	bloom->hash_count = 1;
+	for (uint16_t k = 1; k <= BLOOM_SPLIT_WORDS; k++) {
+		uint32_t table_size = bloom_split_table_size(k,
+				number_of_values, false_positive_rate);
+		if (table_size < bloom->table_size) {
+			bloom->table_size = table_size;
+			bloom->hash_count = k;
+		}
+	}
+	bloom->table = calloc(bloom->table_size, sizeof(*bloom->table));
+	if (bloom->table == NULL)
+		return -1;
+	return 0;
+}
+
+double
+bloom_split_fpr(const struct bloom *bloom, uint32_t number_of_values)
+{
+	if (number_of_values == 0)
+		return 0;
+	/* Number of hash functions. */
+	uint16_t k = bloom->hash_count;
+	/* Average number of elements in a block. */
+	double lambda = (double)number_of_values / bloom->table_size;
+	/* Probability that an element sets a given bit of a block. */
+	double p = (double)k / (BLOOM_SPLIT_WORDS * sizeof(uint64_t) *
+				CHAR_BIT);
+	/*
+	 * Unlike a classic bloom filter, the false positive rate
+	 * depends on the number of elements in the block a value
+	 * falls into, which follows the Poisson distribution.
+	 */
+	double fpr = 0;
+	uint32_t max_count = lambda + 12 * sqrt(lambda) + 12;
+	for (uint32_t n = 0; n <= max_count; n++) {
+		double prob = exp(n * log(lambda) - lambda - lgamma(n + 1));
+		fpr += prob * pow(1 - pow(1 - p, n), k);
+	}
+	return fpr;
+}
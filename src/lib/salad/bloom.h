@@ -49,6 +49,10 @@
 #include <limits.h>
 #include "bit/bit.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -56,15 +60,32 @@ extern "C" {
 enum {
 	/* Expected cache line of target processor */
 	BLOOM_CACHE_LINE = 64,
+	/* Number of words in a block of split block bloom filter */
+	BLOOM_SPLIT_WORDS = BLOOM_CACHE_LINE / sizeof(uint64_t),
 };
 
 typedef uint32_t bloom_hash_t;
 
+/**
+ * Layout of bits of a value in a bloom filter block.
+ */
+enum bloom_type {
+	/* hash_count bits anywhere in the block, see bloom_add() */
+	BLOOM_TYPE_CLASSIC,
+	/* One bit in each of hash_count words, see bloom_split_add() */
+	BLOOM_TYPE_SPLIT_BLOCK,
+	bloom_type_MAX
+};
+extern const char *bloom_type_strs[];
+
 /**
  * Cache-line-size block of bloom filter
  */
 struct bloom_block {
-	unsigned char bits[BLOOM_CACHE_LINE];
+	union {
+		unsigned char bits[BLOOM_CACHE_LINE];
+		uint64_t words[BLOOM_SPLIT_WORDS];
+	};
 };
 
 /**
@@ -158,6 +179,60 @@ bloom_store(const struct bloom *bloom, char *table);
 int
 bloom_load_table(struct bloom *bloom, const char *table);
 
+/*
+ * Split block bloom filter
+ *
+ * A variant of the filter that shares the table layout and
+ * the store/load functions with the classic one, but sets one
+ * bit in each of hash_count 64-bit words of a block instead of
+ * hash_count bits anywhere in the block. The bits of a value
+ * are computed independently of each other, so a lookup checks
+ * them all at once with a few vector instructions.
+ * The idea is borrowed from the Apache Parquet format:
+ *  https://github.com/apache/parquet-format/blob/master/BloomFilter.md
+ */
+
+/**
+ * Allocate and initialize an instance of split block bloom filter
+ *
+ * @param bloom - structure to initialize
+ * @param number_of_values - estimated number of values to be added
+ * @param false_positive_rate - desired false positive rate
+ * @return 0 - OK, -1 - memory error
+ */
+int
+bloom_split_create(struct bloom *bloom, uint32_t number_of_values,
+		   double false_positive_rate);
+
+/**
+ * Add a value into the data set of a split block bloom filter
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ */
+static void
+bloom_split_add(struct bloom *bloom, bloom_hash_t hash);
+
+/**
+ * Query for presence of a value in the data set of a split block
+ * bloom filter
+ * @param bloom - the bloom filter
+ * @param hash - hash of the value
+ * @return true - the value could be in data set; false - the value is
+ *  definitively not in data set
+ */
+static bool
+bloom_split_maybe_has(const struct bloom *bloom, bloom_hash_t hash);
+
+/**
+ * Return the expected false positive rate of a split block
+ * bloom filter.
+ * @param bloom - the bloom filter
+ * @param number_of_values - number of values stored in the filter
+ * @return - expected false positive rate
+ */
+double
+bloom_split_fpr(const struct bloom *bloom, uint32_t number_of_values);
+
 /* }}} API declaration */
 
 /* {{{ API definition */
@@ -204,6 +279,89 @@ bloom_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
 	return true;
 }
 
+/* Odd multipliers giving independent bit numbers for each word */
+static const uint32_t bloom_split_salt[BLOOM_SPLIT_WORDS] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+static inline uint32_t
+bloom_split_pos(const struct bloom *bloom, bloom_hash_t hash)
+{
+	/* Using upper part of the hash for finding a block */
+	return ((uint64_t)hash * bloom->table_size) >> 32;
+}
+
+/**
+ * Word i of a block is used by a value if it is one of
+ * hash_count words starting from the word selected by the lower
+ * part of the hash, so that all words of a block are loaded
+ * evenly even if hash_count is less than BLOOM_SPLIT_WORDS.
+ * The number of the bit of the word is taken from the upper
+ * part of the hash multiplied by the word salt.
+ */
+static inline void
+bloom_split_mask(bloom_hash_t hash, uint16_t hash_count, uint64_t *mask)
+{
+	uint32_t first = hash % BLOOM_SPLIT_WORDS;
+	for (uint32_t i = 0; i < BLOOM_SPLIT_WORDS; i++) {
+		uint32_t bit_no = (hash * bloom_split_salt[i]) >> 26;
+		bool is_used = (i - first) % BLOOM_SPLIT_WORDS < hash_count;
+		mask[i] = (uint64_t)is_used << bit_no;
+	}
+}
+
+static inline void
+bloom_split_add(struct bloom *bloom, bloom_hash_t hash)
+{
+	struct bloom_block *block = &bloom->table[bloom_split_pos(bloom, hash)];
+	uint64_t mask[BLOOM_SPLIT_WORDS];
+	bloom_split_mask(hash, bloom->hash_count, mask);
+	for (uint32_t i = 0; i < BLOOM_SPLIT_WORDS; i++)
+		block->words[i] |= mask[i];
+}
+
+static inline bool
+bloom_split_maybe_has(const struct bloom *bloom, bloom_hash_t hash)
+{
+	const struct bloom_block *block =
+		&bloom->table[bloom_split_pos(bloom, hash)];
+#if defined(__AVX2__)
+	/*
+	 * Same as bloom_split_mask(), but for all words at once.
+	 * Unused words get a bit number greater than 63, which
+	 * makes the variable shift yield zero.
+	 */
+	const __m256i salt = _mm256_loadu_si256(
+		(const __m256i *)bloom_split_salt);
+	__m256i bit_no = _mm256_srli_epi32(_mm256_mullo_epi32(
+		_mm256_set1_epi32(hash), salt), 26);
+	__m256i word_no = _mm256_and_si256(_mm256_sub_epi32(
+		_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+		_mm256_set1_epi32(hash % BLOOM_SPLIT_WORDS)),
+		_mm256_set1_epi32(BLOOM_SPLIT_WORDS - 1));
+	__m256i is_used = _mm256_cmpgt_epi32(
+		_mm256_set1_epi32(bloom->hash_count), word_no);
+	bit_no = _mm256_or_si256(bit_no, _mm256_andnot_si256(
+		is_used, _mm256_set1_epi32(64)));
+	const __m256i one = _mm256_set1_epi64x(1);
+	__m256i lo = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(
+		_mm256_castsi256_si128(bit_no)));
+	__m256i hi = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(
+		_mm256_extracti128_si256(bit_no, 1)));
+	const __m256i *words = (const __m256i *)block->words;
+	return _mm256_testc_si256(_mm256_loadu_si256(words), lo) &&
+	       _mm256_testc_si256(_mm256_loadu_si256(words + 1), hi);
+#else
+	uint64_t mask[BLOOM_SPLIT_WORDS];
+	bloom_split_mask(hash, bloom->hash_count, mask);
+	uint64_t missing = 0;
+	for (uint32_t i = 0; i < BLOOM_SPLIT_WORDS; i++)
+		missing |= mask[i] & ~block->words[i];
+	return missing == 0;
+#endif
+}
+
 /* }}} API definition */
 
 #if defined(__cplusplus)
@@ -37,6 +37,9 @@
 #include <assert.h>
 #include <stdio.h> /* printf */
 #include "small/matras.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 /* {{{ BPS-tree description */
 /**
@@ -158,6 +161,14 @@
  * struct bps_tree_iterator bps_tree_lower_bound_elem(tree, elem, exact);
  * struct bps_tree_iterator bps_tree_upper_bound_elem(tree, elem, exact);
  * size_t bps_tree_approxiamte_count(tree, key);
+ * // with BPS_INNER_CHILD_CARDS only:
+ * struct bps_tree_iterator bps_tree_iterator_at(tree, offset);
+ * struct bps_tree_iterator bps_tree_lower_bound_get_offset(tree, key, exact,
+ *							   offset);
+ * struct bps_tree_iterator bps_tree_upper_bound_get_offset(tree, key, exact,
+ *							   offset);
+ * struct bps_tree_iterator bps_tree_lower_bound_elem_get_offset(tree, elem,
+ *								exact, offset);
  * bps_tree_elem_t *bps_tree_iterator_get_elem(tree, itr);
  * bool bps_tree_iterator_next(tree, itr);
  * bool bps_tree_iterator_prev(tree, itr);
@@ -302,6 +313,42 @@
  * #define BPS_BLOCK_LINEAR_SEARCH
  */
 
+/**
+ * A switch that turns the tree into an order statistic tree.
+ * Every inner block stores the number of elements in the subtree
+ * of each of its children, so an element can be found by its
+ * offset in the tree and the offset of a lower/upper bound can
+ * be calculated, both in logarithmic time. Costs some space in
+ * inner blocks (and thus a bit lower branching factor) and a
+ * little extra work on insertion and deletion. To turn it on,
+ * #define BPS_INNER_CHILD_CARDS
+ */
+
+/**
+ * Optional comparison hints. If every element carries a 64-bit
+ * hint such that hint(a) < hint(b) implies a < b, the tree can
+ * narrow the range of a block that must be searched with the
+ * comparator by looking at the hints only, which is done for
+ * several elements at a time with SIMD instructions where they
+ * are available. A special value means "no hint" and is never
+ * used for narrowing. To turn it on, define:
+ * BPS_TREE_ELEM_HINT(elem) - an lvalue of type uint64_t, the hint
+ *   of an element;
+ * BPS_TREE_KEY_HINT(key) - the hint of a key;
+ * BPS_TREE_HINT_NONE - the "no hint" value.
+ * Optionally, BPS_TREE_HINT_IS_ORDERED(arg) can be defined to
+ * tell at runtime whether the hints of the tree with the given
+ * argument follow the order. Example:
+ *
+ * #define BPS_TREE_ELEM_HINT(elem) ((elem).hint)
+ * #define BPS_TREE_KEY_HINT(key) ((key)->hint)
+ * #define BPS_TREE_HINT_NONE UINT64_MAX
+ */
+#if defined(BPS_TREE_ELEM_HINT) && !defined(BPS_TREE_HINT_IS_ORDERED)
+#define BPS_TREE_HINT_IS_ORDERED(arg) true
+#define BPS_TREE_HINT_IS_ORDERED_DEFAULT
+#endif
+
 /**
  * A switch that enables collection of executions of different
  * branches of code. Used only for debug purposes, I hope you
@@ -318,6 +365,8 @@ namespace BPS_TREE_NAMESPACE {
 /* {{{ BPS-tree internal settings */
 typedef int16_t bps_tree_pos_t;
 typedef uint32_t bps_tree_block_id_t;
+/* Number of elements in a subtree, see BPS_INNER_CHILD_CARDS */
+typedef size_t bps_tree_card_t;
 /* }}} */
 
 /* {{{ Compile time utils */
@@ -389,6 +438,11 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_lower_bound_elem _api_name(lower_bound_elem)
 #define bps_tree_upper_bound_elem _api_name(upper_bound_elem)
 #define bps_tree_approximate_count _api_name(approximate_count)
+#define bps_tree_iterator_at _api_name(iterator_at)
+#define bps_tree_lower_bound_get_offset _api_name(lower_bound_get_offset)
+#define bps_tree_upper_bound_get_offset _api_name(upper_bound_get_offset)
+#define bps_tree_lower_bound_elem_get_offset \
+	_api_name(lower_bound_elem_get_offset)
 #define bps_tree_iterator_get_elem _api_name(iterator_get_elem)
 #define bps_tree_iterator_next _api_name(iterator_next)
 #define bps_tree_iterator_prev _api_name(iterator_prev)
@@ -412,6 +466,8 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_restore_block_ver _bps_tree(restore_block_ver)
 #define bps_tree_root _bps_tree(root)
 #define bps_tree_touch_block _bps_tree(touch_block)
+#define bps_tree_hint_match _bps_tree(hint_match)
+#define bps_tree_hint_range _bps_tree(hint_range)
 #define bps_tree_find_ins_point_key _bps_tree(find_ins_point_key)
 #define bps_tree_find_ins_point_elem _bps_tree(find_ins_point_elem)
 #define bps_tree_find_after_ins_point_key _bps_tree(find_after_ins_point_key)
@@ -429,6 +485,12 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_touch_leaf_path_max_elem _bps_tree(touch_leaf_path_max_elem)
 #define bps_tree_touch_path _bps_tree(touch_path_max_elem)
 #define bps_tree_process_replace _bps_tree(process_replace)
+#define bps_tree_block_card _bps_tree(block_card)
+#define bps_tree_inner_set_child _bps_tree(inner_set_child)
+#define bps_tree_inner_move_children _bps_tree(inner_move_children)
+#define bps_tree_path_add_card _bps_tree(path_add_card)
+#define bps_tree_update_leaf_cards _bps_tree(update_leaf_cards)
+#define bps_tree_update_inner_cards _bps_tree(update_inner_cards)
 #define bps_tree_debug_memmove _bps_tree(debug_memmove)
 #define bps_tree_insert_into_leaf _bps_tree(insert_into_leaf)
 #define bps_tree_insert_into_inner _bps_tree(insert_into_inner)
@@ -804,6 +866,65 @@ bps_tree_upper_bound_elem(const struct bps_tree *tree, bps_tree_elem_t key,
 static inline size_t
 bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key);
 
+#ifdef BPS_INNER_CHILD_CARDS
+
+/**
+ * @brief Get an iterator to the element at the given offset, i.e.
+ *  the element that has exactly offset elements before it.
+ * @param tree - pointer to a tree
+ * @param offset - zero-based position of the element in the tree
+ * @return - Iterator. Invalid if offset >= size of the tree.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset);
+
+/**
+ * @brief Same as bps_tree_lower_bound, but also calculates the offset
+ *  of the found position, i.e. the number of elements less than key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_lower_bound. Pass NULL if not needed.
+ * @param offset - pointer to the result offset
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Same as bps_tree_upper_bound, but also calculates the offset
+ *  of the found position, i.e. the number of elements less than or
+ *  equal to key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_upper_bound. Pass NULL if not needed.
+ * @param offset - pointer to the result offset
+ * @return - Upper-bound iterator. Invalid if all elements are less or equal
+ *  than the key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Same as bps_tree_lower_bound_elem, but also calculates the
+ *  offset of the found position, i.e. the number of elements less
+ *  than the given one.
+ * @param tree - pointer to a tree
+ * @param key - the element that will be compared with tree elements
+ * @param exact - see bps_tree_lower_bound_elem. Pass NULL if not needed.
+ * @param offset - pointer to the result offset
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_elem_get_offset(const struct bps_tree *tree,
+				     bps_tree_elem_t key, bool *exact,
+				     size_t *offset);
+
+#endif /* BPS_INNER_CHILD_CARDS */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -936,9 +1057,18 @@ enum bps_tree_max_sizes {
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
 		 - 2 * sizeof(bps_tree_block_id_t) )
 		/ sizeof(bps_tree_elem_t),
+#ifdef BPS_INNER_CHILD_CARDS
+	/* One card is reserved for alignment of the arrays */
+	BPS_TREE_MAX_COUNT_IN_INNER =
+		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
+		 - sizeof(bps_tree_card_t))
+		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)
+		   + sizeof(bps_tree_card_t)),
+#else
 	BPS_TREE_MAX_COUNT_IN_INNER =
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block))
 		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)),
+#endif
 	BPS_TREE_MAX_DEPTH = 16
 };
 
@@ -984,6 +1114,10 @@ struct bps_inner {
 	bps_tree_elem_t elems[BPS_TREE_MAX_COUNT_IN_INNER - 1];
 	/* Corresponding child IDs */
 	bps_tree_block_id_t child_ids[BPS_TREE_MAX_COUNT_IN_INNER];
+#ifdef BPS_INNER_CHILD_CARDS
+	/* Numbers of elements in the corresponding child subtrees */
+	bps_tree_card_t child_cards[BPS_TREE_MAX_COUNT_IN_INNER];
+#endif
 };
 
 /**
@@ -1194,6 +1328,9 @@ bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 			}
 			parents[i]->child_ids[parents[i]->header.size] =
 				insert_id;
+#ifdef BPS_INNER_CHILD_CARDS
+			parents[i]->child_cards[parents[i]->header.size] = 0;
+#endif
 			if (new_id == (bps_tree_block_id_t)-1)
 				break;
 			if (i == depth - 2) {
@@ -1202,6 +1339,11 @@ bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 				insert_id = new_id;
 			}
 		}
+#ifdef BPS_INNER_CHILD_CARDS
+		for (bps_tree_block_id_t i = 0; i < depth - 1; i++)
+			parents[i]->child_cards[parents[i]->header.size] +=
+				leaf->header.size;
+#endif
 
 		bps_tree_elem_t insert_value = current[leaf->header.size - 1];
 		for (bps_tree_block_id_t i = 0; i < depth - 1; i++) {
@@ -1345,6 +1487,99 @@ bps_tree_random(const struct bps_tree *tree, size_t rnd)
 	return leaf->elems + pos;
 }
 
+#ifdef BPS_TREE_ELEM_HINT
+/**
+ * @brief Compare hints of up to 64 elements with the given hint.
+ * @param arr - array of elements
+ * @param size - size of the array, not greater than 64
+ * @param hint - hint to compare with, not BPS_TREE_HINT_NONE
+ * @param lt - receives a bit mask of elements whose hint is less
+ *             than the given one
+ * @param gt - receives a bit mask of elements whose hint is
+ *             greater than the given one and is not "no hint"
+ */
+static inline void
+bps_tree_hint_match(const bps_tree_elem_t *arr, size_t size, uint64_t hint,
+		    uint64_t *lt, uint64_t *gt)
+{
+	assert(size <= 64);
+	uint64_t lt_mask = 0, gt_mask = 0;
+	size_t i = 0;
+#if defined(__AVX2__)
+	/*
+	 * There is no unsigned 64-bit comparison in AVX2, so flip
+	 * the sign bits and compare as signed. Hints are gathered
+	 * right from the elements to keep the block layout intact.
+	 */
+	const long long stride = sizeof(bps_tree_elem_t);
+	const __m256i offsets = _mm256_set_epi64x(3 * stride, 2 * stride,
+						  stride, 0);
+	const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+	const __m256i h = _mm256_xor_si256(_mm256_set1_epi64x(hint), sign);
+	const __m256i none = _mm256_xor_si256(
+		_mm256_set1_epi64x(BPS_TREE_HINT_NONE), sign);
+	for (; i + 4 <= size; i += 4) {
+		const long long *base =
+			(const long long *)&BPS_TREE_ELEM_HINT(arr[i]);
+		__m256i v = _mm256_i64gather_epi64(base, offsets, 1);
+		v = _mm256_xor_si256(v, sign);
+		__m256i l = _mm256_cmpgt_epi64(h, v);
+		__m256i g = _mm256_andnot_si256(_mm256_cmpeq_epi64(v, none),
+						_mm256_cmpgt_epi64(v, h));
+		lt_mask |= (uint64_t)_mm256_movemask_pd(
+			_mm256_castsi256_pd(l)) << i;
+		gt_mask |= (uint64_t)_mm256_movemask_pd(
+			_mm256_castsi256_pd(g)) << i;
+	}
+#endif
+	for (; i < size; i++) {
+		uint64_t elem_hint = BPS_TREE_ELEM_HINT(arr[i]);
+		lt_mask |= (uint64_t)(elem_hint < hint) << i;
+		gt_mask |= (uint64_t)(elem_hint > hint &&
+				      elem_hint != BPS_TREE_HINT_NONE) << i;
+	}
+	*lt = lt_mask;
+	*gt = gt_mask;
+}
+
+/**
+ * @brief Narrow the range of a sorted array that must be searched
+ * for an element or a key with the given hint. All elements before
+ * the range are less and all elements after it are greater than
+ * the sought one, so the comparator is only called on hint ties.
+ * @param tree - pointer to a tree
+ * @param arr - array of elements
+ * @param size - size of the array
+ * @param hint - hint of the element or the key to find
+ * @param begin - receives the beginning of the range
+ * @param end - receives the end of the range
+ */
+static inline void
+bps_tree_hint_range(const struct bps_tree *tree, bps_tree_elem_t *arr,
+		    size_t size, uint64_t hint, bps_tree_elem_t **begin,
+		    bps_tree_elem_t **end)
+{
+	if (hint == BPS_TREE_HINT_NONE || !BPS_TREE_HINT_IS_ORDERED(tree->arg))
+		return;
+	size_t lt_end = 0;
+	size_t gt_begin = size;
+	for (size_t i = 0; i < size; i += 64) {
+		size_t count = size - i < 64 ? size - i : 64;
+		uint64_t lt, gt;
+		bps_tree_hint_match(arr + i, count, hint, &lt, &gt);
+		if (lt != 0)
+			lt_end = i + 64 - __builtin_clzll(lt);
+		if (gt != 0) {
+			gt_begin = i + __builtin_ctzll(gt);
+			break;
+		}
+	}
+	assert(lt_end <= gt_begin);
+	*begin = arr + lt_end;
+	*end = arr + gt_begin;
+}
+#endif /* #ifdef BPS_TREE_ELEM_HINT */
+
 /**
  * @brief Find the lowest element in sorted array that is >= than the key
  * @param tree - pointer to a tree
@@ -1361,6 +1596,9 @@ bps_tree_find_ins_point_key(const struct bps_tree *tree, bps_tree_elem_t *arr,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_ELEM_HINT
+	bps_tree_hint_range(tree, arr, size, BPS_TREE_KEY_HINT(key), &begin, &end);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -1406,6 +1644,9 @@ bps_tree_find_ins_point_elem(const struct bps_tree *tree, bps_tree_elem_t *arr,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_ELEM_HINT
+	bps_tree_hint_range(tree, arr, size, BPS_TREE_ELEM_HINT(elem), &begin, &end);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE(*begin, elem, tree->arg);
@@ -1453,6 +1694,9 @@ bps_tree_find_after_ins_point_key(const struct bps_tree *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_ELEM_HINT
+	bps_tree_hint_range(tree, arr, size, BPS_TREE_KEY_HINT(key), &begin, &end);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE_KEY(*begin, key, tree->arg);
@@ -1499,6 +1743,9 @@ bps_tree_find_after_ins_point_elem(const struct bps_tree *tree,
 	bps_tree_elem_t *begin = arr;
 	bps_tree_elem_t *end = arr + size;
 	*exact = false;
+#ifdef BPS_TREE_ELEM_HINT
+	bps_tree_hint_range(tree, arr, size, BPS_TREE_ELEM_HINT(elem), &begin, &end);
+#endif
 #ifdef BPS_BLOCK_LINEAR_SEARCH
 	while (begin != end) {
 		int res = BPS_TREE_COMPARE(*begin, elem, tree->arg);
@@ -1972,6 +2219,220 @@ bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key)
 	return result;
 }
 
+#ifdef BPS_INNER_CHILD_CARDS
+
+/**
+ * @brief Get an iterator to the element at the given offset, i.e.
+ *  the element that has exactly offset elements before it.
+ * @param tree - pointer to a tree
+ * @param offset - zero-based position of the element in the tree
+ * @return - Iterator. Invalid if offset >= size of the tree.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	if (offset >= tree->size) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos = 0;
+		while (pos < inner->header.size - 1 &&
+		       offset >= inner->child_cards[pos]) {
+			offset -= inner->child_cards[pos];
+			pos++;
+		}
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+	assert(offset < (size_t)block->size);
+	res.block_id = block_id;
+	res.pos = offset;
+	return res;
+}
+
+/**
+ * @brief Same as bps_tree_lower_bound, but also calculates the offset
+ *  of the found position, i.e. the number of elements less than key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_lower_bound. Pass NULL if not needed.
+ * @param offset - pointer to the result offset
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_ins_point_key(tree, inner->elems,
+						  inner->header.size - 1,
+						  key, exact);
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
+					  key, exact);
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+/**
+ * @brief Same as bps_tree_upper_bound, but also calculates the offset
+ *  of the found position, i.e. the number of elements less than or
+ *  equal to key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_upper_bound. Pass NULL if not needed.
+ * @param offset - pointer to the result offset
+ * @return - Upper-bound iterator. Invalid if all elements are less or equal
+ *  than the key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	bool exact_test;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_after_ins_point_key(tree, inner->elems,
+							inner->header.size - 1,
+							key, &exact_test);
+		if (exact_test)
+			*exact = true;
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_after_ins_point_key(tree, leaf->elems,
+						leaf->header.size,
+						key, &exact_test);
+	if (exact_test)
+		*exact = true;
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+/**
+ * @brief Same as bps_tree_lower_bound_elem, but also calculates the
+ *  offset of the found position, i.e. the number of elements less
+ *  than the given one.
+ * @param tree - pointer to a tree
+ * @param key - the element that will be compared with tree elements
+ * @param exact - see bps_tree_lower_bound_elem. Pass NULL if not needed.
+ * @param offset - pointer to the result offset
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_elem_get_offset(const struct bps_tree *tree,
+				     bps_tree_elem_t key, bool *exact,
+				     size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_ins_point_elem(tree, inner->elems,
+						   inner->header.size - 1,
+						   key, exact);
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_ins_point_elem(tree, leaf->elems, leaf->header.size,
+					   key, exact);
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+#endif /* BPS_INNER_CHILD_CARDS */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -2471,6 +2932,158 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 }
 #endif
 
+#ifdef BPS_INNER_CHILD_CARDS
+/**
+ * @brief Get the number of elements in the subtree of a block.
+ */
+static inline bps_tree_card_t
+bps_tree_block_card(struct bps_block *block)
+{
+	if (block->type == BPS_TREE_BT_LEAF)
+		return block->size;
+	assert(block->type == BPS_TREE_BT_INNER);
+	struct bps_inner *inner = (struct bps_inner *)block;
+	bps_tree_card_t card = 0;
+	for (bps_tree_pos_t i = 0; i < block->size; i++)
+		card += inner->child_cards[i];
+	return card;
+}
+#endif
+
+/**
+ * @brief Set a child of an inner block (and its cardinality if
+ *  BPS_INNER_CHILD_CARDS is defined).
+ */
+static inline void
+bps_tree_inner_set_child(struct bps_tree *tree, struct bps_inner *inner,
+			 bps_tree_pos_t pos, bps_tree_block_id_t block_id)
+{
+	inner->child_ids[pos] = block_id;
+#ifdef BPS_INNER_CHILD_CARDS
+	/* exclusive behaviour for debug checks */
+	if (tree->root_id != (bps_tree_block_id_t) -1)
+		inner->child_cards[pos] = bps_tree_block_card(
+			bps_tree_restore_block(tree, block_id));
+	else
+		inner->child_cards[pos] = 0;
+#else
+	(void)tree;
+#endif
+}
+
+/**
+ * @brief Move a number of children of inner blocks (and their
+ *  cardinalities if BPS_INNER_CHILD_CARDS is defined).
+ */
+static inline void
+bps_tree_inner_move_children(struct bps_inner *dst, bps_tree_pos_t dst_pos,
+			     struct bps_inner *src, bps_tree_pos_t src_pos,
+			     bps_tree_pos_t num)
+{
+	BPS_TREE_DATAMOVE(dst->child_ids + dst_pos, src->child_ids + src_pos,
+			  num, dst, src);
+#ifdef BPS_INNER_CHILD_CARDS
+	memmove(dst->child_cards + dst_pos, src->child_cards + src_pos,
+		num * sizeof(bps_tree_card_t));
+#endif
+}
+
+/**
+ * @brief Add delta to the cardinalities of all the subtrees on the
+ *  path from the root to a leaf. Called before an element is
+ *  inserted into (or deleted from) the leaf; blocks that are
+ *  rebalanced after that get their cardinalities updated by
+ *  bps_tree_update_leaf_cards and bps_tree_update_inner_cards.
+ */
+static inline void
+bps_tree_path_add_card(struct bps_tree *tree,
+		       struct bps_leaf_path_elem *leaf_path_elem, int delta)
+{
+#ifdef BPS_INNER_CHILD_CARDS
+	if (leaf_path_elem->parent == NULL)
+		return;
+	bps_tree_touch_path(tree, leaf_path_elem);
+	for (struct bps_inner_path_elem *path = leaf_path_elem->parent;
+	     path != NULL; path = path->parent)
+		path->block->child_cards[path->insertion_point] += delta;
+#else
+	(void)tree;
+	(void)leaf_path_elem;
+	(void)delta;
+#endif
+}
+
+/**
+ * @brief Update cardinalities of leaves that took part in
+ *  rebalancing in their (common) parent. Uncollected neighbours
+ *  (with NULL block) are skipped. Must be called before the
+ *  parent is modified, since positions in parent are used.
+ */
+static inline void
+bps_tree_update_leaf_cards(struct bps_leaf_path_elem *leaf_path_elem,
+			   struct bps_leaf_path_elem *left_ext,
+			   struct bps_leaf_path_elem *right_ext,
+			   struct bps_leaf_path_elem *left_left_ext,
+			   struct bps_leaf_path_elem *right_right_ext)
+{
+#ifdef BPS_INNER_CHILD_CARDS
+	struct bps_inner_path_elem *parent = leaf_path_elem->parent;
+	if (parent == NULL)
+		return;
+	struct bps_leaf_path_elem *exts[] = {
+		leaf_path_elem, left_ext, right_ext,
+		left_left_ext, right_right_ext,
+	};
+	for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+		if (exts[i]->block == NULL)
+			continue;
+		assert(exts[i]->parent == parent);
+		parent->block->child_cards[exts[i]->pos_in_parent] =
+			exts[i]->block->header.size;
+	}
+#else
+	(void)leaf_path_elem;
+	(void)left_ext;
+	(void)right_ext;
+	(void)left_left_ext;
+	(void)right_right_ext;
+#endif
+}
+
+/**
+ * @brief Same as bps_tree_update_leaf_cards, but for inner blocks.
+ */
+static inline void
+bps_tree_update_inner_cards(struct bps_inner_path_elem *inner_path_elem,
+			    struct bps_inner_path_elem *left_ext,
+			    struct bps_inner_path_elem *right_ext,
+			    struct bps_inner_path_elem *left_left_ext,
+			    struct bps_inner_path_elem *right_right_ext)
+{
+#ifdef BPS_INNER_CHILD_CARDS
+	struct bps_inner_path_elem *parent = inner_path_elem->parent;
+	if (parent == NULL)
+		return;
+	struct bps_inner_path_elem *exts[] = {
+		inner_path_elem, left_ext, right_ext,
+		left_left_ext, right_right_ext,
+	};
+	for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+		if (exts[i]->block == NULL)
+			continue;
+		assert(exts[i]->parent == parent);
+		parent->block->child_cards[exts[i]->pos_in_parent] =
+			bps_tree_block_card(&exts[i]->block->header);
+	}
+#else
+	(void)inner_path_elem;
+	(void)left_ext;
+	(void)right_ext;
+	(void)left_left_ext;
+	(void)right_right_ext;
+#endif
+}
+
 /**
  * @breif Insert an element into leaf block. There must be enough space.
  */
@@ -2525,15 +3138,14 @@ bps_tree_insert_into_inner(struct bps_tree *tree,
 		BPS_TREE_DATAMOVE(inner->elems + pos + 1, inner->elems + pos,
 				  inner->header.size - pos - 1, inner, inner);
 		inner->elems[pos] = max_elem;
-		BPS_TREE_DATAMOVE(inner->child_ids + pos + 1,
-				  inner->child_ids + pos,
-				  inner->header.size - pos, inner, inner);
+		bps_tree_inner_move_children(inner, pos + 1, inner, pos,
+					     inner->header.size - pos);
 	} else {
 		if (pos > 0)
 			inner->elems[pos - 1] = *inner_path_elem->max_elem_copy;
 		*inner_path_elem->max_elem_copy = max_elem;
 	}
-	inner->child_ids[pos] = block_id;
+	bps_tree_inner_set_child(tree, inner, pos, block_id);
 
 	inner->header.size++;
 }
@@ -2589,9 +3201,8 @@ bps_tree_delete_from_inner(struct bps_tree *tree,
 	if (pos < inner->header.size - 1) {
 		BPS_TREE_DATAMOVE(inner->elems + pos, inner->elems + pos + 1,
 				  inner->header.size - 2 - pos, inner, inner);
-		BPS_TREE_DATAMOVE(inner->child_ids + pos,
-				  inner->child_ids + pos + 1,
-				  inner->header.size - 1 - pos, inner, inner);
+		bps_tree_inner_move_children(inner, pos, inner, pos + 1,
+					     inner->header.size - 1 - pos);
 	} else if (pos > 0) {
 		*inner_path_elem->max_elem_copy = inner->elems[pos - 1];
 	}
@@ -2661,10 +3272,8 @@ bps_tree_move_elems_to_right_inner(struct bps_tree *tree,
 	assert(a->header.size >= num);
 	assert(b->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-			  b->header.size, b, b);
-	BPS_TREE_DATAMOVE(b->child_ids, a->child_ids + a->header.size - num,
-			  num, b, a);
+	bps_tree_inner_move_children(b, num, b, 0, b->header.size);
+	bps_tree_inner_move_children(b, 0, a, a->header.size - num, num);
 
 	if (!move_to_empty)
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
@@ -2741,10 +3350,8 @@ bps_tree_move_elems_to_left_inner(struct bps_tree *tree,
 	assert(b->header.size >= num);
 	assert(a->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-			  num, a, b);
-	BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-			  b->header.size - num, b, b);
+	bps_tree_inner_move_children(a, a->header.size, b, 0, num);
+	bps_tree_inner_move_children(b, 0, b, num, b->header.size - num);
 
 	if (!move_to_empty)
 		a->elems[a->header.size - 1] =
@@ -2865,8 +3472,7 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	assert(pos >= 0);
 
 	if (!move_to_empty) {
-		BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-				  b->header.size, b, b);
+		bps_tree_inner_move_children(b, num, b, 0, b->header.size);
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
 				  b->header.size - 1, b, b);
 	}
@@ -2874,12 +3480,11 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	bps_tree_pos_t mid_part_size = a->header.size - pos;
 	if (mid_part_size > num) {
 		/* In fact insert to 'a' block, to the internal position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_inner_move_children(b, 0, a, a->header.size - num,
+					     num);
+		bps_tree_inner_move_children(a, pos + 1, a, pos,
+					     mid_part_size - num);
+		bps_tree_inner_set_child(tree, a, pos, block_id);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + (a->header.size - num),
 				  num - 1, b, a);
@@ -2896,12 +3501,11 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 		a->elems[pos] = max_elem;
 	} else if (mid_part_size == num) {
 		/* In fact insert to 'a' block, to the last position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_inner_move_children(b, 0, a, a->header.size - num,
+					     num);
+		bps_tree_inner_move_children(a, pos + 1, a, pos,
+					     mid_part_size - num);
+		bps_tree_inner_set_child(tree, a, pos, block_id);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + (a->header.size - num),
 				  num - 1, b, a);
@@ -2915,12 +3519,11 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	} else {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = num - mid_part_size - 1;/* Can be 0 */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num + 1,
-				  new_pos, b, a);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  a->child_ids + pos, mid_part_size, b, a);
+		bps_tree_inner_move_children(b, 0, a, a->header.size - num + 1,
+					     new_pos);
+		bps_tree_inner_set_child(tree, b, new_pos, block_id);
+		bps_tree_inner_move_children(b, new_pos + 1, a, pos,
+					     mid_part_size);
 
 		if (pos == a->header.size) {
 			/* +1 */
@@ -3070,14 +3673,11 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 	if (pos >= num) {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = pos - num; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-				  num, a, b);
-		BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-				  new_pos, b, b);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  b->child_ids + pos,
-				  b->header.size - pos, b, b);
+		bps_tree_inner_move_children(a, a->header.size, b, 0, num);
+		bps_tree_inner_move_children(b, 0, b, num, new_pos);
+		bps_tree_inner_set_child(tree, b, new_pos, block_id);
+		bps_tree_inner_move_children(b, new_pos + 1, b, pos,
+					     b->header.size - pos);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3111,14 +3711,13 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 	} else {
 		/* In fact insert to 'a' block */
 		bps_tree_pos_t new_pos = a->header.size + pos; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size,
-				  b->child_ids, pos, a, b);
-		a->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(a->child_ids + new_pos + 1,
-				  b->child_ids + pos, num - 1 - pos, a, b);
+		bps_tree_inner_move_children(a, a->header.size, b, 0, pos);
+		bps_tree_inner_set_child(tree, a, new_pos, block_id);
+		bps_tree_inner_move_children(a, new_pos + 1, b, pos,
+					     num - 1 - pos);
 		if (!move_all)
-			BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num - 1,
-					  b->header.size - num + 1, b, b);
+			bps_tree_inner_move_children(b, 0, b, num - 1,
+						     b->header.size - num + 1);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3400,6 +3999,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x1);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3411,6 +4012,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x2);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3424,6 +4027,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x3);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3443,6 +4048,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x4);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3456,6 +4063,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x5);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3475,6 +4084,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x6);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3726,8 +4337,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 		struct bps_inner *new_root = bps_tree_create_inner(tree,
 				&new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_inner_set_child(tree, new_root, 0, tree->root_id);
+		bps_tree_inner_set_child(tree, new_root, 1, new_block_id);
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -3741,6 +4352,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 	*inserted_in_block = inserted_ext->block_id;
 	*inserted_in_pos = inserted_ext->insertion_point;
 	assert(leaf_path_elem->parent);
+	bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+				   &left_left_ext, &right_right_ext);
 	BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0xD);
 	return bps_tree_process_insert_inner(tree, leaf_path_elem->parent,
 			new_block_id, new_path_elem.pos_in_parent,
@@ -3783,6 +4396,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem, move_count,
 					block_id, pos, max_elem);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x1);
 			return 0;
 		} else if (bps_tree_inner_free_size(right_ext.block) > 0) {
@@ -3791,6 +4407,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count, block_id, pos, max_elem);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x2);
 			return 0;
 		}
@@ -3801,6 +4420,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem,
 					move_count, block_id, pos, max_elem);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x3);
 			return 0;
 		}
@@ -3817,6 +4439,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem, move_count,
 					block_id, pos, max_elem);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x4);
 			return 0;
 		}
@@ -3827,6 +4452,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count, block_id, pos, max_elem);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x5);
 			return 0;
 		}
@@ -3843,6 +4471,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count, block_id, pos, max_elem);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x6);
 			return 0;
 		}
@@ -4046,8 +4677,8 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 		struct bps_inner *new_root =
 			bps_tree_create_inner(tree, &new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_inner_set_child(tree, new_root, 0, tree->root_id);
+		bps_tree_inner_set_child(tree, new_root, 1, new_block_id);
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -4056,6 +4687,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 		return 0;
 	}
 	assert(inner_path_elem->parent);
+	bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+				    &right_ext, &left_left_ext,
+				    &right_right_ext);
 	BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0xD);
 	return bps_tree_process_insert_inner(tree, inner_path_elem->parent,
 			new_block_id, new_path_elem.pos_in_parent,
@@ -4106,6 +4740,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				bps_tree_leaf_overmin_size(left_ext.block) / 2;
 			bps_tree_move_elems_to_right_leaf(tree, &left_ext,
 					leaf_path_elem, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x1);
 			return;
 		} else if (bps_tree_leaf_overmin_size(right_ext.block) > 0) {
@@ -4113,6 +4749,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				bps_tree_leaf_overmin_size(right_ext.block) / 2;
 			bps_tree_move_elems_to_left_leaf(tree, leaf_path_elem,
 					&right_ext, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x2);
 			return;
 		}
@@ -4122,6 +4760,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				bps_tree_leaf_overmin_size(left_ext.block) / 2;
 			bps_tree_move_elems_to_right_leaf(tree, &left_ext,
 					leaf_path_elem, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x3);
 			return;
 		}
@@ -4137,6 +4777,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 					leaf_path_elem, move_count1);
 			bps_tree_move_elems_to_right_leaf(tree, &left_left_ext,
 					&left_ext, move_count2);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x4);
 			return;
 		}
@@ -4147,6 +4789,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				/ 2;
 			bps_tree_move_elems_to_left_leaf(tree, leaf_path_elem,
 					&right_ext, move_count);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x5);
 			return;
 		}
@@ -4162,6 +4806,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 					&right_ext, move_count1);
 			bps_tree_move_elems_to_left_leaf(tree, &right_ext,
 					&right_right_ext, move_count2);
+			bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+						   &left_left_ext, &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x6);
 			return;
 		}
@@ -4233,6 +4879,8 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 	}
 
 	assert(leaf_path_elem->block->header.size == 0);
+	bps_tree_update_leaf_cards(leaf_path_elem, &left_ext, &right_ext,
+				   &left_left_ext, &right_right_ext);
 
 	struct bps_leaf *leaf = (struct bps_leaf*)leaf_path_elem->block;
 	if (leaf->prev_id == (bps_tree_block_id_t)(-1)) {
@@ -4293,6 +4941,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 				/ 2;
 			bps_tree_move_elems_to_right_inner(tree, &left_ext,
 					inner_path_elem, move_count);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x1);
 			return;
 		} else if (bps_tree_inner_overmin_size(right_ext.block) > 0) {
@@ -4302,6 +4953,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 			bps_tree_move_elems_to_left_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x2);
 			return;
 		}
@@ -4312,6 +4966,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 				/ 2;
 			bps_tree_move_elems_to_right_inner(tree, &left_ext,
 					inner_path_elem, move_count);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x3);
 			return;
 		}
@@ -4328,6 +4985,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 					inner_path_elem, move_count1);
 			bps_tree_move_elems_to_right_inner(tree,
 					&left_left_ext, &left_ext, move_count2);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x4);
 			return;
 		}
@@ -4339,6 +4999,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 			bps_tree_move_elems_to_left_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x5);
 			return;
 		}
@@ -4355,6 +5018,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 					&right_ext, move_count1);
 			bps_tree_move_elems_to_left_inner(tree, &right_ext,
 					&right_right_ext, move_count2);
+			bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+						    &right_ext, &left_left_ext,
+						    &right_right_ext);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x6);
 			return;
 		}
@@ -4425,6 +5091,9 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 		return;
 	}
 	assert(inner_path_elem->block->header.size == 0);
+	bps_tree_update_inner_cards(inner_path_elem, &left_ext,
+				    &right_ext, &left_left_ext,
+				    &right_right_ext);
 
 	bps_tree_dispose_inner(tree, inner_path_elem->block,
 			inner_path_elem->block_id);
@@ -4465,9 +5134,13 @@ bps_tree_insert(struct bps_tree *tree, bps_tree_elem_t new_elem,
 	} else {
 		bps_tree_block_id_t unused1;
 		bps_tree_pos_t unused2;
-		return bps_tree_process_insert_leaf(tree, &leaf_path_elem,
-						    new_elem, &unused1,
-						    &unused2);
+		bps_tree_path_add_card(tree, &leaf_path_elem, 1);
+		int rc = bps_tree_process_insert_leaf(tree, &leaf_path_elem,
+						      new_elem, &unused1,
+						      &unused2);
+		if (rc != 0)
+			bps_tree_path_add_card(tree, &leaf_path_elem, -1);
+		return rc;
 	}
 }
 
@@ -4500,10 +5173,13 @@ bps_tree_insert_get_iterator(struct bps_tree *tree, bps_tree_elem_t new_elem,
 					 replaced);
 		return 0;
 	} else {
+		bps_tree_path_add_card(tree, &leaf_path_elem, 1);
 		int rc = bps_tree_process_insert_leaf(tree, &leaf_path_elem,
 						      new_elem,
 						      &inserted_iterator->block_id,
 						      &inserted_iterator->pos);
+		if (rc != 0)
+			bps_tree_path_add_card(tree, &leaf_path_elem, -1);
 		matras_head_read_view(&inserted_iterator->view);
 		return rc;
 	}
@@ -4528,6 +5204,7 @@ bps_tree_delete(struct bps_tree *tree, bps_tree_elem_t elem)
 	if (!exact)
 		return -1;
 
+	bps_tree_path_add_card(tree, &leaf_path_elem, -1);
 	bps_tree_process_delete_leaf(tree, &leaf_path_elem);
 	return 0;
 }
@@ -4561,6 +5238,7 @@ bps_tree_delete_value(struct bps_tree *tree, bps_tree_elem_t elem,
 		return -1;
 	if (deleted_elem != NULL)
 		*deleted_elem = leaf->elems[leaf_path_elem.insertion_point];
+	bps_tree_path_add_card(tree, &leaf_path_elem, -1);
 	bps_tree_process_delete_leaf(tree, &leaf_path_elem);
 	return 0;
 }
@@ -4676,13 +5354,21 @@ bps_tree_debug_check_block(const struct bps_tree *tree, struct bps_block *block,
 				result |= 0x4000000;
 		}
 
-		for (bps_tree_pos_t i = 0; i < block->size; i++)
+		for (bps_tree_pos_t i = 0; i < block->size; i++) {
+#ifdef BPS_INNER_CHILD_CARDS
+			size_t count_before = *calc_count;
+#endif
 			result |= bps_tree_debug_check_block(tree,
 				bps_tree_restore_block(tree,
 						       inner->child_ids[i]),
 				inner->child_ids[i], level - 1, calc_count,
 				expected_prev_id, expected_this_id,
 				check_fullness_next);
+#ifdef BPS_INNER_CHILD_CARDS
+			if (inner->child_cards[i] != *calc_count - count_before)
+				result |= 0x8000000;
+#endif
+		}
 		return result;
 	}
 }
@@ -6075,6 +6761,10 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef BPS_TREE_MEMMOVE
 #undef BPS_TREE_DATAMOVE
 #undef BPS_TREE_BRANCH_TRACE
+#ifdef BPS_TREE_HINT_IS_ORDERED_DEFAULT
+#undef BPS_TREE_HINT_IS_ORDERED
+#undef BPS_TREE_HINT_IS_ORDERED_DEFAULT
+#endif
 
 /* {{{ Macros for custom naming of structs and functions */
 #undef _api_name
@@ -6113,6 +6803,10 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_lower_bound_elem
 #undef bps_tree_upper_bound_elem
 #undef bps_tree_approximate_count
+#undef bps_tree_iterator_at
+#undef bps_tree_lower_bound_get_offset
+#undef bps_tree_upper_bound_get_offset
+#undef bps_tree_lower_bound_elem_get_offset
 #undef bps_tree_iterator_get_elem
 #undef bps_tree_iterator_next
 #undef bps_tree_iterator_prev
@@ -6135,6 +6829,8 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_restore_block_ver
 #undef bps_tree_root
 #undef bps_tree_touch_block
+#undef bps_tree_hint_match
+#undef bps_tree_hint_range
 #undef bps_tree_find_ins_point_key
 #undef bps_tree_find_ins_point_elem
 #undef bps_tree_find_after_ins_point_key
@@ -6152,6 +6848,12 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_touch_leaf_path_max_elem
 #undef bps_tree_touch_path
 #undef bps_tree_process_replace
+#undef bps_tree_block_card
+#undef bps_tree_inner_set_child
+#undef bps_tree_inner_move_children
+#undef bps_tree_path_add_card
+#undef bps_tree_update_leaf_cards
+#undef bps_tree_update_inner_cards
 #undef bps_tree_debug_memmove
 #undef bps_tree_insert_into_leaf
 #undef bps_tree_insert_into_inner
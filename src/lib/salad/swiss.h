@@ -0,0 +1,1052 @@
+/*
+ * *No header guard*: the header is allowed to be included twice
+ * with different sets of defines.
+ */
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Open addressing hash table with SIMD group probing.
+ *
+ * Values are stored in groups of SWISS_GROUP_SLOTS slots. Every
+ * group starts with a 16 byte control word: a tag byte per slot
+ * (zero for an empty slot, 7 bits of the hash with the high bit
+ * set for an occupied one) and an overflow counter. A lookup
+ * loads the control word of the home group, compares all tags
+ * with a couple of SSE2 instructions and calls the comparator
+ * only for the slots whose tag matches, so a successful lookup
+ * usually touches one cache line of the table and one value.
+ * If the home group is full, the value is put to the next group
+ * with a free slot and the overflow counters of the groups it
+ * was pushed past are incremented. A lookup stops at the first
+ * group with a zero overflow counter. A group is 128 bytes long,
+ * so an entry costs 9 bytes plus the load factor slack.
+ *
+ * Groups are stored in matras, so a consistent read view of the
+ * table can be created in O(1) (see SWISS(read_view_create)).
+ *
+ * The table grows incrementally in order not to stall the
+ * caller: when it becomes 3/4 full, a table of twice the size
+ * is allocated, SWISS_ALLOC_STEP groups per insertion. Once it
+ * is ready, it starts receiving new values and the values of
+ * the old table are moved there, SWISS_MIGRATE_STEP slots per
+ * insertion. While the migration is in progress, a lookup may
+ * need to check both tables. The table never shrinks.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "small/matras.h"
+
+#ifndef TARANTOOL_LIB_SALAD_SWISS_COMMON
+#define TARANTOOL_LIB_SALAD_SWISS_COMMON
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+enum {
+	/** Number of slots in a group. */
+	SWISS_GROUP_SLOTS = 14,
+	/** Mask of all slots of a group in a match bit mask. */
+	SWISS_GROUP_MASK = (1 << SWISS_GROUP_SLOTS) - 1,
+	/** Size of a group. Must be a power of two for matras. */
+	SWISS_GROUP_SIZE = 128,
+	/** Number of groups of a new table allocated per insertion. */
+	SWISS_ALLOC_STEP = 16,
+	/** Number of slots of an old table migrated per insertion. */
+	SWISS_MIGRATE_STEP = 2 * SWISS_GROUP_SLOTS,
+	/** Max number of groups in a table, see SWISS_POS_OLD. */
+	SWISS_GROUP_COUNT_MAX = 1 << 27,
+};
+
+/**
+ * The bit is set in a position of a value that is stored in
+ * the table being migrated.
+ */
+#define SWISS_POS_OLD 0x80000000u
+
+/**
+ * Return a bit mask of the slots of a group which tags are
+ * equal to the given one.
+ */
+static inline uint32_t
+swiss_group_match(const uint8_t *tags, uint8_t tag)
+{
+#if defined(__SSE2__)
+	__m128i ctrl = _mm_loadu_si128((const __m128i *)tags);
+	__m128i eq = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag));
+	return (uint32_t)_mm_movemask_epi8(eq) & SWISS_GROUP_MASK;
+#else
+	uint32_t mask = 0;
+	for (int i = 0; i < SWISS_GROUP_SLOTS; i++)
+		mask |= (uint32_t)(tags[i] == tag) << i;
+	return mask;
+#endif
+}
+
+/**
+ * Tag of a value with the given hash. The low bits of the hash
+ * select the home group, so the tag is taken from the high bits
+ * of the hash mixed with the golden ratio constant.
+ */
+static inline uint8_t
+swiss_tag(uint32_t hash)
+{
+	return (uint8_t)(((hash * 0x9E3779B1u) >> 25) | 0x80);
+}
+
+#endif /* TARANTOOL_LIB_SALAD_SWISS_COMMON */
+
+/**
+ * Additional user defined name that appended to prefix 'swiss'
+ * for all names of structs and functions in this header file.
+ * All names use pattern: swiss<SWISS_NAME>_<name of func/struct>
+ * May be empty, but still have to be defined (just #define SWISS_NAME)
+ */
+#ifndef SWISS_NAME
+#error "SWISS_NAME must be defined"
+#endif
+
+/**
+ * Data type that hash table holds. Must be not greater than
+ * 8 bytes.
+ */
+#ifndef SWISS_DATA_TYPE
+#error "SWISS_DATA_TYPE must be defined"
+#endif
+
+/**
+ * Data type that used to for finding values.
+ */
+#ifndef SWISS_KEY_TYPE
+#error "SWISS_KEY_TYPE must be defined"
+#endif
+
+/**
+ * Type of optional third parameter of comparing and hashing
+ * functions. If not needed, simply use #define SWISS_CMP_ARG_TYPE int
+ */
+#ifndef SWISS_CMP_ARG_TYPE
+#error "SWISS_CMP_ARG_TYPE must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value1, value2 and
+ * optional value that stored in hash table struct.
+ */
+#ifndef SWISS_EQUAL
+#error "SWISS_EQUAL must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value, key and
+ * optional value that stored in hash table struct.
+ */
+#ifndef SWISS_EQUAL_KEY
+#error "SWISS_EQUAL_KEY must be defined"
+#endif
+
+/**
+ * Hash function. Takes 2 parameters - value and optional value
+ * that stored in hash table struct. Must return the same hash
+ * as passed to SWISS(insert) for the value. Only hash fragments
+ * are stored in the table, so it is used to move values to a
+ * bigger table on growth.
+ */
+#ifndef SWISS_HASH
+#error "SWISS_HASH must be defined"
+#endif
+
+/**
+ * Tools for name substitution:
+ */
+#ifndef CONCAT4
+#define CONCAT4_R(a, b, c, d) a##b##c##d
+#define CONCAT4(a, b, c, d) CONCAT4_R(a, b, c, d)
+#endif
+
+#ifdef _
+#error '_' must be undefinded!
+#endif
+#define SWISS(name) CONCAT4(swiss, SWISS_NAME, _, name)
+
+/**
+ * Group of slots, the unit of probing.
+ */
+struct SWISS(group) {
+	/** Tags of the slots, zero for an empty slot. */
+	uint8_t tag[SWISS_GROUP_SLOTS];
+	/**
+	 * Number of values that were pushed past this group
+	 * because it was full. Sticks at UINT8_MAX.
+	 */
+	uint8_t overflow;
+	uint8_t unused;
+	union {
+		SWISS_DATA_TYPE value;
+		uint64_t padding;
+	} slot[SWISS_GROUP_SLOTS];
+};
+
+/**
+ * Array of groups. Reference counted, because a read view may
+ * outlive a table retired after a migration.
+ */
+struct SWISS(table) {
+	/* dynamic storage for groups */
+	struct matras mtable;
+	/* number of groups, power of two */
+	uint32_t group_count;
+	/* count of values stored in the table */
+	uint32_t count;
+	/* unique identifier of the table, used by iterators */
+	uint32_t id;
+	/* number of references: the hash table and read views */
+	uint32_t refs;
+};
+
+/**
+ * Type of functions for memory allocation and deallocation
+ */
+typedef void *(*SWISS(extent_alloc_t))(void *ctx);
+typedef void (*SWISS(extent_free_t))(void *ctx, void *extent);
+
+/**
+ * Main struct for holding hash table
+ */
+struct SWISS(core) {
+	/* count of values in hash table */
+	uint32_t count;
+	/* table that receives new values, NULL if never inserted */
+	struct SWISS(table) *table;
+	/* table being migrated to the current one or NULL */
+	struct SWISS(table) *old;
+	/* slots of the old table below this one are migrated */
+	uint32_t migrate_pos;
+	/* table being allocated for the next growth or NULL */
+	struct SWISS(table) *next;
+	/* the last assigned table identifier */
+	uint32_t last_id;
+	/* memory allocation parameters */
+	size_t extent_size;
+	SWISS(extent_alloc_t) extent_alloc;
+	SWISS(extent_free_t) extent_free;
+	void *alloc_ctx;
+	/* additional parameter for data comparison */
+	SWISS_CMP_ARG_TYPE arg;
+};
+
+/**
+ * Iterator, for iterating all values in hash_table.
+ * It also may be used for restoring one value by key.
+ * Values moved by the growth of the table while iterating may
+ * be visited twice.
+ */
+struct SWISS(iterator) {
+	/* identifier of the table being iterated */
+	uint32_t table_id;
+	/* current slot in the table */
+	uint32_t pos;
+};
+
+/**
+ * Frozen state of a hash table: all following hash table
+ * modifications will not be visible through it.
+ */
+struct SWISS(read_view) {
+	/* the old and the current tables at the moment of creation */
+	struct SWISS(table) *table[2];
+	/* versions of matras memory of the tables */
+	struct matras_view view[2];
+	/* index of the table being iterated */
+	uint32_t cur;
+	/* current slot in the table */
+	uint32_t pos;
+};
+
+/**
+ * Special result of swiss_find that means that nothing was found
+ */
+static const uint32_t SWISS(end) = 0xFFFFFFFF;
+
+/* Functions definition */
+
+/**
+ * @brief Hash table construction. Fills struct swiss members.
+ * @param ht - pointer to a hash table struct
+ * @param extent_size - size of allocating memory blocks
+ * @param extent_alloc_func - memory blocks allocation function
+ * @param extent_free_func - memory blocks deallocation function
+ * @param alloc_ctx - argument passed to memory block allocator
+ * @param arg - optional parameter to save for comparing function
+ */
+static inline void
+SWISS(create)(struct SWISS(core) *ht, size_t extent_size,
+	      SWISS(extent_alloc_t) extent_alloc_func,
+	      SWISS(extent_free_t) extent_free_func,
+	      void *alloc_ctx, SWISS_CMP_ARG_TYPE arg)
+{
+	assert(sizeof(SWISS_DATA_TYPE) <= sizeof(uint64_t));
+	assert(sizeof(struct SWISS(group)) == SWISS_GROUP_SIZE);
+	memset(ht, 0, sizeof(*ht));
+	ht->extent_size = extent_size;
+	ht->extent_alloc = extent_alloc_func;
+	ht->extent_free = extent_free_func;
+	ht->alloc_ctx = alloc_ctx;
+	ht->arg = arg;
+}
+
+static inline struct SWISS(table) *
+SWISS(table_new)(struct SWISS(core) *ht, uint32_t group_count)
+{
+	struct SWISS(table) *t = (struct SWISS(table) *)malloc(sizeof(*t));
+	if (t == NULL)
+		return NULL;
+	matras_create(&t->mtable, ht->extent_size, sizeof(struct SWISS(group)),
+		      ht->extent_alloc, ht->extent_free, ht->alloc_ctx);
+	t->group_count = group_count;
+	t->count = 0;
+	t->id = ++ht->last_id;
+	t->refs = 1;
+	return t;
+}
+
+static inline void
+SWISS(table_unref)(struct SWISS(table) *t)
+{
+	assert(t->refs > 0);
+	if (--t->refs > 0)
+		return;
+	matras_destroy(&t->mtable);
+	free(t);
+}
+
+/**
+ * Allocate up to @a step more groups of a table.
+ * Return -1 on memory error.
+ */
+static inline int
+SWISS(table_fill)(struct SWISS(table) *t, uint32_t step)
+{
+	while (step-- > 0 && t->mtable.head.block_count < t->group_count) {
+		matras_id_t id;
+		struct SWISS(group) *group = (struct SWISS(group) *)
+			matras_alloc(&t->mtable, &id);
+		if (group == NULL)
+			return -1;
+		memset(group, 0, sizeof(*group));
+	}
+	return 0;
+}
+
+static inline uint32_t
+SWISS(table_size)(const struct SWISS(table) *t)
+{
+	return t->group_count * SWISS_GROUP_SLOTS;
+}
+
+/**
+ * Find a value in a table skipping slots below @a begin.
+ */
+static inline uint32_t
+SWISS(table_find)(const struct SWISS(core) *ht, const struct SWISS(table) *t,
+		  uint32_t begin, uint32_t hash, SWISS_DATA_TYPE value)
+{
+	(void)ht;
+	uint32_t mask = t->group_count - 1;
+	uint32_t g = hash & mask;
+	uint8_t tag = swiss_tag(hash);
+	for (uint32_t i = 0; i <= mask; i++) {
+		struct SWISS(group) *group = (struct SWISS(group) *)
+			matras_get(&t->mtable, g);
+		uint32_t match = swiss_group_match(group->tag, tag);
+		while (match != 0) {
+			uint32_t s = __builtin_ctz(match);
+			uint32_t pos = g * SWISS_GROUP_SLOTS + s;
+			if (pos >= begin &&
+			    SWISS_EQUAL((group->slot[s].value), (value),
+					(ht->arg)))
+				return pos;
+			match &= match - 1;
+		}
+		if (group->overflow == 0)
+			break;
+		g = (g + 1) & mask;
+	}
+	return SWISS(end);
+}
+
+/**
+ * Find a key in a table skipping slots below @a begin.
+ */
+static inline uint32_t
+SWISS(table_find_key)(const struct SWISS(core) *ht,
+		      const struct SWISS(table) *t, uint32_t begin,
+		      uint32_t hash, SWISS_KEY_TYPE key)
+{
+	(void)ht;
+	uint32_t mask = t->group_count - 1;
+	uint32_t g = hash & mask;
+	uint8_t tag = swiss_tag(hash);
+	for (uint32_t i = 0; i <= mask; i++) {
+		struct SWISS(group) *group = (struct SWISS(group) *)
+			matras_get(&t->mtable, g);
+		uint32_t match = swiss_group_match(group->tag, tag);
+		while (match != 0) {
+			uint32_t s = __builtin_ctz(match);
+			uint32_t pos = g * SWISS_GROUP_SLOTS + s;
+			if (pos >= begin &&
+			    SWISS_EQUAL_KEY((group->slot[s].value), (key),
+					    (ht->arg)))
+				return pos;
+			match &= match - 1;
+		}
+		if (group->overflow == 0)
+			break;
+		g = (g + 1) & mask;
+	}
+	return SWISS(end);
+}
+
+/**
+ * Put a value to the first free slot in its probe sequence.
+ * Return the slot or SWISS(end) on memory error or if the table
+ * is full.
+ */
+static inline uint32_t
+SWISS(table_insert)(struct SWISS(table) *t, uint32_t hash,
+		    SWISS_DATA_TYPE value)
+{
+	uint32_t mask = t->group_count - 1;
+	uint32_t home = hash & mask;
+	uint32_t g = home;
+	struct SWISS(group) *group;
+	while (true) {
+		group = (struct SWISS(group) *)matras_get(&t->mtable, g);
+		if (swiss_group_match(group->tag, 0) != 0)
+			break;
+		g = (g + 1) & mask;
+		if (g == home)
+			return SWISS(end);
+	}
+	/*
+	 * Update the overflow counters first: if we fail to
+	 * touch a group, the counters are left too big, which
+	 * only makes lookups a bit longer.
+	 */
+	for (uint32_t i = home; i != g; i = (i + 1) & mask) {
+		group = (struct SWISS(group) *)matras_touch(&t->mtable, i);
+		if (group == NULL)
+			return SWISS(end);
+		if (group->overflow < UINT8_MAX)
+			group->overflow++;
+	}
+	group = (struct SWISS(group) *)matras_touch(&t->mtable, g);
+	if (group == NULL)
+		return SWISS(end);
+	uint32_t s = __builtin_ctz(swiss_group_match(group->tag, 0));
+	group->tag[s] = swiss_tag(hash);
+	group->slot[s].value = value;
+	t->count++;
+	return g * SWISS_GROUP_SLOTS + s;
+}
+
+/**
+ * Move up to @a step slots of the old table to the current one.
+ * The migrated slots are not cleared, they are skipped by
+ * lookups instead, so that read views of the old table don't
+ * have to copy its memory.
+ */
+static inline void
+SWISS(migrate)(struct SWISS(core) *ht, uint32_t step)
+{
+	struct SWISS(table) *old = ht->old;
+	uint32_t size = SWISS(table_size)(old);
+	while (step-- > 0 && ht->migrate_pos < size) {
+		uint32_t pos = ht->migrate_pos;
+		struct SWISS(group) *group = (struct SWISS(group) *)
+			matras_get(&old->mtable, pos / SWISS_GROUP_SLOTS);
+		uint32_t s = pos % SWISS_GROUP_SLOTS;
+		if (group->tag[s] != 0) {
+			SWISS_DATA_TYPE value = group->slot[s].value;
+			uint32_t h = SWISS_HASH((value), (ht->arg));
+			if (SWISS(table_insert)(ht->table, h,
+						value) == SWISS(end))
+				return; /* retried on the next insertion */
+			old->count--;
+		}
+		ht->migrate_pos++;
+	}
+	if (ht->migrate_pos < size)
+		return;
+	assert(old->count == 0);
+	ht->old = NULL;
+	SWISS(table_unref)(old);
+}
+
+/**
+ * Allocate up to @a step groups of the next table. When it's
+ * ready, switch insertions to it and start the migration.
+ */
+static inline void
+SWISS(prepare)(struct SWISS(core) *ht, uint32_t step)
+{
+	struct SWISS(table) *next = ht->next;
+	if (SWISS(table_fill)(next, step) != 0)
+		return; /* retried on the next insertion */
+	if (next->mtable.head.block_count < next->group_count)
+		return;
+	assert(ht->old == NULL);
+	ht->old = ht->table;
+	ht->migrate_pos = 0;
+	ht->table = next;
+	ht->next = NULL;
+}
+
+/**
+ * Make a step of growth of the table, if needed, before an
+ * insertion. Return -1 on memory error.
+ */
+static inline int
+SWISS(grow)(struct SWISS(core) *ht)
+{
+	if (ht->table == NULL) {
+		struct SWISS(table) *t = SWISS(table_new)(ht, 1);
+		if (t == NULL)
+			return -1;
+		if (SWISS(table_fill)(t, 1) != 0) {
+			SWISS(table_unref)(t);
+			return -1;
+		}
+		ht->table = t;
+		return 0;
+	}
+	struct SWISS(table) *t = ht->table;
+	uint64_t size = SWISS(table_size)(t);
+	if (ht->old != NULL) {
+		SWISS(migrate)(ht, SWISS_MIGRATE_STEP);
+	} else if (ht->next != NULL) {
+		SWISS(prepare)(ht, SWISS_ALLOC_STEP);
+	} else if ((uint64_t)t->count * 4 >= size * 3 &&
+		   t->group_count < SWISS_GROUP_COUNT_MAX) {
+		/* Memory error is retried on the next insertion. */
+		ht->next = SWISS(table_new)(ht, t->group_count * 2);
+		if (ht->next != NULL)
+			SWISS(prepare)(ht, SWISS_ALLOC_STEP);
+	}
+	/*
+	 * The growth is spread over many insertions, so normally
+	 * it's over long before the table is full. Still, finish
+	 * it at once if it isn't.
+	 */
+	if ((uint64_t)t->count * 8 >= size * 7) {
+		if (ht->next != NULL)
+			SWISS(prepare)(ht, UINT32_MAX);
+		if (ht->old != NULL)
+			SWISS(migrate)(ht, UINT32_MAX);
+	}
+	return 0;
+}
+
+/**
+ * @brief Hash table destruction. Frees all allocated memory
+ * except the tables referenced by read views.
+ * @param ht - pointer to a hash table struct
+ */
+static inline void
+SWISS(destroy)(struct SWISS(core) *ht)
+{
+	if (ht->table != NULL)
+		SWISS(table_unref)(ht->table);
+	if (ht->old != NULL)
+		SWISS(table_unref)(ht->old);
+	if (ht->next != NULL)
+		SWISS(table_unref)(ht->next);
+}
+
+/**
+ * @brief Find a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param value - value to find
+ * @return position of the found value or swiss_end if nothing found
+ */
+static inline uint32_t
+SWISS(find)(const struct SWISS(core) *ht, uint32_t hash, SWISS_DATA_TYPE value)
+{
+	if (ht->count == 0)
+		return SWISS(end);
+	uint32_t pos = SWISS(table_find)(ht, ht->table, 0, hash, value);
+	if (pos != SWISS(end) || ht->old == NULL)
+		return pos;
+	pos = SWISS(table_find)(ht, ht->old, ht->migrate_pos, hash, value);
+	return pos != SWISS(end) ? pos | SWISS_POS_OLD : pos;
+}
+
+/**
+ * @brief Find a record with given hash and key
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param key - key to find
+ * @return position of the found value or swiss_end if nothing found
+ */
+static inline uint32_t
+SWISS(find_key)(const struct SWISS(core) *ht, uint32_t hash,
+		SWISS_KEY_TYPE key)
+{
+	if (ht->count == 0)
+		return SWISS(end);
+	uint32_t pos = SWISS(table_find_key)(ht, ht->table, 0, hash, key);
+	if (pos != SWISS(end) || ht->old == NULL)
+		return pos;
+	pos = SWISS(table_find_key)(ht, ht->old, ht->migrate_pos, hash, key);
+	return pos != SWISS(end) ? pos | SWISS_POS_OLD : pos;
+}
+
+/**
+ * Get the table a position refers to and the slot in it.
+ */
+static inline struct SWISS(table) *
+SWISS(pos_table)(const struct SWISS(core) *ht, uint32_t *pos)
+{
+	if ((*pos & SWISS_POS_OLD) != 0) {
+		*pos &= ~SWISS_POS_OLD;
+		assert(ht->old != NULL && *pos >= ht->migrate_pos);
+		return ht->old;
+	}
+	return ht->table;
+}
+
+/**
+ * @brief Insert a record with given hash and value. Doesn't
+ * check if the value is already in the table.
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to insert
+ * @param value - value to insert
+ * @return position of the inserted value or swiss_end on memory error
+ */
+static inline uint32_t
+SWISS(insert)(struct SWISS(core) *ht, uint32_t hash, SWISS_DATA_TYPE value)
+{
+	if (SWISS(grow)(ht) != 0)
+		return SWISS(end);
+	uint32_t pos = SWISS(table_insert)(ht->table, hash, value);
+	if (pos != SWISS(end))
+		ht->count++;
+	return pos;
+}
+
+/**
+ * @brief Replace a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param value - value to find and replace
+ * @param replaced - pointer to a value that was stored in table before replace
+ * @return 0 if ok, 1 if not found or -1 on memory error
+ * (only with read views)
+ */
+static inline int
+SWISS(replace)(struct SWISS(core) *ht, uint32_t hash,
+	       SWISS_DATA_TYPE value, SWISS_DATA_TYPE *replaced)
+{
+	uint32_t pos = SWISS(find)(ht, hash, value);
+	if (pos == SWISS(end))
+		return 1;
+	struct SWISS(table) *t = SWISS(pos_table)(ht, &pos);
+	struct SWISS(group) *group = (struct SWISS(group) *)
+		matras_touch(&t->mtable, pos / SWISS_GROUP_SLOTS);
+	if (group == NULL)
+		return -1;
+	*replaced = group->slot[pos % SWISS_GROUP_SLOTS].value;
+	group->slot[pos % SWISS_GROUP_SLOTS].value = value;
+	return 0;
+}
+
+/**
+ * @brief Determine if position holds a value
+ * @param ht - pointer to a hash table struct
+ * @param pos - position of a value
+ */
+static inline bool
+SWISS(pos_valid)(const struct SWISS(core) *ht, uint32_t pos)
+{
+	struct SWISS(table) *t = SWISS(pos_table)(ht, &pos);
+	assert(pos < SWISS(table_size)(t));
+	struct SWISS(group) *group = (struct SWISS(group) *)
+		matras_get(&t->mtable, pos / SWISS_GROUP_SLOTS);
+	return group->tag[pos % SWISS_GROUP_SLOTS] != 0;
+}
+
+/**
+ * @brief Get a value from a desired position
+ * @param ht - pointer to a hash table struct
+ * @param pos - position of a value, must be valid (asserted).
+ */
+static inline SWISS_DATA_TYPE
+SWISS(get)(const struct SWISS(core) *ht, uint32_t pos)
+{
+	assert(SWISS(pos_valid)(ht, pos));
+	struct SWISS(table) *t = SWISS(pos_table)(ht, &pos);
+	struct SWISS(group) *group = (struct SWISS(group) *)
+		matras_get(&t->mtable, pos / SWISS_GROUP_SLOTS);
+	return group->slot[pos % SWISS_GROUP_SLOTS].value;
+}
+
+/**
+ * Delete a record from a hash table by given position, @a hash
+ * must be the hash of the value stored at the position.
+ */
+static inline int
+SWISS(delete_hashed)(struct SWISS(core) *ht, uint32_t pos, uint32_t hash)
+{
+	bool is_old = (pos & SWISS_POS_OLD) != 0;
+	struct SWISS(table) *t = SWISS(pos_table)(ht, &pos);
+	uint32_t g = pos / SWISS_GROUP_SLOTS;
+	struct SWISS(group) *group = (struct SWISS(group) *)
+		matras_touch(&t->mtable, g);
+	if (group == NULL)
+		return -1;
+	uint32_t s = pos % SWISS_GROUP_SLOTS;
+	assert(group->tag[s] != 0);
+	group->tag[s] = 0;
+	t->count--;
+	ht->count--;
+	if (is_old)
+		return 0; /* no more insertions into the old table */
+	/*
+	 * The value doesn't overflow the groups before its own
+	 * one any more. If we fail to touch a group, its counter
+	 * is left too big, which only makes lookups a bit longer.
+	 */
+	uint32_t mask = t->group_count - 1;
+	for (uint32_t i = hash & mask; i != g; i = (i + 1) & mask) {
+		group = (struct SWISS(group) *)matras_touch(&t->mtable, i);
+		if (group == NULL)
+			break;
+		if (group->overflow > 0 && group->overflow < UINT8_MAX)
+			group->overflow--;
+	}
+	return 0;
+}
+
+/**
+ * @brief Delete a record from a hash table by given position
+ * @param ht - pointer to a hash table struct
+ * @param pos - position of a value. See SWISS(find) for details.
+ * @return 0 if ok, -1 on memory error (only with read views)
+ */
+static inline int
+SWISS(delete)(struct SWISS(core) *ht, uint32_t pos)
+{
+	/* The hash isn't needed to delete from the old table. */
+	uint32_t hash = 0;
+	if ((pos & SWISS_POS_OLD) == 0)
+		hash = SWISS_HASH((SWISS(get)(ht, pos)), (ht->arg));
+	return SWISS(delete_hashed)(ht, pos, hash);
+}
+
+/**
+ * @brief Delete a record from a hash table by that value and its hash.
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash of the value
+ * @param value - value to delete
+ * @return 0 if ok, 1 if not found or -1 on memory error
+ * (only with read views)
+ */
+static inline int
+SWISS(delete_value)(struct SWISS(core) *ht, uint32_t hash,
+		    SWISS_DATA_TYPE value)
+{
+	uint32_t pos = SWISS(find)(ht, hash, value);
+	if (pos == SWISS(end))
+		return 1;
+	return SWISS(delete_hashed)(ht, pos, hash);
+}
+
+/**
+ * @brief Get position of a value that follows the given random
+ * number in the table.
+ * @param ht - pointer to a hash table struct
+ * @param rnd - random number
+ * @return position of a value or swiss_end if the table is empty
+ */
+static inline uint32_t
+SWISS(random)(const struct SWISS(core) *ht, uint32_t rnd)
+{
+	if (ht->count == 0)
+		return SWISS(end);
+	uint32_t old_size = 0;
+	if (ht->old != NULL)
+		old_size = SWISS(table_size)(ht->old) - ht->migrate_pos;
+	uint32_t size = old_size + SWISS(table_size)(ht->table);
+	rnd %= size;
+	while (true) {
+		uint32_t pos = rnd < old_size ?
+			(ht->migrate_pos + rnd) | SWISS_POS_OLD :
+			rnd - old_size;
+		if (SWISS(pos_valid)(ht, pos))
+			return pos;
+		if (++rnd == size)
+			rnd = 0;
+	}
+}
+
+/**
+ * @brief Get the number of memory extents used by the hash table
+ * @param ht - pointer to a hash table struct
+ */
+static inline size_t
+SWISS(extent_count)(const struct SWISS(core) *ht)
+{
+	size_t count = 0;
+	if (ht->table != NULL)
+		count += matras_extent_count(&ht->table->mtable);
+	if (ht->old != NULL)
+		count += matras_extent_count(&ht->old->mtable);
+	if (ht->next != NULL)
+		count += matras_extent_count(&ht->next->mtable);
+	return count;
+}
+
+/**
+ * @brief Set iterator to the beginning of hash table
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ */
+static inline void
+SWISS(iterator_begin)(const struct SWISS(core) *ht,
+		      struct SWISS(iterator) *itr)
+{
+	if (ht->old != NULL) {
+		itr->table_id = ht->old->id;
+		itr->pos = ht->migrate_pos;
+	} else {
+		itr->table_id = ht->table != NULL ? ht->table->id : 0;
+		itr->pos = 0;
+	}
+}
+
+/**
+ * @brief Set iterator to position determined by key
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @param hash - hash to find
+ * @param key - key to find
+ */
+static inline void
+SWISS(iterator_key)(const struct SWISS(core) *ht, struct SWISS(iterator) *itr,
+		    uint32_t hash, SWISS_KEY_TYPE key)
+{
+	uint32_t pos = SWISS(find_key)(ht, hash, key);
+	if (pos == SWISS(end)) {
+		itr->table_id = SWISS(end);
+		itr->pos = 0;
+		return;
+	}
+	struct SWISS(table) *t = SWISS(pos_table)(ht, &pos);
+	itr->table_id = t->id;
+	itr->pos = pos;
+}
+
+/**
+ * Get the next occupied slot of a table version starting from
+ * @a *pos and advance @a *pos past it.
+ */
+static inline SWISS_DATA_TYPE *
+SWISS(view_next)(const struct SWISS(table) *t, const struct matras_view *view,
+		 uint32_t *pos)
+{
+	uint32_t size = view->block_count * SWISS_GROUP_SLOTS;
+	while (*pos < size) {
+		uint32_t g = *pos / SWISS_GROUP_SLOTS;
+		struct SWISS(group) *group = (struct SWISS(group) *)
+			matras_view_get(&t->mtable, view, g);
+		uint32_t occupied = ~swiss_group_match(group->tag, 0) &
+				    SWISS_GROUP_MASK;
+		occupied &= ~0u << (*pos % SWISS_GROUP_SLOTS);
+		if (occupied != 0) {
+			uint32_t s = __builtin_ctz(occupied);
+			*pos = g * SWISS_GROUP_SLOTS + s + 1;
+			return &group->slot[s].value;
+		}
+		*pos = (g + 1) * SWISS_GROUP_SLOTS;
+	}
+	return NULL;
+}
+
+/**
+ * @brief Get the value that iterator currently points to
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @return pointer to the value or NULL if iteration is complete
+ */
+static inline SWISS_DATA_TYPE *
+SWISS(iterator_get_and_next)(const struct SWISS(core) *ht,
+			     struct SWISS(iterator) *itr)
+{
+	while (ht->table != NULL) {
+		struct SWISS(table) *t;
+		if (ht->old != NULL && itr->table_id == ht->old->id) {
+			t = ht->old;
+			if (itr->pos < ht->migrate_pos)
+				itr->pos = ht->migrate_pos;
+		} else if (itr->table_id == ht->table->id) {
+			t = ht->table;
+		} else if (itr->table_id < ht->table->id) {
+			/* The table was retired after a migration. */
+			SWISS(iterator_begin)(ht, itr);
+			continue;
+		} else {
+			break;
+		}
+		SWISS_DATA_TYPE *res = SWISS(view_next)(t, &t->mtable.head,
+							&itr->pos);
+		if (res != NULL)
+			return res;
+		if (t == ht->table)
+			break;
+		itr->table_id = ht->table->id;
+		itr->pos = 0;
+	}
+	itr->table_id = SWISS(end);
+	return NULL;
+}
+
+/**
+ * @brief Create a read view of the hash table. All following hash
+ * table modifications will not be visible through it. It must be
+ * destroyed with a swiss_read_view_destroy call after usage, but
+ * it may outlive the hash table.
+ * @param ht - pointer to a hash table struct
+ * @param rv - read view to create
+ */
+static inline void
+SWISS(read_view_create)(struct SWISS(core) *ht, struct SWISS(read_view) *rv)
+{
+	rv->table[0] = ht->old;
+	rv->table[1] = ht->table;
+	for (int i = 0; i < 2; i++) {
+		struct SWISS(table) *t = rv->table[i];
+		if (t == NULL) {
+			matras_head_read_view(&rv->view[i]);
+			continue;
+		}
+		t->refs++;
+		matras_create_read_view(&t->mtable, &rv->view[i]);
+	}
+	rv->cur = ht->old != NULL ? 0 : 1;
+	rv->pos = ht->old != NULL ? ht->migrate_pos : 0;
+}
+
+/**
+ * @brief Get the next value of a read view
+ * @param rv - read view
+ * @return pointer to the value or NULL if iteration is complete
+ */
+static inline SWISS_DATA_TYPE *
+SWISS(read_view_get_and_next)(struct SWISS(read_view) *rv)
+{
+	for (; rv->cur < 2; rv->cur++, rv->pos = 0) {
+		struct SWISS(table) *t = rv->table[rv->cur];
+		if (t == NULL)
+			continue;
+		SWISS_DATA_TYPE *res = SWISS(view_next)(t, &rv->view[rv->cur],
+							&rv->pos);
+		if (res != NULL)
+			return res;
+	}
+	return NULL;
+}
+
+/**
+ * @brief Destroy a read view
+ * @param rv - read view to destroy
+ */
+static inline void
+SWISS(read_view_destroy)(struct SWISS(read_view) *rv)
+{
+	for (int i = 0; i < 2; i++) {
+		struct SWISS(table) *t = rv->table[i];
+		if (t == NULL)
+			continue;
+		matras_destroy_read_view(&t->mtable, &rv->view[i]);
+		SWISS(table_unref)(t);
+	}
+}
+
+/*
+ * Selfcheck of the internal state of hash table. Used only for debugging.
+ * That means that you should not use this function.
+ * If return not zero, something went terribly wrong.
+ */
+static inline int
+SWISS(selfcheck)(const struct SWISS(core) *ht)
+{
+	int res = 0;
+	uint32_t count = 0;
+	for (int i = 0; i < 2; i++) {
+		struct SWISS(table) *t = i == 0 ? ht->old : ht->table;
+		if (t == NULL)
+			continue;
+		uint32_t begin = i == 0 ? ht->migrate_pos : 0;
+		uint32_t table_count = 0;
+		if (t->mtable.head.block_count != t->group_count)
+			res |= 1; /* table is not allocated */
+		for (uint32_t pos = begin; pos < SWISS(table_size)(t); pos++) {
+			struct SWISS(group) *group = (struct SWISS(group) *)
+				matras_get(&t->mtable, pos / SWISS_GROUP_SLOTS);
+			uint32_t s = pos % SWISS_GROUP_SLOTS;
+			if (group->tag[s] == 0)
+				continue;
+			table_count++;
+			SWISS_DATA_TYPE value = group->slot[s].value;
+			uint32_t h = SWISS_HASH((value), (ht->arg));
+			if (group->tag[s] != swiss_tag(h))
+				res |= 2; /* wrong tag */
+			uint32_t found = SWISS(table_find)(ht, t, begin,
+							   h, value);
+			if (found == SWISS(end))
+				res |= 4; /* value is unreachable */
+		}
+		if (table_count != t->count)
+			res |= 8; /* wrong table count */
+		count += table_count;
+	}
+	if (count != ht->count)
+		res |= 16; /* wrong count */
+	if (ht->next != NULL && ht->old != NULL)
+		res |= 32; /* growth started before migration end */
+	return res;
+}
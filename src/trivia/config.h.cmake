@@ -204,6 +204,11 @@
  */
 #cmakedefine HAVE_ICU_STRCOLLUTF8 1
 
+/*
+ * Defined if liburing is available.
+ */
+#cmakedefine HAVE_LIBURING 1
+
 /*
 * Defined if notifications on NOTIFY_SOCKET are enabled
  */
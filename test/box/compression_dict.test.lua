@@ -0,0 +1,84 @@
+test_run = require('test_run').new()
+fio = require('fio')
+xlog = require('xlog')
+
+--
+-- compression_dict_size is either 0 or fits the dictionary
+-- size limits.
+--
+box.cfg{compression_dict_size = -1}
+box.cfg{compression_dict_size = 100}
+box.cfg{compression_dict_size = 2 * 1024 * 1024}
+box.cfg.compression_dict_size
+
+test_run:cmd("setopt delimiter ';'")
+function fill(space, first, last)
+    box.begin()
+    for i = first, last do
+        space:replace{i, 'active', 'user' .. i .. '@example.com',
+                      {'Moscow', i % 100}}
+    end
+    box.commit()
+end;
+function last_file(pattern)
+    local files = fio.glob(pattern)
+    table.sort(files)
+    return files[#files]
+end;
+function has_dict(path)
+    local f = fio.open(path, {'O_RDONLY'})
+    local header = f:read(1024)
+    f:close()
+    return header:match('\nDictionary: %d+\n') ~= nil
+end;
+function count_rows(path)
+    local count = 0
+    for _ in xlog.pairs(path) do count = count + 1 end
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+
+--
+-- A dictionary trained on a snapshot is used to compress
+-- the next snapshot.
+--
+box.cfg{compression_dict_size = 4096}
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+fill(s, 1, 10000)
+box.snapshot()
+has_dict(last_file(box.cfg.memtx_dir .. '/*.snap'))
+fill(s, 10001, 10010)
+box.snapshot()
+snap = last_file(box.cfg.memtx_dir .. '/*.snap')
+has_dict(snap)
+count_rows(snap) > 10010
+
+--
+-- A dictionary trained on a vinyl dump is used to compress
+-- the run written by compaction.
+--
+v = box.schema.space.create('test_vinyl', {engine = 'vinyl'})
+_ = v:create_index('pk')
+fill(v, 1, 10000)
+box.snapshot()
+fill(v, 10001, 10010)
+box.snapshot()
+v.index.pk:compact()
+test_run:wait_cond(function() return v.index.pk:stat().run_count == 1 end)
+has_dict(last_file(box.cfg.vinyl_dir .. '/' .. v.id .. '/0/*.run'))
+
+--
+-- The data is readable after restart whatever
+-- compression_dict_size is.
+--
+test_run:cmd('restart server default')
+box.cfg.compression_dict_size
+s = box.space.test
+s:count()
+s:get{10010}
+v = box.space.test_vinyl
+v:count()
+v:get{5000}
+s:drop()
+v:drop()
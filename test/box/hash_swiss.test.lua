@@ -0,0 +1,52 @@
+test_run = require('test_run').new()
+
+--
+-- Open addressing hash table layout of memtx hash index.
+--
+s = box.schema.space.create('test')
+pk = s:create_index('pk', {type = 'hash', layout = 'swiss'})
+pk.layout
+sk = s:create_index('sk', {type = 'hash', parts = {2, 'string'}})
+sk.layout
+s:create_index('tree', {type = 'tree', layout = 'swiss'})
+s:create_index('sk2', {type = 'hash', parts = {2, 'string'}, layout = 'cuckoo'})
+-- The option is checked on direct _index inserts too.
+box.space._index:insert{s.id, 10, 'tree', 'tree', {layout = 'swiss'}, {{0, 'unsigned'}}}
+
+--
+-- The table grows incrementally while tuples are inserted.
+--
+for i = 1, 100000 do s:replace{i, tostring(i)} end
+pk:len()
+pk:get(1)
+pk:get(100000)
+pk:get(100001)
+for i = 1, 100000, 2 do s:delete{i} end
+pk:len()
+pk:get(1)
+pk:get(2)
+cnt = 0
+for _, t in pk:pairs() do cnt = cnt + 1 end
+cnt
+pk:select({4}, {iterator = 'eq'})
+pk:random(42) ~= nil
+pk:bsize() > 0
+s:insert{2, 'x'}
+
+--
+-- Changing the layout rebuilds the index.
+--
+sk:alter({layout = 'swiss'})
+sk.layout
+sk:get('4')
+
+--
+-- The index is checkpointed and recovered.
+--
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+s.index.pk.layout
+s.index.pk:len()
+s.index.sk:get('100000')
+s:drop()
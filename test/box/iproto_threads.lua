@@ -0,0 +1,9 @@
+#!/usr/bin/env tarantool
+
+box.cfg({
+    listen = os.getenv('LISTEN'),
+    iproto_threads = tonumber(arg[1]),
+    iproto_io_uring = arg[2] == 'true',
+})
+
+require('console').listen(os.getenv('ADMIN'))
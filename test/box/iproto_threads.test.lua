@@ -0,0 +1,62 @@
+test_run = require('test_run').new()
+net_box = require('net.box')
+
+--
+-- iproto_threads can't be changed after box.cfg().
+--
+box.cfg{iproto_threads = box.cfg.iproto_threads + 1}
+
+test_run:cmd("create server test with script='box/iproto_threads.lua'")
+test_run:cmd("start server test with args='4'")
+test_run:cmd("switch test")
+box.schema.user.grant('guest', 'super')
+#box.stat.net.thread()
+test_run:cmd("switch default")
+
+--
+-- Connections are spread among the threads, per-thread
+-- counters sum up to the total ones.
+--
+addr = test_run:eval('test', 'return box.cfg.listen')[1]
+conns = {}
+for i = 1, 16 do conns[i] = net_box.connect(addr) end
+ok = true
+for i = 1, 16 do ok = ok and conns[i]:ping() end
+ok
+test_run:cmd("switch test")
+stat = box.stat.net()
+connections = 0
+requests = 0
+for _, t in ipairs(box.stat.net.thread()) do                \
+    connections = connections + t.CONNECTIONS.current       \
+    requests = requests + t.REQUESTS.total                  \
+end
+connections
+connections == stat.CONNECTIONS.current
+requests >= 16
+test_run:cmd("switch default")
+
+for _, c in ipairs(conns) do c:close() end
+test_run:cmd("stop server test")
+
+--
+-- iproto_io_uring: requests and large replies are served the
+-- same way no matter whether io_uring is used or the thread
+-- falls back to epoll.
+--
+box.cfg{iproto_io_uring = not box.cfg.iproto_io_uring}
+test_run:cmd("start server test with args='2 true'")
+test_run:eval('test', 'box.schema.user.grant("guest", "super", nil, nil, {if_not_exists = true})')
+addr = test_run:eval('test', 'return box.cfg.listen')[1]
+conns = {}
+for i = 1, 4 do conns[i] = net_box.connect(addr) end
+ok = true
+for i = 1, 4 do ok = ok and conns[i]:ping() end
+ok
+big = string.rep('x', 4 * 1024 * 1024)
+#conns[1]:eval('return ...', {big})
+#conns[2]:eval('return string.rep("y", 8 * 1024 * 1024)')
+for _, c in ipairs(conns) do c:close() end
+test_run:cmd("stop server test")
+test_run:cmd("cleanup server test")
+test_run:cmd("delete server test")
@@ -0,0 +1,52 @@
+net = require('net.box')
+fiber = require('fiber')
+
+--
+-- Large SELECT result sets are written to the socket right
+-- from the tuple memory. The tuples must stay alive until they
+-- are written, even if they are replaced in the space meanwhile.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+box.schema.user.grant('guest', 'read,write', 'space', 'test')
+pad = string.rep('x', 1024)
+for i = 1, 1000 do s:replace{i, pad .. i} end
+c = net.connect(box.cfg.listen)
+res = c.space.test:select({}, {limit = 1000})
+#res
+res[1][2] == pad .. 1
+res[1000][2] == pad .. 1000
+res = nil
+
+ok = true
+fibers = {}
+for i = 1, 10 do                                                \
+    fibers[i] = fiber.new(function()                            \
+        local r = c.space.test:select({}, {limit = 1000})       \
+        for j, t in ipairs(r) do                                \
+            if t[1] ~= j or t[2]:sub(-#tostring(j)) ~= tostring(j) then \
+                ok = false                                      \
+            end                                                 \
+        end                                                     \
+    end)                                                        \
+    fibers[i]:set_joinable(true)                                \
+end
+for i = 1, 1000 do s:replace{i, pad .. pad .. i} end
+for i = 1, 10 do fibers[i]:join() end
+ok
+
+-- A single huge tuple.
+_ = s:replace{1001, string.rep('y', 100000)}
+#c.space.test:get{1001}[2]
+-- Small result sets are copied to the output buffer as usual.
+c.space.test:get{1}[1]
+-- Small and large replies interleave in the output.
+f1 = fiber.new(function() return c.space.test:select({}, {limit = 1001}) end)
+f1:set_joinable(true)
+c.space.test:get{2}[1]
+ok, res = f1:join()
+ok, #res
+res = nil
+
+c:close()
+s:drop()
@@ -0,0 +1,64 @@
+test_run = require('test_run').new()
+fio = require('fio')
+
+box.cfg{memtx_checkpoint_threads = 0}
+box.cfg{memtx_checkpoint_threads = 1000}
+box.cfg.memtx_checkpoint_threads
+
+--
+-- User spaces are split between several snapshot files
+-- written in parallel.
+--
+box.cfg{memtx_checkpoint_threads = 4}
+test_run:cmd("setopt delimiter ';'")
+for i = 1, 3 do
+    local s = box.schema.space.create('test' .. i)
+    s:create_index('pk')
+    for j = 1, 1000 * i do s:insert{j, string.rep('x', i)} end
+end;
+test_run:cmd("setopt delimiter ''");
+box.snapshot()
+signature = box.info.signature
+function snap_parts(signature) return #fio.glob(fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.*.snap', signature))) end
+function snap_version(signature) local fh = fio.open(fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap', signature))) local v = fh:read(64):split('\n')[2] fh:close() return v end
+snap_parts(signature)
+-- Older versions can't read a snapshot split into parts.
+snap_version(signature)
+
+--
+-- Part files are included in a backup.
+--
+files = box.backup.start()
+count = 0
+for _, f in ipairs(files) do if f:match('%.%d+%.snap$') then count = count + 1 end end
+count
+box.backup.stop()
+
+--
+-- The snapshot is recovered from all files.
+--
+test_run:cmd('restart server default')
+fio = require('fio')
+function snap_parts(signature) return #fio.glob(fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.*.snap', signature))) end
+function snap_version(signature) local fh = fio.open(fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap', signature))) local v = fh:read(64):split('\n')[2] fh:close() return v end
+box.cfg.memtx_checkpoint_threads
+box.space.test1:count()
+box.space.test2:count()
+box.space.test3:count()
+box.space.test3:get{3000}
+
+--
+-- A single file is written with one thread. Part files of
+-- old snapshots are removed along with them.
+--
+box.space.test1:replace{1, 'y'}
+box.snapshot()
+snap_parts(box.info.signature)
+snap_version(box.info.signature)
+box.space.test1:replace{2, 'y'}
+box.snapshot()
+test_run:wait_cond(function() return #fio.glob(fio.pathjoin(box.cfg.memtx_dir, '*.*.snap')) == 0 end)
+
+box.space.test1:drop()
+box.space.test2:drop()
+box.space.test3:drop()
@@ -0,0 +1,8 @@
+#!/usr/bin/env tarantool
+
+box.cfg({
+    listen = os.getenv('LISTEN'),
+    memtx_recovery_threads = tonumber(arg[1]),
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,54 @@
+test_run = require('test_run').new()
+
+--
+-- memtx_recovery_threads can't be changed after box.cfg().
+--
+box.cfg{memtx_recovery_threads = 1}
+box.cfg.memtx_recovery_threads
+
+test_run:cmd("create server test with script='box/memtx_recovery_threads.lua'")
+test_run:cmd("start server test with args='3'")
+test_run:cmd("switch test")
+box.cfg.memtx_recovery_threads
+
+--
+-- A snapshot consisting of many tx blocks is recovered
+-- by the decoding threads in the file order.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+_ = s:create_index('sk2', {parts = {3, 'string'}, unique = false})
+_ = s:create_index('sk3', {parts = {3, 'string', 1, 'unsigned'}})
+box.begin() for i = 1, 20000 do s:replace{i, 20000 - i, string.rep('x', i % 100)} end box.commit()
+box.snapshot()
+
+test_run:cmd("restart server test with args='3'")
+box.cfg.memtx_recovery_threads
+s = box.space.test
+s:count()
+s.index.sk:count()
+s:get{1}
+s:get{20000}
+s.index.sk:get{1}[1]
+#s:get{199}[3]
+s.index.sk:min()[1]
+s.index.sk:max()[1]
+
+--
+-- Secondary keys are sorted by the recovery threads.
+--
+s.index.sk2:count()
+s.index.sk2:count('xx')
+s.index.sk3:count()
+s.index.sk3:min()[1]
+s.index.sk3:max()[1]
+prev = nil
+sorted = true
+for _, t in s.index.sk3:pairs() do if prev ~= nil and (prev[3] > t[3] or prev[3] == t[3] and prev[1] >= t[1]) then sorted = false end prev = t end
+sorted
+
+test_run:cmd("switch default")
+test_run:cmd("stop server test")
+test_run:cmd("cleanup server test")
+test_run:cmd("delete server test")
@@ -0,0 +1,67 @@
+net = require('net.box')
+
+--
+-- IPROTO_AFTER_POSITION and IPROTO_FETCH_POSITION: select
+-- resumes right after the last tuple of the previous page.
+--
+m = box.schema.space.create('memtx', {engine = 'memtx'})
+_ = m:create_index('pk')
+_ = m:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+_ = m:create_index('hash', {type = 'hash'})
+v = box.schema.space.create('vinyl', {engine = 'vinyl'})
+_ = v:create_index('pk')
+_ = v:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+for i = 1, 20 do m:replace{i, i % 3} end
+for i = 1, 20 do v:replace{i, i % 3} end
+box.schema.user.grant('guest', 'read', 'universe')
+c = net.connect(box.cfg.listen)
+
+test_run = require('test_run').new()
+test_run:cmd("setopt delimiter ';'")
+function scan(index, key, opts)
+    local res = {}
+    local pos
+    while true do
+        local o = table.deepcopy(opts or {})
+        o.fetch_pos = true
+        o.limit = o.limit or 3
+        o.after = pos
+        local page
+        page, pos = index:select(key, o)
+        if #page == 0 then
+            break
+        end
+        for _, t in ipairs(page) do
+            table.insert(res, t[1])
+        end
+    end
+    return table.concat(res, ' ')
+end;
+test_run:cmd("setopt delimiter ''");
+
+scan(c.space.memtx.index.pk)
+scan(c.space.vinyl.index.pk)
+scan(c.space.memtx.index.pk, {10}, {iterator = 'LT'})
+scan(c.space.vinyl.index.pk, {10}, {iterator = 'GE'})
+-- Non-unique index: the position includes the primary key.
+scan(c.space.memtx.index.sk, {1})
+scan(c.space.vinyl.index.sk, {1})
+scan(c.space.memtx.index.sk, {2}, {iterator = 'REQ'})
+scan(c.space.vinyl.index.sk, {0}, {iterator = 'GT', limit = 2})
+-- Offset is applied after the position.
+scan(c.space.memtx.index.pk, {}, {offset = 1, limit = 4})
+
+-- No position for an empty result.
+c.space.memtx:select({100}, {fetch_pos = true})
+-- Unsupported cases.
+c.space.memtx.index.hash:select({1}, {fetch_pos = true})
+_, pos = c.space.memtx:select({}, {limit = 1, fetch_pos = true})
+c.space.memtx.index.pk:select({}, {after = pos, iterator = 'BITS_ALL_SET'})
+c.space.memtx.index.sk:select({}, {after = pos})
+c.space.memtx:select({}, {after = 'garbage'})
+c.space.memtx:select({}, {after = 1})
+
+c:close()
+box.schema.user.revoke('guest', 'read', 'universe')
+m:drop()
+v:drop()
@@ -0,0 +1,41 @@
+net = require('net.box')
+
+--
+-- IPROTO_FIELDS and IPROTO_KEY_ONLY: select returns only the
+-- requested fields or the index key parts of the tuples.
+--
+format = {{'id', 'unsigned'}, {'name', 'string'}, {'data', 'map'}}
+m = box.schema.space.create('memtx', {engine = 'memtx', format = format})
+_ = m:create_index('pk')
+_ = m:create_index('sk', {parts = {{2, 'string'}, {1, 'unsigned'}}})
+v = box.schema.space.create('vinyl', {engine = 'vinyl', format = format})
+_ = v:create_index('pk')
+_ = v:create_index('sk', {parts = {{2, 'string'}, {1, 'unsigned'}}})
+for i = 1, 3 do m:replace{i, 'n' .. i, {x = i}, i * 10} end
+for i = 1, 3 do v:replace{i, 'n' .. i, {x = i}, i * 10} end
+box.schema.user.grant('guest', 'read', 'universe')
+c = net.connect(box.cfg.listen)
+
+c.space.memtx:select({}, {fields = {4, 2}})
+c.space.vinyl:select({}, {fields = {4, 2}})
+-- Names and JSON paths.
+c.space.memtx:select({2}, {fields = {'name', 'data.x', '[4]'}})
+c.space.vinyl:select({2}, {fields = {'name', 'data.x', '[4]'}})
+-- Missing fields are nil.
+c.space.memtx:select({1}, {fields = {1, 5, 'data.y', 'foo'}})
+-- Key-only results.
+c.space.memtx.index.sk:select({}, {key_only = true})
+c.space.vinyl.index.sk:select({}, {key_only = true})
+c.space.memtx:select({}, {key_only = true, limit = 2})
+-- Invalid projections.
+c.space.memtx:select({}, {fields = {0}})
+c.space.memtx:select({}, {fields = {{}}})
+c.space.memtx:select({}, {fields = 1})
+c.space.memtx:select({}, {fields = {1}, key_only = true})
+-- Regular selects are not affected.
+c.space.memtx:select({1})[1].name
+
+c:close()
+box.schema.user.revoke('guest', 'read', 'universe')
+m:drop()
+v:drop()
@@ -0,0 +1,43 @@
+test_run = require('test_run').new()
+
+--
+-- Tree indexes are built in bulk on recovery. Keys are
+-- sorted whatever order they come in.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('asc', {parts = {2, 'unsigned'}})
+_ = s:create_index('desc', {parts = {3, 'unsigned'}})
+_ = s:create_index('mixed', {parts = {4, 'unsigned'}, unique = false})
+_ = s:create_index('mk', {parts = {{5, 'unsigned', path = '[*]'}}, unique = false})
+box.begin() for i = 1, 10000 do s:replace{i, i * 2, 10000 - i, i % 7, {i % 3, 10 - i % 5}} end box.commit()
+box.snapshot()
+test_run:cmd('restart server default')
+
+s = box.space.test
+key_def = require('key_def')
+test_run:cmd("setopt delimiter ';'")
+function check(index, fieldno)
+    local kd = key_def.new({{fieldno = fieldno, type = 'unsigned'}})
+    local prev = nil
+    local count = 0
+    for _, t in index:pairs() do
+        if prev ~= nil and kd:compare(prev, t) > 0 then
+            return false
+        end
+        prev = t
+        count = count + 1
+    end
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+check(s.index.pk, 1)
+check(s.index.asc, 2)
+check(s.index.desc, 3)
+check(s.index.mixed, 4)
+s.index.desc:min()[1]
+s.index.desc:max()[1]
+s.index.mixed:count(0)
+s.index.mk:count()
+s.index.mk:count(10)
+s:drop()
@@ -0,0 +1,61 @@
+--
+-- count() and select() with offset are served by the tree
+-- subtree cardinalities. Check them against plain iteration.
+--
+test_run = require('test_run').new()
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+_ = s:create_index('multi', {parts = {{'[3][*]', 'unsigned'}}, unique = false})
+for i = 1, 1000 do s:replace{i, i % 10, {i % 7, i % 7 + 7}} end
+for i = 1, 1000, 3 do s:delete{i} end
+types = {'EQ', 'REQ', 'GE', 'GT', 'LE', 'LT'}
+test_run:cmd("setopt delimiter ';'")
+function check_count(index, key)
+    local bad = {}
+    for _, t in ipairs(types) do
+        local count = index:count(key, {iterator = t})
+        if count ~= #index:select(key, {iterator = t}) then
+            table.insert(bad, t)
+        end
+    end
+    return bad
+end;
+function check_offset(index, key)
+    local bad = {}
+    for _, t in ipairs(types) do
+        local all = index:select(key, {iterator = t})
+        for _, offset in ipairs({0, 1, 7, 99, math.max(#all - 2, 0),
+                                     #all, 5000}) do
+            local res = index:select(key, {iterator = t, offset = offset,
+                                           limit = 3})
+            for i = 1, 3 do
+                local a, b = res[i], all[offset + i]
+                if (a == nil) ~= (b == nil) or
+                   (a ~= nil and a[1] ~= b[1]) then
+                    table.insert(bad, t .. ' ' .. offset)
+                    break
+                end
+            end
+        end
+    end
+    return bad
+end;
+test_run:cmd("setopt delimiter ''");
+check_count(s.index.pk, 500)
+check_count(s.index.pk, 0)
+check_count(s.index.pk, 2000)
+check_count(s.index.sk, 5)
+check_count(s.index.sk, 10)
+check_count(s.index.multi, 3)
+check_count(s.index.multi, 8)
+check_offset(s.index.pk, 500)
+check_offset(s.index.pk, nil)
+check_offset(s.index.sk, 5)
+check_offset(s.index.sk, 0)
+check_offset(s.index.multi, 9)
+s.index.sk:count(5)
+s.index.sk:count(5, {iterator = 'LT'})
+s.index.pk:select({}, {offset = 660, limit = 3})
+s.index.pk:select({}, {iterator = 'LE', offset = 660, limit = 3})
+s:drop()
@@ -0,0 +1,73 @@
+test_run = require('test_run').new()
+
+--
+-- Normalized keys of memtx tree index.
+--
+s = box.schema.space.create('test')
+pk = s:create_index('pk')
+s:create_index('h', {type = 'hash', normalized_keys = true})
+s:create_index('n', {parts = {2, 'number'}, normalized_keys = true})
+s:create_index('m', {parts = {{2, 'unsigned', path = '[*]'}}, normalized_keys = true})
+s:create_index('nh', {parts = {2, 'string'}, hint = false, normalized_keys = true})
+parts = {{2, 'string', collation = 'unicode_ci'}, {3, 'integer'}, {4, 'string', is_nullable = true}}
+sk = s:create_index('sk', {parts = parts, unique = false, normalized_keys = true})
+sk.normalized_keys
+pk.normalized_keys
+ref = s:create_index('ref', {parts = parts, unique = false})
+
+--
+-- The order of tuples is the same as in a regular index.
+--
+strs = {'a', 'A', 'b', 'Б', 'б', 'ё', 'е', 'ab', 'a\0b', ''}
+for i = 1, 1000 do s:insert{i, strs[i % #strs + 1], i % 7 - 3, i % 3 == 0 and box.NULL or strs[i % 5 + 1]} end
+function keys(index, ...) local r = {} for _, t in index:pairs(...) do table.insert(r, t[1]) end return r end
+function same(...) local a, b = keys(sk, ...), keys(ref, ...) if #a ~= #b then return false end for i = 1, #a do if a[i] ~= b[i] then return false end end return true end
+same()
+same({'A'})
+same({'b', 0}, {iterator = 'ge'})
+same({'Б', 1}, {iterator = 'lt'})
+sk:count({'a'}) == ref:count({'a'})
+for i = 1, 1000, 3 do s:delete{i} end
+for i = 2, 1000, 3 do s:update({i}, {{'=', 3, -i}}) end
+same()
+same({'a'}, {iterator = 'le'})
+
+--
+-- Unique index.
+--
+t = box.schema.space.create('t')
+_ = t:create_index('pk', {parts = {{1, 'string', collation = 'unicode_ci'}, {2, 'integer'}}, normalized_keys = true})
+t:insert{'abc', -1}
+t:insert{'ABC', -1}
+t:replace{'ABC', -1}
+t:insert{'abc', 18446744073709551615ULL}
+t:insert{'abc', -9223372036854775808LL}
+t:insert{'abc', 0}
+t:insert{'abd', -2}
+t:select{}
+t:select({'ABC', 0}, {iterator = 'gt'})
+
+--
+-- Changing the option rebuilds the index.
+--
+t.index.pk:alter({normalized_keys = false})
+t.index.pk.normalized_keys
+t:select{}
+t.index.pk:alter({normalized_keys = true})
+t.index.pk.normalized_keys
+
+--
+-- The index is built on recovery.
+--
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+t = box.space.t
+function keys(index, ...) local r = {} for _, t in index:pairs(...) do table.insert(r, t[1]) end return r end
+function same(...) local a, b = keys(s.index.sk, ...), keys(s.index.ref, ...) if #a ~= #b then return false end for i = 1, #a do if a[i] ~= b[i] then return false end end return true end
+s.index.sk.normalized_keys
+same()
+same({'ё'}, {iterator = 'gt'})
+t:select{}
+s:drop()
+t:drop()
@@ -0,0 +1,100 @@
+test_run = require('test_run').new()
+
+--
+-- Compression of tuple fields in memtx spaces.
+--
+box.schema.space.create('test', {format = {{'id', 'unsigned'}, {'doc', compression = 'lz4'}}})
+format = {{'id', 'unsigned'}, {'doc', 'map', compression = 'zstd'}, {'tag', 'string', is_nullable = true}}
+box.schema.space.create('test', {engine = 'vinyl', format = format})
+s = box.schema.space.create('test', {format = format})
+_ = s:create_index('pk')
+s:create_index('sk', {parts = {{'doc.name', 'string'}}})
+_ = s:create_index('tag', {parts = {{3, 'string', is_nullable = true}}, unique = false})
+
+--
+-- Large values are stored compressed and decompressed on access.
+--
+text = string.rep('lorem ipsum dolor sit amet ', 100)
+s:insert{1, {name = 'first', text = text}, 'a'}.doc.text == text
+s:get(1).doc.text == text
+s:get(1):bsize() > #text
+s:bsize() < #text / 10
+s:insert{2, {name = 'small'}, 'a'}
+s:insert{3, text}
+s:insert{3, {name = 'third', text = text}, 'b'}.doc.name
+s:select({}, {limit = 1})[1].doc.name
+s.index.tag:select{'b'}[1].doc.text == text
+s.index.pk:min().doc.name
+s.index.pk:max().doc.name
+n = 0
+for _, t in s:pairs() do if t.doc.text == text then n = n + 1 end end
+n
+s:count()
+
+--
+-- Update operations see the original values.
+--
+s:update(1, {{'=', 'doc.name', 'updated'}}).doc.name
+s:get(1).doc.text == text
+s:upsert({1, {}}, {{'=', 2, {name = 'upserted', text = text}}})
+s:get(1).doc.name
+s:delete(3).doc.text == text
+
+--
+-- Triggers see the original values.
+--
+names = {}
+trigger = s:on_replace(function(old, new) table.insert(names, old.doc.name) table.insert(names, new.doc.name) end)
+_ = s:replace{1, {name = 'replaced', text = text}}
+names
+_ = s:on_replace(nil, trigger)
+
+--
+-- Compression can be dropped while the data is compressed.
+-- Old tuples keep their format and are still decompressed.
+--
+s:format({{'id', 'unsigned'}, {'doc', 'map'}, {'tag', 'string', is_nullable = true}})
+s:get(1).doc.text == text
+s:format(format)
+s:replace{1, {name = 'first', text = text}}.doc.name
+
+--
+-- Compressed values sent by users are checked.
+--
+ffi = require('ffi')
+ffi.cdef('int box_insert(uint32_t space_id, const char *tuple, const char *tuple_end, void **result);')
+function insert_raw(data) local p = ffi.cast('const char *', data) if ffi.C.box_insert(s.id, p, p + #data, nil) ~= 0 then return box.error.last().message end end
+zstd = '\x28\xb5\x2f\xfd'
+insert_raw('\x92\x04\xc7\x0b\x10\x01' .. zstd .. '\x20\x01\x09\x00\x00\x80')
+s:get(4)
+insert_raw('\x92\x05\xc7\x0e\x10\x01' .. zstd .. '\x20\x04\x21\x00\x00\xa3abc')
+insert_raw('\x92\x05\xc7\x0c\x10\x01' .. zstd .. '\x20\x02\x11\x00\x00\xa3a')
+insert_raw('\x92\x05\xc7\x0b\x10\x01' .. zstd .. '\x20\xff\x09\x00\x00\x80')
+insert_raw('\x92\x05\xc7\x0e\x10\x01' .. zstd .. '\xa0\xff\xff\xff\xff\x09\x00\x00\x80')
+insert_raw('\x92\x05\xc7\x02\x10\x07\x00')
+s:get(5)
+_ = s:delete(4)
+
+--
+-- Compressed values are stored in the snapshot as is.
+--
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+text = string.rep('lorem ipsum dolor sit amet ', 100)
+s:get(1).doc.text == text
+s:get(2)
+s:bsize() < #text / 10
+
+--
+-- Compressed values left in the snapshot after compression
+-- was dropped are decompressed on recovery.
+--
+s:format({{'id', 'unsigned'}, {'doc', 'map'}, {'tag', 'string', is_nullable = true}})
+box.snapshot()
+test_run:cmd('restart server default')
+s = box.space.test
+text = string.rep('lorem ipsum dolor sit amet ', 100)
+s:get(1).doc.text == text
+s:bsize() > #text
+s:drop()
@@ -0,0 +1,46 @@
+--
+-- wal_commit_delay and wal_max_batch_size hold WAL batches
+-- open to group more transactions into a single write.
+--
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+box.cfg{wal_commit_delay = -1}
+box.cfg{wal_max_batch_size = 0}
+box.cfg.wal_commit_delay
+box.cfg.wal_max_batch_size
+
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+
+box.cfg{wal_commit_delay = 0.01}
+box.stat.reset()
+stat = box.stat.wal()
+stat.batches
+stat.requests
+
+ch = fiber.channel(100)
+for i = 1, 100 do fiber.create(function() s:insert{i} ch:put(true) end) end
+for i = 1, 100 do ch:get() end
+s:count()
+stat = box.stat.wal()
+stat.requests
+stat.batches < stat.requests
+type(stat.batch_histogram)
+type(stat.batch_size_histogram)
+
+--
+-- A batch reaching wal_max_batch_size is sent to WAL at once
+-- and switching the delay off flushes the pending batch.
+--
+box.cfg{wal_max_batch_size = 1, wal_commit_delay = 10}
+t = fiber.clock()
+s:insert{101}
+fiber.clock() - t < 5
+box.cfg{wal_max_batch_size = 1024 * 1024}
+_ = fiber.create(function() s:insert{102} ch:put(true) end)
+box.cfg{wal_commit_delay = 0}
+ch:get(5)
+s:get{102}
+
+s:drop()
@@ -0,0 +1,48 @@
+test_run = require('test_run').new()
+
+--
+-- wal_compress_threads can't be changed after box.cfg().
+--
+box.cfg{wal_compress_threads = 1}
+box.cfg.wal_compress_threads
+
+test_run:cmd("create server test with script='box/wal_compress.lua'")
+test_run:cmd("start server test with args='2'")
+test_run:cmd("switch test")
+box.cfg.wal_compress_threads
+
+--
+-- Big transactions are compressed by the compression threads,
+-- small ones are written as is, the order is preserved.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+fiber = require('fiber')
+test_run:cmd("setopt delimiter ';'")
+function big_tx(n)
+    box.begin()
+    for i = 1, 200 do
+        s:replace{n * 1000 + i, string.rep('x', 1000)}
+    end
+    box.commit()
+end;
+test_run:cmd("setopt delimiter ''");
+ch = fiber.channel(40)
+for i = 1, 20 do fiber.create(function() big_tx(i) ch:put(true) end) s:replace{i} end
+for i = 1, 20 do ch:get() end
+s:count()
+
+--
+-- The WAL is readable after restart.
+--
+test_run:cmd("restart server test")
+s = box.space.test
+s:count()
+s:get{1}
+s:get{20200}[1]
+#s:get{20200}[2]
+
+test_run:cmd("switch default")
+test_run:cmd("stop server test")
+test_run:cmd("cleanup server test")
+test_run:cmd("delete server test")
@@ -0,0 +1,9 @@
+#!/usr/bin/env tarantool
+
+box.cfg({
+    listen = os.getenv('LISTEN'),
+    wal_direct_io = arg[1] == 'true',
+    wal_compress_threads = tonumber(arg[2]),
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,66 @@
+test_run = require('test_run').new()
+
+--
+-- wal_direct_io can't be changed after box.cfg().
+--
+box.cfg{wal_direct_io = true}
+box.cfg.wal_direct_io
+
+test_run:cmd("create server test with script='box/wal_direct_io.lua'")
+test_run:cmd("start server test with args='true 0'")
+test_run:cmd("switch test")
+box.cfg.wal_direct_io
+
+--
+-- Small and big transactions are written through the direct
+-- I/O buffers, the latter span a few buffers.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+for i = 1, 100 do s:replace{i} end
+box.begin() for i = 1, 3000 do s:replace{1000 + i, string.rep('x', 1000)} end box.commit()
+s:count()
+
+--
+-- The EOF marker of a rotated WAL is written after the last
+-- row, so the closed file is read back in full.
+--
+fio = require('fio')
+xlog = require('xlog')
+box.snapshot()
+files = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+table.sort(files)
+rows = 0
+for _, row in xlog.pairs(files[1]) do if row.BODY ~= nil and row.BODY.space_id == s.id then rows = rows + 1 end end
+rows
+
+--
+-- The WAL is readable after restart, writes go on in
+-- the same mode.
+--
+test_run:cmd("restart server test with args='true 2'")
+s = box.space.test
+s:count()
+s:get{100}
+#s:get{4000}[2]
+
+--
+-- Small transactions aren't padded to a page each.
+--
+fio = require('fio')
+for i = 1, 100 do s:replace{i, i} end
+files = fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog'))
+table.sort(files)
+fio.stat(files[#files]).size < 100 * 1024
+
+box.begin() for i = 1, 3000 do s:replace{10000 + i, string.rep('y', 1000)} end box.commit()
+s:count()
+test_run:cmd("restart server test with args='false 0'")
+s = box.space.test
+s:count()
+s:get{13000}[2]:sub(1, 3)
+
+test_run:cmd("switch default")
+test_run:cmd("stop server test")
+test_run:cmd("cleanup server test")
+test_run:cmd("delete server test")
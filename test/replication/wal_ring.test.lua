@@ -0,0 +1,52 @@
+test_run = require('test_run').new()
+
+--
+-- Relays that have caught up with WAL read new rows from
+-- the WAL memory ring rather than from xlog files, falling
+-- back on files when the rows have been evicted.
+--
+test_run:cmd("create server master with script='replication/wal_ring_master.lua'")
+test_run:cmd('start server master')
+test_run:cmd("switch master")
+box.cfg.wal_ring_size
+box.schema.user.grant('guest', 'replication')
+engine = test_run:get_cfg('engine')
+s = box.schema.space.create('test', {engine = engine})
+_ = s:create_index('pk')
+
+test_run:cmd("create server replica with rpl_master=master, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+
+-- Rows spanning a few WAL files.
+for i = 1, 1000 do s:replace{i, string.rep('x', 100)} end
+test_run:wait_lsn('replica', 'master')
+test_run:cmd("switch replica")
+box.space.test:count()
+
+-- A row that doesn't fit in the ring.
+test_run:cmd("switch master")
+_ = s:replace{0, string.rep('y', 100 * 1024)}
+for i = 1001, 1100 do s:replace{i, string.rep('x', 100)} end
+test_run:wait_lsn('replica', 'master')
+test_run:cmd("switch replica")
+box.space.test:get(0)[2]:len()
+box.space.test:count()
+
+-- WAL files sent from the ring are garbage collected.
+test_run:cmd("switch master")
+fio = require('fio')
+box.snapshot()
+test_run:wait_cond(function() return #fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog')) == 1 end, 10)
+
+-- A replica that has fallen behind reads xlog files first.
+test_run:cmd("stop server replica")
+for i = 1101, 2000 do s:replace{i, string.rep('x', 100)} end
+test_run:cmd("start server replica")
+for i = 2001, 2100 do s:replace{i, string.rep('x', 100)} end
+test_run:wait_lsn('replica', 'master')
+test_run:cmd("switch replica")
+box.space.test:count()
+
+-- Cleanup.
+test_run:cmd("switch default")
+test_run:drop_cluster({'master', 'replica'})
@@ -0,0 +1,12 @@
+#!/usr/bin/env tarantool
+os = require('os')
+box.cfg({
+    listen              = os.getenv("LISTEN"),
+    memtx_memory        = 107374182,
+    replication_timeout = 0.1,
+    wal_ring_size       = 64 * 1024,
+    wal_max_size        = 16 * 1024,
+    checkpoint_count    = 1,
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "unit.h"
+
+typedef int64_t type_t;
+
+static int
+compare(type_t a, type_t b)
+{
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+#define BPS_TREE_NAME test
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 1024 /* value is to low specially for tests */
+#define BPS_TREE_IS_IDENTICAL(a, b) (a == b)
+#define BPS_TREE_COMPARE(a, b, arg) compare(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare(a, b)
+#define BPS_INNER_CHILD_CARDS
+#define bps_tree_elem_t type_t
+#define bps_tree_key_t type_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
+
+enum {
+	/** Values are taken from [0, VALUE_RANGE). */
+	VALUE_RANGE = 20000,
+	/** Number of random modifications of the tree. */
+	ROUNDS = 100000,
+	/** How often the tree is checked during modifications. */
+	CHECK_EVERY = 997,
+};
+
+int total_extents_allocated = 0;
+
+static void *
+extent_alloc(void *ctx)
+{
+	int *p_total_extents_allocated = (int *)ctx;
+	assert(p_total_extents_allocated == &total_extents_allocated);
+	++*p_total_extents_allocated;
+	return malloc(BPS_TREE_EXTENT_SIZE);
+}
+
+static void
+extent_free(void *ctx, void *extent)
+{
+	int *p_total_extents_allocated = (int *)ctx;
+	assert(p_total_extents_allocated == &total_extents_allocated);
+	--*p_total_extents_allocated;
+	free(extent);
+}
+
+/**
+ * Check offsets and positioning by offset against a plain
+ * presence map of the values.
+ */
+static void
+check_offsets(test *tree, const bool *present)
+{
+	if (test_debug_check(tree))
+		fail("debug check nonzero", "true");
+	size_t offset = 0;
+	for (type_t v = 0; v < VALUE_RANGE; v++) {
+		bool exact;
+		size_t lower, upper, lower_elem;
+		test_lower_bound_get_offset(tree, v, &exact, &lower);
+		test_upper_bound_get_offset(tree, v, &exact, &upper);
+		test_lower_bound_elem_get_offset(tree, v, &exact,
+						 &lower_elem);
+		if (lower != offset || lower_elem != offset)
+			fail("lower bound offset", "true");
+		if (present[v]) {
+			test_iterator itr = test_iterator_at(tree, offset);
+			type_t *e = test_iterator_get_elem(tree, &itr);
+			if (e == NULL || *e != v)
+				fail("iterator at offset", "true");
+			offset++;
+		}
+		if (upper != offset)
+			fail("upper bound offset", "true");
+	}
+	if (offset != test_size(tree))
+		fail("tree size", "true");
+	test_iterator itr = test_iterator_at(tree, offset);
+	if (!test_iterator_is_invalid(&itr))
+		fail("iterator at size is not invalid", "true");
+}
+
+static void
+card_check()
+{
+	header();
+
+	test tree;
+	test_create(&tree, 0, extent_alloc, extent_free,
+		    &total_extents_allocated);
+	bool *present = (bool *)calloc(VALUE_RANGE, sizeof(*present));
+
+	for (int i = 0; i < ROUNDS; i++) {
+		type_t v = rand() % VALUE_RANGE;
+		/* Grow the tree in the first half and shrink after. */
+		bool insert = (rand() % 3 == 0) != (i < ROUNDS / 2);
+		if (insert) {
+			test_insert(&tree, v, NULL);
+			present[v] = true;
+		} else {
+			test_delete(&tree, v);
+			present[v] = false;
+		}
+		if (i % CHECK_EVERY == 0)
+			check_offsets(&tree, present);
+	}
+	check_offsets(&tree, present);
+
+	/* Drain the tree to walk through all the merge branches. */
+	for (type_t v = 0; v < VALUE_RANGE; v++) {
+		type_t victim = (v * 7919) % VALUE_RANGE;
+		test_delete(&tree, victim);
+		present[victim] = false;
+		if (v % CHECK_EVERY == 0)
+			check_offsets(&tree, present);
+	}
+	check_offsets(&tree, present);
+	if (test_size(&tree) != 0)
+		fail("tree is not empty", "true");
+
+	test_destroy(&tree);
+	free(present);
+
+	footer();
+}
+
+static void
+build_check()
+{
+	header();
+
+	const size_t count = VALUE_RANGE / 2;
+	type_t *arr = (type_t *)malloc(count * sizeof(*arr));
+	bool *present = (bool *)calloc(VALUE_RANGE, sizeof(*present));
+	for (size_t i = 0; i < count; i++) {
+		arr[i] = i * 2;
+		present[i * 2] = true;
+	}
+
+	test tree;
+	test_create(&tree, 0, extent_alloc, extent_free,
+		    &total_extents_allocated);
+	if (test_build(&tree, arr, count) != 0)
+		fail("build", "true");
+	check_offsets(&tree, present);
+	for (size_t i = 0; i < count; i++) {
+		test_insert(&tree, i * 2 + 1, NULL);
+		present[i * 2 + 1] = true;
+	}
+	check_offsets(&tree, present);
+
+	test_destroy(&tree);
+	free(present);
+	free(arr);
+
+	footer();
+}
+
+int
+main(void)
+{
+	srand(time(0));
+	card_check();
+	build_check();
+	if (total_extents_allocated) {
+		fail("memory leak", "true");
+	}
+}
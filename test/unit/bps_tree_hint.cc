@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "unit.h"
+
+enum {
+	/** Values are taken from [0, VALUE_RANGE). */
+	VALUE_RANGE = 20000,
+	/** Number of random modifications of the tree. */
+	ROUNDS = 50000,
+	/** How often the tree is checked during modifications. */
+	CHECK_EVERY = 997,
+};
+
+static const uint64_t HINT_NONE = UINT64_MAX;
+
+struct elem {
+	int64_t value;
+	uint64_t hint;
+};
+
+struct tree_arg {
+	/** Whether hints follow the order of values. */
+	bool is_ordered;
+	/** Number of comparator calls. */
+	size_t compare_count;
+};
+
+static int
+compare(int64_t a, int64_t b, struct tree_arg *arg)
+{
+	arg->compare_count++;
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/**
+ * A hint is a coarse prefix of the value. Some values have no
+ * hint at all, like non-finite doubles in a real index. If hints
+ * are unordered, they are pure noise that must not be used.
+ */
+static uint64_t
+value_hint(int64_t value, bool is_ordered)
+{
+	if (value % 7 == 0)
+		return HINT_NONE;
+	return is_ordered ? value / 16 : (value * 7919) % 101;
+}
+
+#define BPS_TREE_NAME test
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_IS_IDENTICAL(a, b) ((a).value == (b).value)
+#define BPS_TREE_COMPARE(a, b, arg) compare((a).value, (b).value, arg)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare((a).value, (b)->value, arg)
+#define BPS_TREE_ELEM_HINT(elem) ((elem).hint)
+#define BPS_TREE_KEY_HINT(key) ((key)->hint)
+#define BPS_TREE_HINT_NONE HINT_NONE
+#define BPS_TREE_HINT_IS_ORDERED(arg) ((arg)->is_ordered)
+#define bps_tree_elem_t struct elem
+#define bps_tree_key_t struct elem *
+#define bps_tree_arg_t struct tree_arg *
+#include "salad/bps_tree.h"
+
+int total_extents_allocated = 0;
+
+static void *
+extent_alloc(void *ctx)
+{
+	int *p_total_extents_allocated = (int *)ctx;
+	assert(p_total_extents_allocated == &total_extents_allocated);
+	++*p_total_extents_allocated;
+	return malloc(BPS_TREE_EXTENT_SIZE);
+}
+
+static void
+extent_free(void *ctx, void *extent)
+{
+	int *p_total_extents_allocated = (int *)ctx;
+	assert(p_total_extents_allocated == &total_extents_allocated);
+	--*p_total_extents_allocated;
+	free(extent);
+}
+
+static struct elem
+make_elem(int64_t value, bool is_ordered)
+{
+	struct elem e;
+	e.value = value;
+	e.hint = value_hint(value, is_ordered);
+	return e;
+}
+
+/**
+ * Check lookups and bounds of every value against a plain
+ * presence map of the values.
+ */
+static void
+check_lookups(test *tree, const bool *present, bool is_ordered)
+{
+	if (test_debug_check(tree))
+		fail("debug check nonzero", "true");
+	for (int64_t v = 0; v < VALUE_RANGE; v++) {
+		struct elem key = make_elem(v, is_ordered);
+		struct elem *found = test_find(tree, &key);
+		if ((found != NULL) != present[v] ||
+		    (found != NULL && found->value != v))
+			fail("find", "true");
+
+		int64_t next = v;
+		while (next < VALUE_RANGE && !present[next])
+			next++;
+		int64_t after = v + 1;
+		while (after < VALUE_RANGE && !present[after])
+			after++;
+
+		bool exact;
+		test_iterator itr = test_lower_bound(tree, &key, &exact);
+		struct elem *e = test_iterator_get_elem(tree, &itr);
+		if (exact != present[v] ||
+		    (next < VALUE_RANGE ? e == NULL || e->value != next :
+					  e != NULL))
+			fail("lower bound", "true");
+		itr = test_upper_bound(tree, &key, &exact);
+		e = test_iterator_get_elem(tree, &itr);
+		if (exact != present[v] ||
+		    (after < VALUE_RANGE ? e == NULL || e->value != after :
+					   e != NULL))
+			fail("upper bound", "true");
+		itr = test_lower_bound_elem(tree, key, &exact);
+		e = test_iterator_get_elem(tree, &itr);
+		if (exact != present[v] ||
+		    (next < VALUE_RANGE ? e == NULL || e->value != next :
+					  e != NULL))
+			fail("lower bound elem", "true");
+	}
+}
+
+static void
+hint_check(bool is_ordered)
+{
+	header();
+
+	struct tree_arg arg = {is_ordered, 0};
+	test tree;
+	test_create(&tree, &arg, extent_alloc, extent_free,
+		    &total_extents_allocated);
+	bool *present = (bool *)calloc(VALUE_RANGE, sizeof(*present));
+
+	for (int i = 0; i < ROUNDS; i++) {
+		int64_t v = rand() % VALUE_RANGE;
+		/* Grow the tree in the first half and shrink after. */
+		bool insert = (rand() % 3 == 0) != (i < ROUNDS / 2);
+		if (insert) {
+			test_insert(&tree, make_elem(v, is_ordered), NULL);
+			present[v] = true;
+		} else {
+			test_delete(&tree, make_elem(v, is_ordered));
+			present[v] = false;
+		}
+		if (i % CHECK_EVERY == 0)
+			check_lookups(&tree, present, is_ordered);
+	}
+	check_lookups(&tree, present, is_ordered);
+
+	test_destroy(&tree);
+	free(present);
+
+	footer();
+}
+
+static void
+compare_count_check()
+{
+	header();
+
+	struct tree_arg arg = {true, 0};
+	test tree;
+	test_create(&tree, &arg, extent_alloc, extent_free,
+		    &total_extents_allocated);
+	for (int64_t v = 0; v < VALUE_RANGE; v++)
+		test_insert(&tree, make_elem(v, true), NULL);
+
+	/*
+	 * Sixteen values share a hint, so lookups of hinted values
+	 * must need fewer comparisons than with hints turned off.
+	 */
+	size_t compare_count[2];
+	for (int i = 0; i < 2; i++) {
+		arg.is_ordered = i == 0;
+		arg.compare_count = 0;
+		for (int64_t v = 0; v < VALUE_RANGE; v++) {
+			if (v % 7 == 0)
+				continue;
+			struct elem key = make_elem(v, true);
+			if (test_find(&tree, &key) == NULL)
+				fail("find", "true");
+		}
+		compare_count[i] = arg.compare_count;
+	}
+	if (compare_count[0] >= compare_count[1])
+		fail("hints are not used", "true");
+
+	test_destroy(&tree);
+
+	footer();
+}
+
+int
+main(void)
+{
+	srand(time(0));
+	hint_check(true);
+	hint_check(false);
+	compare_count_check();
+	if (total_extents_allocated) {
+		fail("memory leak", "true");
+	}
+}
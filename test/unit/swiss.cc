@@ -0,0 +1,336 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <vector>
+#include <time.h>
+
+#include "unit.h"
+
+typedef uint64_t hash_value_t;
+typedef uint32_t hash_t;
+
+static const size_t swiss_extent_size = 16 * 1024;
+static size_t extents_count = 0;
+
+static int hash_multiplier = 1;
+
+hash_t
+hash(hash_value_t value)
+{
+	return (hash_t) value * hash_multiplier;
+}
+
+bool
+equal(hash_value_t v1, hash_value_t v2)
+{
+	return v1 == v2;
+}
+
+bool
+equal_key(hash_value_t v1, hash_value_t v2)
+{
+	return v1 == v2;
+}
+
+#define SWISS_NAME
+#define SWISS_DATA_TYPE uint64_t
+#define SWISS_KEY_TYPE uint64_t
+#define SWISS_CMP_ARG_TYPE int
+#define SWISS_EQUAL(a, b, arg) equal(a, b)
+#define SWISS_EQUAL_KEY(a, b, arg) equal_key(a, b)
+#define SWISS_HASH(a, arg) hash(a)
+#include "salad/swiss.h"
+
+inline void *
+my_swiss_alloc(void *ctx)
+{
+	size_t *p_extents_count = (size_t *)ctx;
+	assert(p_extents_count == &extents_count);
+	++*p_extents_count;
+	return malloc(swiss_extent_size);
+}
+
+inline void
+my_swiss_free(void *ctx, void *p)
+{
+	size_t *p_extents_count = (size_t *)ctx;
+	assert(p_extents_count == &extents_count);
+	--*p_extents_count;
+	free(p);
+}
+
+static void
+check(struct swiss_core *ht, const std::vector<bool> &vect, size_t count)
+{
+	if (count != ht->count)
+		fail("count check failed!", "true");
+	bool identical = true;
+	for (hash_value_t test = 0; test < vect.size(); test++) {
+		bool found = swiss_find(ht, hash(test), test) != swiss_end;
+		if (found != vect[test])
+			identical = false;
+	}
+	if (!identical)
+		fail("internal test failed!", "true");
+	if (swiss_selfcheck(ht) != 0)
+		fail("selfcheck failed!", "true");
+}
+
+static void
+simple_test(int multiplier)
+{
+	header();
+
+	hash_multiplier = multiplier;
+	struct swiss_core ht;
+	swiss_create(&ht, swiss_extent_size,
+		     my_swiss_alloc, my_swiss_free, &extents_count, 0);
+	std::vector<bool> vect;
+	size_t count = 0;
+	const size_t rounds = 1000;
+	const size_t start_limits = 20;
+	for (size_t limits = start_limits; limits <= 2 * rounds; limits *= 10) {
+		while (vect.size() < limits)
+			vect.push_back(false);
+		for (size_t i = 0; i < rounds; i++) {
+			hash_value_t val = rand() % limits;
+			hash_t h = hash(val);
+			uint32_t fnd = swiss_find(&ht, h, val);
+			bool has1 = fnd != swiss_end;
+			bool has2 = vect[val];
+			if (has1 != has2) {
+				fail("find key failed!", "true");
+				return;
+			}
+			if (!has1) {
+				count++;
+				vect[val] = true;
+				swiss_insert(&ht, h, val);
+			} else {
+				count--;
+				vect[val] = false;
+				swiss_delete(&ht, fnd);
+			}
+			check(&ht, vect, count);
+		}
+	}
+	swiss_destroy(&ht);
+	hash_multiplier = 1;
+
+	footer();
+}
+
+static void
+grow_test()
+{
+	header();
+
+	struct swiss_core ht;
+	swiss_create(&ht, swiss_extent_size,
+		     my_swiss_alloc, my_swiss_free, &extents_count, 0);
+	std::vector<bool> vect(100000, false);
+	size_t count = 0;
+	for (hash_value_t val = 0; val < vect.size(); val++) {
+		swiss_insert(&ht, hash(val), val);
+		vect[val] = true;
+		count++;
+		/* Remove some values while the table is migrated. */
+		if (val % 3 == 0) {
+			hash_value_t victim = val / 2;
+			if (vect[victim]) {
+				if (swiss_delete_value(&ht, hash(victim),
+						       victim) != 0)
+					fail("delete failed!", "true");
+				vect[victim] = false;
+				count--;
+			}
+		}
+		if (val % 997 == 0 || ht.old != NULL)
+			if (swiss_selfcheck(&ht) != 0)
+				fail("selfcheck failed!", "true");
+	}
+	check(&ht, vect, count);
+	size_t iterated = 0;
+	struct swiss_iterator itr;
+	swiss_iterator_begin(&ht, &itr);
+	while (swiss_iterator_get_and_next(&ht, &itr) != NULL)
+		iterated++;
+	if (iterated != count)
+		fail("iteration failed!", "true");
+	swiss_destroy(&ht);
+
+	footer();
+}
+
+static void
+replace_test()
+{
+	header();
+
+	struct swiss_core ht;
+	swiss_create(&ht, swiss_extent_size,
+		     my_swiss_alloc, my_swiss_free, &extents_count, 0);
+	hash_value_t replaced = 0;
+	if (swiss_replace(&ht, hash(1), 1, &replaced) != 1)
+		fail("replace in empty table", "true");
+	for (hash_value_t val = 0; val < 1000; val++)
+		swiss_insert(&ht, hash(val), val);
+	for (hash_value_t val = 0; val < 1000; val++) {
+		if (swiss_replace(&ht, hash(val), val, &replaced) != 0 ||
+		    replaced != val)
+			fail("replace failed!", "true");
+	}
+	if (swiss_replace(&ht, hash(1000), 1000, &replaced) != 1)
+		fail("replace of absent value", "true");
+	if (ht.count != 1000)
+		fail("count check failed!", "true");
+	swiss_destroy(&ht);
+
+	footer();
+}
+
+static void
+iterator_test()
+{
+	header();
+
+	struct swiss_core ht;
+	swiss_create(&ht, swiss_extent_size,
+		     my_swiss_alloc, my_swiss_free, &extents_count, 0);
+	const size_t rounds = 1000;
+	const size_t start_limits = 20;
+
+	const size_t iterator_count = 16;
+	struct swiss_iterator iterators[iterator_count];
+	for (size_t i = 0; i < iterator_count; i++)
+		swiss_iterator_begin(&ht, iterators + i);
+	size_t cur_iterator = 0;
+	hash_value_t strage_thing = 0;
+
+	for (size_t limits = start_limits; limits <= 2 * rounds; limits *= 10) {
+		for (size_t i = 0; i < rounds; i++) {
+			hash_value_t val = rand() % limits;
+			hash_t h = hash(val);
+			uint32_t fnd = swiss_find(&ht, h, val);
+
+			if (fnd == swiss_end) {
+				swiss_insert(&ht, h, val);
+			} else {
+				swiss_delete(&ht, fnd);
+			}
+
+			hash_value_t *pval = swiss_iterator_get_and_next(&ht, iterators + cur_iterator);
+			if (pval)
+				strage_thing ^= *pval;
+			if (!pval || (rand() % iterator_count) == 0) {
+				if (rand() % iterator_count) {
+					hash_value_t val = rand() % limits;
+					hash_t h = hash(val);
+					swiss_iterator_key(&ht, iterators + cur_iterator, h, val);
+				} else {
+					swiss_iterator_begin(&ht, iterators + cur_iterator);
+				}
+			}
+
+			cur_iterator++;
+			if (cur_iterator >= iterator_count)
+				cur_iterator = 0;
+		}
+	}
+	swiss_destroy(&ht);
+
+	if (strage_thing >> 20) {
+		printf("impossible!\n"); // prevent strage_thing to be optimized out
+	}
+
+	footer();
+}
+
+static void
+read_view_check()
+{
+	header();
+
+	const int test_data_size = 1000;
+	hash_value_t comp_buf[test_data_size];
+	const int test_data_mod = 2000;
+	srand(0);
+	struct swiss_core ht;
+
+	for (int i = 0; i < 10; i++) {
+		swiss_create(&ht, swiss_extent_size,
+			     my_swiss_alloc, my_swiss_free, &extents_count, 0);
+		int comp_buf_size = 0;
+		for (int j = 0; j < test_data_size; j++) {
+			hash_value_t val = rand() % test_data_mod;
+			hash_t h = hash(val);
+			if (swiss_find(&ht, h, val) == swiss_end)
+				swiss_insert(&ht, h, val);
+		}
+		struct swiss_read_view rv;
+		swiss_read_view_create(&ht, &rv);
+		hash_value_t *e;
+		while ((e = swiss_read_view_get_and_next(&rv)) != NULL)
+			comp_buf[comp_buf_size++] = *e;
+		swiss_read_view_destroy(&rv);
+		if (comp_buf_size != (int)ht.count)
+			fail("read view size", "true");
+
+		struct swiss_read_view rv1;
+		swiss_read_view_create(&ht, &rv1);
+		struct swiss_read_view rv2;
+		swiss_read_view_create(&ht, &rv2);
+		/* Make the table grow. */
+		for (int j = 0; j < 4 * test_data_size; j++) {
+			hash_value_t val = test_data_mod + j;
+			swiss_insert(&ht, hash(val), val);
+		}
+		int tested_count = 0;
+		while ((e = swiss_read_view_get_and_next(&rv1)) != NULL) {
+			if (tested_count >= comp_buf_size ||
+			    *e != comp_buf[tested_count])
+				fail("version restore failed (1)", "true");
+			tested_count++;
+		}
+		if (tested_count != comp_buf_size)
+			fail("version restore failed (2)", "true");
+		swiss_read_view_destroy(&rv1);
+		for (int j = 0; j < test_data_mod; j++) {
+			hash_value_t val = j;
+			uint32_t pos = swiss_find(&ht, hash(val), val);
+			if (pos != swiss_end)
+				swiss_delete(&ht, pos);
+		}
+		/* The read view may outlive the hash table. */
+		swiss_destroy(&ht);
+
+		tested_count = 0;
+		while ((e = swiss_read_view_get_and_next(&rv2)) != NULL) {
+			if (tested_count >= comp_buf_size ||
+			    *e != comp_buf[tested_count])
+				fail("version restore failed (3)", "true");
+			tested_count++;
+		}
+		if (tested_count != comp_buf_size)
+			fail("version restore failed (4)", "true");
+		swiss_read_view_destroy(&rv2);
+	}
+
+	footer();
+}
+
+int
+main(int, const char**)
+{
+	srand(time(0));
+	simple_test(1);
+	/* All values collide in the first group. */
+	simple_test(1 << 20);
+	grow_test();
+	replace_test();
+	iterator_test();
+	read_view_check();
+	if (extents_count != 0)
+		fail("memory leak!", "true");
+}
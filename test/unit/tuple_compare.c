@@ -0,0 +1,313 @@
+#include "unit.h"
+#include "memory.h"
+#include "fiber.h"
+#include "clock.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "box/tuple.h"
+#include "box/tuple_format.h"
+#include "box/key_def.h"
+
+#include <string.h>
+#include <time.h>
+
+/*
+ * Checks comparators, hashers and key extractors picked for
+ * a key definition against the general-purpose ones.
+ *
+ * Run with the "bench" argument to also print how much time
+ * each function takes, e.g. `tuple_compare.test bench 1000000`.
+ */
+
+enum {
+	/** Number of tuples to pick pairs from. */
+	TUPLE_COUNT = 1000,
+	/** Number of checked pairs per key definition. */
+	CHECK_COUNT = 20000,
+	/** Default number of benchmark iterations. */
+	BENCH_COUNT = 1000000,
+	/** Number of fields in a tuple. */
+	FIELD_COUNT = 5,
+	MAX_PART_COUNT = 3,
+};
+
+/**
+ * Tuple fields are:
+ * [unsigned, string, integer, unsigned, string].
+ * Value ranges are small to get many equal fields.
+ */
+static const enum field_type field_types[FIELD_COUNT] = {
+	FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING, FIELD_TYPE_INTEGER,
+	FIELD_TYPE_UNSIGNED, FIELD_TYPE_STRING,
+};
+
+struct layout {
+	const char *name;
+	uint32_t part_count;
+	uint32_t fieldno[MAX_PART_COUNT];
+};
+
+static const struct layout layouts[] = {
+	{"[0]", 1, {0}},
+	{"[3]", 1, {3}},
+	{"[2]", 1, {2}},
+	{"[0, 1]", 2, {0, 1}},
+	{"[1, 3]", 2, {1, 3}},
+	{"[3, 2]", 2, {3, 2}},
+	{"[0, 1, 2]", 3, {0, 1, 2}},
+	{"[4, 2, 0]", 3, {4, 2, 0}},
+	{"[2, 3, 4]", 3, {2, 3, 4}},
+};
+
+static struct tuple *tuples[TUPLE_COUNT];
+
+static struct key_def *
+layout_key_def(const struct layout *layout, bool is_generic)
+{
+	struct key_part_def parts[MAX_PART_COUNT];
+	for (uint32_t i = 0; i < layout->part_count; i++) {
+		parts[i] = key_part_def_default;
+		parts[i].fieldno = layout->fieldno[i];
+		parts[i].type = field_types[layout->fieldno[i]];
+		/*
+		 * Nullable optional parts make the key definition
+		 * use the general-purpose functions, while the data
+		 * has no nulls, so the results must be the same.
+		 */
+		parts[i].is_nullable = is_generic;
+	}
+	struct key_def *def = key_def_new(parts, layout->part_count, false);
+	fail_if(def == NULL);
+	if (is_generic)
+		key_def_update_optionality(def, 0);
+	return def;
+}
+
+static char *
+encode_str(char *data)
+{
+	char str[16];
+	uint32_t len = rand() % sizeof(str);
+	for (uint32_t i = 0; i < len; i++)
+		str[i] = 'a' + rand() % 3;
+	return mp_encode_str(data, str, len);
+}
+
+static void
+tuples_create(struct tuple_format *format)
+{
+	char buf[128];
+	for (int i = 0; i < TUPLE_COUNT; i++) {
+		char *data = buf;
+		data = mp_encode_array(data, FIELD_COUNT);
+		data = mp_encode_uint(data, rand() % 20);
+		data = encode_str(data);
+		int64_t v = rand() % 40 - 20;
+		data = v < 0 ? mp_encode_int(data, v) :
+			       mp_encode_uint(data, v);
+		data = mp_encode_uint(data, rand() % 1000 * 1000000007ULL);
+		data = encode_str(data);
+		assert(data <= buf + sizeof(buf));
+		tuples[i] = tuple_new(format, buf, data);
+		fail_if(tuples[i] == NULL);
+		tuple_ref(tuples[i]);
+	}
+}
+
+static void
+tuples_delete(void)
+{
+	for (int i = 0; i < TUPLE_COUNT; i++)
+		tuple_unref(tuples[i]);
+}
+
+static int
+sign(int rc)
+{
+	return rc < 0 ? -1 : rc > 0;
+}
+
+static bool
+check_layout(struct key_def *def, struct key_def *generic)
+{
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	bool ok = true;
+	for (int i = 0; i < CHECK_COUNT && ok; i++) {
+		struct tuple *a = tuples[rand() % TUPLE_COUNT];
+		struct tuple *b = tuples[rand() % TUPLE_COUNT];
+		if (sign(tuple_compare(a, HINT_NONE, b, HINT_NONE, def)) !=
+		    sign(tuple_compare(a, HINT_NONE, b, HINT_NONE, generic)))
+			ok = false;
+		uint32_t size, generic_size;
+		const char *key = tuple_extract_key(b, def, MULTIKEY_NONE,
+						    &size);
+		const char *generic_key = tuple_extract_key(b, generic,
+							    MULTIKEY_NONE,
+							    &generic_size);
+		fail_if(key == NULL || generic_key == NULL);
+		if (size != generic_size || memcmp(key, generic_key, size) != 0)
+			ok = false;
+		uint32_t part_count = mp_decode_array(&key);
+		part_count = rand() % (part_count + 1);
+		if (sign(tuple_compare_with_key(a, HINT_NONE, key, part_count,
+						HINT_NONE, def)) !=
+		    sign(tuple_compare_with_key(a, HINT_NONE, key, part_count,
+						HINT_NONE, generic)))
+			ok = false;
+		if (tuple_hash(b, def) != key_hash(key, def))
+			ok = false;
+		region_truncate(region, used);
+	}
+	return ok;
+}
+
+static double
+bench_compare(struct key_def *def, int count)
+{
+	double start = clock_monotonic();
+	int sum = 0;
+	for (int i = 0; i < count; i++) {
+		struct tuple *a = tuples[i % TUPLE_COUNT];
+		struct tuple *b = tuples[(i * 7 + 1) % TUPLE_COUNT];
+		sum += tuple_compare(a, HINT_NONE, b, HINT_NONE, def);
+	}
+	double time = clock_monotonic() - start;
+	if (sum == INT32_MAX)
+		printf("impossible!\n"); /* prevent optimizing out */
+	return time;
+}
+
+static double
+bench_compare_with_key(struct key_def *def, int count)
+{
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	const char *keys[TUPLE_COUNT];
+	for (int i = 0; i < TUPLE_COUNT; i++) {
+		keys[i] = tuple_extract_key(tuples[i], def, MULTIKEY_NONE,
+					    NULL);
+		fail_if(keys[i] == NULL);
+		mp_decode_array(&keys[i]);
+	}
+	double start = clock_monotonic();
+	int sum = 0;
+	for (int i = 0; i < count; i++) {
+		struct tuple *a = tuples[i % TUPLE_COUNT];
+		const char *key = keys[(i * 7 + 1) % TUPLE_COUNT];
+		sum += tuple_compare_with_key(a, HINT_NONE, key,
+					      def->part_count, HINT_NONE, def);
+	}
+	double time = clock_monotonic() - start;
+	if (sum == INT32_MAX)
+		printf("impossible!\n"); /* prevent optimizing out */
+	region_truncate(region, used);
+	return time;
+}
+
+static double
+bench_hash(struct key_def *def, int count)
+{
+	double start = clock_monotonic();
+	uint32_t sum = 0;
+	for (int i = 0; i < count; i++)
+		sum ^= tuple_hash(tuples[i % TUPLE_COUNT], def);
+	double time = clock_monotonic() - start;
+	if (sum == UINT32_MAX)
+		printf("impossible!\n"); /* prevent optimizing out */
+	return time;
+}
+
+static double
+bench_extract_key(struct key_def *def, int count)
+{
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	double start = clock_monotonic();
+	for (int i = 0; i < count; i++) {
+		fail_if(tuple_extract_key(tuples[i % TUPLE_COUNT], def,
+					  MULTIKEY_NONE, NULL) == NULL);
+		region_truncate(region, used);
+	}
+	return clock_monotonic() - start;
+}
+
+static void
+bench_layout(const struct layout *layout, struct key_def *def,
+	     struct key_def *generic, int count)
+{
+	double (*bench[])(struct key_def *, int) = {
+		bench_compare, bench_compare_with_key,
+		bench_hash, bench_extract_key,
+	};
+	static const char *names[] = {
+		"compare", "compare_with_key", "hash", "extract_key",
+	};
+	for (unsigned i = 0; i < lengthof(bench); i++) {
+		double time = bench[i](def, count);
+		double generic_time = bench[i](generic, count);
+		fprintf(stderr, "%-10s %-17s %6.1f ns %6.1f ns %5.2fx\n",
+			layout->name, names[i], time * 1e9 / count,
+			generic_time * 1e9 / count, generic_time / time);
+	}
+}
+
+static void
+tuple_compare_test(int bench_count)
+{
+	header();
+	plan(lengthof(layouts));
+
+	struct key_def *defs[lengthof(layouts)];
+	struct key_def *generic_defs[lengthof(layouts)];
+	for (unsigned i = 0; i < lengthof(layouts); i++) {
+		defs[i] = layout_key_def(&layouts[i], false);
+		generic_defs[i] = layout_key_def(&layouts[i], true);
+	}
+	struct tuple_format *format = box_tuple_format_new(defs,
+							   lengthof(defs));
+	fail_if(format == NULL);
+	tuples_create(format);
+
+	for (unsigned i = 0; i < lengthof(layouts); i++) {
+		ok(check_layout(defs[i], generic_defs[i]),
+		   "layout %s", layouts[i].name);
+	}
+	if (bench_count > 0) {
+		fprintf(stderr, "%-10s %-17s %9s %9s\n", "layout",
+			"function", "picked", "generic");
+		for (unsigned i = 0; i < lengthof(layouts); i++)
+			bench_layout(&layouts[i], defs[i], generic_defs[i],
+				     bench_count);
+	}
+
+	tuples_delete();
+	tuple_format_unref(format);
+	for (unsigned i = 0; i < lengthof(layouts); i++) {
+		key_def_delete(defs[i]);
+		key_def_delete(generic_defs[i]);
+	}
+
+	footer();
+	check_plan();
+}
+
+int
+main(int argc, char **argv)
+{
+	int bench_count = 0;
+	if (argc > 1 && strcmp(argv[1], "bench") == 0)
+		bench_count = argc > 2 ? atoi(argv[2]) : BENCH_COUNT;
+
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	tuple_init(NULL);
+	srand(time(NULL));
+
+	tuple_compare_test(bench_count);
+
+	tuple_free();
+	fiber_free();
+	memory_free();
+	return 0;
+}
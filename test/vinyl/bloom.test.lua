@@ -151,3 +151,64 @@ s:get(-1LL)
 s:get(9007199254740992LL)
 s:get(-9007199254740994LL)
 s:drop()
+
+--
+-- Split block bloom filter.
+--
+s = box.schema.space.create('test', {engine = 'memtx'})
+s:create_index('pk', {bloom_type = 'split_block'})
+s:drop()
+s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {bloom_type = 'foo'})
+_ = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}, run_count_per_level = 10, bloom_fpr = 0.01, bloom_type = 'split_block'})
+s.index.pk.options.bloom_type
+for i = 1, 1000 do s:replace{i, i} end
+box.snapshot()
+s.index.pk:stat().disk.bloom_size > 0
+
+box.cfg{vinyl_cache = 0}
+_ = new_reflects()
+_ = new_seeks()
+
+for i = 1, 1000 do s:select{i} end
+new_reflects() == 0
+new_seeks() == 1000
+
+for i = 1, 1000 do s:select{i, i} end
+new_reflects() == 0
+new_seeks() == 1000
+
+for i = 1001, 2000 do s:select{i} end
+new_reflects() > 970
+new_seeks() < 30
+
+-- Runs with different bloom filter layouts can coexist.
+s.index.pk:alter{bloom_type = 'classic'}
+s.index.pk.options.bloom_type
+for i = 1001, 2000 do s:replace{i, i} end
+box.snapshot()
+s.index.pk:stat().run_count
+found = 0
+for i = 1, 2000 do if s:get{i, i} ~= nil then found = found + 1 end end
+found
+_ = new_reflects()
+_ = new_seeks()
+for i = 2001, 3000 do s:select{i} end
+new_reflects() > 1940
+new_seeks() < 60
+
+test_run:cmd('restart server default')
+box.cfg{vinyl_cache = 0}
+s = box.space.test
+s.index.pk.options.bloom_type
+reflects = 0
+function cur_reflects() return box.space.test.index.pk:stat().disk.iterator.bloom.hit end
+function new_reflects() local o = reflects reflects = cur_reflects() return reflects - o end
+found = 0
+for i = 1, 2000 do if s:get{i, i} ~= nil then found = found + 1 end end
+found
+_ = new_reflects()
+for i = 2001, 3000 do s:select{i} end
+new_reflects() > 1940
+s:drop()
+box.cfg{vinyl_cache = 10240}
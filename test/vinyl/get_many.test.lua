@@ -0,0 +1,119 @@
+test_run = require('test_run').new()
+msgpack = require('msgpack')
+
+-- Disable tuple cache so that all lookups go to disk.
+box.cfg{vinyl_cache = 0}
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, page_size = 1024})
+_ = s:create_index('nu', {parts = {3, 'string'}, unique = false})
+for i = 1, 1000 do s:replace{i, 2000 - i, string.rep('x', 100)} end
+box.snapshot()
+for i = 1, 1000, 3 do s:replace{i, 4000 - i, 'y'} end
+box.snapshot()
+for i = 1, 1000, 10 do s:replace{i, 6000 - i, 'z'} end
+for i = 5, 1000, 10 do s:delete{i} end
+
+--
+-- get_many() returns the same tuples as get() called for each
+-- key, in the order of the keys. Keys that match nothing are
+-- skipped.
+--
+#s:get_many({})
+r = s:get_many({3, 5, 1, 3000, 3})
+#r
+r[1][1], r[2][1], r[3][1]
+
+test_run:cmd("setopt delimiter ';'")
+function gets(index, keys)
+    local ret = {}
+    for _, key in ipairs(keys) do
+        local tuple = index:get(key)
+        if tuple ~= nil then
+            table.insert(ret, tuple)
+        end
+    end
+    return ret
+end;
+function equal(r1, r2)
+    return msgpack.encode(r1) == msgpack.encode(r2)
+end;
+function check(index, keys)
+    return equal(index:get_many(keys), gets(index, keys))
+end;
+test_run:cmd("setopt delimiter ''");
+
+keys = {}
+for i = 1200, 0, -7 do table.insert(keys, i) end
+for i = 1, 1200, 11 do table.insert(keys, {i}) end
+check(s.index.pk, keys)
+check(s.index.pk, {1000, 1, 500, 500, 1})
+sk_keys = {}
+for i = 0, 7000, 13 do table.insert(sk_keys, i) end
+check(s.index.sk, sk_keys)
+equal(s:get_many(keys), s.index.pk:get_many(keys))
+
+--
+-- Keys stored in the same page share the page read.
+--
+t = box.schema.space.create('test2', {engine = 'vinyl'})
+_ = t:create_index('pk', {page_size = 1024})
+for i = 1, 100 do t:replace{i, string.rep('x', 100)} end
+box.snapshot()
+reads = 0
+function new_reads() local o = reads reads = t.index.pk:stat().disk.iterator.read.pages return reads - o end
+_ = new_reads()
+_ = gets(t.index.pk, {4, 2, 3})
+new_reads() -- 3
+#t:get_many({4, 2, 3})
+new_reads() -- 1
+#t:get_many({90, 10, 50})
+new_reads() -- 3
+t:drop()
+
+--
+-- get_many() sees the changes made by the transaction.
+--
+box.begin()
+s:replace{2, 8000, 'w'}
+s:delete{3}
+r = s:get_many({2, 3, 4})
+s.index.sk:get_many({8000})[1][1]
+box.rollback()
+#r
+r[1][3], r[2][1]
+s:get{2}[3] == string.rep('x', 100)
+
+--
+-- The results stay the same with tuple cache on.
+--
+box.cfg{vinyl_cache = 10 * 1024 * 1024}
+check(s.index.pk, keys)
+check(s.index.sk, sk_keys)
+check(s.index.pk, keys)
+check(s.index.sk, sk_keys)
+box.cfg{vinyl_cache = 0}
+
+--
+-- Errors.
+--
+s:get_many(1)
+s.index.nu:get_many({'x'})
+s:get_many({{1, 2}})
+s:get_many({'abc'})
+
+--
+-- memtx indexes support get_many() too.
+--
+m = box.schema.space.create('memtx')
+_ = m:create_index('pk')
+_ = m:create_index('sk', {type = 'hash', parts = {2, 'unsigned'}})
+for i = 1, 100 do m:replace{i, 200 - i} end
+check(m.index.pk, keys)
+check(m.index.sk, sk_keys)
+#m:get_many({1, 1, 101})
+m:drop()
+
+s:drop()
+box.cfg{vinyl_cache = 10240}
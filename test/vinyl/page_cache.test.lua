@@ -0,0 +1,66 @@
+test_run = require('test_run').new()
+
+-- Disable tuple cache so that all lookups go to disk.
+box.cfg{vinyl_cache = 0, vinyl_page_cache = 1024 * 1024}
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+for i = 1, 100 do s:replace{i, string.rep('x', 100)} end
+box.snapshot()
+
+hits = 0
+function new_hits() local o = hits hits = box.stat.vinyl().page_cache.hit return hits - o end
+misses = 0
+function new_misses() local o = misses misses = box.stat.vinyl().page_cache.miss return misses - o end
+reads = 0
+function new_reads() local o = reads reads = s.index.pk:stat().disk.iterator.read.pages return reads - o end
+_ = new_hits()
+_ = new_misses()
+_ = new_reads()
+
+--
+-- The first lookup reads the page from disk, the second one
+-- finds it in the page cache.
+--
+s:get{1}[1]
+new_hits() -- 0
+new_misses() -- 1
+new_reads() -- 1
+s:get{1}[1]
+new_hits() -- 1
+new_misses() -- 0
+new_reads() -- 0
+box.stat.vinyl().memory.page_cache > 0
+
+--
+-- A page that was reused is not evicted by a scan.
+--
+box.cfg{vinyl_page_cache = 8 * 1024}
+#s:select{}
+box.stat.vinyl().memory.page_cache <= 8 * 1024
+_ = new_hits()
+_ = new_misses()
+_ = new_reads()
+s:get{1}[1]
+new_hits() -- 1
+new_reads() -- 0
+
+--
+-- Setting the quota to 0 disables the cache.
+--
+box.cfg{vinyl_page_cache = 0}
+box.stat.vinyl().memory.page_cache -- 0
+s:get{1}[1]
+new_hits() -- 0
+new_reads() -- 1
+
+--
+-- Pages of a deleted run are freed.
+--
+box.cfg{vinyl_page_cache = 1024 * 1024}
+s:get{1}[1]
+box.stat.vinyl().memory.page_cache > 0
+s:drop()
+test_run:wait_cond(function() return box.stat.vinyl().memory.page_cache == 0 end)
+
+box.cfg{vinyl_cache = 10240, vinyl_page_cache = 0}
@@ -0,0 +1,142 @@
+test_run = require('test_run').new()
+msgpack = require('msgpack')
+
+--
+-- page_restart_interval is checked and is only allowed for vinyl.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {page_restart_interval = -1})
+s:create_index('pk', {page_restart_interval = 129})
+s:drop()
+s = box.schema.space.create('test', {engine = 'memtx'})
+s:create_index('pk', {page_restart_interval = 16})
+s:drop()
+
+-- Disable tuple cache so that all lookups go to disk.
+box.cfg{vinyl_cache = 0}
+
+--
+-- Keys sharing a long prefix take much less space on disk
+-- if stored with prefix compression.
+--
+s1 = box.schema.space.create('test1', {engine = 'vinyl'})
+_ = s1:create_index('pk', {parts = {1, 'string'}, page_size = 1024, page_restart_interval = 8})
+_ = s1:create_index('sk', {parts = {2, 'unsigned'}, unique = false, page_size = 1024, page_restart_interval = 8})
+s2 = box.schema.space.create('test2', {engine = 'vinyl'})
+_ = s2:create_index('pk', {parts = {1, 'string'}, page_size = 1024})
+_ = s2:create_index('sk', {parts = {2, 'unsigned'}, unique = false, page_size = 1024})
+s1.index.pk.options.page_restart_interval -- 8
+s2.index.pk.options.page_restart_interval -- nil
+
+prefix = 'tenant-0123456789/collection-0123456789/item-'
+function key(i) return string.format('%s%05d', prefix, i) end
+for i = 1, 1000 do s1:replace{key(i), i % 10} s2:replace{key(i), i % 10} end
+for i = 1, 1000, 7 do s1:delete{key(i)} s2:delete{key(i)} end
+box.snapshot()
+
+s1.index.pk:stat().disk.bytes < s2.index.pk:stat().disk.bytes / 2
+s1.index.sk:stat().disk.bytes < s2.index.sk:stat().disk.bytes
+
+--
+-- Runs with prefix compressed pages are written in a format
+-- version older versions refuse to read.
+--
+fio = require('fio')
+function run_version(s) local f = fio.glob(fio.pathjoin(box.cfg.vinyl_dir, s.id, 0, '*.run'))[1] local fh = fio.open(f) local v = fh:read(64):split('\n')[2] fh:close() return v end
+run_version(s1)
+run_version(s2)
+
+--
+-- Lookups return the same results no matter if keys are
+-- compressed or not.
+--
+test_run:cmd("setopt delimiter ';'")
+function equal(r1, r2)
+    return msgpack.encode(r1) == msgpack.encode(r2)
+end;
+function check()
+    local errors = 0
+    local iterators = {'EQ', 'GE', 'GT', 'LE', 'LT'}
+    for i = 0, 1001 do
+        for _, it in ipairs(iterators) do
+            local opts = {iterator = it, limit = 3}
+            if not equal(s1:select(key(i), opts),
+                         s2:select(key(i), opts)) then
+                errors = errors + 1
+            end
+        end
+        if not equal(s1:get(key(i)), s2:get(key(i))) then
+            errors = errors + 1
+        end
+    end
+    for i = 0, 10 do
+        for _, it in ipairs(iterators) do
+            local opts = {iterator = it}
+            if not equal(s1.index.sk:select(i, opts),
+                         s2.index.sk:select(i, opts)) then
+                errors = errors + 1
+            end
+        end
+    end
+    if not equal(s1:select(), s2:select()) then
+        errors = errors + 1
+    end
+    return errors
+end;
+test_run:cmd("setopt delimiter ''");
+
+check() -- 0
+
+--
+-- Runs written with different restart intervals can be
+-- read together.
+--
+s1.index.pk:alter{page_restart_interval = 0}
+s2.index.pk:alter{page_restart_interval = 1}
+s1.index.pk.options.page_restart_interval -- nil
+s2.index.pk.options.page_restart_interval -- 1
+for i = 1, 1000, 3 do s1:replace{key(i), i % 10 + 1} s2:replace{key(i), i % 10 + 1} end
+box.snapshot()
+check() -- 0
+
+--
+-- Compressed pages are read after recovery.
+--
+test_run:cmd('restart server default')
+test_run = require('test_run').new()
+msgpack = require('msgpack')
+box.cfg{vinyl_cache = 0}
+s1 = box.space.test1
+s2 = box.space.test2
+s1.index.sk.options.page_restart_interval -- 8
+prefix = 'tenant-0123456789/collection-0123456789/item-'
+function key(i) return string.format('%s%05d', prefix, i) end
+test_run:cmd("setopt delimiter ';'")
+function equal(r1, r2)
+    return msgpack.encode(r1) == msgpack.encode(r2)
+end;
+function check()
+    local errors = 0
+    local iterators = {'EQ', 'GE', 'GT', 'LE', 'LT'}
+    for i = 0, 1001 do
+        for _, it in ipairs(iterators) do
+            local opts = {iterator = it, limit = 3}
+            if not equal(s1:select(key(i), opts),
+                         s2:select(key(i), opts)) then
+                errors = errors + 1
+            end
+        end
+    end
+    for i = 0, 11 do
+        if not equal(s1.index.sk:select(i), s2.index.sk:select(i)) then
+            errors = errors + 1
+        end
+    end
+    return errors
+end;
+test_run:cmd("setopt delimiter ''");
+check() -- 0
+
+s1:drop()
+s2:drop()
+box.cfg{vinyl_cache = 10240}
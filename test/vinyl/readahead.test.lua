@@ -0,0 +1,95 @@
+test_run = require('test_run').new()
+msgpack = require('msgpack')
+
+box.cfg{vinyl_readahead = -1}
+
+-- Disable tuple cache so that all lookups go to disk.
+box.cfg{vinyl_cache = 0, vinyl_readahead = 4}
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+for i = 1, 1000 do s:replace{i, string.rep('x', 100)} end
+box.snapshot()
+page_count = s.index.pk:stat().disk.pages
+page_count > 10
+
+pages = 0
+function new_pages() local o = pages pages = box.stat.vinyl().readahead.pages return pages - o end
+wasted = 0
+function new_wasted() local o = wasted wasted = box.stat.vinyl().readahead.wasted return wasted - o end
+reads = 0
+function new_reads() local o = reads reads = s.index.pk:stat().disk.iterator.read.pages return reads - o end
+_ = new_pages()
+_ = new_wasted()
+_ = new_reads()
+
+--
+-- Point lookups don't read ahead.
+--
+s:get{500}[1]
+new_pages() -- 0
+new_reads() -- 1
+
+--
+-- Once a scan moves to the next page, the following pages
+-- are read ahead.
+--
+#s:select()
+new_pages() == page_count - 2
+new_wasted() -- 0
+new_reads() == page_count
+#s:select({}, {iterator = 'LE'})
+new_pages() == page_count - 2
+new_wasted() -- 0
+new_reads() == page_count
+
+--
+-- Pages read ahead that the scan didn't get to are dropped.
+--
+#s:select({}, {limit = 50})
+new_pages() > 0
+new_wasted() > 0
+
+--
+-- Scans return the same results with and without readahead.
+--
+test_run:cmd("setopt delimiter ';'")
+function scan()
+    return msgpack.encode({s:select({}),
+                           s:select({}, {iterator = 'LE'}),
+                           s:select({300}, {iterator = 'GT'}),
+                           s:select({700}, {iterator = 'LT'}),
+                           s:select({100}, {iterator = 'GE', limit = 200})})
+end;
+test_run:cmd("setopt delimiter ''");
+r1 = scan()
+new_pages() > 0
+box.cfg{vinyl_readahead = 0}
+r2 = scan()
+new_pages() -- 0
+r1 == r2
+
+box.cfg{vinyl_readahead = 1}
+r3 = scan()
+new_pages() > 0
+r1 == r3
+
+--
+-- Equality lookups don't read ahead even if the key spans
+-- several pages.
+--
+s2 = box.schema.space.create('test2', {engine = 'vinyl'})
+_ = s2:create_index('pk', {page_size = 1024})
+_ = s2:create_index('sk', {parts = {2, 'unsigned'}, unique = false, page_size = 1024})
+for i = 1, 1000 do s2:replace{i, i % 2, string.rep('x', 100)} end
+box.snapshot()
+s2.index.sk:stat().disk.pages > 4
+_ = new_pages()
+#s2.index.sk:select({1})
+new_pages() -- 0
+#s2.index.sk:select({1}, {iterator = 'REQ'})
+new_pages() -- 0
+s2:drop()
+
+s:drop()
+box.cfg{vinyl_cache = 10240, vinyl_readahead = 0}
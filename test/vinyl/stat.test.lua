@@ -87,9 +87,15 @@ end;
 --
 -- Filter dump/compaction time as we need error injection to
 -- test them properly.
+--
+-- The page cache and readahead are disabled in this test and
+-- checked by vinyl/page_cache.test.lua and vinyl/readahead.test.lua.
 function gstat()
     local st = box.stat.vinyl()
     st.regulator = nil
+    st.page_cache = nil
+    st.readahead = nil
+    st.memory.page_cache = nil
     st.scheduler.dump_time = nil
     st.scheduler.compaction_time = nil
     return st
@@ -15,6 +15,14 @@ extern "C" {
 void qsort_arg(void *a, size_t n, size_t es,
 	       int (*cmp)(const void *a, const void *b, void *arg), void *arg);
 
+/**
+ * Single-threaded version of qsort_arg(), for callers that
+ * already run in a thread of their own.
+ */
+void qsort_arg_st(void *a, size_t n, size_t es,
+		  int (*cmp)(const void *a, const void *b, void *arg),
+		  void *arg);
+
 #if defined(__cplusplus)
 }
 #endif /* defined(__cplusplus) */